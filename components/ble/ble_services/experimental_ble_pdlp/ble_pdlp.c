@@ -49,6 +49,15 @@ static bool                      m_indication_confirmed = false;
 
 static ble_pdls_init_t m_pdlp_service;
 
+/**@brief PDSIS threshold gating state of each sensor type. */
+static struct
+{
+    ble_pdsis_notify_value_t threshold;         /**< Threshold set by the PDLP Client, 0 to indicate every change. */
+    ble_pdsis_notify_value_t last;              /**< Last indicated value. */
+    bool                     has_last;          /**< A value was indicated since the threshold was set. */
+    uint8_t                  suppressed_count;  /**< Values not indicated since the last indicated one. */
+}                                m_pdsis_gate[PDSIS_SETTING_MAX];
+
 // Forward declaration
 static void service_reset(void);
 static uint32_t handle_transmit_written(ble_pdls_t * p_pdls);
@@ -158,6 +167,7 @@ static uint32_t indicate_ack(ble_pdls_t * p_pdls)
 static void on_connect(ble_pdls_t * p_pdls, ble_evt_t * p_ble_evt)
 {
     p_pdls->conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
+    memset(m_pdsis_gate, 0, sizeof(m_pdsis_gate));
 }
 
 /**@brief Function for handling the Disconnect event.
@@ -471,6 +481,60 @@ static ble_pdls_result_code_t PDPIS_service_handler(uint16_t msgid, uint16_t *rs
     return PDLS_RESULT_OK;
 }
 
+/**@brief Function for checking whether a PDSIS value changed by more than the threshold since the last indicated value.
+ *
+ * @details The 3-axis values and thresholds are IEEE 754 single precision, the other ones are in the 12-bit
+ *          DoCoMo format of their sensor type.
+ *
+ * @param[in]  sensor_type     Type of sensor
+ * @param[in]  p_notify_value  Sensor data to be notified to PDLP Client.
+ */
+static bool pdsis_value_changed(ble_pdsis_sensor_type_t sensor_type, ble_pdsis_notify_value_t *p_notify_value)
+{
+    ble_pdsis_notify_value_t const * p_last      = &m_pdsis_gate[sensor_type].last;
+    ble_pdsis_notify_value_t const * p_threshold = &m_pdsis_gate[sensor_type].threshold;
+    float    value, last, threshold;
+    uint8_t  i;
+
+    switch (sensor_type)
+    {
+      case PDSIS_SENSOR_TYPE_GYROSCOPE:
+      case PDSIS_SENSOR_TYPE_ACCELEROMETER:
+      case PDSIS_SENSOR_TYPE_ORIENTATION:
+        for (i = 0; i < 3; i++)
+        {
+          memcpy(&value,     &p_notify_value->u32_originaldata[i], sizeof(float));
+          memcpy(&last,      &p_last->u32_originaldata[i],         sizeof(float));
+          memcpy(&threshold, &p_threshold->u32_originaldata[i],    sizeof(float));
+          if (((value > last) ? (value - last) : (last - value)) > threshold)
+          {
+            return true;
+          }
+        }
+        return false;
+
+      case PDSIS_SENSOR_TYPE_TEMPERATURE:
+        value     = IEEE754_Decode_Temperature(p_notify_value->u16_originaldata[0]);
+        last      = IEEE754_Decode_Temperature(p_last->u16_originaldata[0]);
+        threshold = IEEE754_Decode_Temperature(p_threshold->u16_originaldata[0]);
+        break;
+
+      case PDSIS_SENSOR_TYPE_HUMIDITY:
+        value     = IEEE754_Decode_Humidity(p_notify_value->u16_originaldata[0]);
+        last      = IEEE754_Decode_Humidity(p_last->u16_originaldata[0]);
+        threshold = IEEE754_Decode_Humidity(p_threshold->u16_originaldata[0]);
+        break;
+
+      default:
+        value     = p_notify_value->u16_originaldata[0];
+        last      = p_last->u16_originaldata[0];
+        threshold = p_threshold->u16_originaldata[0];
+        break;
+    }
+
+    return ((value > last) ? (value - last) : (last - value)) > threshold;
+}
+
 /**@brief Function for handling a PDSIS request.
  *
  * @param[in]  p_pdls      PDLP Service structure.
@@ -559,9 +623,10 @@ static ble_pdls_result_code_t PDSIS_service_handler(ble_pdls_t * p_pdls, uint16_
           // Status
           event_data.event = PDSIS_EVT_SET_NOTIFY_INFO;
           result = pdls_decode_param_uint8(m_data_pos, PDSIS_PARAM_STATUS, (uint8_t *)&event_data.status);
-          ERROR_CHECK(result); paramindex++;
+          ERROR_CHECK(result);
           m_data_pos += PARAM_UINT8_LENGTH; paramindex++;
-          // Threshold or original data
+          // Threshold or original data, 0 if not given
+          memset(&event_data.data, 0, sizeof(event_data.data));
           switch (event_data.type) {
             {
               case PDSIS_SENSOR_TYPE_GYROSCOPE:
@@ -583,7 +648,9 @@ static ble_pdls_result_code_t PDSIS_service_handler(ble_pdls_t * p_pdls, uint16_
                 // optional data
                 if (paramindex < param_num)
                 {
-                  // set the *optional* OriginalData if needed
+                  // the *optional* OriginalData is the threshold, in the format of the values
+                  result = pdls_decode_param_uint16(m_data_pos, PDSIS_PARAM_ORIGINALDATA, &event_data.data.u16_originaldata[0]);
+                  ERROR_CHECK(result);
                 }
                 break;
               
@@ -594,6 +661,12 @@ static ble_pdls_result_code_t PDSIS_service_handler(ble_pdls_t * p_pdls, uint16_
           // Send the request to App for handling
           event_data.event = PDSIS_EVT_SET_NOTIFY_INFO;
           result = m_pdlp_service.pdsis_event_handler(p_pdls, &event_data);
+          if ((result == PDLS_RESULT_OK) && (event_data.type < PDSIS_SETTING_MAX))
+          {
+            // Keep the threshold for gating, the next value is always indicated
+            m_pdsis_gate[event_data.type].threshold = event_data.data;
+            m_pdsis_gate[event_data.type].has_last  = false;
+          }
           // Prepare response, first service header
           m_data_pos = m_rsp_buf;
           m_data_pos += pdls_encode_service_header(m_data_pos, PDLS_SERVICE_SIS, PDSIS_SET_NOTIFY_SENSOR_INFO_RESP, 1);
@@ -964,6 +1037,22 @@ uint32_t ble_pdls_pdos_notify(ble_pdls_t * p_pdls, ble_pdos_button_id_t button_i
 
 uint32_t ble_pdls_pdsis_notify(ble_pdls_t * p_pdls, ble_pdsis_sensor_type_t sensor_type, ble_pdsis_notify_value_t *p_notify_value)
 {
+    uint32_t err_code;
+
+    if (sensor_type >= PDSIS_SETTING_MAX)
+    {
+      return NRF_ERROR_INVALID_DATA;
+    }
+
+    // Skip values within the threshold, but send a heartbeat every pdsis_heartbeat values
+    if (m_pdsis_gate[sensor_type].has_last
+    &&  !pdsis_value_changed(sensor_type, p_notify_value)
+    &&  ((m_pdlp_service.pdsis_heartbeat == 0) || ((m_pdsis_gate[sensor_type].suppressed_count + 1) < m_pdlp_service.pdsis_heartbeat)))
+    {
+      m_pdsis_gate[sensor_type].suppressed_count++;
+      return NRF_SUCCESS;
+    }
+
     // check state
     if (m_transmit_state != PDLS_STATE_IDLE || !m_indication_confirmed)
     {
@@ -1008,7 +1097,14 @@ uint32_t ble_pdls_pdsis_notify(ble_pdls_t * p_pdls, ble_pdsis_sensor_type_t sens
     m_data_size      = m_data_pos - m_rsp_buf;
     m_data_pos       = m_rsp_buf;
     m_current_packet = 0;
-    return indicate_ack(p_pdls);
+    err_code = indicate_ack(p_pdls);
+    if (err_code == NRF_SUCCESS)
+    {
+      m_pdsis_gate[sensor_type].last             = *p_notify_value;
+      m_pdsis_gate[sensor_type].has_last         = true;
+      m_pdsis_gate[sensor_type].suppressed_count = 0;
+    }
+    return err_code;
 }
 
 uint32_t ble_pdls_pdns_get_pd_notify_detail_data(ble_pdls_t * p_pdls, uint16_t unique_id, uint8_t param_id, uint32_t param_len)
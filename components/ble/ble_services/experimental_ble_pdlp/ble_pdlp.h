@@ -44,11 +44,6 @@
 #define PDLS_UUID_WRITE_CHAR  0x9101 /**< Write Message characteristic */
 #define PDLS_UUID_IND_CHAR    0x9102 /**< Indicate Message characteristic */
 
-#define PDLS_HEADER_SOURCE_Pos                7
-#define PDLS_HEADER_CANCEL_Pos                6
-#define PDLS_HEADER_SEQNUM_Pos                1
-#define PDLS_HEADER_EXECUTE_Pos               0
-
 /**@brief PDLS service type. */
 typedef enum
 {
@@ -584,6 +579,7 @@ typedef struct
     ble_pdns_event_handler_t    pdns_event_handler;
     //PDSIS
     uint8_t   sensortypes;      /**< Sensor types */
+    uint8_t   pdsis_heartbeat;  /**< Indicate every Nth sensor value even if within the threshold, 0 for never. */
     ble_pdsis_event_handler_t   pdsis_event_handler;
     //PDSOS
     ble_pdsos_event_handler_t   pdsos_event_handler;
@@ -620,12 +616,16 @@ void ble_pdls_on_ble_evt(ble_pdls_t * p_pdls, ble_evt_t * p_ble_evt);
 uint32_t ble_pdls_pdos_notify(ble_pdls_t * p_pdls, ble_pdos_button_id_t button_id);
 
 /**@brief Function for PDSIS sensor information notification
+ *
+ * @details The value is not indicated if it changed by no more than the threshold set by the PDLP Client
+ *          since the last indicated value, except for every pdsis_heartbeat-th value.
  *
  * @param[in] p_pdls          PDLP Service structure. This data must be supplied by the application.
  * @param[in] sensor_type     Type of sensor
  * @param[in] p_notify_value  Sensor data to be notified to PDLP Client.
  *
- * @retval NRF_SUCCESS If the service was handled successfully. Otherwise, an error code is returned.
+ * @retval NRF_SUCCESS If the service was handled successfully or the value was within the threshold.
+ *                     Otherwise, an error code is returned.
  */
 uint32_t ble_pdls_pdsis_notify(ble_pdls_t * p_pdls, ble_pdsis_sensor_type_t sensor_type, ble_pdsis_notify_value_t *p_notify_value);
 
@@ -22,6 +22,22 @@
 
 #define SINT16_SERVICE_DATA_OFFS    (38)    /* The offset of the temperature in the beacon advertising pdu */
 
+/* Multi-service beacon, without the 128-bit UUID entry and with several service data entries */
+#define MULTI_SERVICE_DATA_OFFS     (20)    /* The offset of the first service data entry in the beacon advertising pdu */
+#define SERVICE_DATA_SIZE           (2)     /* The size of one service data entry */
+
+/* The codec below is shared by the firmware and host tools, so it does not depend on the nRF headers.
+ */
+#ifndef LINKING_STATIC_INLINE
+#if defined(__CC_ARM) || defined(_MSC_VER)
+#define LINKING_STATIC_INLINE       static __inline
+#elif defined(__GNUC__)
+#define LINKING_STATIC_INLINE       static __inline__
+#else
+#define LINKING_STATIC_INLINE       static inline
+#endif
+#endif
+
 /* The linking beacon service types based on DoCoMo spec v2.0.2 (2016-08-08)
  */
 enum
@@ -38,6 +54,13 @@ enum
     LINKING_SERVICE_TYPE_GENERAL = 15
 };
 
+#define LINKING_SERVICE_VALUE_MAX   4095
+typedef struct
+{
+    uint16_t service_id:4;
+    uint16_t value:12;              /* The 12-bit float of temperature, humidity and air pressure, see IEEE754_Convert_*, or the general value */
+} linking_sensor_info_t;
+
 typedef struct
 {
     uint16_t service_id:4;
@@ -75,6 +98,140 @@ typedef struct
     uint16_t dummy:11;
 } linking_vibration_sensor_info_t;
 
+
+/* The structs above are the decoded form only. Their bitfield layout depends on the compiler, so an entry
+ * must not be copied to or from the advertising pdu as a struct. On air, an entry is 16-bit big-endian:
+ * the service ID in the upper 4 bits of the first byte, followed by the 12-bit value, whose upper bit is
+ * the flag of the types that have one.
+ */
+
+/* Packs one service data entry into its SERVICE_DATA_SIZE bytes of the advertising pdu.
+ */
+LINKING_STATIC_INLINE void linking_service_data_pack(uint8_t * p_data, uint8_t service_id, uint16_t value)
+{
+    p_data[0] = (uint8_t)(((service_id & 0xF) << 4) | ((value >> 8) & 0xF));
+    p_data[1] = (uint8_t)(value & 0xFF);
+}
+
+/* Gets the service ID of one service data entry of the advertising pdu.
+ */
+LINKING_STATIC_INLINE uint8_t linking_service_data_id_unpack(uint8_t const * p_data)
+{
+    return ( (uint8_t)(p_data[0] >> 4) );
+}
+
+/* Gets the 12-bit value of one service data entry of the advertising pdu.
+ */
+LINKING_STATIC_INLINE uint16_t linking_service_data_value_unpack(uint8_t const * p_data)
+{
+    return ( (uint16_t)(((p_data[0] & 0xF) << 8) | p_data[1]) );
+}
+
+/* Unpacks count consecutive service data entries in one pass, into one array of service IDs and one of values.
+ */
+LINKING_STATIC_INLINE void linking_service_data_batch_unpack(uint8_t const * p_data, uint32_t count, uint8_t * p_service_ids, uint16_t * p_values)
+{
+    uint32_t i;
+
+    for ( i = 0; i < count; i++ )
+    {
+        p_service_ids[i] = (uint8_t)(p_data[0] >> 4);
+        p_values[i]      = (uint16_t)(((p_data[0] & 0xF) << 8) | p_data[1]);
+        p_data          += SERVICE_DATA_SIZE;
+    }
+}
+
+/* Packs a flag and an 11-bit count into a 12-bit value.
+ */
+LINKING_STATIC_INLINE uint16_t linking_flag_value_pack(bool flag, uint16_t count)
+{
+    return ( (uint16_t)((flag ? 0x800 : 0) | (count & 0x7FF)) );
+}
+
+/* Temperature, humidity, air pressure and general. */
+LINKING_STATIC_INLINE void linking_sensor_info_pack(uint8_t * p_data, linking_sensor_info_t const * p_info)
+{
+    linking_service_data_pack(p_data, p_info->service_id, p_info->value);
+}
+
+LINKING_STATIC_INLINE void linking_sensor_info_unpack(uint8_t const * p_data, linking_sensor_info_t * p_info)
+{
+    p_info->service_id = linking_service_data_id_unpack(p_data);
+    p_info->value      = linking_service_data_value_unpack(p_data);
+}
+
+/* Battery. */
+LINKING_STATIC_INLINE void linking_battery_info_pack(uint8_t * p_data, linking_battery_info_t const * p_info)
+{
+    linking_service_data_pack(p_data, p_info->service_id, linking_flag_value_pack(p_info->charge_needed, p_info->battery_level));
+}
+
+LINKING_STATIC_INLINE void linking_battery_info_unpack(uint8_t const * p_data, linking_battery_info_t * p_info)
+{
+    uint16_t value = linking_service_data_value_unpack(p_data);
+
+    p_info->service_id    = linking_service_data_id_unpack(p_data);
+    p_info->charge_needed = (value >> 11) & 1;
+    p_info->battery_level = value & 0x7FF;
+}
+
+/* Button. */
+LINKING_STATIC_INLINE void linking_button_info_pack(uint8_t * p_data, linking_button_info_t const * p_info)
+{
+    linking_service_data_pack(p_data, p_info->service_id, p_info->button_id);
+}
+
+LINKING_STATIC_INLINE void linking_button_info_unpack(uint8_t const * p_data, linking_button_info_t * p_info)
+{
+    p_info->service_id = linking_service_data_id_unpack(p_data);
+    p_info->button_id  = linking_service_data_value_unpack(p_data);
+}
+
+/* Open/close sense. */
+LINKING_STATIC_INLINE void linking_openclose_sensor_info_pack(uint8_t * p_data, linking_openclose_sensor_info_t const * p_info)
+{
+    linking_service_data_pack(p_data, p_info->service_id, linking_flag_value_pack(p_info->open_close_flag, p_info->open_count));
+}
+
+LINKING_STATIC_INLINE void linking_openclose_sensor_info_unpack(uint8_t const * p_data, linking_openclose_sensor_info_t * p_info)
+{
+    uint16_t value = linking_service_data_value_unpack(p_data);
+
+    p_info->service_id      = linking_service_data_id_unpack(p_data);
+    p_info->open_close_flag = (value >> 11) & 1;
+    p_info->open_count      = value & 0x7FF;
+}
+
+/* Human sense. */
+LINKING_STATIC_INLINE void linking_human_sensor_info_pack(uint8_t * p_data, linking_human_sensor_info_t const * p_info)
+{
+    linking_service_data_pack(p_data, p_info->service_id, linking_flag_value_pack(p_info->human_sensed, p_info->dummy));
+}
+
+LINKING_STATIC_INLINE void linking_human_sensor_info_unpack(uint8_t const * p_data, linking_human_sensor_info_t * p_info)
+{
+    uint16_t value = linking_service_data_value_unpack(p_data);
+
+    p_info->service_id   = linking_service_data_id_unpack(p_data);
+    p_info->human_sensed = (value >> 11) & 1;
+    p_info->dummy        = value & 0x7FF;
+}
+
+/* Vibration sense. */
+LINKING_STATIC_INLINE void linking_vibration_sensor_info_pack(uint8_t * p_data, linking_vibration_sensor_info_t const * p_info)
+{
+    linking_service_data_pack(p_data, p_info->service_id, linking_flag_value_pack(p_info->vibration_sensed, p_info->dummy));
+}
+
+LINKING_STATIC_INLINE void linking_vibration_sensor_info_unpack(uint8_t const * p_data, linking_vibration_sensor_info_t * p_info)
+{
+    uint16_t value = linking_service_data_value_unpack(p_data);
+
+    p_info->service_id       = linking_service_data_id_unpack(p_data);
+    p_info->vibration_sensed = (value >> 11) & 1;
+    p_info->dummy            = value & 0x7FF;
+}
+
 #endif // BLE_PDLP_BEACON_H__
 
 /** @} */
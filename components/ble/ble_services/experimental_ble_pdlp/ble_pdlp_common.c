@@ -126,6 +126,48 @@ uint16_t IEEE754_Convert_Air_Pressure(float f_value)
     }
 }
 
+// Convert a 12-bit IEEE754 format back to a float, the inverse of the conversions above
+static float IEEE754_Decode(uint16_t sign, int16_t exponent, uint16_t fraction, uint8_t fraction_bits, int16_t bias)
+{
+    union IEEE754_Converter value;
+
+    if (exponent == 0)
+    {
+        // Non-normalization, fraction * 2^(1 - bias - fraction_bits)
+        value.i_val.u_val = (unsigned int)(1 - bias - fraction_bits + 127) << 23;
+        value.f_val      *= (float)fraction;
+    }
+    else
+    {
+        // Normalization
+        value.i_val.u_val = ((unsigned int)(exponent - bias + 127) << 23) | ((unsigned int)fraction << (23 - fraction_bits));
+    }
+
+    return sign ? -value.f_val : value.f_val;
+}
+
+// bit 11     sign
+// bit 7-10   exponent
+// bit 0-6    fraction
+float IEEE754_Decode_Temperature(uint16_t value)
+{
+    return IEEE754_Decode((value >> 11) & 0x1, (value >> 7) & 0xF, value & 0x7F, 7, 7);
+}
+
+// bit 8-11   exponent
+// bit 0-7    fraction
+float IEEE754_Decode_Humidity(uint16_t value)
+{
+    return IEEE754_Decode(0, (value >> 8) & 0xF, value & 0xFF, 8, 7);
+}
+
+// bit 7-11   exponent
+// bit 0-6    fraction
+float IEEE754_Decode_Air_Pressure(uint16_t value)
+{
+    return IEEE754_Decode(0, (value >> 7) & 0x1F, value & 0x7F, 7, 15);
+}
+
 // Little-endian encoding 
 uint32_t pdls_encode_service_header(uint8_t *p_buf, uint8_t service_id, uint16_t message_id, uint8_t number_of_param)
 {
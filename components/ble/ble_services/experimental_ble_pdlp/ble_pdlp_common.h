@@ -15,6 +15,12 @@
 #include <stdint.h>
 #include <string.h>
 
+/* The header byte in front of every PDLP packet */
+#define PDLS_HEADER_SOURCE_Pos                7
+#define PDLS_HEADER_CANCEL_Pos                6
+#define PDLS_HEADER_SEQNUM_Pos                1
+#define PDLS_HEADER_EXECUTE_Pos               0
+
 /**@brief PDLS result code */
 typedef enum
 {
@@ -56,6 +62,10 @@ uint16_t IEEE754_Convert_Temperature(float f_value);
 uint16_t IEEE754_Convert_Humidity(float f_value);
 uint16_t IEEE754_Convert_Air_Pressure(float f_value);
 
+float IEEE754_Decode_Temperature(uint16_t value);
+float IEEE754_Decode_Humidity(uint16_t value);
+float IEEE754_Decode_Air_Pressure(uint16_t value);
+
 #endif // BLE_PDLP_COMMON_H__
 
 /** @} */
@@ -0,0 +1,161 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+// Host stand-in of the SoftDevice ble.h, with only the types, events and calls ble_pdlp.c uses. The test
+// program defines the sd_ calls.
+
+#ifndef BLE_H__
+#define BLE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define NRF_SUCCESS                 (0)
+#define NRF_ERROR_INVALID_PARAM     (7)
+#define NRF_ERROR_INVALID_STATE     (8)
+#define NRF_ERROR_INVALID_DATA      (11)
+
+#define BLE_CONN_HANDLE_INVALID     (0xFFFF)
+#define GATT_MTU_SIZE_DEFAULT       (23)
+#define BLE_GATTS_SRVC_TYPE_PRIMARY (1)
+#define BLE_GATTS_VLOC_STACK        (1)
+#define BLE_GATT_HVX_INDICATION     (2)
+
+enum
+{
+    BLE_GAP_EVT_CONNECTED = 1,
+    BLE_GAP_EVT_DISCONNECTED,
+    BLE_GATTS_EVT_WRITE,
+    BLE_GATTS_EVT_HVC,
+    BLE_GATTS_EVT_TIMEOUT
+};
+
+typedef struct
+{
+    uint8_t uuid128[16];
+} ble_uuid128_t;
+
+typedef struct
+{
+    uint16_t uuid;
+    uint8_t  type;
+} ble_uuid_t;
+
+typedef struct
+{
+    uint16_t handle;
+    uint8_t  op;
+    uint16_t offset;
+    uint16_t len;
+    uint8_t  data[GATT_MTU_SIZE_DEFAULT - 3];
+} ble_gatts_evt_write_t;
+
+typedef struct
+{
+    uint16_t handle;
+} ble_gatts_evt_hvc_t;
+
+typedef struct
+{
+    struct
+    {
+        uint16_t evt_id;
+    } header;
+    struct
+    {
+        struct
+        {
+            uint16_t conn_handle;
+        } gap_evt;
+        struct
+        {
+            uint16_t conn_handle;
+            union
+            {
+                ble_gatts_evt_write_t write;
+                ble_gatts_evt_hvc_t   hvc;
+            } params;
+        } gatts_evt;
+    } evt;
+} ble_evt_t;
+
+typedef struct
+{
+    uint16_t value_handle;
+    uint16_t user_desc_handle;
+    uint16_t cccd_handle;
+    uint16_t sccd_handle;
+} ble_gatts_char_handles_t;
+
+typedef struct
+{
+    uint8_t sm;
+    uint8_t lv;
+} ble_gap_conn_sec_mode_t;
+
+typedef struct
+{
+    ble_gap_conn_sec_mode_t read_perm;
+    ble_gap_conn_sec_mode_t write_perm;
+    uint8_t                 vlen;
+    uint8_t                 vloc;
+    uint8_t                 rd_auth;
+    uint8_t                 wr_auth;
+} ble_gatts_attr_md_t;
+
+typedef struct
+{
+    struct
+    {
+        uint8_t read;
+        uint8_t write;
+        uint8_t write_wo_resp;
+        uint8_t indicate;
+        uint8_t notify;
+    } char_props;
+    void * p_char_user_desc;
+    void * p_char_pf;
+    void * p_user_desc_md;
+    void * p_cccd_md;
+    void * p_sccd_md;
+} ble_gatts_char_md_t;
+
+typedef struct
+{
+    ble_uuid_t          * p_uuid;
+    ble_gatts_attr_md_t * p_attr_md;
+    uint16_t              init_len;
+    uint16_t              init_offs;
+    uint16_t              max_len;
+    uint8_t             * p_value;
+} ble_gatts_attr_t;
+
+typedef struct
+{
+    uint16_t   handle;
+    uint8_t    type;
+    uint16_t   offset;
+    uint16_t * p_len;
+    uint8_t  * p_data;
+} ble_gatts_hvx_params_t;
+
+#define BLE_GAP_CONN_SEC_MODE_SET_NO_ACCESS(p_mode) ((void)(p_mode))
+#define BLE_GAP_CONN_SEC_MODE_SET_OPEN(p_mode)      ((void)(p_mode))
+
+uint32_t sd_ble_uuid_vs_add(ble_uuid128_t const * p_vs_uuid, uint8_t * p_uuid_type);
+uint32_t sd_ble_gatts_service_add(uint8_t type, ble_uuid_t const * p_uuid, uint16_t * p_handle);
+uint32_t sd_ble_gatts_characteristic_add(uint16_t service_handle, ble_gatts_char_md_t const * p_char_md,
+                                         ble_gatts_attr_t const * p_attr_char_value, ble_gatts_char_handles_t * p_handles);
+uint32_t sd_ble_gatts_hvx(uint16_t conn_handle, ble_gatts_hvx_params_t const * p_hvx_params);
+
+#endif // BLE_H__
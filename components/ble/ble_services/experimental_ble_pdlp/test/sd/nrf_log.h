@@ -0,0 +1,18 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+// Host stand-in of the SDK nrf_log.h, ble_pdlp.c does not log.
+
+#ifndef NRF_LOG_H__
+#define NRF_LOG_H__
+
+#endif // NRF_LOG_H__
@@ -0,0 +1,33 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+// Host stand-in of the SDK sdk_common.h, with the checks ble_pdlp.c uses.
+
+#ifndef SDK_COMMON_H__
+#define SDK_COMMON_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define UNUSED_PARAMETER(x) ((void)(x))
+
+#define VERIFY_SUCCESS(err_code)        \
+do                                      \
+{                                       \
+    if ((err_code) != 0)                \
+    {                                   \
+        return (err_code);              \
+    }                                   \
+} while (0)
+
+#endif // SDK_COMMON_H__
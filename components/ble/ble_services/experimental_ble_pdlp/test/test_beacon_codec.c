@@ -0,0 +1,181 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+// Checks the Linking service data codec of ble_pdlp_beacon.h against the over-the-air layout: a 16-bit
+// big-endian entry with the service ID in the upper 4 bits and the 12-bit value, whose upper bit is the flag
+// of the types that have one. Every type is packed, compared byte by byte and unpacked again.
+
+#include <string.h>
+
+#include "ble_pdlp_beacon.h"
+#include "test.h"
+
+#ifndef TEST_NAME
+#define TEST_NAME   "test_beacon_codec"
+#endif
+
+static const uint16_t m_values[] = { 0x000, 0x001, 0x07F, 0x080, 0x7FF, 0x800, 0x801, 0xABC, 0xFFF };
+
+// The entry as the beacon core wrote it before the codec, byte by byte
+static void reference_pack(uint8_t * p_data, uint8_t service_id, uint16_t value)
+{
+    p_data[0]  = (service_id << 4) & 0xF0;
+    p_data[0] |= (value >> 8) & 0xF;
+    p_data[1]  = (value >> 0) & 0xFF;
+}
+
+static void raw_test(void)
+{
+    uint8_t  service_id;
+    uint32_t i;
+
+    for (service_id = 0; service_id < 16; service_id++)
+    {
+        for (i = 0; i < sizeof(m_values) / sizeof(m_values[0]); i++)
+        {
+            uint8_t data[SERVICE_DATA_SIZE];
+            uint8_t reference[SERVICE_DATA_SIZE];
+
+            linking_service_data_pack(data, service_id, m_values[i]);
+            reference_pack(reference, service_id, m_values[i]);
+            TEST_CHECK(memcmp(data, reference, sizeof(data)) == 0, "ID %u value %03X: %02X %02X", service_id, m_values[i], data[0], data[1]);
+            TEST_CHECK(linking_service_data_id_unpack(data) == service_id, "ID %u", service_id);
+            TEST_CHECK(linking_service_data_value_unpack(data) == m_values[i], "value %03X", m_values[i]);
+        }
+    }
+
+    // Bits above the 4-bit ID and the 12-bit value do not spill into the other field
+    {
+        uint8_t data[SERVICE_DATA_SIZE];
+
+        linking_service_data_pack(data, 0x1F, 0xF123);
+        TEST_CHECK((data[0] == 0xF1) && (data[1] == 0x23), "%02X %02X", data[0], data[1]);
+    }
+
+    TEST_CHECK(linking_flag_value_pack(true, 0) == 0x800, "%03X", linking_flag_value_pack(true, 0));
+    TEST_CHECK(linking_flag_value_pack(false, 0x7FF) == 0x7FF, "%03X", linking_flag_value_pack(false, 0x7FF));
+    TEST_CHECK(linking_flag_value_pack(false, 0xFFF) == 0x7FF, "%03X", linking_flag_value_pack(false, 0xFFF));
+}
+
+static void typed_test(void)
+{
+    uint8_t data[SERVICE_DATA_SIZE];
+
+    {
+        linking_sensor_info_t in, out;
+
+        in.service_id = LINKING_SERVICE_TYPE_AIRPRESSURE;
+        in.value      = 0x9C4;
+        linking_sensor_info_pack(data, &in);
+        linking_sensor_info_unpack(data, &out);
+        TEST_CHECK((data[0] == 0x39) && (data[1] == 0xC4), "sensor %02X %02X", data[0], data[1]);
+        TEST_CHECK((out.service_id == in.service_id) && (out.value == in.value), "sensor %u %03X", out.service_id, out.value);
+    }
+    {
+        linking_battery_info_t in, out;
+
+        in.service_id    = LINKING_SERVICE_TYPE_BATTERY;
+        in.charge_needed = 1;
+        in.battery_level = 1000;
+        linking_battery_info_pack(data, &in);
+        linking_battery_info_unpack(data, &out);
+        TEST_CHECK((data[0] == 0x4B) && (data[1] == 0xE8), "battery %02X %02X", data[0], data[1]);
+        TEST_CHECK((out.service_id == in.service_id) && (out.charge_needed == 1) && (out.battery_level == 1000),
+                   "battery %u %u %u", out.service_id, out.charge_needed, out.battery_level);
+    }
+    {
+        linking_button_info_t in, out;
+
+        in.service_id = LINKING_SERVICE_TYPE_BUTTON;
+        in.button_id  = LINKING_BUTTON_ID_MAX;
+        linking_button_info_pack(data, &in);
+        linking_button_info_unpack(data, &out);
+        TEST_CHECK((data[0] == 0x5F) && (data[1] == 0xFF), "button %02X %02X", data[0], data[1]);
+        TEST_CHECK((out.service_id == in.service_id) && (out.button_id == LINKING_BUTTON_ID_MAX), "button %u %u", out.service_id, out.button_id);
+    }
+    {
+        linking_openclose_sensor_info_t in, out;
+
+        in.service_id      = LINKING_SERVICE_TYPE_OPEN_CLOSE_SENSE;
+        in.open_close_flag = 1;
+        in.open_count      = LINKING_OPEN_COUNT_MAX;
+        linking_openclose_sensor_info_pack(data, &in);
+        linking_openclose_sensor_info_unpack(data, &out);
+        TEST_CHECK((data[0] == 0x6F) && (data[1] == 0xFF), "open/close %02X %02X", data[0], data[1]);
+        TEST_CHECK((out.service_id == in.service_id) && (out.open_close_flag == 1) && (out.open_count == LINKING_OPEN_COUNT_MAX),
+                   "open/close %u %u %u", out.service_id, out.open_close_flag, out.open_count);
+
+        in.open_close_flag = 0;
+        in.open_count      = 5;
+        linking_openclose_sensor_info_pack(data, &in);
+        linking_openclose_sensor_info_unpack(data, &out);
+        TEST_CHECK((data[0] == 0x60) && (data[1] == 0x05), "open/close %02X %02X", data[0], data[1]);
+        TEST_CHECK((out.open_close_flag == 0) && (out.open_count == 5), "open/close %u %u", out.open_close_flag, out.open_count);
+    }
+    {
+        linking_human_sensor_info_t in, out;
+
+        in.service_id   = LINKING_SERVICE_TYPE_HUMAN_SENSE;
+        in.human_sensed = 1;
+        in.dummy        = 0;
+        linking_human_sensor_info_pack(data, &in);
+        linking_human_sensor_info_unpack(data, &out);
+        TEST_CHECK((data[0] == 0x78) && (data[1] == 0x00), "human %02X %02X", data[0], data[1]);
+        TEST_CHECK((out.service_id == in.service_id) && (out.human_sensed == 1) && (out.dummy == 0),
+                   "human %u %u %u", out.service_id, out.human_sensed, out.dummy);
+    }
+    {
+        linking_vibration_sensor_info_t in, out;
+
+        in.service_id       = LINKING_SERVICE_TYPE_VIBRATION_SENSE;
+        in.vibration_sensed = 1;
+        in.dummy            = 0;
+        linking_vibration_sensor_info_pack(data, &in);
+        linking_vibration_sensor_info_unpack(data, &out);
+        TEST_CHECK((data[0] == 0x88) && (data[1] == 0x00), "vibration %02X %02X", data[0], data[1]);
+        TEST_CHECK((out.service_id == in.service_id) && (out.vibration_sensed == 1) && (out.dummy == 0),
+                   "vibration %u %u %u", out.service_id, out.vibration_sensed, out.dummy);
+    }
+}
+
+// Unpacks a pdu of entries in one pass, as a gateway does, and compares with the entries one by one
+static void batch_test(void)
+{
+    enum { COUNT = 10 };
+    uint8_t  pdu[COUNT * SERVICE_DATA_SIZE];
+    uint8_t  service_ids[COUNT];
+    uint16_t values[COUNT];
+    uint32_t i;
+
+    for (i = 0; i < COUNT; i++)
+    {
+        linking_service_data_pack(&pdu[i * SERVICE_DATA_SIZE], (uint8_t)(i + 1), m_values[i % (sizeof(m_values) / sizeof(m_values[0]))]);
+    }
+
+    linking_service_data_batch_unpack(pdu, COUNT, service_ids, values);
+    for (i = 0; i < COUNT; i++)
+    {
+        TEST_CHECK(service_ids[i] == linking_service_data_id_unpack(&pdu[i * SERVICE_DATA_SIZE]), "entry %u ID %u", i, service_ids[i]);
+        TEST_CHECK(values[i] == linking_service_data_value_unpack(&pdu[i * SERVICE_DATA_SIZE]), "entry %u value %03X", i, values[i]);
+        TEST_CHECK((service_ids[i] == i + 1) && (values[i] == m_values[i % (sizeof(m_values) / sizeof(m_values[0]))]),
+                   "entry %u: %u %03X", i, service_ids[i], values[i]);
+    }
+}
+
+int main(void)
+{
+    raw_test();
+    typed_test();
+    batch_test();
+
+    return test_result(TEST_NAME);
+}
@@ -0,0 +1,229 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+// Runs the PDLP Service of ble_pdlp.c on the SoftDevice stand-ins in sd/ and writes PDSIS requests to it as a PDLP
+// Client would, packet by packet. The checks cover the parameters SetNotifySensorInfo passes to the application,
+// including the optional OriginalData threshold after the Status, and the gating of the indications with it.
+
+#include <string.h>
+
+#include "ble_pdlp.h"
+#include "test.h"
+
+#define CONN_HANDLE     (1)
+
+static ble_pdls_t             m_pdls;
+static uint16_t               m_char_handle;
+static uint8_t                m_hvx_data[GATT_MTU_SIZE_DEFAULT];
+static uint16_t               m_hvx_len;
+static uint32_t               m_hvx_count;
+static ble_pdsis_event_data_t m_event;
+static uint32_t               m_event_count;
+
+uint32_t sd_ble_uuid_vs_add(ble_uuid128_t const * p_vs_uuid, uint8_t * p_uuid_type)
+{
+    (void)p_vs_uuid;
+    *p_uuid_type = 2;
+    return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gatts_service_add(uint8_t type, ble_uuid_t const * p_uuid, uint16_t * p_handle)
+{
+    (void)type;
+    (void)p_uuid;
+    *p_handle = 0x0010;
+    return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gatts_characteristic_add(uint16_t service_handle, ble_gatts_char_md_t const * p_char_md,
+                                         ble_gatts_attr_t const * p_attr_char_value, ble_gatts_char_handles_t * p_handles)
+{
+    (void)service_handle;
+    (void)p_char_md;
+    (void)p_attr_char_value;
+    memset(p_handles, 0, sizeof(ble_gatts_char_handles_t));
+    m_char_handle         += 2;
+    p_handles->value_handle = 0x0010 + m_char_handle;
+    p_handles->cccd_handle  = 0x0011 + m_char_handle;
+    return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gatts_hvx(uint16_t conn_handle, ble_gatts_hvx_params_t const * p_hvx_params)
+{
+    (void)conn_handle;
+    m_hvx_len = *p_hvx_params->p_len;
+    memcpy(m_hvx_data, p_hvx_params->p_data, m_hvx_len);
+    m_hvx_count++;
+    return NRF_SUCCESS;
+}
+
+static ble_pdls_result_code_t pdsis_event_handler(ble_pdls_t * p_pdls, ble_pdsis_event_data_t * p_pdsis_event)
+{
+    (void)p_pdls;
+    m_event = *p_pdsis_event;
+    m_event_count++;
+    return PDLS_RESULT_OK;
+}
+
+static void on_ble_evt(uint16_t evt_id, ble_evt_t * p_ble_evt)
+{
+    p_ble_evt->header.evt_id                 = evt_id;
+    p_ble_evt->evt.gap_evt.conn_handle       = CONN_HANDLE;
+    p_ble_evt->evt.gatts_evt.conn_handle     = CONN_HANDLE;
+    ble_pdls_on_ble_evt(&m_pdls, p_ble_evt);
+}
+
+// Confirms the indications until the transaction is done
+static void confirm(void)
+{
+    uint32_t  hvx_count;
+    ble_evt_t ble_evt;
+
+    do
+    {
+        hvx_count = m_hvx_count;
+        memset(&ble_evt, 0, sizeof(ble_evt));
+        on_ble_evt(BLE_GATTS_EVT_HVC, &ble_evt);
+    } while (m_hvx_count != hvx_count);
+}
+
+// Writes a message in packets of up to 19 bytes after the header, the last one with the execute bit
+static void write_message(uint8_t const * p_message, uint16_t len)
+{
+    uint16_t offset = 0;
+    uint8_t  seqnum = 0;
+
+    while (offset < len)
+    {
+        ble_evt_t ble_evt;
+        uint16_t  packet_len = ((len - offset) > (GATT_MTU_SIZE_DEFAULT - 4)) ? (GATT_MTU_SIZE_DEFAULT - 4) : (len - offset);
+        bool      last       = ((offset + packet_len) == len);
+
+        memset(&ble_evt, 0, sizeof(ble_evt));
+        ble_evt.evt.gatts_evt.params.write.handle  = m_pdls.write_char_handles.value_handle;
+        ble_evt.evt.gatts_evt.params.write.len     = packet_len + 1;
+        ble_evt.evt.gatts_evt.params.write.data[0] = (seqnum << PDLS_HEADER_SEQNUM_Pos) | (last << PDLS_HEADER_EXECUTE_Pos);
+        memcpy(&ble_evt.evt.gatts_evt.params.write.data[1], p_message + offset, packet_len);
+        on_ble_evt(BLE_GATTS_EVT_WRITE, &ble_evt);
+        offset += packet_len;
+        seqnum++;
+    }
+}
+
+// Sends SetNotifySensorInfo with the OriginalData threshold when p_threshold is not NULL, returns the result
+// code of the response
+static uint8_t set_notify_sensor_info(ble_pdsis_sensor_type_t type, ble_pdsis_status_t status, uint16_t const * p_threshold)
+{
+    uint8_t   message[32];
+    uint8_t   result;
+    uint8_t * p_pos = message;
+
+    p_pos += pdls_encode_service_header(p_pos, PDLS_SERVICE_SIS, PDSIS_SET_NOTIFY_SENSOR_INFO, (p_threshold != NULL) ? 3 : 2);
+    p_pos += pdls_encode_param_uint8(p_pos, PDSIS_PARAM_SENSORTYPE, (uint8_t)type);
+    p_pos += pdls_encode_param_uint8(p_pos, PDSIS_PARAM_STATUS, (uint8_t)status);
+    if (p_threshold != NULL)
+    {
+        p_pos += pdls_encode_param_uint16(p_pos, PDSIS_PARAM_ORIGINALDATA, *p_threshold);
+    }
+
+    m_hvx_len = 0;
+    write_message(message, p_pos - message);
+    // Header, service header, then the result code parameter of 4 bytes and its value
+    result = (m_hvx_len == 10) ? m_hvx_data[9] : 0xFF;
+    confirm();
+    return result;
+}
+
+// Notifies a temperature, returns whether it was indicated
+static bool notify_temperature(float temperature)
+{
+    ble_pdsis_notify_value_t value;
+    uint32_t                 hvx_count = m_hvx_count;
+
+    memset(&value, 0, sizeof(value));
+    value.u16_originaldata[0] = IEEE754_Convert_Temperature(temperature);
+    TEST_CHECK(ble_pdls_pdsis_notify(&m_pdls, PDSIS_SENSOR_TYPE_TEMPERATURE, &value) == NRF_SUCCESS, "notify %.2f", temperature);
+    confirm();
+    return m_hvx_count != hvx_count;
+}
+
+static void threshold_test(void)
+{
+    uint16_t threshold = IEEE754_Convert_Temperature(0.5f);
+    uint8_t  result;
+
+    m_event_count = 0;
+    result        = set_notify_sensor_info(PDSIS_SENSOR_TYPE_TEMPERATURE, PDSIS_STATUS_ON, &threshold);
+    TEST_CHECK(result == PDLS_RESULT_OK, "result %u", result);
+    TEST_CHECK(m_event_count == 1, "%u events", (unsigned int)m_event_count);
+    TEST_CHECK(m_event.event == PDSIS_EVT_SET_NOTIFY_INFO, "event %u", m_event.event);
+    TEST_CHECK(m_event.type == PDSIS_SENSOR_TYPE_TEMPERATURE, "type %u", m_event.type);
+    TEST_CHECK(m_event.status == PDSIS_STATUS_ON, "status %u", m_event.status);
+    TEST_CHECK(m_event.data.u16_originaldata[0] == threshold, "threshold 0x%04X, expected 0x%04X",
+               m_event.data.u16_originaldata[0], threshold);
+
+    // Values within the threshold of the last indicated one are not indicated
+    TEST_CHECK(notify_temperature(20.0f), "first value not indicated");
+    TEST_CHECK(!notify_temperature(20.25f), "value within the threshold indicated");
+    TEST_CHECK(notify_temperature(21.0f), "value over the threshold not indicated");
+}
+
+static void no_threshold_test(void)
+{
+    uint8_t result;
+
+    m_event_count = 0;
+    result        = set_notify_sensor_info(PDSIS_SENSOR_TYPE_HUMIDITY, PDSIS_STATUS_OFF, NULL);
+    TEST_CHECK(result == PDLS_RESULT_OK, "result %u", result);
+    TEST_CHECK(m_event_count == 1, "%u events", (unsigned int)m_event_count);
+    TEST_CHECK(m_event.status == PDSIS_STATUS_OFF, "status %u", m_event.status);
+    TEST_CHECK(m_event.data.u16_originaldata[0] == 0, "threshold 0x%04X without one", m_event.data.u16_originaldata[0]);
+
+    // Every change is indicated
+    TEST_CHECK(notify_temperature(20.0f), "value not indicated");
+    m_event_count = 0;
+    result        = set_notify_sensor_info(PDSIS_SENSOR_TYPE_TEMPERATURE, PDSIS_STATUS_ON, NULL);
+    TEST_CHECK(result == PDLS_RESULT_OK, "result %u", result);
+    TEST_CHECK(notify_temperature(20.0f), "first value not indicated");
+    TEST_CHECK(notify_temperature(20.25f), "changed value not indicated");
+    TEST_CHECK(!notify_temperature(20.25f), "same value indicated");
+}
+
+static void not_supported_test(void)
+{
+    uint16_t threshold = 10;
+    uint8_t  result;
+
+    m_event_count = 0;
+    result        = set_notify_sensor_info(PDSIS_SENSOR_TYPE_BATTERY, PDSIS_STATUS_ON, &threshold);
+    TEST_CHECK(result == PDLS_RESULT_ERROR_NOT_SUPPORT, "result %u", result);
+    TEST_CHECK(m_event_count == 0, "%u events", (unsigned int)m_event_count);
+}
+
+int main(void)
+{
+    ble_pdls_init_t init;
+    ble_evt_t       ble_evt;
+
+    memset(&init, 0, sizeof(init));
+    init.sensortypes         = (1 << PDSIS_SENSOR_TYPE_TEMPERATURE) | (1 << PDSIS_SENSOR_TYPE_HUMIDITY);
+    init.pdsis_event_handler = pdsis_event_handler;
+    TEST_CHECK(ble_pdls_init(&m_pdls, &init) == NRF_SUCCESS, "init failed");
+    memset(&ble_evt, 0, sizeof(ble_evt));
+    on_ble_evt(BLE_GAP_EVT_CONNECTED, &ble_evt);
+
+    threshold_test();
+    no_threshold_test();
+    not_supported_test();
+
+    return test_result("test_pdlp");
+}
@@ -35,6 +35,7 @@
 #define HAL_CLOCK_H__
 
 #include <stdint.h>
+#include <stdbool.h>
 
 void hal_clock_lfclk_enable(void);
 
@@ -44,4 +45,24 @@ void hal_clock_hfclk_enable(void);
 
 void hal_clock_hfclk_disable(void);
 
+
+/* Gets the address of the task that enables the HF clock, to trigger it through PPI. */
+uint32_t hal_clock_hfclk_enable_task_get(void);
+
+
+/* Gets the address of the task that disables the HF clock, to trigger it through PPI. */
+uint32_t hal_clock_hfclk_disable_task_get(void);
+
+
+/* Enables the POWER_CLOCK interrupt for the next HFCLKSTARTED event, i.e. when the crystal reports
+   that it is stable. Shall be called while the HF clock is disabled, before hal_clock_hfclk_enable
+   or before the enable task is triggered through PPI. */
+void hal_clock_hfclk_started_irq_enable(void);
+
+
+/* Handles the POWER_CLOCK interrupt. Shall be called from POWER_CLOCK_IRQHandler.
+
+   Returns true if the HF clock has started. */
+bool hal_clock_isr_handler(void);
+
 #endif // HAL_CLOCK_H__
@@ -31,22 +31,36 @@
  * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
-#ifndef HAL_RADIO_H__
-#define HAL_RADIO_H__
+#ifndef HAL_NVM_COUNTER_H__
+#define HAL_NVM_COUNTER_H__
 
 #include <stdint.h>
 
 
-/* Resets the radio configuration. */
-void hal_radio_reset(void);
+/* A counter kept in the last two flash pages, which survives resets and power loss.
 
+   Every update is appended as a record to the active page, so a page is only erased when the
+   other page is full and about to become the active one. Then the other page still holds the last
+   value. Each page starts with its generation, and each record holds the value and its complement.
+   A write or an erase cut short by a power failure is detected on the next init, and the last
+   complete record is used.
 
-/* Sets up the radio to use the specified channel index. */
-void hal_radio_channel_index_set(uint8_t channel_index);
+   The pages must not be used by the application image; the scatter files of the examples reserve
+   them. Flash is written through the NVMC directly, so this module must not be used with
+   SOFTDEVICE_PRESENT. */
 
 
-/* Sends the specified packet. */
-void hal_radio_send(uint8_t *data);
+/* Finds the last stored value. Shall be called before any other function of this module. */
+void hal_nvm_counter_init(void);
 
 
-#endif // HAL_RADIO_H__
+/* Returns the last stored value, or 0 if none has been stored. */
+uint32_t hal_nvm_counter_get(void);
+
+
+/* Stores a new value. The CPU is halted while the flash is written, about 100 us per update and
+   in addition about 20 ms each time a page is full and the other one has to be erased. */
+void hal_nvm_counter_set(uint32_t value);
+
+
+#endif // HAL_NVM_COUNTER_H__
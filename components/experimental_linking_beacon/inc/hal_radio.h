@@ -0,0 +1,89 @@
+/* Copyright (c) Nordic Semiconductor ASA
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ *   1. Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ *   2. Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ *   3. Neither the name of Nordic Semiconductor ASA nor the names of other
+ *   contributors to this software may be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ * 
+ *   4. This software must only be used in a processor manufactured by Nordic
+ *   Semiconductor ASA, or in a processor manufactured by a third party that
+ *   is used in combination with a processor manufactured by Nordic Semiconductor.
+ * 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef HAL_RADIO_H__
+#define HAL_RADIO_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/* Resets the radio configuration. */
+void hal_radio_reset(void);
+
+
+/* Sets up the radio to use the specified channel index. */
+void hal_radio_channel_index_set(uint8_t channel_index);
+
+
+/* Sends the specified packet. */
+void hal_radio_send(uint8_t *data);
+
+
+/* The maximum number of packets in a chain. */
+#define HAL_RADIO_CHAIN_COUNT_MAX       (3)
+
+/* The PPI channels and channel groups used by the chained sending. */
+#define HAL_RADIO_PPI_CH_REENABLE       (0)     ///< DISABLED->TXEN, between the packets of a chain.
+#define HAL_RADIO_PPI_CH_LAST_READY     (1)     ///< READY of the last packet->stop re-enabling and arm the end task.
+#define HAL_RADIO_PPI_CH_END            (2)     ///< DISABLED of the last packet->end task.
+#ifndef NRF52
+#define HAL_RADIO_PPI_CH_LAST_READY_ARM (7)     ///< READY of the last packet->arm the end task, as the nRF51 PPI has no FORK.
+#define HAL_RADIO_PPI_CH_END_DISARM     (8)     ///< DISABLED of the last packet->disarm the end task.
+#endif
+#define HAL_RADIO_PPI_GROUP_CHAIN       (0)
+#define HAL_RADIO_PPI_GROUP_END         (1)
+
+
+/* Sends the specified packet once on each of the specified channel indices, back-to-back.
+
+   The radio re-enables itself through PPI, so the gap between the packets is the radio ramp-up
+   time. FREQUENCY and DATAWHITEIV cannot be written through PPI, so the channel settings are
+   computed up front and the ADDRESS interrupt of each packet but the last writes those of the
+   next packet, i.e. count - 1 interrupts per chain. The READY event of the last packet stops the
+   re-enabling, and its DISABLED event triggers the end task through PPI, e.g. the HFCLKSTOP task,
+   or nothing if end_task is zero.
+
+   count shall be from 2 to HAL_RADIO_CHAIN_COUNT_MAX. The packet shall be left unchanged until the
+   whole chain has been sent. */
+void hal_radio_send_chained(uint8_t *data, uint8_t const * p_channel_indices, uint8_t count, uint32_t end_task);
+
+
+/* Handles the RADIO interrupt. Shall be called from RADIO_IRQHandler.
+
+   Returns true when the packet has been sent, or when the last packet of a chain has been set up
+   and the rest of the chain needs no CPU. */
+bool hal_radio_isr_handler(void);
+
+
+#endif // HAL_RADIO_H__
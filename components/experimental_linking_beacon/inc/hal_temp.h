@@ -0,0 +1,80 @@
+/* Copyright (c) Nordic Semiconductor ASA
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ *   1. Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ *   2. Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ *   3. Neither the name of Nordic Semiconductor ASA nor the names of other
+ *   contributors to this software may be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ * 
+ *   4. This software must only be used in a processor manufactured by Nordic
+ *   Semiconductor ASA, or in a processor manufactured by a third party that
+ *   is used in combination with a processor manufactured by Nordic Semiconductor.
+ * 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef HAL_TEMP_H__
+#define HAL_TEMP_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+#ifdef SOFTDEVICE_PRESENT
+/* The software interrupt in which the sample is taken through the SoftDevice. SWI3 is used by
+   neither the SoftDevice nor the SDK libraries. */
+#ifdef NRF51
+#define HAL_TEMP_SWI_IRQn           (SWI3_IRQn)
+#define HAL_TEMP_SWI_IRQHandler     SWI3_IRQHandler
+#else
+#define HAL_TEMP_SWI_IRQn           (SWI3_EGU3_IRQn)
+#define HAL_TEMP_SWI_IRQHandler     SWI3_EGU3_IRQHandler
+#endif
+#endif
+
+
+/* The callback type for a finished temperature sample. The temperature is given in steps of
+   0.25 degrees Celsius. */
+typedef void (*hal_temp_callback_t)(int32_t temp);
+
+
+/* Starts sampling the SoC temperature. The callback is called with the result when the sample
+   is done. Returns false if a sample is already in progress.
+
+   Bare-metal, the DATARDY interrupt is used and the callback is called from the TEMP interrupt,
+   so the CPU can sleep during the conversion. With SOFTDEVICE_PRESENT, the TEMP peripheral is
+   owned by the SoftDevice, so the sample is taken through sd_temp_get from HAL_TEMP_SWI_IRQn at
+   the low application priority, and the callback is called from there. The SoftDevice waits for
+   the conversion with the CPU running, but a caller at the low application priority or above,
+   e.g. a SoftDevice event or app_timer handler, is not held up and gets the callback after this
+   function has returned. From thread mode, the callback can be called before it returns. */
+bool hal_temp_sample_start(hal_temp_callback_t callback);
+
+
+/* Handles the TEMP interrupt. Shall be called from TEMP_IRQHandler, or with SOFTDEVICE_PRESENT
+   from HAL_TEMP_SWI_IRQHandler.
+
+   Returns true if a sample has been done and the callback has been called. If the SoftDevice
+   fails to take the sample, the callback is not called and a new sample can be started. */
+bool hal_temp_isr_handler(void);
+
+
+#endif // HAL_TEMP_H__
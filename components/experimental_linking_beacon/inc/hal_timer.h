@@ -0,0 +1,129 @@
+/* Copyright (c) Nordic Semiconductor ASA
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ *   1. Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ *   2. Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ *   3. Neither the name of Nordic Semiconductor ASA nor the names of other
+ *   contributors to this software may be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ * 
+ *   4. This software must only be used in a processor manufactured by Nordic
+ *   Semiconductor ASA, or in a processor manufactured by a third party that
+ *   is used in combination with a processor manufactured by Nordic Semiconductor.
+ * 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef HAL_TIMER_H__
+#define HAL_TIMER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/* The RTC runs unprescaled from the 32.768 kHz LFCLK. 15625 us corresponds to exactly 512 ticks. */
+#define HAL_TIMER_TICKS_PER_SECOND  (32768UL)
+#define HAL_TIMER_COUNTER_BITS      (24)
+#define HAL_TIMER_COUNTER_MASK      ((1UL << HAL_TIMER_COUNTER_BITS) - 1)
+
+
+/* Converts the specified microsecond time to the closest prior RTC tick. Intended for constants,
+   so that the division is resolved at compile time. */
+#define HAL_TIMER_US_TO_TICKS(time_us)  ((uint32_t)(((uint64_t)(time_us) * 512) / 15625))
+
+
+/* Converts the specified microsecond time to the closest following RTC tick. Intended for guard times. */
+#define HAL_TIMER_US_TO_TICKS_ROUNDUP(time_us)  ((uint32_t)((((uint64_t)(time_us) * 512) + 15624) / 15625))
+
+
+/* Converts the specified number of RTC ticks to microseconds (rounded down). */
+#define HAL_TIMER_TICKS_TO_US(time_ticks)   ((uint32_t)(((uint64_t)(time_ticks) * 15625) >> 9))
+
+
+/* A periodic interval in RTC ticks, with the sub-tick remainder (in 1/15625 ticks) carried
+   between periods so that the timeline does not drift from the nominal microsecond interval. */
+typedef struct
+{
+    uint32_t ticks;         ///< Whole RTC ticks per period.
+    uint32_t remainder;     ///< Sub-tick remainder per period, in units of 1/15625 tick.
+    uint32_t accumulator;   ///< Accumulated sub-tick remainder, in units of 1/15625 tick.
+} hal_timer_period_t;
+
+
+/* Initializer for a period of the specified number of microseconds. */
+#define HAL_TIMER_PERIOD_INIT(period_us)                                                \
+{                                                                                       \
+    .ticks       = HAL_TIMER_US_TO_TICKS(period_us),                                    \
+    .remainder   = (uint32_t)((((uint64_t)(period_us) * 512) % 15625)),                 \
+    .accumulator = 0,                                                                   \
+}
+
+
+/* Starts the RTC timer and resets the tick timeline to zero. */
+void hal_timer_start(void);
+
+
+/* Gets the current point in time of the monotonic 64-bit tick timeline. */
+uint64_t hal_timer_ticks_get(void);
+
+
+/* Sets a deadline at the specified point in time of the tick timeline. Deadlines that are
+   in the past, or too close to be captured by the RTC, expire immediately. */
+void hal_timer_deadline_set(uint64_t deadline_ticks);
+
+
+/* Cancels the currently scheduled deadline, if any. */
+void hal_timer_deadline_cancel(void);
+
+
+/* The peripherals used by the task trigger, see hal_timer_task_trigger_set(). */
+#define HAL_TIMER_TRIGGER_TIMER             NRF_TIMER1
+#define HAL_TIMER_TRIGGER_PPI_CH_COMPARE    (3)     ///< RTC0 COMPARE[1]->TIMER START, or the task if there is no delay.
+#define HAL_TIMER_TRIGGER_PPI_CH_DELAY      (4)     ///< TIMER COMPARE[0]->the task.
+
+/* The minimum distance in ticks between arming the task trigger and the point in time to trigger at. */
+#define HAL_TIMER_TRIGGER_LEAD_TICKS        (2)
+
+
+/* Triggers the specified task through PPI the specified delay after the specified point in time of
+   the tick timeline, without the CPU. The delay, in microseconds, shall be less than one tick; it
+   is counted by HAL_TIMER_TRIGGER_TIMER, so that the task is triggered between two RTC ticks.
+
+   Returns false if the point in time is less than HAL_TIMER_TRIGGER_LEAD_TICKS away, in which case
+   the trigger is not armed and the caller shall trigger the task itself. The task may have been
+   triggered already if the thread was preempted while arming, so it shall be one that can be
+   triggered twice, e.g. HFCLKSTART. */
+bool hal_timer_task_trigger_set(uint64_t trigger_ticks, uint32_t delay_us, uint32_t task);
+
+
+/* Disarms the task trigger and stops its timer. */
+void hal_timer_task_trigger_cancel(void);
+
+
+/* Advances the specified point in time by one period. */
+uint64_t hal_timer_period_advance(hal_timer_period_t * p_period, uint64_t time_ticks);
+
+
+/* Handles the RTC0 interrupt. Shall be called from RTC0_IRQHandler.
+
+   Returns true if the deadline has expired. */
+bool hal_timer_isr_handler(void);
+
+#endif // HAL_TIMER_H__
@@ -44,6 +44,7 @@ void hal_clock_lfclk_enable(void)
 
 void hal_clock_hfclk_enable(void)
 {
+    NRF_CLOCK->EVENTS_HFCLKSTARTED = 0;
     NRF_CLOCK->TASKS_HFCLKSTART = 1;
 }
 
@@ -52,3 +53,39 @@ void hal_clock_hfclk_disable()
 {
     NRF_CLOCK->TASKS_HFCLKSTOP = 1;
 }
+
+
+uint32_t hal_clock_hfclk_enable_task_get(void)
+{
+    return ( (uint32_t)&(NRF_CLOCK->TASKS_HFCLKSTART) );
+}
+
+
+uint32_t hal_clock_hfclk_disable_task_get(void)
+{
+    return ( (uint32_t)&(NRF_CLOCK->TASKS_HFCLKSTOP) );
+}
+
+
+void hal_clock_hfclk_started_irq_enable(void)
+{
+    NRF_CLOCK->EVENTS_HFCLKSTARTED = 0;
+    NRF_CLOCK->INTENSET = (CLOCK_INTENSET_HFCLKSTARTED_Enabled << CLOCK_INTENSET_HFCLKSTARTED_Pos);
+
+    NVIC_ClearPendingIRQ(POWER_CLOCK_IRQn);
+    NVIC_EnableIRQ(POWER_CLOCK_IRQn);
+}
+
+
+bool hal_clock_isr_handler(void)
+{
+    if ( NRF_CLOCK->EVENTS_HFCLKSTARTED != 0 )
+    {
+        NRF_CLOCK->EVENTS_HFCLKSTARTED = 0;
+        NRF_CLOCK->INTENCLR = (CLOCK_INTENCLR_HFCLKSTARTED_Enabled << CLOCK_INTENCLR_HFCLKSTARTED_Pos);
+        
+        return ( true );
+    }
+    
+    return ( false );
+}
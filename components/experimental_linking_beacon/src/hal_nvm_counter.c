@@ -0,0 +1,222 @@
+/* Copyright (c) Nordic Semiconductor ASA
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ *   1. Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ *   2. Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ *   3. Neither the name of Nordic Semiconductor ASA nor the names of other
+ *   contributors to this software may be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ * 
+ *   4. This software must only be used in a processor manufactured by Nordic
+ *   Semiconductor ASA, or in a processor manufactured by a third party that
+ *   is used in combination with a processor manufactured by Nordic Semiconductor.
+ * 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "hal_nvm_counter.h"
+#include "nrf.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+
+#define NVM_COUNTER_ERASED          (0xFFFFFFFFUL)
+#define NVM_COUNTER_PAGES           (2)
+#define NVM_COUNTER_NONE            (NVM_COUNTER_PAGES)     /* No page has been started. */
+#define NVM_COUNTER_HEADER_WORDS    (2)                     /* The generation of the page and its complement. */
+#define NVM_COUNTER_RECORD_WORDS    (2)                     /* The value and its complement. */
+
+
+static uint32_t volatile * m_p_pages[NVM_COUNTER_PAGES];   /* The last two flash pages. */
+static uint32_t            m_page_words;                   /* The number of words in a page. */
+static uint32_t            m_active;                       /* The page started last, or NVM_COUNTER_NONE. */
+static uint32_t            m_generation;                   /* The generation of the active page. */
+static uint32_t            m_next;                         /* The index of the next erased record in the active page. */
+static uint32_t            m_value;                        /* The last stored value. */
+
+
+static void nvmc_config_set(uint32_t config)
+{
+    NRF_NVMC->CONFIG = (config << NVMC_CONFIG_WEN_Pos);
+    
+    while ( NRF_NVMC->READY == NVMC_READY_READY_Busy )
+    {
+    }
+}
+
+
+/* Writes a word, with writes enabled. */
+static void word_write(uint32_t volatile * p_word, uint32_t value)
+{
+    *p_word = value;
+    
+    while ( NRF_NVMC->READY == NVMC_READY_READY_Busy )
+    {
+    }
+}
+
+
+/* Tells if the two words hold a value and its complement. Writes and erases cut short leave some
+   bits unchanged, which breaks the pair. */
+static bool pair_complete(uint32_t volatile const * p_pair)
+{
+    return ( p_pair[0] == ~p_pair[1] );
+}
+
+
+/* Tells if the page has been started, and gets its generation. */
+static bool page_generation_get(uint32_t page, uint32_t * p_generation)
+{
+    uint32_t volatile * p_page = m_p_pages[page];
+    
+    // Generations start at 1, so that a header whose complement was never written does not count.
+    if ( !pair_complete(p_page) || (p_page[0] == 0) || (p_page[0] == NVM_COUNTER_ERASED) )
+    {
+        return ( false );
+    }
+    
+    *p_generation = p_page[0];
+    return ( true );
+}
+
+
+/* Gets the value of the last complete record of the page, and the index of the first erased record
+   after it. Returns false if the page holds no complete record. */
+static bool page_scan(uint32_t page, uint32_t * p_value, uint32_t * p_next)
+{
+    uint32_t volatile * p_page = m_p_pages[page];
+    bool                found  = false;
+    uint32_t            i;
+    
+    for ( i = NVM_COUNTER_HEADER_WORDS; i < m_page_words; i += NVM_COUNTER_RECORD_WORDS )
+    {
+        if ( (p_page[i] == NVM_COUNTER_ERASED) && (p_page[i + 1] == NVM_COUNTER_ERASED) )
+        {
+            break;
+        }
+        if ( pair_complete(&(p_page[i])) )
+        {
+            *p_value = p_page[i];
+            found    = true;
+        }
+    }
+    
+    *p_next = i;
+    return ( found );
+}
+
+
+/* Makes the other page the active one, erasing it first unless it is erased already. The page that
+   was active keeps the last value until the new page holds a complete record. */
+static void page_start(void)
+{
+    uint32_t            page   = (m_active == 0) ? 1 : 0;
+    uint32_t volatile * p_page = m_p_pages[page];
+    uint32_t            i;
+    
+    for ( i = 0; i < m_page_words; i++ )
+    {
+        if ( p_page[i] != NVM_COUNTER_ERASED )
+        {
+            nvmc_config_set(NVMC_CONFIG_WEN_Een);
+            NRF_NVMC->ERASEPAGE = (uint32_t)p_page;
+            
+            while ( NRF_NVMC->READY == NVMC_READY_READY_Busy )
+            {
+            }
+            break;
+        }
+    }
+    
+    m_generation = (m_active == NVM_COUNTER_NONE) ? 1 : (m_generation + 1);
+    
+    nvmc_config_set(NVMC_CONFIG_WEN_Wen);
+    word_write(&(p_page[0]), m_generation);
+    word_write(&(p_page[1]), ~m_generation);
+    
+    m_active = page;
+    m_next   = NVM_COUNTER_HEADER_WORDS;
+}
+
+
+void hal_nvm_counter_init(void)
+{
+    uint32_t page;
+    uint32_t generation;
+    uint32_t next;
+    
+    m_page_words = NRF_FICR->CODEPAGESIZE / sizeof(uint32_t);
+    m_active     = NVM_COUNTER_NONE;
+    m_value      = 0;
+    
+    for ( page = 0; page < NVM_COUNTER_PAGES; page++ )
+    {
+        m_p_pages[page] = (uint32_t volatile *)((NRF_FICR->CODESIZE - NVM_COUNTER_PAGES + page) * NRF_FICR->CODEPAGESIZE);
+    }
+    
+    for ( page = 0; page < NVM_COUNTER_PAGES; page++ )
+    {
+        if ( page_generation_get(page, &generation)
+        &&   ((m_active == NVM_COUNTER_NONE) || ((int32_t)(generation - m_generation) > 0)) )
+        {
+            m_active     = page;
+            m_generation = generation;
+        }
+    }
+    
+    if ( m_active == NVM_COUNTER_NONE )
+    {
+        m_next = m_page_words;
+        return;
+    }
+    
+    if ( !page_scan(m_active, &m_value, &m_next) )
+    {
+        // The power failed before the first record of the page was complete, so the value is still in the other page.
+        page = (m_active == 0) ? 1 : 0;
+        if ( page_generation_get(page, &generation) )
+        {
+            (void)page_scan(page, &m_value, &next);
+        }
+    }
+}
+
+
+uint32_t hal_nvm_counter_get(void)
+{
+    return ( m_value );
+}
+
+
+void hal_nvm_counter_set(uint32_t value)
+{
+    if ( m_next >= m_page_words )
+    {
+        page_start();
+    }
+    
+    nvmc_config_set(NVMC_CONFIG_WEN_Wen);
+    word_write(&(m_p_pages[m_active][m_next]), value);
+    word_write(&(m_p_pages[m_active][m_next + 1]), ~value);
+    nvmc_config_set(NVMC_CONFIG_WEN_Ren);
+    
+    m_next += NVM_COUNTER_RECORD_WORDS;
+    m_value = value;
+}
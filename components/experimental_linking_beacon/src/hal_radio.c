@@ -31,6 +31,7 @@
  * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
+#include "hal_radio.h"
 #include "nrf.h"
 
 
@@ -77,7 +78,17 @@ uint8_t seed[3] = {0x55, 0x55, 0x55};
                         ((index)*2 + 4)\
                     :\
                         ((index)*2 + 6)))))
-                        
+
+
+/* The state of the chained sending. */
+static struct
+{
+    uint8_t          frequency[HAL_RADIO_CHAIN_COUNT_MAX];      ///< The FREQUENCY of each packet of the chain.
+    uint8_t          datawhiteiv[HAL_RADIO_CHAIN_COUNT_MAX];    ///< The DATAWHITEIV of each packet of the chain.
+    uint8_t          count;                 ///< The number of packets in the chain.
+    uint8_t volatile next;                  ///< The index of the next packet to set up the channel for.
+} m_chain;
+
 
 void hal_radio_channel_index_set(uint8_t channel_index)
 {
@@ -137,3 +148,93 @@ void hal_radio_send(uint8_t *p_data)
     NRF_RADIO->EVENTS_DISABLED = 0;
     NRF_RADIO->TASKS_TXEN = 1;
 }
+
+
+void hal_radio_send_chained(uint8_t *p_data, uint8_t const * p_channel_indices, uint8_t count, uint32_t end_task)
+{
+    uint8_t i;
+    
+    for ( i = 0; i < count; i++ )
+    {
+        m_chain.frequency[i]   = CHANNEL_IDX_TO_FREQ_OFFS(p_channel_indices[i]);
+        m_chain.datawhiteiv[i] = p_channel_indices[i];
+    }
+    m_chain.count = count;
+    m_chain.next  = 1;
+    
+    hal_radio_channel_index_set(p_channel_indices[0]);
+    
+    NRF_RADIO->SHORTS          = DEFAULT_RADIO_SHORTS;
+    NRF_RADIO->PACKETPTR       = (uint32_t)&(p_data[0]);
+    NRF_RADIO->EVENTS_ADDRESS  = 0;
+    NRF_RADIO->EVENTS_DISABLED = 0;
+    NRF_RADIO->INTENCLR        = (RADIO_INTENCLR_DISABLED_Clear << RADIO_INTENCLR_DISABLED_Pos);
+    NRF_RADIO->INTENSET        = (RADIO_INTENSET_ADDRESS_Enabled << RADIO_INTENSET_ADDRESS_Pos);
+    
+    /* DISABLED re-enables the radio until the READY event of the last packet turns that off and
+       arms the end task, which disarms itself when triggered by the DISABLED event of the last packet. */
+    NRF_PPI->CH[HAL_RADIO_PPI_CH_REENABLE].EEP    = (uint32_t)&(NRF_RADIO->EVENTS_DISABLED);
+    NRF_PPI->CH[HAL_RADIO_PPI_CH_REENABLE].TEP    = (uint32_t)&(NRF_RADIO->TASKS_TXEN);
+    NRF_PPI->CH[HAL_RADIO_PPI_CH_LAST_READY].EEP  = (uint32_t)&(NRF_RADIO->EVENTS_READY);
+    NRF_PPI->CH[HAL_RADIO_PPI_CH_LAST_READY].TEP  = (uint32_t)&(NRF_PPI->TASKS_CHG[HAL_RADIO_PPI_GROUP_CHAIN].DIS);
+    NRF_PPI->CH[HAL_RADIO_PPI_CH_END].EEP         = (uint32_t)&(NRF_RADIO->EVENTS_DISABLED);
+    NRF_PPI->CH[HAL_RADIO_PPI_CH_END].TEP         = end_task;
+#ifdef NRF52
+    NRF_PPI->FORK[HAL_RADIO_PPI_CH_LAST_READY].TEP = (end_task != 0) ? (uint32_t)&(NRF_PPI->TASKS_CHG[HAL_RADIO_PPI_GROUP_END].EN) : 0;
+    NRF_PPI->FORK[HAL_RADIO_PPI_CH_END].TEP       = (uint32_t)&(NRF_PPI->TASKS_CHG[HAL_RADIO_PPI_GROUP_END].DIS);
+    NRF_PPI->CHG[HAL_RADIO_PPI_GROUP_CHAIN]       = (1UL << HAL_RADIO_PPI_CH_REENABLE) | (1UL << HAL_RADIO_PPI_CH_LAST_READY);
+    NRF_PPI->CHG[HAL_RADIO_PPI_GROUP_END]         = (1UL << HAL_RADIO_PPI_CH_END);
+    NRF_PPI->CHENCLR = (1UL << HAL_RADIO_PPI_CH_LAST_READY) | (1UL << HAL_RADIO_PPI_CH_END);
+#else
+    // Without FORK, a second channel on each of the events arms and disarms the end task.
+    NRF_PPI->CH[HAL_RADIO_PPI_CH_LAST_READY_ARM].EEP = (uint32_t)&(NRF_RADIO->EVENTS_READY);
+    NRF_PPI->CH[HAL_RADIO_PPI_CH_LAST_READY_ARM].TEP = (end_task != 0) ? (uint32_t)&(NRF_PPI->TASKS_CHG[HAL_RADIO_PPI_GROUP_END].EN) : 0;
+    NRF_PPI->CH[HAL_RADIO_PPI_CH_END_DISARM].EEP     = (uint32_t)&(NRF_RADIO->EVENTS_DISABLED);
+    NRF_PPI->CH[HAL_RADIO_PPI_CH_END_DISARM].TEP     = (uint32_t)&(NRF_PPI->TASKS_CHG[HAL_RADIO_PPI_GROUP_END].DIS);
+    NRF_PPI->CHG[HAL_RADIO_PPI_GROUP_CHAIN]       = (1UL << HAL_RADIO_PPI_CH_REENABLE) | (1UL << HAL_RADIO_PPI_CH_LAST_READY) |
+                                                    (1UL << HAL_RADIO_PPI_CH_LAST_READY_ARM);
+    NRF_PPI->CHG[HAL_RADIO_PPI_GROUP_END]         = (1UL << HAL_RADIO_PPI_CH_END) | (1UL << HAL_RADIO_PPI_CH_END_DISARM);
+    NRF_PPI->CHENCLR = (1UL << HAL_RADIO_PPI_CH_LAST_READY) | (1UL << HAL_RADIO_PPI_CH_LAST_READY_ARM) |
+                       (1UL << HAL_RADIO_PPI_CH_END) | (1UL << HAL_RADIO_PPI_CH_END_DISARM);
+#endif
+    NRF_PPI->CHENSET = (1UL << HAL_RADIO_PPI_CH_REENABLE);
+    
+    NRF_RADIO->TASKS_TXEN = 1;
+}
+
+
+bool hal_radio_isr_handler(void)
+{
+    if ( NRF_RADIO->EVENTS_ADDRESS != 0 )
+    {
+        NRF_RADIO->EVENTS_ADDRESS = 0;
+        
+        /* FREQUENCY is sampled when the radio ramps up after this packet, and DATAWHITEIV when it starts. */
+        NRF_RADIO->FREQUENCY   = m_chain.frequency[m_chain.next];
+        NRF_RADIO->DATAWHITEIV = m_chain.datawhiteiv[m_chain.next];
+        
+        if ( ++m_chain.next < m_chain.count )
+        {
+            return ( false );
+        }
+        
+        /* The last packet is set up; the rest of the chain completes without the CPU. */
+        NRF_RADIO->INTENCLR = (RADIO_INTENCLR_ADDRESS_Clear << RADIO_INTENCLR_ADDRESS_Pos);
+#ifdef NRF52
+        NRF_PPI->CHENSET    = (1UL << HAL_RADIO_PPI_CH_LAST_READY);
+#else
+        NRF_PPI->CHENSET    = (1UL << HAL_RADIO_PPI_CH_LAST_READY) | (1UL << HAL_RADIO_PPI_CH_LAST_READY_ARM);
+#endif
+        
+        return ( true );
+    }
+    
+    if ( NRF_RADIO->EVENTS_DISABLED != 0 )
+    {
+        NRF_RADIO->EVENTS_DISABLED = 0;
+        
+        return ( (NRF_RADIO->INTENSET & (RADIO_INTENSET_DISABLED_Enabled << RADIO_INTENSET_DISABLED_Pos)) != 0 );
+    }
+    
+    return ( false );
+}
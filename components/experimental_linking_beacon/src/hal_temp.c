@@ -0,0 +1,118 @@
+/* Copyright (c) Nordic Semiconductor ASA
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ *   1. Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ *   2. Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ *   3. Neither the name of Nordic Semiconductor ASA nor the names of other
+ *   contributors to this software may be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ * 
+ *   4. This software must only be used in a processor manufactured by Nordic
+ *   Semiconductor ASA, or in a processor manufactured by a third party that
+ *   is used in combination with a processor manufactured by Nordic Semiconductor.
+ * 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "hal_temp.h"
+#include "nrf.h"
+#include <stddef.h>
+#ifdef SOFTDEVICE_PRESENT
+#include "nrf_soc.h"
+#else
+#include "nrf_temp.h"
+#endif
+
+
+static hal_temp_callback_t volatile m_callback;   /* The callback of the ongoing sample, NULL if none. */
+
+
+bool hal_temp_sample_start(hal_temp_callback_t callback)
+{
+    if ( m_callback != NULL )
+    {
+        return ( false );
+    }
+    
+    m_callback = callback;
+    
+#ifdef SOFTDEVICE_PRESENT
+    (void)sd_nvic_SetPriority(HAL_TEMP_SWI_IRQn, NRF_APP_PRIORITY_LOW);
+    (void)sd_nvic_ClearPendingIRQ(HAL_TEMP_SWI_IRQn);
+    (void)sd_nvic_EnableIRQ(HAL_TEMP_SWI_IRQn);
+    (void)sd_nvic_SetPendingIRQ(HAL_TEMP_SWI_IRQn);
+#else
+    nrf_temp_init();
+    NRF_TEMP->EVENTS_DATARDY = 0;
+    NRF_TEMP->INTENSET = (TEMP_INTENSET_DATARDY_Enabled << TEMP_INTENSET_DATARDY_Pos);
+    NVIC_ClearPendingIRQ(TEMP_IRQn);
+    NVIC_EnableIRQ(TEMP_IRQn);
+    
+    NRF_TEMP->TASKS_START = 1;
+#endif
+    
+    return ( true );
+}
+
+
+bool hal_temp_isr_handler(void)
+{
+#ifdef SOFTDEVICE_PRESENT
+    hal_temp_callback_t callback = m_callback;
+    int32_t temp;
+    
+    if ( callback != NULL )
+    {
+        uint32_t err_code = sd_temp_get(&temp);
+        
+        m_callback = NULL;
+        if ( err_code == NRF_SUCCESS )
+        {
+            callback(temp);
+            return ( true );
+        }
+    }
+#else
+    if ( NRF_TEMP->EVENTS_DATARDY != 0 )
+    {
+        hal_temp_callback_t callback = m_callback;
+        int32_t temp;
+        
+        NRF_TEMP->EVENTS_DATARDY = 0;
+        NRF_TEMP->INTENCLR = (TEMP_INTENCLR_DATARDY_Enabled << TEMP_INTENCLR_DATARDY_Pos);
+        
+        /* PAN 29: STOP clears the TEMP register, so read it first. */
+        temp = nrf_temp_read();
+        
+        /* PAN 30: The analog front end is not powered down on DATARDY. */
+        NRF_TEMP->TASKS_STOP = 1;
+        
+        m_callback = NULL;
+        if ( callback != NULL )
+        {
+            callback(temp);
+        }
+        
+        return ( true );
+    }
+#endif
+    
+    return ( false );
+}
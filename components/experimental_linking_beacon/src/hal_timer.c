@@ -0,0 +1,208 @@
+/* Copyright (c) Nordic Semiconductor ASA
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ *   1. Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ *   2. Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ *   3. Neither the name of Nordic Semiconductor ASA nor the names of other
+ *   contributors to this software may be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ * 
+ *   4. This software must only be used in a processor manufactured by Nordic
+ *   Semiconductor ASA, or in a processor manufactured by a third party that
+ *   is used in combination with a processor manufactured by Nordic Semiconductor.
+ * 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "hal_timer.h"
+#include "hal_clock.h"
+#include "nrf.h"
+
+
+/* The minimum distance in ticks between COUNTER and CC for a compare event to be generated. */
+#define M_COMPARE_MIN_TICKS (2)
+
+
+static uint32_t volatile m_overflow_count;  /* The number of RTC counter overflows since the timer was started. */
+static uint64_t volatile m_deadline_ticks;  /* The currently scheduled deadline. */
+
+
+void hal_timer_start(void)
+{
+    hal_clock_lfclk_enable();
+
+    NVIC_ClearPendingIRQ(RTC0_IRQn);
+    NVIC_EnableIRQ(RTC0_IRQn);
+
+    m_overflow_count = 0;
+
+    NRF_RTC0->TASKS_CLEAR   = 1;
+    NRF_RTC0->EVENTS_OVRFLW = 0;
+    NRF_RTC0->INTENSET      = (RTC_INTENSET_OVRFLW_Enabled << RTC_INTENSET_OVRFLW_Pos);
+    NRF_RTC0->TASKS_START   = 1;
+}
+
+
+uint64_t hal_timer_ticks_get(void)
+{
+    uint32_t overflow_count;
+    uint32_t counter;
+    bool     overflow_pending;
+    
+    do
+    {
+        overflow_count   = m_overflow_count;
+        counter          = NRF_RTC0->COUNTER;
+        overflow_pending = ( (NRF_RTC0->EVENTS_OVRFLW != 0)
+                         &&  (counter < (HAL_TIMER_COUNTER_MASK >> 1)) );
+    } while ( overflow_count != m_overflow_count );
+    
+    /* Account for an overflow that has occurred but has not been handled yet (e.g. when
+       called from an interrupt with the same or higher priority as the RTC interrupt). */
+    if ( overflow_pending )
+    {
+        ++overflow_count;
+    }
+    
+    return ( ((uint64_t)overflow_count << HAL_TIMER_COUNTER_BITS) | counter );
+}
+
+
+void hal_timer_deadline_set(uint64_t deadline_ticks)
+{
+    uint64_t now_ticks;
+
+    NRF_RTC0->INTENCLR = (RTC_INTENCLR_COMPARE0_Enabled << RTC_INTENCLR_COMPARE0_Pos);
+
+    m_deadline_ticks = deadline_ticks;
+
+    NRF_RTC0->EVENTS_COMPARE[0] = 0;
+    NRF_RTC0->CC[0]    = (uint32_t)(deadline_ticks & HAL_TIMER_COUNTER_MASK);
+    NRF_RTC0->EVTENSET = (RTC_EVTENSET_COMPARE0_Enabled << RTC_EVTENSET_COMPARE0_Pos);
+    NRF_RTC0->INTENSET = (RTC_INTENSET_COMPARE0_Enabled << RTC_INTENSET_COMPARE0_Pos);
+
+    /* The timeline is read after CC has been written: if the thread was preempted before, the
+       counter may already have passed CC, and the compare event would only occur after the next
+       wrap of the 24-bit counter (512 s). A deadline that has passed, or is too close to be
+       captured, expires right away instead. The interrupt is pended only once the compare
+       interrupt is enabled, since the handler ignores it otherwise. */
+    now_ticks = hal_timer_ticks_get();
+    if ( deadline_ticks < now_ticks + M_COMPARE_MIN_TICKS )
+    {
+        NRF_RTC0->INTENCLR = (RTC_INTENCLR_COMPARE0_Enabled << RTC_INTENCLR_COMPARE0_Pos);
+        m_deadline_ticks   = now_ticks;
+        NRF_RTC0->INTENSET = (RTC_INTENSET_COMPARE0_Enabled << RTC_INTENSET_COMPARE0_Pos);
+        NVIC_SetPendingIRQ(RTC0_IRQn);
+    }
+}
+
+
+void hal_timer_deadline_cancel(void)
+{
+    NRF_RTC0->EVTENCLR = (RTC_EVTENCLR_COMPARE0_Enabled << RTC_EVTENCLR_COMPARE0_Pos);
+    NRF_RTC0->INTENCLR = (RTC_INTENCLR_COMPARE0_Enabled << RTC_INTENCLR_COMPARE0_Pos);
+    NRF_RTC0->EVENTS_COMPARE[0] = 0;
+}
+
+
+bool hal_timer_task_trigger_set(uint64_t trigger_ticks, uint32_t delay_us, uint32_t task)
+{
+    hal_timer_task_trigger_cancel();
+    
+    HAL_TIMER_TRIGGER_TIMER->MODE      = (TIMER_MODE_MODE_Timer << TIMER_MODE_MODE_Pos);
+    HAL_TIMER_TRIGGER_TIMER->BITMODE   = (TIMER_BITMODE_BITMODE_16Bit << TIMER_BITMODE_BITMODE_Pos);
+    HAL_TIMER_TRIGGER_TIMER->PRESCALER = 4;
+    HAL_TIMER_TRIGGER_TIMER->CC[0]     = delay_us;
+    HAL_TIMER_TRIGGER_TIMER->SHORTS    = (TIMER_SHORTS_COMPARE0_CLEAR_Enabled << TIMER_SHORTS_COMPARE0_CLEAR_Pos)
+                                       | (TIMER_SHORTS_COMPARE0_STOP_Enabled << TIMER_SHORTS_COMPARE0_STOP_Pos);
+    
+    NRF_PPI->CH[HAL_TIMER_TRIGGER_PPI_CH_COMPARE].EEP = (uint32_t)&(NRF_RTC0->EVENTS_COMPARE[1]);
+    NRF_PPI->CH[HAL_TIMER_TRIGGER_PPI_CH_COMPARE].TEP = (delay_us != 0) ? (uint32_t)&(HAL_TIMER_TRIGGER_TIMER->TASKS_START) : task;
+    NRF_PPI->CH[HAL_TIMER_TRIGGER_PPI_CH_DELAY].EEP   = (uint32_t)&(HAL_TIMER_TRIGGER_TIMER->EVENTS_COMPARE[0]);
+    NRF_PPI->CH[HAL_TIMER_TRIGGER_PPI_CH_DELAY].TEP   = task;
+    NRF_PPI->CHENSET = (1UL << HAL_TIMER_TRIGGER_PPI_CH_COMPARE) | (1UL << HAL_TIMER_TRIGGER_PPI_CH_DELAY);
+    
+    NRF_RTC0->EVENTS_COMPARE[1] = 0;
+    NRF_RTC0->CC[1]    = (uint32_t)(trigger_ticks & HAL_TIMER_COUNTER_MASK);
+    NRF_RTC0->EVTENSET = (RTC_EVTENSET_COMPARE1_Enabled << RTC_EVTENSET_COMPARE1_Pos);
+    
+    /* As for the deadlines, the timeline is read after CC has been written. */
+    if ( trigger_ticks < hal_timer_ticks_get() + HAL_TIMER_TRIGGER_LEAD_TICKS )
+    {
+        hal_timer_task_trigger_cancel();
+        
+        return ( false );
+    }
+    
+    return ( true );
+}
+
+
+void hal_timer_task_trigger_cancel(void)
+{
+    NRF_RTC0->EVTENCLR = (RTC_EVTENCLR_COMPARE1_Enabled << RTC_EVTENCLR_COMPARE1_Pos);
+    NRF_PPI->CHENCLR   = (1UL << HAL_TIMER_TRIGGER_PPI_CH_COMPARE) | (1UL << HAL_TIMER_TRIGGER_PPI_CH_DELAY);
+    
+    HAL_TIMER_TRIGGER_TIMER->TASKS_STOP  = 1;
+    HAL_TIMER_TRIGGER_TIMER->TASKS_CLEAR = 1;
+    HAL_TIMER_TRIGGER_TIMER->EVENTS_COMPARE[0] = 0;
+}
+
+
+uint64_t hal_timer_period_advance(hal_timer_period_t * p_period, uint64_t time_ticks)
+{
+    time_ticks += p_period->ticks;
+    
+    p_period->accumulator += p_period->remainder;
+    if ( p_period->accumulator >= 15625 )
+    {
+        p_period->accumulator -= 15625;
+        ++time_ticks;
+    }
+    
+    return ( time_ticks );
+}
+
+
+bool hal_timer_isr_handler(void)
+{
+    if ( NRF_RTC0->EVENTS_OVRFLW != 0 )
+    {
+        NRF_RTC0->EVENTS_OVRFLW = 0;
+        ++m_overflow_count;
+    }
+    
+    if ( (NRF_RTC0->INTENSET & (RTC_INTENSET_COMPARE0_Enabled << RTC_INTENSET_COMPARE0_Pos)) != 0 )
+    {
+        NRF_RTC0->EVENTS_COMPARE[0] = 0;
+        
+        /* The compare matches once per counter period, so a deadline further away than one
+           period stays armed until the timeline has caught up with it. */
+        if ( hal_timer_ticks_get() >= m_deadline_ticks )
+        {
+            NRF_RTC0->EVTENCLR = (RTC_EVTENCLR_COMPARE0_Enabled << RTC_EVTENCLR_COMPARE0_Pos);
+            NRF_RTC0->INTENCLR = (RTC_INTENCLR_COMPARE0_Enabled << RTC_INTENCLR_COMPARE0_Pos);
+            
+            return ( true );
+        }
+    }
+    
+    return ( false );
+}
@@ -0,0 +1,1578 @@
+/* Copyright (c) Nordic Semiconductor ASA
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ *   1. Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ *   2. Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ *   3. Neither the name of Nordic Semiconductor ASA nor the names of other
+ *   contributors to this software may be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ * 
+ *   4. This software must only be used in a processor manufactured by Nordic
+ *   Semiconductor ASA, or in a processor manufactured by a third party that
+ *   is used in combination with a processor manufactured by Nordic Semiconductor.
+ * 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "sensor_beacon_config.h"
+#include "hal_radio.h"
+#include "hal_timer.h"
+#include "hal_clock.h"
+#if defined(SENSOR_BEACON_BACKEND_LPS25H)
+#include "drv_lps25h.h"
+#include "drv_lps25h_bitfields.h"
+#include "hal_serial.h"
+#include "hal_twi.h"
+#elif defined(SENSOR_BEACON_BACKEND_SOC_TEMP)
+#include "hal_temp.h"
+#else
+#error "No sensor backend selected!"
+#endif
+#ifdef BEACON_EVENT_PIN
+#include "hal_nvm_counter.h"
+#endif
+
+#include "nrf.h"
+#include "ble_pdlp_beacon.h"
+#include "ble_pdlp_common.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+
+//#define DBG_RADIO_ACTIVE_ENABLE
+
+//#define DBG_BEACON_START_PIN    (16)
+//#define DBG_HFCLK_ENABLED_PIN   (27)
+//#define DBG_HFCLK_DISABLED_PIN  (26)
+//#define DBG_PKT_SENT_PIN        (9)
+//#define DBG_CALCULATE_BEGIN_PIN (15)
+//#define DBG_CALCULATE_END_PIN   (15)
+//#define DBG_RADIO_ACTIVE_PIN    (24)
+//#define DBG_WFE_BEGIN_PIN (25)
+//#define DBG_WFE_END_PIN   (25)
+
+
+//#define DBG_BEACON_START                              \
+//{                                                     \
+//    NRF_GPIO->OUTSET = (1 << DBG_BEACON_START_PIN);   \
+//    NRF_GPIO->DIRSET = (1 << DBG_BEACON_START_PIN);   \
+//    NRF_GPIO->DIRCLR = (1 << DBG_BEACON_START_PIN);   \
+//    NRF_GPIO->OUTCLR = (1 << DBG_BEACON_START_PIN);   \
+//}                                                     
+//#define DBG_HFCLK_ENABLED                             \
+//{                                                     \
+//    NRF_GPIO->OUTSET = (1 << DBG_HFCLK_ENABLED_PIN);  \
+//    NRF_GPIO->DIRSET = (1 << DBG_HFCLK_ENABLED_PIN);  \
+//    NRF_GPIO->DIRCLR = (1 << DBG_HFCLK_ENABLED_PIN);  \
+//    NRF_GPIO->OUTCLR = (1 << DBG_HFCLK_ENABLED_PIN);  \
+//}                                                     
+//#define DBG_HFCLK_DISABLED                            \
+//{                                                     \
+//    NRF_GPIO->OUTSET = (1 << DBG_HFCLK_DISABLED_PIN); \
+//    NRF_GPIO->DIRSET = (1 << DBG_HFCLK_DISABLED_PIN); \
+//    NRF_GPIO->DIRCLR = (1 << DBG_HFCLK_DISABLED_PIN); \
+//    NRF_GPIO->OUTCLR = (1 << DBG_HFCLK_DISABLED_PIN); \
+//}                                                     
+//#define DBG_PKT_SENT                                   \
+//{                                                      \
+//    NRF_GPIO->OUTSET = (1 << DBG_PKT_SENT_PIN);        \
+//    NRF_GPIO->DIRSET = (1 << DBG_PKT_SENT_PIN);        \
+//    NRF_GPIO->DIRCLR = (1 << DBG_PKT_SENT_PIN);        \
+//    NRF_GPIO->OUTCLR = (1 << DBG_PKT_SENT_PIN);        \
+//}                                                      
+//#define DBG_WFE_BEGIN                            \
+//{                                                \
+//    NRF_GPIO->OUTCLR = (1 << DBG_WFE_BEGIN_PIN); \
+//    NRF_GPIO->DIRSET = (1 << DBG_WFE_BEGIN_PIN); \
+//    NRF_GPIO->OUTSET = (1 << DBG_WFE_BEGIN_PIN); \
+//    for ( int i = 0; i < 0xFF; i++ ) __NOP();\
+//    NRF_GPIO->OUTCLR = (1 << DBG_WFE_BEGIN_PIN); \
+//}
+//#define DBG_WFE_END                              \
+//{                                                \
+//    for ( int i = 0; i < 0xFF; i++ ) __NOP();\
+//    NRF_GPIO->OUTSET = (1 << DBG_WFE_END_PIN);   \
+//    /*NRF_GPIO->DIRSET = (1 << DBG_WFE_END_PIN);*/   \
+//}
+
+
+#ifndef DBG_BEACON_START
+#define DBG_BEACON_START
+#endif
+#ifndef DBG_PKT_SENT
+#define DBG_PKT_SENT
+#endif
+#ifndef DBG_HFCLK_ENABLED
+#define DBG_HFCLK_ENABLED
+#endif
+#ifndef DBG_HFCLK_DISABLED
+#define DBG_HFCLK_DISABLED
+#endif
+#ifndef DBG_WFE_BEGIN
+#define DBG_WFE_BEGIN
+#endif
+#ifndef DBG_WFE_END
+#define DBG_WFE_END
+#endif
+
+
+#ifdef NRF52
+#define FPU_EXCEPTION_MASK                          0x0000009F          //!< FPU exception mask used to clear exceptions in FPSCR register.
+#define FPU_FPSCR_REG_STACK_OFF                     0x40                //!< Offset of FPSCR register stacked during interrupt handling in FPU part stack.
+#endif
+
+
+#ifdef SENSOR_BEACON_BACKEND_LPS25H
+#ifdef PCA20014
+static const hal_serial_cfg_t serial_cfg =
+{
+    .twi0.psel.scl = 27,
+    .twi0.psel.sda = 26,
+};    
+#else
+#ifdef PCA10036
+static const hal_serial_cfg_t serial_cfg =
+{
+    .twi0.psel.scl = 25,
+    .twi0.psel.sda = 23,
+};
+#else
+static const hal_serial_cfg_t serial_cfg =
+{
+    .twi0.psel.scl = 29,
+    .twi0.psel.sda = 25,    
+};
+#endif  
+#endif
+#endif
+
+
+/* The advertising interval, the sensor schedule and the feature flags are set per board in sensor_beacon_config.h. */
+#define HFCLK_STARTUP_TIME_US                       (1600)              /* The time in microseconds it takes to start up the HF clock*. */
+#define INITIAL_TIMEOUT                             (INTERVAL_US)       /* The time in microseconds until adverising the first time. */
+#define START_OF_INTERVAL_TO_SENSOR_READ_TIME_US    (INTERVAL_US / 2)   /* The time from the start of the latest advertising event until reading the sensor. */
+#define SENSOR_STEP_GUARD_US                        (2000)              /* The time in microseconds reserved for one step of reading the sensor. */
+
+#ifdef SENSOR_BEACON_BACKEND_LPS25H
+#define SENSOR_POWERUP_TIME_US                      (10000)             /* The time in microseconds from powering up the sensor until accessing it. */
+#ifdef SENSOR_FIFO_MEAN_ENABLE
+#define SENSOR_FIFO_MEAN_PERIOD_US                  (40000)             /* The time in microseconds between samples at 25 Hz. */
+#define SENSOR_FIRST_READ_TIME_US                   (SENSOR_POWERUP_TIME_US + ((SENSOR_FIFO_MEAN_WTM_POINT + 1) * SENSOR_FIFO_MEAN_PERIOD_US))  /* Until the FIFO holds all the samples of the mean. */
+#else
+#define SENSOR_FIRST_READ_TIME_US                   (40000)             /* The time in microseconds from powering up the sensor until the first read attempt. */
+#endif
+#define SENSOR_RETRY_INTERVAL_US                    (10000)             /* The time in microseconds between sensor read attempts. */
+#define SENSOR_RETRY_COUNT                          (10)                /* The maximum number of sensor read attempts. */
+#define SENSOR_SIMULATED_SERVICES                   (1 << LINKING_SERVICE_TYPE_HUMIDITY)    /* The service types without a real sensor behind them. */
+#else
+#define SENSOR_POWERUP_TIME_US                      (0)                 /* The SoC temperature sensor needs no power-up. */
+#define SENSOR_FIRST_READ_TIME_US                   (100)               /* The time in microseconds from starting the conversion (36 us) until the first read attempt. */
+#define SENSOR_RETRY_INTERVAL_US                    (100)               /* The time in microseconds between sensor read attempts. */
+#define SENSOR_RETRY_COUNT                          (3)                 /* The maximum number of sensor read attempts. */
+#define SENSOR_SIMULATED_SERVICES                   ((1 << LINKING_SERVICE_TYPE_HUMIDITY) | (1 << LINKING_SERVICE_TYPE_AIRPRESSURE))
+#endif
+
+#ifdef ADAPTIVE_INTERVAL_ENABLE
+#define SENSOR_READ_INTERVAL_US                     (SENSOR_SKIP_READ_COUNT * INTERVAL_US)  /* The time in microseconds between reading the sensor, the same as with the fixed interval but on its own deadline. */
+#endif
+
+/* The above times in RTC ticks, resolved at compile time. */
+#define HFCLK_STARTUP_TIME_TICKS                    HAL_TIMER_US_TO_TICKS_ROUNDUP(HFCLK_STARTUP_TIME_US)
+#define INITIAL_TIMEOUT_TICKS                       HAL_TIMER_US_TO_TICKS(INITIAL_TIMEOUT - HFCLK_STARTUP_TIME_US)
+#define START_OF_INTERVAL_TO_SENSOR_READ_TIME_TICKS HAL_TIMER_US_TO_TICKS(START_OF_INTERVAL_TO_SENSOR_READ_TIME_US)
+#define SENSOR_POWERUP_TIME_TICKS                   HAL_TIMER_US_TO_TICKS_ROUNDUP(SENSOR_POWERUP_TIME_US)
+#define SENSOR_FIRST_READ_TIME_TICKS                HAL_TIMER_US_TO_TICKS_ROUNDUP(SENSOR_FIRST_READ_TIME_US)
+#define SENSOR_RETRY_INTERVAL_TICKS                 HAL_TIMER_US_TO_TICKS_ROUNDUP(SENSOR_RETRY_INTERVAL_US)
+#define SENSOR_STEP_GUARD_TICKS                     HAL_TIMER_US_TO_TICKS_ROUNDUP(SENSOR_STEP_GUARD_US)
+#ifdef SENSOR_DRDY_PIN
+#define SENSOR_DRDY_CTRL_REG_SET_MASK               (DRV_LSP25H_CTRL_REG_P1_DRDY_Enabled << DRV_LSP25H_CTRL_REG_P1_DRDY_Pos)
+#else
+#define SENSOR_DRDY_CTRL_REG_SET_MASK               (0)
+#endif
+#ifdef ADAPTIVE_INTERVAL_ENABLE
+#define ADAPTIVE_INTERVAL_MIN_TICKS                 HAL_TIMER_US_TO_TICKS(ADAPTIVE_INTERVAL_MIN_US)
+#define SENSOR_READ_INTERVAL_TICKS                  HAL_TIMER_US_TO_TICKS(SENSOR_READ_INTERVAL_US)
+#endif
+
+#ifdef ADV_DELAY_ENABLE
+#define ADV_DELAY_MAX_US                            (10000)             /* The maximum advDelay added to each advertising interval, as in the Bluetooth specification. */
+#define ADV_DELAY_MAX_TICKS                         HAL_TIMER_US_TO_TICKS(ADV_DELAY_MAX_US)
+#endif
+
+#ifdef BEACON_EVENT_PIN
+#ifndef BEACON_EVENT_ACTIVE_LEVEL
+#define BEACON_EVENT_ACTIVE_LEVEL                   (0)                 /* The pin level when pressed, closed or sensed. */
+#endif
+#ifndef BEACON_EVENT_PIN_PULL
+#define BEACON_EVENT_PIN_PULL                       (GPIO_PIN_CNF_PULL_Pullup)  /* The pull of the event pin, for a switch to ground. */
+#endif
+#ifndef BEACON_EVENT_BUTTON_ID
+#define BEACON_EVENT_BUTTON_ID                      (1)                 /* The button ID sent on a press, 0 to 4095. */
+#endif
+#ifndef BEACON_EVENT_DEBOUNCE_US
+#define BEACON_EVENT_DEBOUNCE_US                    (5000)              /* The time in microseconds the pin is left to settle before it is read. */
+#endif
+#ifndef BEACON_EVENT_BURST_COUNT
+#define BEACON_EVENT_BURST_COUNT                    (5)                 /* The number of advertising events sent for each event. */
+#endif
+#ifndef BEACON_EVENT_BURST_INTERVAL_US
+#define BEACON_EVENT_BURST_INTERVAL_US              (100000)            /* The time in microseconds between the advertising events of a burst. */
+#endif
+#define BEACON_EVENT_DEBOUNCE_TICKS                 HAL_TIMER_US_TO_TICKS_ROUNDUP(BEACON_EVENT_DEBOUNCE_US)
+#define BEACON_EVENT_BURST_INTERVAL_TICKS           HAL_TIMER_US_TO_TICKS(BEACON_EVENT_BURST_INTERVAL_US)
+#endif
+
+#ifdef HFCLK_PRECISION_MODE_ENABLE
+#define HFCLK_STARTUP_FRAC_BITS                     (4)                             /* The number of fractional bits of the learned HF clock startup time. */
+#define HFCLK_STARTUP_GUARD_MIN                     (1 << HFCLK_STARTUP_FRAC_BITS)  /* The minimum guard margin (one RTC tick). */
+#define HFCLK_STARTUP_TIMEOUT_TICKS                 (2 * HFCLK_STARTUP_TIME_TICKS)  /* The time to wait for HFCLKSTARTED before sending anyway. */
+#define HFCLK_STARTUP_FRAC_TO_US(frac)              (((frac) * 15625) >> (9 + HFCLK_STARTUP_FRAC_BITS))  /* Converts 1/16 RTC ticks to microseconds. */
+#endif
+
+
+#if INITIAL_TIMEOUT - HFCLK_STARTUP_TIME_US < 400
+#error "Initial timeout too short!"
+#endif
+
+#if (defined(SENSOR_FIFO_MEAN_ENABLE) || defined(SENSOR_DRDY_PIN)) && !defined(SENSOR_BEACON_BACKEND_LPS25H)
+#error "The sensor FIFO and data ready signal are only available with the LPS25H!"
+#endif
+
+#if defined(SENSOR_FIFO_MEAN_ENABLE) && defined(SENSOR_DRDY_PIN)
+#error "The data ready signal comes with the first sample of the FIFO mean, use one or the other!"
+#endif
+
+#ifdef ADAPTIVE_INTERVAL_ENABLE
+#if (ADAPTIVE_INTERVAL_MIN_US % 15625) != 0
+#error "The burst interval must be a whole number of RTC ticks!"
+#endif
+#if ADAPTIVE_INTERVAL_MIN_US < 100000
+#error "Advertising interval too short for a non-connectable beacon!"
+#endif
+#endif
+
+#ifdef BEACON_EVENT_PIN
+#ifndef BEACON_EVENT_SERVICE_TYPE
+#error "No service type selected for the event pin!"
+#endif
+#ifdef SENSOR_DRDY_PIN
+#error "The event pin and the sensor data ready signal both use the GPIOTE PORT event!"
+#endif
+#if BEACON_EVENT_BURST_INTERVAL_US < 100000
+#error "Advertising interval too short for a non-connectable beacon!"
+#endif
+#endif
+
+
+
+static bool volatile m_radio_isr_called;    /* Indicates that the radio ISR has executed. */
+static bool volatile m_rtc_isr_called;      /* Indicates that the RTC ISR has executed. */
+#ifdef SENSOR_DRDY_PIN
+static bool volatile m_sensor_drdy;         /* Indicates that the sensor has signalled data ready. */
+#endif
+static uint64_t m_time_ticks;               /* Keeps track of the latest scheduled point in time. */
+#ifndef ADAPTIVE_INTERVAL_ENABLE
+static hal_timer_period_t m_interval = HAL_TIMER_PERIOD_INIT(INTERVAL_US);  /* The advertising interval. */
+static uint32_t m_skip_read_counter = 0;    /* Keeps track on when to read the sensor. */
+#endif
+static uint8_t m_adv_pdu[2][40];            /* The RAM representation of the advertising PDU, double-buffered. */
+static uint8_t volatile m_adv_pdu_front;    /* The index of the advertising PDU being sent, the other one is updated by the sensor. */
+static const uint8_t m_service_schedule[] = {BEACON_SERVICE_SCHEDULE};  /* The advertised service types, in turn or all at once. */
+#ifndef BEACON_PDU_MULTI_SERVICE_ENABLE
+static uint8_t m_service_index;             /* The schedule index of the service type of the next sensor reading. */
+#endif
+#ifdef SENSOR_BEACON_BACKEND_SOC_TEMP
+static bool volatile m_soc_temp_ready;      /* Indicates that a SoC temperature sample is done. */
+static int32_t m_soc_temp;                  /* The latest SoC temperature sample, in steps of 0.25 degrees Celsius. */
+#endif
+#ifdef RADIO_CHAINED_TX_ENABLE
+static const uint8_t m_adv_channels[] = {37, 38, 39};  /* The advertising channel indices. */
+#endif
+#ifdef ADV_DELAY_ENABLE
+static uint32_t m_adv_delay_state;          /* The state of the pseudo-random advDelay generator, never zero. */
+#endif
+#ifdef BEACON_EVENT_PIN
+static uint8_t m_event_pdu[40];             /* The RAM representation of the advertising PDU of the latest event. */
+#endif
+
+/* The states of reading the sensor. */
+typedef enum
+{
+    SENSOR_STATE_IDLE,                      ///< Not reading the sensor.
+    SENSOR_STATE_POWERUP,                   ///< Waiting to power up the sensor.
+    SENSOR_STATE_SETUP,                     ///< Waiting to start the measurement.
+    SENSOR_STATE_READ,                      ///< Waiting to read the measurement.
+} sensor_state_t;
+
+/* The state of reading the sensor. */
+static struct
+{
+    sensor_state_t state;                   ///< The current state.
+    uint64_t       start_ticks;             ///< The point in time when reading the sensor started.
+    uint64_t       deadline_ticks;          ///< The point in time of the next step.
+    uint8_t        retry_count;             ///< The remaining read attempts.
+} m_sensor;
+
+#ifdef BEACON_EVENT_PIN
+/* The state of the event pin. */
+static struct
+{
+    bool volatile pending;                  ///< Indicates that the event pin has changed since it was last read.
+    bool          active;                   ///< The latest read state, pressed, closed or sensed.
+    uint16_t      open_count;               ///< The number of times opened, stored in flash, 0 to LINKING_OPEN_COUNT_MAX.
+} m_event;
+#endif
+
+#ifdef ADAPTIVE_INTERVAL_ENABLE
+/* The state of the adaptive advertising interval. */
+static struct
+{
+    uint32_t interval_ticks;                ///< The interval leading up to the next advertising event.
+    uint8_t  shift;                         ///< The next interval as a power of two of the burst interval.
+    uint8_t  burst_count;                   ///< The remaining advertising events at the burst interval.
+    bool     changed;                       ///< Indicates that the latest sensor reading changed beyond the delta.
+    uint64_t event_ticks;                   ///< The point in time of the latest advertising event.
+    uint64_t sensor_read_ticks;             ///< The point in time when the sensor is due to be read, independent of the advertising events.
+    uint16_t reference[LINKING_SERVICE_TYPE_AIRPRESSURE + 1];  ///< The latest advertised value of each service type, indexed by service type.
+} m_adaptive =
+{
+    .interval_ticks = INITIAL_TIMEOUT_TICKS,
+    .shift          = ADAPTIVE_INTERVAL_MAX_SHIFT,
+    .reference      = {0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF},
+};
+#endif
+
+#ifdef HFCLK_PRECISION_MODE_ENABLE
+static bool volatile m_hfclk_started;       /* Indicates that the HF crystal has reported that it is stable. */
+
+/* The HF clock statistics of the precision mode, to be inspected with a debugger. */
+static struct
+{
+    uint32_t startup_estimate;              ///< The learned HF clock startup time, in 1/16 RTC ticks.
+    uint32_t guard;                         ///< The adaptive guard margin added to the startup estimate, in 1/16 RTC ticks.
+    uint32_t last_startup;                  ///< The measured HF clock startup time of the latest advertising event, in 1/16 RTC ticks.
+    uint32_t last_on_us;                    ///< The HF clock on-time of the latest advertising event, in microseconds. With
+                                            ///< RADIO_CHAINED_TX_ENABLE it ends when the last packet is set up, not sent.
+    uint32_t timeout_count;                 ///< The number of advertising events where HFCLKSTARTED was not reported in time.
+} volatile m_hfclk =
+{
+    .startup_estimate = HFCLK_STARTUP_TIME_TICKS << HFCLK_STARTUP_FRAC_BITS,
+    .guard            = HFCLK_STARTUP_GUARD_MIN,
+};
+#endif
+
+/* Initializes the beacon advertising PDU.
+ */
+static void m_beacon_pdu_init(uint8_t * p_beacon_pdu)
+{
+    p_beacon_pdu[0] = 0x42;
+    p_beacon_pdu[1] = 0;
+    p_beacon_pdu[2] = 0;
+}
+
+
+/* Sets the BLE address field in the sensor beacon PDU.
+ */
+static void m_beacon_pdu_bd_addr_default_set(uint8_t * p_beacon_pdu)
+{
+    if ( ( NRF_FICR->DEVICEADDR[0]           != 0xFFFFFFFF)
+    ||   ((NRF_FICR->DEVICEADDR[1] & 0xFFFF) != 0xFFFF) )
+    {
+        p_beacon_pdu[BD_ADDR_OFFS    ] = (NRF_FICR->DEVICEADDR[0]      ) & 0xFF;
+        p_beacon_pdu[BD_ADDR_OFFS + 1] = (NRF_FICR->DEVICEADDR[0] >>  8) & 0xFF;
+        p_beacon_pdu[BD_ADDR_OFFS + 2] = (NRF_FICR->DEVICEADDR[0] >> 16) & 0xFF;
+        p_beacon_pdu[BD_ADDR_OFFS + 3] = (NRF_FICR->DEVICEADDR[0] >> 24)       ;
+        p_beacon_pdu[BD_ADDR_OFFS + 4] = (NRF_FICR->DEVICEADDR[1]      ) & 0xFF;
+        p_beacon_pdu[BD_ADDR_OFFS + 5] = (NRF_FICR->DEVICEADDR[1] >>  8) & 0xFF;
+    }
+    else
+    {
+        static const uint8_t random_bd_addr[M_BD_ADDR_SIZE] = {0xE2, 0xA3, 0x01, 0xE7, 0x61, 0xF7};
+        memcpy(&(p_beacon_pdu[3]), &(random_bd_addr[0]), M_BD_ADDR_SIZE);
+    }
+    
+    p_beacon_pdu[1] = (p_beacon_pdu[1] == 0) ? M_BD_ADDR_SIZE : p_beacon_pdu[1];
+}
+
+
+/* Resets the sensor data of the sensor beacon PDU.
+ */
+static void m_beacon_pdu_sensor_data_reset(uint8_t * p_beacon_pdu)
+{
+#ifndef BEACON_PDU_MULTI_SERVICE_ENABLE
+    // 128-bit UUID beacon
+    static const uint8_t beacon_temp_pres[31] = 
+    {
+        /* Entry for Flags */
+        0x02,
+        0x01, 0x04,
+        /* Entry for Complete List of 128-bit Service Class UUID of Linking beacon */
+        0x11,
+        0x07, 0xCD, 0xA6, 0x13, 0x5B, 0x83, 0x50, 0x8D, 0x80,0x44, 0x40, 0xD3, 0x50, 0x01, 0x69, 0xB3, 0xB3,
+        /* Entry for Manufacture specific data in Linking spec*/
+        0x09,
+        0xFF, 
+        0xE2, 0x02,             // Company ID DoCoMo (0x02E2)
+        0x0A, 0xB1, 0x23, 0x45, // Version 0x0, VenderID 0xAB, ClassID 0x12345
+        0x00, 0x00              // Service data
+    };
+
+    memcpy(&(p_beacon_pdu[3 + M_BD_ADDR_SIZE]), &(beacon_temp_pres[0]), sizeof(beacon_temp_pres));
+    p_beacon_pdu[1] = M_BD_ADDR_SIZE + sizeof(beacon_temp_pres);
+#else
+    // Multi-service beacon with one service data entry per scheduled service type. The 128-bit UUID entry
+    // is left out to make room for the service data, as a non-scannable beacon has no scan response to carry it.
+    static const uint8_t beacon_multi[11] = 
+    {
+        /* Entry for Flags */
+        0x02,
+        0x01, 0x04,
+        /* Entry for Manufacture specific data in Linking spec*/
+        0x07 + sizeof(m_service_schedule) * SERVICE_DATA_SIZE,
+        0xFF, 
+        0xE2, 0x02,             // Company ID DoCoMo (0x02E2)
+        0x0A, 0xB1, 0x23, 0x45, // Version 0x0, VenderID 0xAB, ClassID 0x12345
+    };
+
+    memcpy(&(p_beacon_pdu[3 + M_BD_ADDR_SIZE]), &(beacon_multi[0]), sizeof(beacon_multi));
+    memset(&(p_beacon_pdu[MULTI_SERVICE_DATA_OFFS]), 0, sizeof(m_service_schedule) * SERVICE_DATA_SIZE);
+    p_beacon_pdu[1] = M_BD_ADDR_SIZE + sizeof(beacon_multi) + sizeof(m_service_schedule) * SERVICE_DATA_SIZE;
+#endif
+}
+
+
+/* Sets one 16-bit service data entry (4-bit service ID and 12-bit value) at the specified offset of the sensor beacon PDU.
+ */
+static void m_beacon_pdu_service_data_set(uint8_t * p_beacon_pdu, uint8_t offs, uint8_t service_type, uint16_t value)
+{
+    linking_service_data_pack(&(p_beacon_pdu[offs]), service_type, value);
+}
+
+
+#ifdef ADAPTIVE_INTERVAL_ENABLE
+/* Compares the new sensor values, indexed by service type, with the latest advertised ones and restarts the burst
+ * if any measured value has changed beyond the delta. Returns true if so.
+ * With a single service type per PDU the changed one is advertised next, whichever type is in turn.
+ */
+static bool adaptive_values_check(uint16_t const * p_values)
+{
+    uint8_t i;
+    
+    for ( i = 0; i < sizeof(m_service_schedule); i++ )
+    {
+        uint8_t  service_type = m_service_schedule[i];
+        uint16_t reference    = m_adaptive.reference[service_type];
+        uint16_t value        = p_values[service_type];
+        uint16_t diff         = (value > reference) ? (value - reference) : (reference - value);
+        
+        if ( (((SENSOR_SIMULATED_SERVICES >> service_type) & 1) == 0)
+        &&   ((reference == 0xFFFF) || (diff >= ADAPTIVE_INTERVAL_DELTA)) )
+        {
+#ifndef BEACON_PDU_MULTI_SERVICE_ENABLE
+            m_service_index = i;
+#endif
+            m_adaptive.changed = true;
+            return ( true );
+        }
+    }
+    
+    return ( false );
+}
+
+
+/* Calculates the point in time of the next advertising event.
+ * A change restarts the burst at the shortest interval, after which the interval is doubled for each event until the idle interval is reached.
+ */
+static uint64_t adaptive_interval_advance(uint64_t time_ticks)
+{
+    m_adaptive.event_ticks = time_ticks;
+    
+    if ( m_adaptive.changed )
+    {
+        m_adaptive.changed     = false;
+        m_adaptive.shift       = 0;
+        m_adaptive.burst_count = ADAPTIVE_INTERVAL_BURST_COUNT;
+    }
+    
+    m_adaptive.interval_ticks = ADAPTIVE_INTERVAL_MIN_TICKS << m_adaptive.shift;
+    
+    if ( m_adaptive.burst_count > 0 )
+    {
+        m_adaptive.burst_count--;
+    }
+    else if ( m_adaptive.shift < ADAPTIVE_INTERVAL_MAX_SHIFT )
+    {
+        m_adaptive.shift++;
+    }
+    
+    return ( time_ticks + m_adaptive.interval_ticks );
+}
+
+
+/* Brings the next advertising event forward after a change, to the burst interval after the latest event
+ * but no earlier than the guard time from now.
+ */
+static void adaptive_event_pull_in(void)
+{
+    uint64_t time_ticks = m_adaptive.event_ticks + ADAPTIVE_INTERVAL_MIN_TICKS;
+    uint64_t soon_ticks = hal_timer_ticks_get() + SENSOR_STEP_GUARD_TICKS;
+    
+    time_ticks = (time_ticks > soon_ticks) ? time_ticks : soon_ticks;
+    if ( time_ticks < m_time_ticks )
+    {
+        m_time_ticks = time_ticks;
+    }
+}
+#endif
+
+
+/* Sets the service data entry of one service type from the sensor values, indexed by service type.
+ */
+static void m_beacon_pdu_service_publish(uint8_t * p_beacon_pdu, uint8_t offs, uint8_t service_type, uint16_t const * p_values)
+{
+    m_beacon_pdu_service_data_set(p_beacon_pdu, offs, service_type, p_values[service_type]);
+#ifdef ADAPTIVE_INTERVAL_ENABLE
+    m_adaptive.reference[service_type] = p_values[service_type];
+#endif
+}
+
+
+/* Sets the sensor data of the sensor beacon PDU from the sensor values, indexed by service type.
+ */
+static void m_beacon_pdu_sensor_data_set(uint8_t * p_beacon_pdu, uint16_t const * p_values)
+{
+#ifndef BEACON_PDU_MULTI_SERVICE_ENABLE
+    // With a single scheduled service type the index is constant and folded away.
+    m_beacon_pdu_service_publish(p_beacon_pdu, SINT16_SERVICE_DATA_OFFS, m_service_schedule[m_service_index], p_values);
+    m_service_index = ((m_service_index + 1) < sizeof(m_service_schedule)) ? (m_service_index + 1) : 0;
+#else
+    uint8_t i;
+    
+    for ( i = 0; i < sizeof(m_service_schedule); i++ )
+    {
+        m_beacon_pdu_service_publish(p_beacon_pdu, MULTI_SERVICE_DATA_OFFS + i * SERVICE_DATA_SIZE, m_service_schedule[i], p_values);
+    }
+#endif
+}
+
+
+/* Waits for the next NVIC event.
+ */
+static void __forceinline cpu_wfe(void)
+{
+    DBG_WFE_BEGIN;
+    __WFE();
+    __SEV();
+    __WFE();
+    DBG_WFE_END;
+}
+
+
+#ifdef SENSOR_BEACON_BACKEND_LPS25H
+/* Hook for the access mode feature of the lps25h driver.
+ */
+static void cpu_sleep_hook(void)
+{
+    cpu_wfe();
+}
+#endif
+
+
+/* Sleeps until the specified point in time.
+ */
+static void sleep_until(uint64_t time_ticks)
+{
+    m_rtc_isr_called = false;
+    hal_timer_deadline_set(time_ticks);
+    while ( !m_rtc_isr_called )
+    {
+        cpu_wfe();
+    }
+}
+
+
+#ifdef BEACON_EVENT_PIN
+/* Sleeps until the specified point in time, or until the event pin changes. Returns false on an event.
+ */
+static bool sleep_until_or_event(uint64_t time_ticks)
+{
+    m_rtc_isr_called = false;
+    hal_timer_deadline_set(time_ticks);
+    while ( (!m_rtc_isr_called) && (!m_event.pending) )
+    {
+        cpu_wfe();
+    }
+    
+    if ( !m_rtc_isr_called )
+    {
+        hal_timer_deadline_cancel();
+        return ( false );
+    }
+    
+    return ( true );
+}
+#endif
+
+
+#ifdef SENSOR_DRDY_PIN
+/* Sleeps until the sensor signals data ready, or at the latest until the specified point in time.
+ */
+static void sleep_until_drdy(uint64_t timeout_ticks)
+{
+    m_rtc_isr_called = false;
+    hal_timer_deadline_set(timeout_ticks);
+    while ( (!m_rtc_isr_called) && (!m_sensor_drdy) )
+    {
+        cpu_wfe();
+    }
+    hal_timer_deadline_cancel();
+}
+#endif
+
+
+#ifdef HFCLK_PRECISION_MODE_ENABLE
+/* Gets the point in time, in 1/16 RTC ticks, to enable the HF clock so that it is expected to be stable
+ * at the specified point in time.
+ */
+static uint64_t hfclk_start_get(uint64_t hfclk_ready_ticks)
+{
+    uint32_t lead = m_hfclk.startup_estimate + m_hfclk.guard;
+    
+    lead = (lead < (HFCLK_STARTUP_TIMEOUT_TICKS << HFCLK_STARTUP_FRAC_BITS)) ? lead : (HFCLK_STARTUP_TIMEOUT_TICKS << HFCLK_STARTUP_FRAC_BITS);
+    
+    return ( (hfclk_ready_ticks << HFCLK_STARTUP_FRAC_BITS) - lead );
+}
+
+
+/* Updates the learned HF clock startup time and guard margin with the specified measurement in 1/16 RTC ticks.
+ */
+static void hfclk_startup_learn(uint32_t startup)
+{
+    int32_t  error     = (int32_t)startup - (int32_t)m_hfclk.startup_estimate;
+    uint32_t deviation = (error < 0) ? -error : error;
+    
+    m_hfclk.last_startup = startup;
+    m_hfclk.startup_estimate   = (uint32_t)((int32_t)m_hfclk.startup_estimate + (error / 8));
+    
+    /* The guard follows a larger deviation immediately, and decays slowly when the startup is stable. */
+    if ( deviation > m_hfclk.guard )
+    {
+        m_hfclk.guard = deviation;
+    }
+    else
+    {
+        m_hfclk.guard -= (m_hfclk.guard >> 4);
+        m_hfclk.guard  = (m_hfclk.guard > HFCLK_STARTUP_GUARD_MIN) ? m_hfclk.guard : HFCLK_STARTUP_GUARD_MIN;
+    }
+}
+
+
+/* Enables the HF clock at the specified point in time, in 1/16 RTC ticks, and sleeps until it is stable.
+ * Returns the point in time, in 1/16 RTC ticks, when it was enabled.
+ *
+ * The RTC only wakes up the CPU on whole ticks, so the HF clock is enabled through PPI, by the RTC and a
+ * timer counting the remaining fraction of a tick. The thread shall wake up HAL_TIMER_TRIGGER_LEAD_TICKS
+ * ahead to arm it; if it is later, the HF clock is enabled right away.
+ */
+static uint64_t hfclk_enable_and_wait(uint64_t start)
+{
+    uint32_t frac = (uint32_t)(start & ((1 << HFCLK_STARTUP_FRAC_BITS) - 1));
+    
+    m_hfclk_started  = false;
+    m_rtc_isr_called = false;
+    hal_clock_hfclk_started_irq_enable();
+    if ( !hal_timer_task_trigger_set(start >> HFCLK_STARTUP_FRAC_BITS, HFCLK_STARTUP_FRAC_TO_US(frac),
+                                     hal_clock_hfclk_enable_task_get()) )
+    {
+        hal_clock_hfclk_enable();
+        start = hal_timer_ticks_get() << HFCLK_STARTUP_FRAC_BITS;
+    }
+    DBG_HFCLK_ENABLED;
+    
+    hal_timer_deadline_set((start >> HFCLK_STARTUP_FRAC_BITS) + 1 + HFCLK_STARTUP_TIMEOUT_TICKS);
+    while ( (!m_hfclk_started) && (!m_rtc_isr_called) )
+    {
+        cpu_wfe();
+    }
+    hal_timer_deadline_cancel();
+    hal_timer_task_trigger_cancel();
+    
+    // The timeline is read in whole ticks, half a tick after the start of the tick on average.
+    if ( m_hfclk_started )
+    {
+        hfclk_startup_learn((uint32_t)((hal_timer_ticks_get() << HFCLK_STARTUP_FRAC_BITS) + (1 << (HFCLK_STARTUP_FRAC_BITS - 1)) - start));
+    }
+    else
+    {
+        ++m_hfclk.timeout_count;
+    }
+    
+    return ( start );
+}
+#endif
+
+
+#ifndef RADIO_CHAINED_TX_ENABLE
+/* Sends an advertising PDU on the given channel index.
+ */
+static void send_one_packet(uint8_t * p_pdu, uint8_t channel_index)
+{
+    uint8_t i;
+    
+    m_radio_isr_called = false;
+    hal_radio_channel_index_set(channel_index);
+    hal_radio_send(p_pdu);
+    while ( !m_radio_isr_called )
+    {
+        cpu_wfe();
+    }
+    
+    for ( i = 0; i < 9; i++ )
+    {
+        __NOP();
+    }
+}
+#else
+/* Sends an advertising PDU on all advertising channels back-to-back. Returns once the last packet is set up,
+ * after which the radio sends it and disables the HF clock by itself.
+ */
+static void send_all_packets(uint8_t * p_pdu)
+{
+    m_radio_isr_called = false;
+    hal_radio_send_chained(p_pdu, m_adv_channels, sizeof(m_adv_channels), hal_clock_hfclk_disable_task_get());
+    while ( !m_radio_isr_called )
+    {
+        cpu_wfe();
+    }
+}
+#endif
+
+
+/* Gets the point in time to wake up for the advertising event at the specified point in time.
+ */
+static uint64_t adv_wakeup_ticks_get(uint64_t time_ticks)
+{
+#ifdef HFCLK_PRECISION_MODE_ENABLE
+    return ( (hfclk_start_get(time_ticks + HFCLK_STARTUP_TIME_TICKS) >> HFCLK_STARTUP_FRAC_BITS) - HAL_TIMER_TRIGGER_LEAD_TICKS );
+#else
+    return ( time_ticks );
+#endif
+}
+
+
+/* Runs one advertising event: enables the HF clock, sends the PDU on all advertising channels once the
+ * clock is stable, at the earliest at the specified point in time, and disables the HF clock.
+ */
+static void adv_event_run(uint8_t * p_pdu, uint64_t hfclk_ready_ticks)
+{
+#ifdef HFCLK_PRECISION_MODE_ENABLE
+    uint64_t hfclk_start = hfclk_enable_and_wait(hfclk_start_get(hfclk_ready_ticks));
+#else
+    hal_clock_hfclk_enable();
+    DBG_HFCLK_ENABLED;
+    
+    sleep_until(hfclk_ready_ticks);
+#endif
+#ifdef RADIO_CHAINED_TX_ENABLE
+    send_all_packets(p_pdu);
+    DBG_PKT_SENT;
+#else
+    send_one_packet(p_pdu, 37);
+    DBG_PKT_SENT;
+    send_one_packet(p_pdu, 38);
+    DBG_PKT_SENT;
+    send_one_packet(p_pdu, 39);
+    DBG_PKT_SENT;
+    
+    hal_clock_hfclk_disable();
+#endif
+#ifdef HFCLK_PRECISION_MODE_ENABLE
+    m_hfclk.last_on_us = HFCLK_STARTUP_FRAC_TO_US((uint32_t)((hal_timer_ticks_get() << HFCLK_STARTUP_FRAC_BITS) - hfclk_start));
+#endif
+    
+    DBG_HFCLK_DISABLED;
+}
+
+
+/* Advances the simulated sensor data, for the service types without a real sensor behind them.
+ */
+static float sensor_simulated_change_get(void)
+{
+    static float simulated_data_change = 1.0f;
+
+    simulated_data_change += 1.0f;
+    if (simulated_data_change > 10.0f)
+    {
+      simulated_data_change = 1.0f;
+    }
+    return ( simulated_data_change );
+}
+
+
+#ifdef SENSOR_BEACON_BACKEND_LPS25H
+/* Initializes the drivers for accessing the lps25h device.
+ */
+static void sensor_chip_init(void)
+{
+    hal_serial_init(&serial_cfg);
+    hal_twi_init();
+    
+    drv_lps25h_init();
+}
+
+
+/* Powers up the the lps25h device and TWI pull-up resistors.
+ */
+static void sensor_chip_powerup(void)
+{
+    NRF_GPIO->OUTSET = (1 << 5) | (1 << 8);
+    NRF_GPIO->OUTSET = (1 << 7);
+
+    NRF_GPIO->DIRSET = (1 << 5) | (1 << 8);
+    NRF_GPIO->DIRSET = (1 << 7);
+}
+
+
+/* Sets up the the lps25h device to measure temperature and pressure.
+ */
+static bool sensor_chip_measurement_setup(void)
+{
+    static const drv_lps25h_cfg_t m_drv_lps25h_cfg =
+    {
+        .twi_id = HAL_TWI_ID_TWI0,
+        .twi_cfg.address   = (0x5C << TWI_ADDRESS_ADDRESS_Pos),
+        .twi_cfg.frequency = (TWI_FREQUENCY_FREQUENCY_K400 << TWI_FREQUENCY_FREQUENCY_Pos),
+        .p_sleep_hook = cpu_sleep_hook,
+#ifdef SENSOR_DRDY_PIN
+        .drdy_wakeup_enabled = true,
+        .drdy_pin            = SENSOR_DRDY_PIN,
+#endif
+    };
+    
+#ifdef SENSOR_DRDY_PIN
+    m_sensor_drdy = false;
+#endif
+    if ( drv_lps25h_open(&m_drv_lps25h_cfg) == DRV_LPS25H_STATUS_CODE_SUCCESS )
+    {
+        drv_lps25h_access_mode_set(DRV_LPS25H_ACCESS_MODE_CPU_INACTIVE);
+        drv_lps25h_ctrl_reg_reset_assume();     // The device was powered up just before, so no need to read the registers back.
+    
+#ifdef SENSOR_FIFO_MEAN_ENABLE
+        drv_lps25h_fifo_mean_mode_set(SENSOR_FIFO_MEAN_WTM_POINT);
+        drv_lps25h_ctrl_reg_modify((DRV_LSP25H_CTRL_REG_PD_Active << DRV_LSP25H_CTRL_REG_PD_Pos) |
+                                   (DRV_LSP25H_CTRL_REG_ODR_25HZ0 << DRV_LSP25H_CTRL_REG_ODR_Pos) |
+                                   SENSOR_DRDY_CTRL_REG_SET_MASK, 0);
+#else
+        // One write powers up the device and starts a single measurement, after which it idles until powered down.
+        drv_lps25h_ctrl_reg_modify((DRV_LSP25H_CTRL_REG_PD_Active      << DRV_LSP25H_CTRL_REG_PD_Pos) |
+                                   (DRV_LSP25H_CTRL_REG_ONE_SHOT_Start << DRV_LSP25H_CTRL_REG_ONE_SHOT_Pos) |
+                                   SENSOR_DRDY_CTRL_REG_SET_MASK, 0);
+#endif
+        
+        return ( true );
+    }
+    else
+    {
+        (void)drv_lps25h_close();
+    }
+    
+    return ( false );
+}
+
+
+/* Ends after measuring temperature and pressure.
+ */
+static void sensor_chip_measurement_done(void)
+{
+    (void)drv_lps25h_close();
+}
+
+
+/* Powers down the the lps25h device and TWI pull-up resistors.
+ */
+static void sensor_chip_powerdown(void)
+{
+    NRF_GPIO->DIRCLR = (1 << 5) | (1 << 7) | (1 << 8);
+}
+
+
+/* Checks whether the lps25h device has both temperature and pressure available.
+ */
+static bool sensor_chip_data_ready(void)
+{
+    uint8_t status;
+    
+    drv_lps25h_status_reg_get(&status);
+    
+    return ( ((status & (DRV_LSP25H_STATUS_REG_T_DA_Available << DRV_LSP25H_STATUS_REG_T_DA_Pos)) != 0)
+    &&       ((status & (DRV_LSP25H_STATUS_REG_P_DA_Available << DRV_LSP25H_STATUS_REG_P_DA_Pos)) != 0) );
+}
+
+
+/* Reads the temperature and the air pressure in one burst, simulates the humidity (there is no humidity sensor),
+ * and converts them to the Linking 12-bit format, indexed by service type.
+ */
+static void sensor_values_get(uint16_t * p_values)
+{
+    int32_t  temperature_milli_deg;
+    uint32_t pressure_pa;
+    drv_lps25h_outputs_get(&temperature_milli_deg, &pressure_pa);
+    p_values[LINKING_SERVICE_TYPE_TEMPERATURE] = IEEE754_Convert_Temperature(temperature_milli_deg*0.001f);
+    p_values[LINKING_SERVICE_TYPE_AIRPRESSURE] = IEEE754_Convert_Air_Pressure(pressure_pa*0.01f);   //Pa to hPa
+    p_values[LINKING_SERVICE_TYPE_HUMIDITY]    = IEEE754_Convert_Humidity(155.5f + sensor_simulated_change_get());
+}
+#else
+/* The SoC temperature sensor needs no driver.
+ */
+static void sensor_chip_init(void)
+{
+}
+
+
+/* Stores the result of a SoC temperature sample.
+ */
+static void sensor_soc_temp_callback(int32_t temp)
+{
+    m_soc_temp = temp;
+    m_soc_temp_ready = true;
+}
+
+
+/* The SoC temperature sensor is always powered.
+ */
+static void sensor_chip_powerup(void)
+{
+}
+
+
+/* Starts a SoC temperature conversion, which is reported from the TEMP interrupt.
+ */
+static bool sensor_chip_measurement_setup(void)
+{
+    m_soc_temp_ready = false;
+    
+    return ( hal_temp_sample_start(sensor_soc_temp_callback) );
+}
+
+
+/* Ends after measuring the SoC temperature.
+ */
+static void sensor_chip_measurement_done(void)
+{
+}
+
+
+/* The SoC temperature sensor is always powered.
+ */
+static void sensor_chip_powerdown(void)
+{
+}
+
+
+/* Checks whether the SoC temperature sample is done.
+ */
+static bool sensor_chip_data_ready(void)
+{
+    return ( m_soc_temp_ready );
+}
+
+
+/* Converts the SoC temperature and simulates the humidity and the air pressure (there are no such sensors)
+ * to the Linking 12-bit format, indexed by service type.
+ */
+static void sensor_values_get(uint16_t * p_values)
+{
+    float simulated_data_change = sensor_simulated_change_get();
+    
+    p_values[LINKING_SERVICE_TYPE_TEMPERATURE] = IEEE754_Convert_Temperature(m_soc_temp*0.25f);
+    p_values[LINKING_SERVICE_TYPE_HUMIDITY]    = IEEE754_Convert_Humidity(155.5f + simulated_data_change);
+    p_values[LINKING_SERVICE_TYPE_AIRPRESSURE] = IEEE754_Convert_Air_Pressure(34567.0f + simulated_data_change*10);
+}
+#endif
+
+
+#ifdef ADV_DELAY_ENABLE
+/* Seeds the advDelay generator, so that beacons powered up together drift apart instead of colliding on every event.
+ */
+static void adv_delay_init(void)
+{
+#ifdef ADV_DELAY_RNG_SEED_ENABLE
+    uint8_t i;
+    
+#endif
+    m_adv_delay_state = NRF_FICR->DEVICEADDR[0] ^ (NRF_FICR->DEVICEADDR[1] << 16) ^ (NRF_FICR->DEVICEADDR[1] >> 16);
+#ifdef ADV_DELAY_RNG_SEED_ENABLE
+    // Mix in four bytes from the RNG once, for devices that share an address (e.g. unprogrammed FICR).
+    NRF_RNG->CONFIG      = (RNG_CONFIG_DERCEN_Enabled << RNG_CONFIG_DERCEN_Pos);
+    NRF_RNG->TASKS_START = 1;
+    for ( i = 0; i < 4; i++ )
+    {
+        while ( NRF_RNG->EVENTS_VALRDY == 0 )
+        {
+            // Do nothing.
+        }
+        NRF_RNG->EVENTS_VALRDY = 0;
+        m_adv_delay_state = (m_adv_delay_state << 8) ^ (m_adv_delay_state >> 24) ^ NRF_RNG->VALUE;
+    }
+    NRF_RNG->TASKS_STOP = 1;
+#endif
+    if ( m_adv_delay_state == 0 )
+    {
+        m_adv_delay_state = 0x2545F491;
+    }
+}
+
+
+/* Draws the next pseudo-random advDelay, from 0 to ADV_DELAY_MAX_TICKS, from a 32-bit xorshift LFSR.
+ */
+static uint32_t adv_delay_ticks_get(void)
+{
+    m_adv_delay_state ^= m_adv_delay_state << 13;
+    m_adv_delay_state ^= m_adv_delay_state >> 17;
+    m_adv_delay_state ^= m_adv_delay_state << 5;
+    
+    return ( ((m_adv_delay_state >> 16) * (ADV_DELAY_MAX_TICKS + 1)) >> 16 );
+}
+#endif
+
+
+/* Gets the back buffer of the advertising PDU, holding a copy of the PDU currently being sent.
+ */
+static uint8_t * adv_pdu_back_get(void)
+{
+    uint8_t * p_back = &(m_adv_pdu[m_adv_pdu_front ^ 1][0]);
+    
+    memcpy(p_back, &(m_adv_pdu[m_adv_pdu_front][0]), sizeof(m_adv_pdu[0]));
+    return ( p_back );
+}
+
+
+/* Publishes the back buffer of the advertising PDU, to be sent from the next advertising event.
+ */
+static void adv_pdu_publish(void)
+{
+    m_adv_pdu_front ^= 1;
+}
+
+
+/* Reads the sensor outputs into the back buffer of the advertising PDU and publishes it.
+ */
+static void sensor_outputs_publish(bool data_available)
+{
+    uint8_t * p_pdu = adv_pdu_back_get();
+    
+    if ( data_available )
+    {
+        uint16_t values[LINKING_SERVICE_TYPE_AIRPRESSURE + 1];
+        
+        sensor_values_get(values);
+#ifdef ADAPTIVE_INTERVAL_ENABLE
+        if ( adaptive_values_check(values) )
+        {
+            adaptive_event_pull_in();
+        }
+#endif
+        m_beacon_pdu_sensor_data_set(p_pdu, values);
+    }
+    else
+    {
+        m_beacon_pdu_sensor_data_reset(p_pdu);
+    }
+    
+    adv_pdu_publish();
+}
+
+
+/* Starts reading the sensor at the specified point in time.
+ */
+static void sensor_start(uint64_t start_ticks)
+{
+    m_sensor.state          = SENSOR_STATE_POWERUP;
+    m_sensor.start_ticks    = start_ticks;
+    m_sensor.deadline_ticks = start_ticks;
+}
+
+
+/* Checks whether the next sensor step is due, leaving room for it to complete before the specified point in time.
+ */
+static bool sensor_step_due_before(uint64_t time_ticks)
+{
+    if ( m_sensor.state == SENSOR_STATE_IDLE )
+    {
+        return ( false );
+    }
+#ifdef SENSOR_DRDY_PIN
+    if ( (m_sensor.state == SENSOR_STATE_READ) && m_sensor_drdy )
+    {
+        return ( true );
+    }
+#endif
+    
+    return ( (m_sensor.deadline_ticks + SENSOR_STEP_GUARD_TICKS) <= time_ticks );
+}
+
+
+/* Runs the next step of reading the sensor. Every step is a short burst of TWI transactions,
+ * and the waits between them are left to the caller.
+ */
+static void sensor_step(void)
+{
+    switch ( m_sensor.state )
+    {
+        case SENSOR_STATE_POWERUP:
+            sensor_chip_powerup();
+            m_sensor.deadline_ticks = m_sensor.start_ticks + SENSOR_POWERUP_TIME_TICKS;
+            m_sensor.state          = SENSOR_STATE_SETUP;
+            break;
+            
+        case SENSOR_STATE_SETUP:
+            if ( sensor_chip_measurement_setup() )
+            {
+#ifdef SENSOR_DRDY_PIN
+                // One wake-up on data ready, with the end of the polling window as the fallback.
+                m_sensor.deadline_ticks = m_sensor.start_ticks + SENSOR_FIRST_READ_TIME_TICKS + ((SENSOR_RETRY_COUNT - 1) * SENSOR_RETRY_INTERVAL_TICKS);
+                m_sensor.retry_count    = 1;
+#else
+                m_sensor.deadline_ticks = m_sensor.start_ticks + SENSOR_FIRST_READ_TIME_TICKS;
+                m_sensor.retry_count    = SENSOR_RETRY_COUNT;
+#endif
+                m_sensor.state          = SENSOR_STATE_READ;
+            }
+            else
+            {
+                sensor_chip_powerdown();
+                m_sensor.state = SENSOR_STATE_IDLE;
+            }
+            break;
+            
+        case SENSOR_STATE_READ:
+            if ( sensor_chip_data_ready() )
+            {
+                sensor_outputs_publish(true);
+            }
+            else if ( --m_sensor.retry_count > 0 )
+            {
+                m_sensor.deadline_ticks += SENSOR_RETRY_INTERVAL_TICKS;
+                break;
+            }
+            else
+            {
+                sensor_outputs_publish(false);
+            }
+            
+            sensor_chip_measurement_done();
+            sensor_chip_powerdown();
+            m_sensor.state = SENSOR_STATE_IDLE;
+            break;
+            
+        default:
+            break;
+    }
+}
+
+
+/* Runs the sensor steps that are due before the specified point in time, sleeping in between.
+ * Returns false if an event on the event pin has cut it short.
+ */
+static bool sensor_steps_run_before(uint64_t time_ticks)
+{
+    while ( 1 )
+    {
+#ifdef ADAPTIVE_INTERVAL_ENABLE
+        // The sensor is read on its own schedule, and a changed reading may bring the advertising event forward.
+        uint64_t wakeup_ticks = adv_wakeup_ticks_get(m_time_ticks);
+        
+        time_ticks = (wakeup_ticks < time_ticks) ? wakeup_ticks : time_ticks;
+        if ( (m_sensor.state == SENSOR_STATE_IDLE)
+        &&   ((m_adaptive.sensor_read_ticks + SENSOR_STEP_GUARD_TICKS) <= time_ticks) )
+        {
+            uint64_t now_ticks = hal_timer_ticks_get();
+            
+            sensor_start((m_adaptive.sensor_read_ticks > now_ticks) ? m_adaptive.sensor_read_ticks : now_ticks);
+            m_adaptive.sensor_read_ticks = m_sensor.start_ticks + SENSOR_READ_INTERVAL_TICKS;
+        }
+#endif
+        if ( !sensor_step_due_before(time_ticks) )
+        {
+            break;
+        }
+#ifdef SENSOR_DRDY_PIN
+        if ( m_sensor.state == SENSOR_STATE_READ )
+        {
+            sleep_until_drdy(m_sensor.deadline_ticks);
+        }
+        else
+#endif
+        {
+#ifdef BEACON_EVENT_PIN
+            if ( !sleep_until_or_event(m_sensor.deadline_ticks) )
+            {
+                return ( false );
+            }
+#else
+            sleep_until(m_sensor.deadline_ticks);
+#endif
+        }
+        sensor_step();
+    }
+    
+    return ( true );
+}
+
+
+/* Calculates the point in time of the next advertising event after the specified one.
+ */
+static uint64_t adv_interval_advance(uint64_t time_ticks)
+{
+#ifdef ADAPTIVE_INTERVAL_ENABLE
+    time_ticks = adaptive_interval_advance(time_ticks);
+#else
+    time_ticks = hal_timer_period_advance(&m_interval, time_ticks);
+#endif
+#ifdef ADV_DELAY_ENABLE
+    time_ticks += adv_delay_ticks_get();
+#endif
+    
+    return ( time_ticks );
+}
+
+
+#ifdef BEACON_EVENT_PIN
+/* Configures the event pin to sense the specified level.
+ */
+static void event_pin_cfg(uint32_t sense)
+{
+    NRF_GPIO->PIN_CNF[BEACON_EVENT_PIN] =
+        (GPIO_PIN_CNF_DIR_Input     << GPIO_PIN_CNF_DIR_Pos)   |
+        (GPIO_PIN_CNF_INPUT_Connect << GPIO_PIN_CNF_INPUT_Pos) |
+        (BEACON_EVENT_PIN_PULL      << GPIO_PIN_CNF_PULL_Pos)  |
+        (sense                      << GPIO_PIN_CNF_SENSE_Pos);
+}
+
+
+/* Reads the event pin and senses the opposite level, so that the next change raises the PORT event.
+ * Returns true if the pin is active.
+ */
+static bool event_pin_read(void)
+{
+    uint32_t level = (NRF_GPIO->IN >> BEACON_EVENT_PIN) & 1;
+    
+    event_pin_cfg((level != 0) ? GPIO_PIN_CNF_SENSE_Low : GPIO_PIN_CNF_SENSE_High);
+    return ( level == BEACON_EVENT_ACTIVE_LEVEL );
+}
+
+
+/* Configures the event pin and enables its interrupt.
+ */
+static void event_pin_init(void)
+{
+    event_pin_cfg(GPIO_PIN_CNF_SENSE_Disabled);
+    m_event.active = event_pin_read();
+    
+    NRF_GPIOTE->EVENTS_PORT = 0;
+    NRF_GPIOTE->INTENSET = (GPIOTE_INTENSET_PORT_Enabled << GPIOTE_INTENSET_PORT_Pos);
+    NVIC_ClearPendingIRQ(GPIOTE_IRQn);
+    NVIC_EnableIRQ(GPIOTE_IRQn);
+}
+
+
+/* Reads the event pin and sets the event service data into the event PDU, on top of a copy of the
+ * PDU currently being sent. Returns false if there is nothing to send, after a bounce or on a button release.
+ */
+static bool event_pdu_update(void)
+{
+    bool     active;
+    uint16_t value;
+    
+    m_event.pending = false;
+    active = event_pin_read();
+    if ( active == m_event.active )
+    {
+        return ( false );
+    }
+    m_event.active = active;
+    
+    // The service type is a constant, so only one case is compiled in.
+    switch ( BEACON_EVENT_SERVICE_TYPE )
+    {
+        case LINKING_SERVICE_TYPE_BUTTON:
+            if ( !active )
+            {
+                return ( false );
+            }
+            value = BEACON_EVENT_BUTTON_ID;
+            break;
+            
+        case LINKING_SERVICE_TYPE_OPEN_CLOSE_SENSE:
+            // The flag is 1 when closed, and the count is advanced on every opening.
+            if ( !active )
+            {
+                m_event.open_count = (m_event.open_count + 1) & LINKING_OPEN_COUNT_MAX;
+            }
+            value = linking_flag_value_pack(active, m_event.open_count);
+            break;
+            
+        default:
+            value = linking_flag_value_pack(active, 0);
+            break;
+    }
+    
+    memcpy(m_event_pdu, &(m_adv_pdu[m_adv_pdu_front][0]), sizeof(m_event_pdu));
+#ifndef BEACON_PDU_MULTI_SERVICE_ENABLE
+    m_beacon_pdu_service_data_set(m_event_pdu, SINT16_SERVICE_DATA_OFFS, BEACON_EVENT_SERVICE_TYPE, value);
+#else
+    // The event is appended to the scheduled service data entries.
+    m_beacon_pdu_service_data_set(m_event_pdu, MULTI_SERVICE_DATA_OFFS + sizeof(m_service_schedule) * SERVICE_DATA_SIZE, BEACON_EVENT_SERVICE_TYPE, value);
+    m_event_pdu[3 + M_BD_ADDR_SIZE + 3] += SERVICE_DATA_SIZE;  // The length of the manufacturer specific data entry.
+    m_event_pdu[1]                      += SERVICE_DATA_SIZE;
+#endif
+    
+    return ( true );
+}
+
+
+/* Sends a burst of advertising events for a change of the event pin, the first one right away,
+ * and moves the next background advertising event to one interval after the burst.
+ */
+static void event_burst_run(void)
+{
+    uint64_t burst_ticks;
+    uint8_t  i;
+    
+    sleep_until(hal_timer_ticks_get() + BEACON_EVENT_DEBOUNCE_TICKS);
+    if ( !event_pdu_update() )
+    {
+        return;
+    }
+    
+    burst_ticks = hal_timer_ticks_get();
+    adv_event_run(m_event_pdu, burst_ticks + HFCLK_STARTUP_TIME_TICKS);
+    
+    // The flash is written after the first advertising event, to keep it off the latency.
+    if ( m_event.open_count != hal_nvm_counter_get() )
+    {
+        hal_nvm_counter_set(m_event.open_count);
+    }
+    
+    for ( i = 1; i < BEACON_EVENT_BURST_COUNT; i++ )
+    {
+        burst_ticks += BEACON_EVENT_BURST_INTERVAL_TICKS;
+#ifdef ADV_DELAY_ENABLE
+        burst_ticks += adv_delay_ticks_get();
+#endif
+        sleep_until(adv_wakeup_ticks_get(burst_ticks));
+        adv_event_run(m_event_pdu, burst_ticks + HFCLK_STARTUP_TIME_TICKS);
+    }
+    
+    m_time_ticks = adv_interval_advance(burst_ticks);
+}
+#endif
+
+
+/* Handles beacon managing.
+ */
+static void beacon_handler(void)
+{
+    uint64_t wakeup_ticks;
+    
+    hal_radio_reset();
+    hal_timer_start();
+    
+    m_time_ticks = INITIAL_TIMEOUT_TICKS; 
+
+    do
+    {
+#ifndef ADAPTIVE_INTERVAL_ENABLE
+        if ( (m_skip_read_counter == 0)
+        &&   (m_sensor.state == SENSOR_STATE_IDLE) )
+        {
+            sensor_start(m_time_ticks - START_OF_INTERVAL_TO_SENSOR_READ_TIME_TICKS);
+        }
+        m_skip_read_counter = ( (m_skip_read_counter + 1) < SENSOR_SKIP_READ_COUNT ) ? (m_skip_read_counter + 1) : 0;
+#endif
+        
+        wakeup_ticks = adv_wakeup_ticks_get(m_time_ticks);
+#ifdef BEACON_EVENT_PIN
+        // An event cuts the waits short and is sent right away, after which the advertising event is rescheduled.
+        while ( (!sensor_steps_run_before(wakeup_ticks))
+        ||      (!sleep_until_or_event(adv_wakeup_ticks_get(m_time_ticks))) )
+        {
+            event_burst_run();
+            wakeup_ticks = adv_wakeup_ticks_get(m_time_ticks);
+        }
+#else
+        // Sensor steps that do not fit before the advertising event continue after it.
+        sensor_steps_run_before(wakeup_ticks);
+        
+        sleep_until(adv_wakeup_ticks_get(m_time_ticks));
+#endif
+        adv_event_run(&(m_adv_pdu[m_adv_pdu_front][0]), m_time_ticks + HFCLK_STARTUP_TIME_TICKS);
+        
+        m_time_ticks = adv_interval_advance(m_time_ticks);
+    } while ( 1 );
+}  
+
+
+int main(void)
+{        
+    DBG_BEACON_START;
+
+    NRF_GPIO->OUTCLR = 0xFFFFFFFF;
+    NRF_GPIO->DIRCLR = 0xFFFFFFFF;
+
+#ifdef FPU_INTERRUPT_MODE
+    // Enable FPU interrupt
+    NVIC_SetPriority(FPU_IRQn, 6);   // nRF52 _PRIO_APP_LOW = 6
+    NVIC_ClearPendingIRQ(FPU_IRQn);
+    NVIC_EnableIRQ(FPU_IRQn);
+#endif
+        
+#ifdef DBG_WFE_BEGIN_PIN
+    NRF_GPIO->OUTSET = (1 << DBG_WFE_BEGIN_PIN);
+    NRF_GPIO->DIRSET = (1 << DBG_WFE_BEGIN_PIN);
+#endif
+    
+    sensor_chip_init();
+#ifdef ADV_DELAY_ENABLE
+    adv_delay_init();
+#endif
+#ifdef BEACON_EVENT_PIN
+    hal_nvm_counter_init();
+    m_event.open_count = hal_nvm_counter_get() & LINKING_OPEN_COUNT_MAX;
+    event_pin_init();
+#endif
+    
+    m_beacon_pdu_init(&(m_adv_pdu[m_adv_pdu_front][0]));
+    m_beacon_pdu_bd_addr_default_set(&(m_adv_pdu[m_adv_pdu_front][0]));
+    m_beacon_pdu_sensor_data_reset(&(m_adv_pdu[m_adv_pdu_front][0]));
+    
+#ifdef DBG_RADIO_ACTIVE_ENABLE
+    NRF_GPIOTE->CONFIG[0] = (GPIOTE_CONFIG_POLARITY_Toggle << GPIOTE_CONFIG_POLARITY_Pos) 
+                          | (DBG_RADIO_ACTIVE_PIN << GPIOTE_CONFIG_PSEL_Pos) 
+                          | (GPIOTE_CONFIG_MODE_Task << GPIOTE_CONFIG_MODE_Pos); 
+
+    NRF_PPI->CH[5].TEP = (uint32_t)&(NRF_GPIOTE->TASKS_OUT[0]); 
+    NRF_PPI->CH[5].EEP = (uint32_t)&(NRF_RADIO->EVENTS_READY); 
+    NRF_PPI->CH[6].TEP = (uint32_t)&(NRF_GPIOTE->TASKS_OUT[0]); 
+    NRF_PPI->CH[6].EEP = (uint32_t)&(NRF_RADIO->EVENTS_DISABLED); 
+
+    NRF_PPI->CHENSET = (PPI_CHEN_CH5_Enabled << PPI_CHEN_CH5_Pos)
+                     | (PPI_CHEN_CH6_Enabled << PPI_CHEN_CH6_Pos); 
+#endif
+
+#ifdef FPU_INTERRUPT_MODE
+    /* Clear FPSCR register and clear pending FPU interrupts. This code is base on
+     * nRF5x_release_notes.txt in documentation folder. It is necessary part of code when
+     * application using power saving mode and after handling FPU errors in polling mode.
+     */
+    __set_FPSCR(__get_FPSCR() & ~(FPU_EXCEPTION_MASK));
+    (void) __get_FPSCR();
+    NVIC_ClearPendingIRQ(FPU_IRQn);
+#endif
+
+    for (;;)
+    {
+        beacon_handler();
+    }
+}
+
+
+void RADIO_IRQHandler(void)
+{
+    if ( hal_radio_isr_handler() )
+    {
+        m_radio_isr_called = true;
+    }
+}
+
+
+void RTC0_IRQHandler(void)
+{
+    if ( hal_timer_isr_handler() )
+    {
+        m_rtc_isr_called = true;
+    }
+}
+
+
+#ifdef SENSOR_DRDY_PIN
+void GPIOTE_IRQHandler(void)
+{
+    if ( drv_lps25h_drdy_isr_handler() )
+    {
+        m_sensor_drdy = true;
+    }
+}
+#endif
+
+
+#ifdef BEACON_EVENT_PIN
+void GPIOTE_IRQHandler(void)
+{
+    if ( NRF_GPIOTE->EVENTS_PORT != 0 )
+    {
+        NRF_GPIOTE->EVENTS_PORT = 0;
+        m_event.pending = true;
+    }
+}
+#endif
+
+
+#ifdef HFCLK_PRECISION_MODE_ENABLE
+void POWER_CLOCK_IRQHandler(void)
+{
+    if ( hal_clock_isr_handler() )
+    {
+        m_hfclk_started = true;
+    }
+}
+#endif
+
+
+#ifdef SENSOR_BEACON_BACKEND_SOC_TEMP
+void TEMP_IRQHandler(void)
+{
+    (void)hal_temp_isr_handler();
+}
+#endif
+
+
+#ifdef FPU_INTERRUPT_MODE
+/**
+ * @brief FPU Interrupt handler. Clearing exception flag at the stack.
+ *
+ * Function clears exception flag in FPSCR register and at the stack. During interrupt handler
+ * execution FPU registers might be copied to the stack (see lazy stacking option) and
+ * it is necessary to clear data at the stack which will be recovered in the return from
+ * interrupt handling.
+ */
+void FPU_IRQHandler(void)
+{
+    // Prepare pointer to stack address with pushed FPSCR register
+    uint32_t * fpscr = (uint32_t * )(FPU->FPCAR + FPU_FPSCR_REG_STACK_OFF);
+    // Execute FPU instruction to activate lazy stacking
+    (void)__get_FPSCR();
+    // Clear flags in stacked FPSCR register
+    *fpscr = *fpscr & ~(FPU_EXCEPTION_MASK);
+}
+#endif
@@ -0,0 +1,113 @@
+/* Copyright (c) Nordic Semiconductor ASA
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ *   1. Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ *   2. Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ *   3. Neither the name of Nordic Semiconductor ASA nor the names of other
+ *   contributors to this software may be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ * 
+ *   4. This software must only be used in a processor manufactured by Nordic
+ *   Semiconductor ASA, or in a processor manufactured by a third party that
+ *   is used in combination with a processor manufactured by Nordic Semiconductor.
+ * 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef ENERGY_H__
+#define ENERGY_H__
+
+/* Average current estimate from the activity times of the simulation.
+
+   The current of each activity is added on top of the sleep current for the time it was active.
+   The defaults are nRF52832 datasheet figures with the DC/DC regulator at 3 V and 0 dBm, and the
+   LPS25H figure is its 1 Hz supply current spread over one conversion. Override them with -D in
+   EXTRA_CFLAGS to use figures measured on a board. */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "sim.h"
+
+#ifndef ENERGY_CURRENT_SLEEP_NA
+#define ENERGY_CURRENT_SLEEP_NA         (1900)      ///< System ON with the RTC on the LFXO and full RAM retention.
+#endif
+#ifndef ENERGY_CURRENT_CPU_NA
+#define ENERGY_CURRENT_CPU_NA           (3700000)   ///< CPU running from flash.
+#endif
+#ifndef ENERGY_CURRENT_HFXO_NA
+#define ENERGY_CURRENT_HFXO_NA          (250000)    ///< HFCLK crystal oscillator.
+#endif
+#ifndef ENERGY_CURRENT_RADIO_RAMP_NA
+#define ENERGY_CURRENT_RADIO_RAMP_NA    (4600000)   ///< Radio ramping up or disabling.
+#endif
+#ifndef ENERGY_CURRENT_RADIO_TX_NA
+#define ENERGY_CURRENT_RADIO_TX_NA      (5300000)   ///< Radio sending at 0 dBm.
+#endif
+#ifndef ENERGY_CURRENT_TWI_NA
+#define ENERGY_CURRENT_TWI_NA           (450000)    ///< TWIM with EasyDMA and the internal HFCLK.
+#endif
+#ifndef ENERGY_CURRENT_TEMP_NA
+#define ENERGY_CURRENT_TEMP_NA          (1000000)   ///< TEMP measurement with the internal HFCLK.
+#endif
+#ifndef ENERGY_CURRENT_FLASH_NA
+#define ENERGY_CURRENT_FLASH_NA         (7400000)   ///< Flash write or erase.
+#endif
+#ifndef ENERGY_CURRENT_DEVICE_NA
+#define ENERGY_CURRENT_DEVICE_NA        (700000)    ///< LPS25H converting.
+#endif
+
+
+/* Gets the average current in nA over the specified time. */
+static inline uint64_t energy_average_current_na(const sim_time_t * p_time, uint64_t elapsed_ns)
+{
+    double charge = (double)p_time->cpu_ns        * ENERGY_CURRENT_CPU_NA
+                  + (double)p_time->hfxo_ns       * ENERGY_CURRENT_HFXO_NA
+                  + (double)p_time->radio_ramp_ns * ENERGY_CURRENT_RADIO_RAMP_NA
+                  + (double)p_time->radio_tx_ns   * ENERGY_CURRENT_RADIO_TX_NA
+                  + (double)p_time->twi_ns        * ENERGY_CURRENT_TWI_NA
+                  + (double)p_time->temp_ns       * ENERGY_CURRENT_TEMP_NA
+                  + (double)p_time->flash_ns      * ENERGY_CURRENT_FLASH_NA
+                  + (double)p_time->device_ns     * ENERGY_CURRENT_DEVICE_NA;
+
+    return ( (elapsed_ns == 0) ? 0 : (uint64_t)(ENERGY_CURRENT_SLEEP_NA + charge / (double)elapsed_ns) );
+}
+
+
+/* Prints the time per second in each activity and the average current. */
+static inline uint64_t energy_report(const char * p_name, const sim_time_t * p_time, uint64_t elapsed_ns)
+{
+    uint64_t average_na = energy_average_current_na(p_time, elapsed_ns);
+
+#define ENERGY_US_PER_S(ns)     ((double)(ns) * 1e6 / (double)elapsed_ns)
+    printf("%s: %.1f s, time per second in us:\n", p_name, (double)elapsed_ns / 1e9);
+    printf("  sleep %.1f  cpu %.1f  hfxo %.1f  radio ramp %.1f  radio tx %.1f\n",
+           ENERGY_US_PER_S(p_time->sleep_ns), ENERGY_US_PER_S(p_time->cpu_ns), ENERGY_US_PER_S(p_time->hfxo_ns),
+           ENERGY_US_PER_S(p_time->radio_ramp_ns), ENERGY_US_PER_S(p_time->radio_tx_ns));
+    printf("  twi %.1f  temp %.1f  flash %.1f  sensor %.1f\n",
+           ENERGY_US_PER_S(p_time->twi_ns), ENERGY_US_PER_S(p_time->temp_ns),
+           ENERGY_US_PER_S(p_time->flash_ns), ENERGY_US_PER_S(p_time->device_ns));
+    printf("  average current %.2f uA\n", (double)average_na / 1000.0);
+#undef ENERGY_US_PER_S
+
+    return ( average_na );
+}
+
+#endif // ENERGY_H__
@@ -0,0 +1,466 @@
+/* Copyright (c) Nordic Semiconductor ASA
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ *   1. Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ *   2. Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ *   3. Neither the name of Nordic Semiconductor ASA nor the names of other
+ *   contributors to this software may be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ * 
+ *   4. This software must only be used in a processor manufactured by Nordic
+ *   Semiconductor ASA, or in a processor manufactured by a third party that
+ *   is used in combination with a processor manufactured by Nordic Semiconductor.
+ * 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "lps25h_model.h"
+#include "sim.h"
+
+#include <string.h>
+
+
+#define M_POWER_PINS            ((1UL << 5) | (1UL << 7) | (1UL << 8))
+
+#define M_REG_WHO_AM_I          (0x0F)
+#define M_REG_RES_CONF          (0x10)
+#define M_REG_PRESS_H           (0x2A)
+#define M_REG_COUNT             (0x40)
+
+#define M_CTRL1_PD              (1 << 7)
+#define M_CTRL1_ODR_Pos         (4)
+#define M_CTRL1_ODR_Msk         (0x7 << M_CTRL1_ODR_Pos)
+#define M_CTRL2_BOOT            (1 << 7)
+#define M_CTRL2_FIFO_EN         (1 << 6)
+#define M_CTRL2_SWRESET         (1 << 2)
+#define M_CTRL2_ONE_SHOT        (1 << 0)
+#define M_CTRL4_P1_DRDY         (1 << 0)
+#define M_STATUS_T_DA           (1 << 0)
+#define M_STATUS_P_DA           (1 << 1)
+#define M_STATUS_T_OR           (1 << 4)
+#define M_STATUS_P_OR           (1 << 5)
+#define M_FIFO_CTRL_WTM_Msk     (0x1F)
+#define M_FIFO_CTRL_MODE_Pos    (5)
+#define M_FIFO_CTRL_MODE_Mean   (6)
+
+#define M_FIFO_SIZE             (32)
+
+
+static struct
+{
+    uint32_t             drdy_pin;
+    uint64_t             conversion_ns;
+    int32_t              temperature_milli_deg;
+    uint32_t             pressure_pa;
+    uint32_t             temperature_noise;
+    uint32_t             pressure_noise;
+    uint32_t             noise_state;
+    bool                 powered;
+    uint64_t             powered_at;
+    uint8_t              regs[M_REG_COUNT];
+    uint8_t              pointer;               /* The register of the next access. */
+    bool                 auto_increment;
+    bool                 converting;
+    uint64_t             conversion_start;
+    int16_t              fifo_temp[M_FIFO_SIZE];
+    uint32_t             fifo_press[M_FIFO_SIZE];
+    uint32_t             fifo_count;
+    lps25h_model_stats_t stats;
+} m_lps25h;
+
+
+static void conversion_start(void);
+
+
+/* Gets a pseudo-random value within plus and minus the amplitude. */
+static int32_t noise_get(uint32_t amplitude)
+{
+    m_lps25h.noise_state ^= m_lps25h.noise_state << 13;
+    m_lps25h.noise_state ^= m_lps25h.noise_state >> 17;
+    m_lps25h.noise_state ^= m_lps25h.noise_state << 5;
+    return ( (int32_t)((uint64_t)m_lps25h.noise_state * (2 * amplitude + 1) >> 32) - (int32_t)amplitude );
+}
+
+
+/* Gets the time between measurements in continuous mode, or zero in one-shot mode. */
+static uint64_t period_ns(void)
+{
+    static const uint64_t periods_ns[] = { 0, 1000000000, 142857143, 80000000, 40000000 };
+    uint32_t odr = (m_lps25h.regs[LPS25H_MODEL_REG_CTRL1] & M_CTRL1_ODR_Msk) >> M_CTRL1_ODR_Pos;
+
+    if ( ((m_lps25h.regs[LPS25H_MODEL_REG_CTRL1] & M_CTRL1_PD) == 0)
+    ||   (odr >= sizeof(periods_ns) / sizeof(periods_ns[0])) )
+    {
+        return ( 0 );
+    }
+    return ( periods_ns[odr] );
+}
+
+
+static void drdy_update(void)
+{
+    bool level = m_lps25h.powered
+              && ((m_lps25h.regs[LPS25H_MODEL_REG_CTRL4] & M_CTRL4_P1_DRDY) != 0)
+              && ((m_lps25h.regs[LPS25H_MODEL_REG_STATUS] & (M_STATUS_T_DA | M_STATUS_P_DA)) != 0);
+
+    if ( m_lps25h.drdy_pin != LPS25H_MODEL_PIN_NONE )
+    {
+        sim_gpio_input_set(m_lps25h.drdy_pin, level);
+    }
+}
+
+
+static void registers_reset(void)
+{
+    memset(m_lps25h.regs, 0, sizeof(m_lps25h.regs));
+    m_lps25h.regs[M_REG_WHO_AM_I]  = 0xBD;
+    m_lps25h.regs[M_REG_RES_CONF]  = 0x05;
+    m_lps25h.pointer               = 0;
+    m_lps25h.auto_increment        = false;
+    m_lps25h.fifo_count            = 0;
+}
+
+
+static void conversion_stop(void)
+{
+    sim_callback_cancel(conversion_start);
+    m_lps25h.converting = false;
+    sim_device_active_set(false);
+}
+
+
+/* Stores a measurement in the outputs, as the mean of the FIFO in FIFO mean mode. */
+static void outputs_store(void)
+{
+    uint8_t * p_regs  = m_lps25h.regs;
+    uint32_t  index   = m_lps25h.fifo_count % M_FIFO_SIZE;
+    uint32_t  samples = 1;
+    int64_t   temp    = 0;
+    uint64_t  press   = 0;
+    uint32_t  raw_press;
+    int16_t   raw_temp;
+
+    int32_t   temperature = m_lps25h.temperature_milli_deg + noise_get(m_lps25h.temperature_noise);
+    int32_t   pressure    = (int32_t)m_lps25h.pressure_pa + noise_get(m_lps25h.pressure_noise);
+
+    m_lps25h.fifo_temp[index]  = (int16_t)(((int64_t)temperature - 42500) * 480 / 1000);
+    m_lps25h.fifo_press[index] = (uint32_t)(((uint64_t)pressure * 4096) / 100);
+    ++m_lps25h.fifo_count;
+
+    if ( (p_regs[LPS25H_MODEL_REG_CTRL2] & M_CTRL2_FIFO_EN)
+    &&   ((p_regs[LPS25H_MODEL_REG_FIFO_CTRL] >> M_FIFO_CTRL_MODE_Pos) == M_FIFO_CTRL_MODE_Mean) )
+    {
+        samples = (p_regs[LPS25H_MODEL_REG_FIFO_CTRL] & M_FIFO_CTRL_WTM_Msk) + 1;
+        samples = (samples < m_lps25h.fifo_count) ? samples : m_lps25h.fifo_count;
+    }
+    for ( uint32_t i = 0; i < samples; ++i )
+    {
+        uint32_t k = (m_lps25h.fifo_count - 1 - i) % M_FIFO_SIZE;
+
+        temp  += m_lps25h.fifo_temp[k];
+        press += m_lps25h.fifo_press[k];
+    }
+    raw_temp  = (int16_t)(temp / (int64_t)samples);
+    raw_press = (uint32_t)(press / samples);
+    m_lps25h.stats.mean_samples = samples;
+
+    p_regs[LPS25H_MODEL_REG_PRESS_XL]     = (uint8_t)(raw_press);
+    p_regs[LPS25H_MODEL_REG_PRESS_XL + 1] = (uint8_t)(raw_press >> 8);
+    p_regs[LPS25H_MODEL_REG_PRESS_XL + 2] = (uint8_t)(raw_press >> 16);
+    p_regs[LPS25H_MODEL_REG_TEMP_H - 1]   = (uint8_t)((uint16_t)raw_temp);
+    p_regs[LPS25H_MODEL_REG_TEMP_H]       = (uint8_t)((uint16_t)raw_temp >> 8);
+
+    if ( p_regs[LPS25H_MODEL_REG_STATUS] & (M_STATUS_T_DA | M_STATUS_P_DA) )
+    {
+        ++m_lps25h.stats.overruns;
+        p_regs[LPS25H_MODEL_REG_STATUS] |= M_STATUS_T_OR | M_STATUS_P_OR;
+    }
+    p_regs[LPS25H_MODEL_REG_STATUS] |= M_STATUS_T_DA | M_STATUS_P_DA;
+}
+
+
+static void conversion_done(void)
+{
+    uint64_t period = period_ns();
+
+    ++m_lps25h.stats.conversions;
+    outputs_store();
+    m_lps25h.regs[LPS25H_MODEL_REG_CTRL2] &= ~M_CTRL2_ONE_SHOT;
+    m_lps25h.converting = false;
+
+    if ( period != 0 )
+    {
+        uint64_t next = m_lps25h.conversion_start + period;
+
+        if ( next <= sim_now_ns() )
+        {
+            conversion_start();
+        }
+        else
+        {
+            sim_device_active_set(false);
+            sim_callback_schedule(conversion_start, next);
+        }
+    }
+    else
+    {
+        sim_device_active_set(false);
+    }
+    drdy_update();
+}
+
+
+/* Starts a measurement; in continuous mode it lasts at most one period. */
+static void conversion_start(void)
+{
+    uint64_t period   = period_ns();
+    uint64_t duration = ((period != 0) && (period < m_lps25h.conversion_ns)) ? period : m_lps25h.conversion_ns;
+
+    m_lps25h.conversion_start = sim_now_ns();
+    m_lps25h.converting       = true;
+    sim_device_active_set(true);
+    sim_callback_schedule(conversion_done, m_lps25h.conversion_start + duration);
+}
+
+
+static void register_write(uint8_t reg, uint8_t value)
+{
+    uint8_t * p_regs = m_lps25h.regs;
+
+    ++m_lps25h.stats.register_writes;
+    switch ( reg )
+    {
+        case LPS25H_MODEL_REG_CTRL1:
+            p_regs[reg] = value;
+            if ( period_ns() != 0 )
+            {
+                if ( !m_lps25h.converting )
+                {
+                    sim_callback_cancel(conversion_start);
+                    conversion_start();
+                }
+            }
+            else if ( (value & M_CTRL1_PD) == 0 )
+            {
+                sim_callback_cancel(conversion_done);
+                conversion_stop();
+            }
+            break;
+
+        case LPS25H_MODEL_REG_CTRL2:
+            if ( value & M_CTRL2_SWRESET )
+            {
+                ++m_lps25h.stats.resets;
+                sim_callback_cancel(conversion_done);
+                conversion_stop();
+                registers_reset();
+                drdy_update();
+                break;
+            }
+            if ( value & M_CTRL2_BOOT )
+            {
+                /* Reloads the trimming; the bit clears itself when done. */
+                ++m_lps25h.stats.resets;
+                value &= ~M_CTRL2_BOOT;
+            }
+            p_regs[reg] = value;
+            if ( (value & M_CTRL2_ONE_SHOT)
+            &&   (p_regs[LPS25H_MODEL_REG_CTRL1] & M_CTRL1_PD)
+            &&   (period_ns() == 0)
+            &&   !m_lps25h.converting )
+            {
+                conversion_start();
+            }
+            break;
+
+        case LPS25H_MODEL_REG_CTRL3:
+        case LPS25H_MODEL_REG_CTRL4:
+            p_regs[reg] = value;
+            drdy_update();
+            break;
+
+        case M_REG_RES_CONF:
+        case LPS25H_MODEL_REG_FIFO_CTRL:
+            p_regs[reg] = value;
+            break;
+
+        default:
+            /* Read-only or not modelled. */
+            break;
+    }
+}
+
+
+static uint8_t register_read(uint8_t reg)
+{
+    uint8_t value = m_lps25h.regs[reg];
+
+    if ( reg == M_REG_PRESS_H )
+    {
+        m_lps25h.regs[LPS25H_MODEL_REG_STATUS] &= ~(M_STATUS_P_DA | M_STATUS_P_OR);
+        drdy_update();
+    }
+    else if ( reg == LPS25H_MODEL_REG_TEMP_H )
+    {
+        m_lps25h.regs[LPS25H_MODEL_REG_STATUS] &= ~(M_STATUS_T_DA | M_STATUS_T_OR);
+        drdy_update();
+    }
+    return ( value );
+}
+
+
+static bool twi_write(const uint8_t * p_data, uint32_t length)
+{
+    if ( !m_lps25h.powered )
+    {
+        ++m_lps25h.stats.nacks;
+        return ( false );
+    }
+    ++m_lps25h.stats.writes;
+    if ( length == 0 )
+    {
+        return ( true );
+    }
+    m_lps25h.pointer        = p_data[0] & 0x7F;
+    m_lps25h.auto_increment = (p_data[0] & 0x80) != 0;
+    for ( uint32_t i = 1; i < length; ++i )
+    {
+        register_write(m_lps25h.pointer % M_REG_COUNT, p_data[i]);
+        m_lps25h.pointer += m_lps25h.auto_increment ? 1 : 0;
+    }
+    return ( true );
+}
+
+
+static bool twi_read(uint8_t * p_data, uint32_t length)
+{
+    if ( !m_lps25h.powered )
+    {
+        ++m_lps25h.stats.nacks;
+        return ( false );
+    }
+    ++m_lps25h.stats.reads;
+    for ( uint32_t i = 0; i < length; ++i )
+    {
+        p_data[i] = register_read(m_lps25h.pointer % M_REG_COUNT);
+        m_lps25h.pointer += m_lps25h.auto_increment ? 1 : 0;
+    }
+    return ( true );
+}
+
+
+static const sim_twi_device_t m_device =
+{
+    .address = LPS25H_MODEL_ADDRESS,
+    .write   = twi_write,
+    .read    = twi_read,
+};
+
+
+static void power_update(uint32_t pin, bool level)
+{
+    bool powered = sim_gpio_level_get(5) && sim_gpio_level_get(7) && sim_gpio_level_get(8);
+
+    (void)level;
+    if ( ((M_POWER_PINS >> pin) & 1) == 0 )
+    {
+        return;
+    }
+    if ( powered && !m_lps25h.powered )
+    {
+        ++m_lps25h.stats.power_ups;
+        m_lps25h.powered    = true;
+        m_lps25h.powered_at = sim_now_ns();
+        registers_reset();
+    }
+    else if ( !powered && m_lps25h.powered )
+    {
+        m_lps25h.stats.powered_ns += sim_now_ns() - m_lps25h.powered_at;
+        m_lps25h.powered = false;
+        sim_callback_cancel(conversion_done);
+        conversion_stop();
+        registers_reset();
+    }
+    drdy_update();
+}
+
+
+void lps25h_model_init(uint32_t drdy_pin)
+{
+    memset(&m_lps25h, 0, sizeof(m_lps25h));
+    m_lps25h.drdy_pin      = drdy_pin;
+    m_lps25h.conversion_ns = 36000000;
+    m_lps25h.temperature_milli_deg = 21500;
+    m_lps25h.pressure_pa   = 101325;
+    m_lps25h.noise_state   = 0x2545F491;
+    registers_reset();
+    sim_twi_device_add(&m_device);
+    sim_gpio_output_handler_set(power_update);
+}
+
+
+void lps25h_model_values_set(int32_t temperature_milli_deg, uint32_t pressure_pa)
+{
+    m_lps25h.temperature_milli_deg = temperature_milli_deg;
+    m_lps25h.pressure_pa           = pressure_pa;
+}
+
+
+void lps25h_model_noise_set(uint32_t temperature_milli_deg, uint32_t pressure_pa)
+{
+    m_lps25h.temperature_noise = temperature_milli_deg;
+    m_lps25h.pressure_noise    = pressure_pa;
+}
+
+
+void lps25h_model_conversion_time_set(uint32_t us)
+{
+    m_lps25h.conversion_ns = (uint64_t)us * 1000;
+}
+
+
+uint8_t lps25h_model_register_get(uint8_t reg)
+{
+    return ( m_lps25h.regs[reg % M_REG_COUNT] );
+}
+
+
+bool lps25h_model_powered(void)
+{
+    return ( m_lps25h.powered );
+}
+
+
+const lps25h_model_stats_t * lps25h_model_stats_get(void)
+{
+    if ( m_lps25h.powered )
+    {
+        m_lps25h.stats.powered_ns += sim_now_ns() - m_lps25h.powered_at;
+        m_lps25h.powered_at        = sim_now_ns();
+    }
+    return ( &m_lps25h.stats );
+}
+
+
+void lps25h_model_stats_clear(void)
+{
+    memset(&m_lps25h.stats, 0, sizeof(m_lps25h.stats));
+    m_lps25h.powered_at = sim_now_ns();
+}
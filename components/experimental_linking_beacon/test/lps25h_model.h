@@ -0,0 +1,114 @@
+/* Copyright (c) Nordic Semiconductor ASA
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ *   1. Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ *   2. Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ *   3. Neither the name of Nordic Semiconductor ASA nor the names of other
+ *   contributors to this software may be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ * 
+ *   4. This software must only be used in a processor manufactured by Nordic
+ *   Semiconductor ASA, or in a processor manufactured by a third party that
+ *   is used in combination with a processor manufactured by Nordic Semiconductor.
+ * 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef LPS25H_MODEL_H__
+#define LPS25H_MODEL_H__
+
+/* Host model of the LPS25H pressure sensor on the simulated TWI bus, as wired on PCA20014.
+
+   The device is powered from GPIO 5, 7 and 8 and answers at address 0x5C while all three are
+   driven high. Losing power resets its registers. It implements the register map used by
+   drv_lps25h: sub-address auto-increment, the control registers with BOOT, SWRESET and
+   ONE_SHOT clearing themselves, the one-shot and continuous modes, the FIFO mean mode, the
+   status flags cleared by reading the outputs, and the data-ready signal on INT1. The device
+   is marked active in the simulation while it converts. Each measurement can add pseudo-random
+   noise to the values, so that the FIFO mean shows in the outputs. */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+#define LPS25H_MODEL_ADDRESS        (0x5C)
+#define LPS25H_MODEL_PIN_NONE       (0xFF)      ///< INT1 is not connected.
+
+/* Registers. */
+#define LPS25H_MODEL_REG_CTRL1      (0x20)
+#define LPS25H_MODEL_REG_CTRL2      (0x21)
+#define LPS25H_MODEL_REG_CTRL3      (0x22)
+#define LPS25H_MODEL_REG_CTRL4      (0x23)
+#define LPS25H_MODEL_REG_STATUS     (0x27)
+#define LPS25H_MODEL_REG_PRESS_XL   (0x28)
+#define LPS25H_MODEL_REG_TEMP_H     (0x2C)
+#define LPS25H_MODEL_REG_FIFO_CTRL  (0x2E)
+
+
+/* Counters of the model. */
+typedef struct
+{
+    uint32_t power_ups;             ///< Power-on transitions.
+    uint32_t conversions;           ///< Completed measurements.
+    uint32_t overruns;              ///< Measurements that overwrote unread outputs.
+    uint32_t reads;                 ///< Read transfers.
+    uint32_t writes;                ///< Write transfers.
+    uint32_t register_writes;       ///< Registers written, counting each byte of a burst.
+    uint32_t nacks;                 ///< Transfers not acknowledged, as the device was not powered.
+    uint32_t resets;                ///< BOOT and SWRESET requests.
+    uint32_t mean_samples;          ///< Measurements averaged in the latest outputs.
+    uint64_t powered_ns;            ///< Time powered.
+} lps25h_model_stats_t;
+
+
+/* Attaches the device to the TWI bus, with INT1 wired to the specified pin. Shall be called after
+   sim_init(); owns the GPIO output handler. */
+void lps25h_model_init(uint32_t drdy_pin);
+
+
+/* Sets the values measured from now on, in milli degrees Celsius and Pascal. */
+void lps25h_model_values_set(int32_t temperature_milli_deg, uint32_t pressure_pa);
+
+
+/* Sets the noise added to each measurement, uniform within plus and minus the specified amounts.
+   Default none. */
+void lps25h_model_noise_set(uint32_t temperature_milli_deg, uint32_t pressure_pa);
+
+
+/* Sets the time of one measurement. Default 36 ms, the one-shot time at the reset averaging. */
+void lps25h_model_conversion_time_set(uint32_t us);
+
+
+/* Gets the value of a register. */
+uint8_t lps25h_model_register_get(uint8_t reg);
+
+
+/* Tells if the device is powered. */
+bool lps25h_model_powered(void);
+
+
+/* Gets the counters; the powered time is brought up to date. */
+const lps25h_model_stats_t * lps25h_model_stats_get(void);
+
+
+/* Clears the counters. */
+void lps25h_model_stats_clear(void);
+
+#endif // LPS25H_MODEL_H__
@@ -31,22 +31,31 @@
  * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
-#ifndef HAL_RADIO_H__
-#define HAL_RADIO_H__
+#ifndef NRF_SOC_H__
+#define NRF_SOC_H__
 
-#include <stdint.h>
+/* The part of the SoftDevice SoC API used by the beacon core, for the host simulation tests. The
+   functions are defined by the test. */
 
+#include <stdint.h>
 
-/* Resets the radio configuration. */
-void hal_radio_reset(void);
+#include "nrf.h"
 
 
-/* Sets up the radio to use the specified channel index. */
-void hal_radio_channel_index_set(uint8_t channel_index);
+#define NRF_SUCCESS             (0)
+#define NRF_ERROR_BUSY          (17)
 
+typedef enum
+{
+    NRF_APP_PRIORITY_HIGH = 1,
+    NRF_APP_PRIORITY_LOW  = 3,
+} nrf_app_irq_priority_t;
 
-/* Sends the specified packet. */
-void hal_radio_send(uint8_t *data);
 
+uint32_t sd_temp_get(int32_t * p_temp);
+uint32_t sd_nvic_SetPriority(IRQn_Type irqn, uint32_t priority);
+uint32_t sd_nvic_ClearPendingIRQ(IRQn_Type irqn);
+uint32_t sd_nvic_EnableIRQ(IRQn_Type irqn);
+uint32_t sd_nvic_SetPendingIRQ(IRQn_Type irqn);
 
-#endif // HAL_RADIO_H__
+#endif // NRF_SOC_H__
@@ -0,0 +1,524 @@
+/* Copyright (c) Nordic Semiconductor ASA
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ *   1. Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ *   2. Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ *   3. Neither the name of Nordic Semiconductor ASA nor the names of other
+ *   contributors to this software may be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ * 
+ *   4. This software must only be used in a processor manufactured by Nordic
+ *   Semiconductor ASA, or in a processor manufactured by a third party that
+ *   is used in combination with a processor manufactured by Nordic Semiconductor.
+ * 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef NRF_H__
+#define NRF_H__
+
+/* Host stand-in for the device header, used by the simulation tests in the parent directory.
+
+   The register blocks have the nRF52832 layout and are mapped at their real base addresses,
+   but the memory behind them is not accessible. Every access traps into sim.c, which keeps
+   the peripheral models in sync with virtual time, see sim.h. */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define __I     volatile const
+#define __O     volatile
+#define __IO    volatile
+
+#define __INLINE            inline
+#define __STATIC_INLINE     static inline
+#define __forceinline       inline __attribute__((always_inline))
+
+
+/* Interrupt numbers. */
+typedef enum
+{
+    POWER_CLOCK_IRQn                        = 0,
+    RADIO_IRQn                              = 1,
+    UARTE0_UART0_IRQn                       = 2,
+    SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQn  = 3,
+    SPIM1_SPIS1_TWIM1_TWIS1_SPI1_TWI1_IRQn  = 4,
+    NFCT_IRQn                               = 5,
+    GPIOTE_IRQn                             = 6,
+    SAADC_IRQn                              = 7,
+    TIMER0_IRQn                             = 8,
+    TIMER1_IRQn                             = 9,
+    TIMER2_IRQn                             = 10,
+    RTC0_IRQn                               = 11,
+    TEMP_IRQn                               = 12,
+    RNG_IRQn                                = 13,
+    ECB_IRQn                                = 14,
+    CCM_AAR_IRQn                            = 15,
+    WDT_IRQn                                = 16,
+    RTC1_IRQn                               = 17,
+    QDEC_IRQn                               = 18,
+    COMP_LPCOMP_IRQn                        = 19,
+    SWI0_EGU0_IRQn                          = 20,
+    SWI1_EGU1_IRQn                          = 21,
+    SWI2_EGU2_IRQn                          = 22,
+    SWI3_EGU3_IRQn                          = 23,
+    SWI4_EGU4_IRQn                          = 24,
+    SWI5_EGU5_IRQn                          = 25,
+    FPU_IRQn                                = 38,
+    SIM_IRQ_COUNT                           = 39
+} IRQn_Type;
+
+#define SPI0_TWI0_IRQn      SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQn
+#define SPI1_TWI1_IRQn      SPIM1_SPIS1_TWIM1_TWIS1_SPI1_TWI1_IRQn
+
+
+/* Core functions, implemented by the simulation. */
+void     NVIC_EnableIRQ(IRQn_Type irqn);
+void     NVIC_DisableIRQ(IRQn_Type irqn);
+void     NVIC_SetPendingIRQ(IRQn_Type irqn);
+void     NVIC_ClearPendingIRQ(IRQn_Type irqn);
+uint32_t NVIC_GetPendingIRQ(IRQn_Type irqn);
+void     NVIC_SetPriority(IRQn_Type irqn, uint32_t priority);
+
+void     sim_wfe(void);
+void     sim_sev(void);
+void     sim_nop(void);
+void     __disable_irq(void);
+void     __enable_irq(void);
+uint32_t __get_PRIMASK(void);
+void     __set_PRIMASK(uint32_t primask);
+uint32_t __get_FPSCR(void);
+void     __set_FPSCR(uint32_t fpscr);
+
+#define __WFE()     sim_wfe()
+#define __SEV()     sim_sev()
+#define __NOP()     sim_nop()
+
+
+/* Register blocks. */
+typedef struct
+{
+    __O  uint32_t  TASKS_START;
+    __O  uint32_t  TASKS_STOP;
+    __O  uint32_t  TASKS_CLEAR;
+    __O  uint32_t  TASKS_TRIGOVRFLW;
+    __I  uint32_t  RESERVED0[60];
+    __IO uint32_t  EVENTS_TICK;
+    __IO uint32_t  EVENTS_OVRFLW;
+    __I  uint32_t  RESERVED1[14];
+    __IO uint32_t  EVENTS_COMPARE[4];
+    __I  uint32_t  RESERVED2[109];
+    __IO uint32_t  INTENSET;
+    __IO uint32_t  INTENCLR;
+    __I  uint32_t  RESERVED3[13];
+    __IO uint32_t  EVTEN;
+    __IO uint32_t  EVTENSET;
+    __IO uint32_t  EVTENCLR;
+    __I  uint32_t  RESERVED4[110];
+    __I  uint32_t  COUNTER;
+    __IO uint32_t  PRESCALER;
+    __I  uint32_t  RESERVED5[13];
+    __IO uint32_t  CC[4];
+} NRF_RTC_Type;
+
+typedef struct
+{
+    __O  uint32_t  TASKS_TXEN;
+    __O  uint32_t  TASKS_RXEN;
+    __O  uint32_t  TASKS_START;
+    __O  uint32_t  TASKS_STOP;
+    __O  uint32_t  TASKS_DISABLE;
+    __O  uint32_t  TASKS_RSSISTART;
+    __O  uint32_t  TASKS_RSSISTOP;
+    __O  uint32_t  TASKS_BCSTART;
+    __O  uint32_t  TASKS_BCSTOP;
+    __I  uint32_t  RESERVED0[55];
+    __IO uint32_t  EVENTS_READY;
+    __IO uint32_t  EVENTS_ADDRESS;
+    __IO uint32_t  EVENTS_PAYLOAD;
+    __IO uint32_t  EVENTS_END;
+    __IO uint32_t  EVENTS_DISABLED;
+    __IO uint32_t  EVENTS_DEVMATCH;
+    __IO uint32_t  EVENTS_DEVMISS;
+    __IO uint32_t  EVENTS_RSSIEND;
+    __I  uint32_t  RESERVED1[2];
+    __IO uint32_t  EVENTS_BCMATCH;
+    __I  uint32_t  RESERVED2[53];
+    __IO uint32_t  SHORTS;
+    __I  uint32_t  RESERVED3[64];
+    __IO uint32_t  INTENSET;
+    __IO uint32_t  INTENCLR;
+    __I  uint32_t  RESERVED4[61];
+    __I  uint32_t  CRCSTATUS;
+    __I  uint32_t  RESERVED5;
+    __I  uint32_t  RXMATCH;
+    __I  uint32_t  RXCRC;
+    __I  uint32_t  DAI;
+    __I  uint32_t  RESERVED6[60];
+    __IO uint32_t  PACKETPTR;
+    __IO uint32_t  FREQUENCY;
+    __IO uint32_t  TXPOWER;
+    __IO uint32_t  MODE;
+    __IO uint32_t  PCNF0;
+    __IO uint32_t  PCNF1;
+    __IO uint32_t  BASE0;
+    __IO uint32_t  BASE1;
+    __IO uint32_t  PREFIX0;
+    __IO uint32_t  PREFIX1;
+    __IO uint32_t  TXADDRESS;
+    __IO uint32_t  RXADDRESSES;
+    __IO uint32_t  CRCCNF;
+    __IO uint32_t  CRCPOLY;
+    __IO uint32_t  CRCINIT;
+    __I  uint32_t  RESERVED7;
+    __IO uint32_t  TIFS;
+    __I  uint32_t  RSSISAMPLE;
+    __I  uint32_t  RESERVED8;
+    __I  uint32_t  STATE;
+    __IO uint32_t  DATAWHITEIV;
+    __I  uint32_t  RESERVED9[682];
+    __IO uint32_t  POWER;
+} NRF_RADIO_Type;
+
+typedef struct
+{
+    __O  uint32_t  TASKS_HFCLKSTART;
+    __O  uint32_t  TASKS_HFCLKSTOP;
+    __O  uint32_t  TASKS_LFCLKSTART;
+    __O  uint32_t  TASKS_LFCLKSTOP;
+    __O  uint32_t  TASKS_CAL;
+    __O  uint32_t  TASKS_CTSTART;
+    __O  uint32_t  TASKS_CTSTOP;
+    __I  uint32_t  RESERVED0[57];
+    __IO uint32_t  EVENTS_HFCLKSTARTED;
+    __IO uint32_t  EVENTS_LFCLKSTARTED;
+    __I  uint32_t  RESERVED1;
+    __IO uint32_t  EVENTS_DONE;
+    __IO uint32_t  EVENTS_CTTO;
+    __I  uint32_t  RESERVED2[124];
+    __IO uint32_t  INTENSET;
+    __IO uint32_t  INTENCLR;
+    __I  uint32_t  RESERVED3[63];
+    __I  uint32_t  HFCLKRUN;
+    __I  uint32_t  HFCLKSTAT;
+    __I  uint32_t  RESERVED4;
+    __I  uint32_t  LFCLKRUN;
+    __I  uint32_t  LFCLKSTAT;
+    __I  uint32_t  LFCLKSRCCOPY;
+    __I  uint32_t  RESERVED5[62];
+    __IO uint32_t  LFCLKSRC;
+    __I  uint32_t  RESERVED6[7];
+    __IO uint32_t  CTIV;
+    __I  uint32_t  RESERVED7[8];
+    __IO uint32_t  TRACECONFIG;
+} NRF_CLOCK_Type;
+
+typedef struct
+{
+    __O  uint32_t  TASKS_START;
+    __O  uint32_t  TASKS_STOP;
+    __O  uint32_t  TASKS_COUNT;
+    __O  uint32_t  TASKS_CLEAR;
+    __O  uint32_t  TASKS_SHUTDOWN;
+    __I  uint32_t  RESERVED0[11];
+    __O  uint32_t  TASKS_CAPTURE[6];
+    __I  uint32_t  RESERVED1[58];
+    __IO uint32_t  EVENTS_COMPARE[6];
+    __I  uint32_t  RESERVED2[42];
+    __IO uint32_t  SHORTS;
+    __I  uint32_t  RESERVED3[64];
+    __IO uint32_t  INTENSET;
+    __IO uint32_t  INTENCLR;
+    __I  uint32_t  RESERVED4[126];
+    __IO uint32_t  MODE;
+    __IO uint32_t  BITMODE;
+    __I  uint32_t  RESERVED5;
+    __IO uint32_t  PRESCALER;
+    __I  uint32_t  RESERVED6[11];
+    __IO uint32_t  CC[6];
+} NRF_TIMER_Type;
+
+typedef struct
+{
+    __O  uint32_t  EN;
+    __O  uint32_t  DIS;
+} PPI_TASKS_CHG_Type;
+
+typedef struct
+{
+    __IO uint32_t  EEP;
+    __IO uint32_t  TEP;
+} PPI_CH_Type;
+
+typedef struct
+{
+    __IO uint32_t  TEP;
+} PPI_FORK_Type;
+
+typedef struct
+{
+    PPI_TASKS_CHG_Type TASKS_CHG[6];
+    __I  uint32_t  RESERVED0[308];
+    __IO uint32_t  CHEN;
+    __IO uint32_t  CHENSET;
+    __IO uint32_t  CHENCLR;
+    __I  uint32_t  RESERVED1;
+    PPI_CH_Type    CH[20];
+    __I  uint32_t  RESERVED2[148];
+    __IO uint32_t  CHG[6];
+    __I  uint32_t  RESERVED3[62];
+    PPI_FORK_Type  FORK[32];
+} NRF_PPI_Type;
+
+typedef struct
+{
+    __O  uint32_t  TASKS_START;
+    __O  uint32_t  TASKS_STOP;
+    __I  uint32_t  RESERVED0[62];
+    __IO uint32_t  EVENTS_DATARDY;
+    __I  uint32_t  RESERVED1[128];
+    __IO uint32_t  INTENSET;
+    __IO uint32_t  INTENCLR;
+    __I  uint32_t  RESERVED2[127];
+    __I  int32_t   TEMP;
+} NRF_TEMP_Type;
+
+typedef struct
+{
+    __O  uint32_t  TASKS_START;
+    __O  uint32_t  TASKS_STOP;
+    __I  uint32_t  RESERVED0[62];
+    __IO uint32_t  EVENTS_VALRDY;
+    __I  uint32_t  RESERVED1[63];
+    __IO uint32_t  SHORTS;
+    __I  uint32_t  RESERVED2[64];
+    __IO uint32_t  INTENSET;
+    __IO uint32_t  INTENCLR;
+    __I  uint32_t  RESERVED3[126];
+    __IO uint32_t  CONFIG;
+    __I  uint32_t  VALUE;
+} NRF_RNG_Type;
+
+typedef struct
+{
+    __I  uint32_t  RESERVED0[256];
+    __I  uint32_t  READY;
+    __I  uint32_t  RESERVED1[64];
+    __IO uint32_t  CONFIG;
+    __IO uint32_t  ERASEPAGE;
+    __IO uint32_t  ERASEALL;
+    __IO uint32_t  ERASEPCR0;
+    __IO uint32_t  ERASEUICR;
+} NRF_NVMC_Type;
+
+typedef struct
+{
+    __I  uint32_t  RESERVED0[4];
+    __I  uint32_t  CODEPAGESIZE;
+    __I  uint32_t  CODESIZE;
+    __I  uint32_t  RESERVED1[34];
+    __I  uint32_t  DEVICEADDRTYPE;
+    __I  uint32_t  DEVICEADDR[2];
+} NRF_FICR_Type;
+
+typedef struct
+{
+    __I  uint32_t  RESERVED0[321];
+    __IO uint32_t  OUT;
+    __IO uint32_t  OUTSET;
+    __IO uint32_t  OUTCLR;
+    __I  uint32_t  IN;
+    __IO uint32_t  DIR;
+    __IO uint32_t  DIRSET;
+    __IO uint32_t  DIRCLR;
+    __IO uint32_t  LATCH;
+    __IO uint32_t  DETECTMODE;
+    __I  uint32_t  RESERVED1[118];
+    __IO uint32_t  PIN_CNF[32];
+} NRF_GPIO_Type;
+
+typedef struct
+{
+    __O  uint32_t  TASKS_OUT[8];
+    __I  uint32_t  RESERVED0[4];
+    __O  uint32_t  TASKS_SET[8];
+    __I  uint32_t  RESERVED1[4];
+    __O  uint32_t  TASKS_CLR[8];
+    __I  uint32_t  RESERVED2[32];
+    __IO uint32_t  EVENTS_IN[8];
+    __I  uint32_t  RESERVED3[23];
+    __IO uint32_t  EVENTS_PORT;
+    __I  uint32_t  RESERVED4[97];
+    __IO uint32_t  INTENSET;
+    __IO uint32_t  INTENCLR;
+    __I  uint32_t  RESERVED5[129];
+    __IO uint32_t  CONFIG[8];
+} NRF_GPIOTE_Type;
+
+typedef struct
+{
+    __O  uint32_t  TASKS_STARTRX;
+    __I  uint32_t  RESERVED0;
+    __O  uint32_t  TASKS_STARTTX;
+    __I  uint32_t  RESERVED1[2];
+    __O  uint32_t  TASKS_STOP;
+    __I  uint32_t  RESERVED2;
+    __O  uint32_t  TASKS_SUSPEND;
+    __O  uint32_t  TASKS_RESUME;
+    __I  uint32_t  RESERVED3[56];
+    __IO uint32_t  EVENTS_STOPPED;
+    __IO uint32_t  EVENTS_RXDREADY;
+    __I  uint32_t  RESERVED4[4];
+    __IO uint32_t  EVENTS_TXDSENT;
+    __I  uint32_t  RESERVED5;
+    __IO uint32_t  EVENTS_ERROR;
+    __I  uint32_t  RESERVED6[4];
+    __IO uint32_t  EVENTS_BB;
+    __I  uint32_t  RESERVED7[3];
+    __IO uint32_t  EVENTS_SUSPENDED;
+    __I  uint32_t  RESERVED8[45];
+    __IO uint32_t  SHORTS;
+    __I  uint32_t  RESERVED9[64];
+    __IO uint32_t  INTENSET;
+    __IO uint32_t  INTENCLR;
+    __I  uint32_t  RESERVED10[110];
+    __IO uint32_t  ERRORSRC;
+    __I  uint32_t  RESERVED11[14];
+    __IO uint32_t  ENABLE;
+    __I  uint32_t  RESERVED12;
+    __IO uint32_t  PSELSCL;
+    __IO uint32_t  PSELSDA;
+    __I  uint32_t  RESERVED13[2];
+    __I  uint32_t  RXD;
+    __IO uint32_t  TXD;
+    __I  uint32_t  RESERVED14;
+    __IO uint32_t  FREQUENCY;
+    __I  uint32_t  RESERVED15[24];
+    __IO uint32_t  ADDRESS;
+} NRF_TWI_Type;
+
+typedef struct
+{
+    __IO uint32_t  SCL;
+    __IO uint32_t  SDA;
+} TWIM_PSEL_Type;
+
+typedef struct
+{
+    __IO uint32_t  PTR;
+    __IO uint32_t  MAXCNT;
+    __I  uint32_t  AMOUNT;
+    __IO uint32_t  LIST;
+} TWIM_DMA_Type;
+
+typedef struct
+{
+    __O  uint32_t  TASKS_STARTRX;
+    __I  uint32_t  RESERVED0;
+    __O  uint32_t  TASKS_STARTTX;
+    __I  uint32_t  RESERVED1[2];
+    __O  uint32_t  TASKS_STOP;
+    __I  uint32_t  RESERVED2;
+    __O  uint32_t  TASKS_SUSPEND;
+    __O  uint32_t  TASKS_RESUME;
+    __I  uint32_t  RESERVED3[56];
+    __IO uint32_t  EVENTS_STOPPED;
+    __I  uint32_t  RESERVED4[7];
+    __IO uint32_t  EVENTS_ERROR;
+    __I  uint32_t  RESERVED5[8];
+    __IO uint32_t  EVENTS_SUSPENDED;
+    __IO uint32_t  EVENTS_RXSTARTED;
+    __IO uint32_t  EVENTS_TXSTARTED;
+    __I  uint32_t  RESERVED6[2];
+    __IO uint32_t  EVENTS_LASTRX;
+    __IO uint32_t  EVENTS_LASTTX;
+    __I  uint32_t  RESERVED7[39];
+    __IO uint32_t  SHORTS;
+    __I  uint32_t  RESERVED8[63];
+    __IO uint32_t  INTEN;
+    __IO uint32_t  INTENSET;
+    __IO uint32_t  INTENCLR;
+    __I  uint32_t  RESERVED9[110];
+    __IO uint32_t  ERRORSRC;
+    __I  uint32_t  RESERVED10[14];
+    __IO uint32_t  ENABLE;
+    __I  uint32_t  RESERVED11;
+    TWIM_PSEL_Type PSEL;
+    __I  uint32_t  RESERVED12[5];
+    __IO uint32_t  FREQUENCY;
+    __I  uint32_t  RESERVED13[3];
+    TWIM_DMA_Type  RXD;
+    TWIM_DMA_Type  TXD;
+    __I  uint32_t  RESERVED14[13];
+    __IO uint32_t  ADDRESS;
+} NRF_TWIM_Type;
+
+typedef struct
+{
+    __I  uint32_t  RESERVED0[320];
+    __IO uint32_t  ENABLE;
+    __I  uint32_t  RESERVED1;
+    __IO uint32_t  PSELSCK;
+    __IO uint32_t  PSELMOSI;
+    __IO uint32_t  PSELMISO;
+} NRF_SPI_Type;
+
+
+/* Base addresses. */
+#define NRF_FICR_BASE       0x10000000UL
+#define NRF_CLOCK_BASE      0x40000000UL
+#define NRF_RADIO_BASE      0x40001000UL
+#define NRF_TWI0_BASE       0x40003000UL
+#define NRF_TWI1_BASE       0x40004000UL
+#define NRF_GPIOTE_BASE     0x40006000UL
+#define NRF_TIMER0_BASE     0x40008000UL
+#define NRF_TIMER1_BASE     0x40009000UL
+#define NRF_TIMER2_BASE     0x4000A000UL
+#define NRF_RTC0_BASE       0x4000B000UL
+#define NRF_TEMP_BASE       0x4000C000UL
+#define NRF_RNG_BASE        0x4000D000UL
+#define NRF_NVMC_BASE       0x4001E000UL
+#define NRF_PPI_BASE        0x4001F000UL
+#define NRF_P0_BASE         0x50000000UL
+
+#define NRF_FICR            ((NRF_FICR_Type   *) NRF_FICR_BASE)
+#define NRF_CLOCK           ((NRF_CLOCK_Type  *) NRF_CLOCK_BASE)
+#define NRF_RADIO           ((NRF_RADIO_Type  *) NRF_RADIO_BASE)
+#define NRF_TWI0            ((NRF_TWI_Type    *) NRF_TWI0_BASE)
+#define NRF_TWIM0           ((NRF_TWIM_Type   *) NRF_TWI0_BASE)
+#define NRF_SPI0            ((NRF_SPI_Type    *) NRF_TWI0_BASE)
+#define NRF_TWI1            ((NRF_TWI_Type    *) NRF_TWI1_BASE)
+#define NRF_TWIM1           ((NRF_TWIM_Type   *) NRF_TWI1_BASE)
+#define NRF_SPI1            ((NRF_SPI_Type    *) NRF_TWI1_BASE)
+#define NRF_GPIOTE          ((NRF_GPIOTE_Type *) NRF_GPIOTE_BASE)
+#define NRF_TIMER0          ((NRF_TIMER_Type  *) NRF_TIMER0_BASE)
+#define NRF_TIMER1          ((NRF_TIMER_Type  *) NRF_TIMER1_BASE)
+#define NRF_TIMER2          ((NRF_TIMER_Type  *) NRF_TIMER2_BASE)
+#define NRF_RTC0            ((NRF_RTC_Type    *) NRF_RTC0_BASE)
+#define NRF_TEMP            ((NRF_TEMP_Type   *) NRF_TEMP_BASE)
+#define NRF_RNG             ((NRF_RNG_Type    *) NRF_RNG_BASE)
+#define NRF_NVMC            ((NRF_NVMC_Type   *) NRF_NVMC_BASE)
+#define NRF_PPI             ((NRF_PPI_Type    *) NRF_PPI_BASE)
+#define NRF_GPIO            ((NRF_GPIO_Type   *) NRF_P0_BASE)
+#define NRF_P0              NRF_GPIO
+
+#include "nrf_bitfields.h"
+
+#endif // NRF_H__
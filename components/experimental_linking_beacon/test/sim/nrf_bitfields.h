@@ -0,0 +1,259 @@
+/* Copyright (c) Nordic Semiconductor ASA
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ *   1. Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ *   2. Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ *   3. Neither the name of Nordic Semiconductor ASA nor the names of other
+ *   contributors to this software may be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ * 
+ *   4. This software must only be used in a processor manufactured by Nordic
+ *   Semiconductor ASA, or in a processor manufactured by a third party that
+ *   is used in combination with a processor manufactured by Nordic Semiconductor.
+ * 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef NRF_BITFIELDS_H__
+#define NRF_BITFIELDS_H__
+
+/* The subset of the nRF52832 register field definitions that the beacon sources use. */
+
+/* CLOCK */
+#define CLOCK_INTENSET_HFCLKSTARTED_Pos         (0UL)
+#define CLOCK_INTENSET_HFCLKSTARTED_Enabled     (1UL)
+#define CLOCK_INTENCLR_HFCLKSTARTED_Pos         (0UL)
+#define CLOCK_INTENCLR_HFCLKSTARTED_Enabled     (1UL)
+#define CLOCK_HFCLKSTAT_STATE_Pos               (16UL)
+#define CLOCK_HFCLKSTAT_STATE_Msk               (0x1UL << CLOCK_HFCLKSTAT_STATE_Pos)
+#define CLOCK_HFCLKSTAT_SRC_Pos                 (0UL)
+#define CLOCK_HFCLKSTAT_SRC_Msk                 (0x1UL << CLOCK_HFCLKSTAT_SRC_Pos)
+#define CLOCK_LFCLKSRC_SRC_RC                   (0UL)
+#define CLOCK_LFCLKSRC_SRC_Xtal                 (1UL)
+#define CLOCK_TRACECONFIG_TRACEMUX_Pos          (16UL)
+#define CLOCK_TRACECONFIG_TRACEMUX_Serial       (1UL)
+#define CLOCK_TRACECONFIG_TRACEMUX_Parallel     (2UL)
+
+/* GPIO */
+#define GPIO_PIN_CNF_DIR_Pos                    (0UL)
+#define GPIO_PIN_CNF_DIR_Input                  (0UL)
+#define GPIO_PIN_CNF_DIR_Output                 (1UL)
+#define GPIO_PIN_CNF_INPUT_Pos                  (1UL)
+#define GPIO_PIN_CNF_INPUT_Connect              (0UL)
+#define GPIO_PIN_CNF_INPUT_Disconnect           (1UL)
+#define GPIO_PIN_CNF_PULL_Pos                   (2UL)
+#define GPIO_PIN_CNF_PULL_Msk                   (0x3UL << GPIO_PIN_CNF_PULL_Pos)
+#define GPIO_PIN_CNF_PULL_Disabled              (0UL)
+#define GPIO_PIN_CNF_PULL_Pulldown              (1UL)
+#define GPIO_PIN_CNF_PULL_Pullup                (3UL)
+#define GPIO_PIN_CNF_DRIVE_Pos                  (8UL)
+#define GPIO_PIN_CNF_DRIVE_H0H1                 (3UL)
+#define GPIO_PIN_CNF_SENSE_Pos                  (16UL)
+#define GPIO_PIN_CNF_SENSE_Msk                  (0x3UL << GPIO_PIN_CNF_SENSE_Pos)
+#define GPIO_PIN_CNF_SENSE_Disabled             (0UL)
+#define GPIO_PIN_CNF_SENSE_High                 (2UL)
+#define GPIO_PIN_CNF_SENSE_Low                  (3UL)
+
+/* GPIOTE */
+#define GPIOTE_CONFIG_MODE_Pos                  (0UL)
+#define GPIOTE_CONFIG_MODE_Msk                  (0x3UL << GPIOTE_CONFIG_MODE_Pos)
+#define GPIOTE_CONFIG_MODE_Disabled             (0UL)
+#define GPIOTE_CONFIG_MODE_Event                (1UL)
+#define GPIOTE_CONFIG_MODE_Task                 (3UL)
+#define GPIOTE_CONFIG_PSEL_Pos                  (8UL)
+#define GPIOTE_CONFIG_PSEL_Msk                  (0x1FUL << GPIOTE_CONFIG_PSEL_Pos)
+#define GPIOTE_CONFIG_POLARITY_Pos              (16UL)
+#define GPIOTE_CONFIG_POLARITY_Msk              (0x3UL << GPIOTE_CONFIG_POLARITY_Pos)
+#define GPIOTE_CONFIG_POLARITY_LoToHi           (1UL)
+#define GPIOTE_CONFIG_POLARITY_HiToLo           (2UL)
+#define GPIOTE_CONFIG_POLARITY_Toggle           (3UL)
+#define GPIOTE_INTENSET_PORT_Pos                (31UL)
+#define GPIOTE_INTENSET_PORT_Enabled            (1UL)
+#define GPIOTE_INTENCLR_PORT_Pos                (31UL)
+#define GPIOTE_INTENCLR_PORT_Clear              (1UL)
+
+/* NVMC */
+#define NVMC_CONFIG_WEN_Pos                     (0UL)
+#define NVMC_CONFIG_WEN_Msk                     (0x3UL << NVMC_CONFIG_WEN_Pos)
+#define NVMC_CONFIG_WEN_Ren                     (0UL)
+#define NVMC_CONFIG_WEN_Wen                     (1UL)
+#define NVMC_CONFIG_WEN_Een                     (2UL)
+#define NVMC_READY_READY_Busy                   (0UL)
+#define NVMC_READY_READY_Ready                  (1UL)
+
+/* PPI */
+#define PPI_CHEN_CH5_Pos                        (5UL)
+#define PPI_CHEN_CH5_Enabled                    (1UL)
+#define PPI_CHEN_CH6_Pos                        (6UL)
+#define PPI_CHEN_CH6_Enabled                    (1UL)
+
+/* RADIO */
+#define RADIO_SHORTS_READY_START_Pos            (0UL)
+#define RADIO_SHORTS_READY_START_Enabled        (1UL)
+#define RADIO_SHORTS_END_DISABLE_Pos            (1UL)
+#define RADIO_SHORTS_END_DISABLE_Enabled        (1UL)
+#define RADIO_SHORTS_DISABLED_TXEN_Pos          (2UL)
+#define RADIO_SHORTS_DISABLED_TXEN_Enabled      (1UL)
+#define RADIO_INTENSET_READY_Pos                (0UL)
+#define RADIO_INTENSET_READY_Enabled            (1UL)
+#define RADIO_INTENSET_ADDRESS_Pos              (1UL)
+#define RADIO_INTENSET_ADDRESS_Enabled          (1UL)
+#define RADIO_INTENSET_END_Pos                  (3UL)
+#define RADIO_INTENSET_END_Enabled              (1UL)
+#define RADIO_INTENSET_DISABLED_Pos             (4UL)
+#define RADIO_INTENSET_DISABLED_Enabled         (1UL)
+#define RADIO_INTENCLR_ADDRESS_Pos              (1UL)
+#define RADIO_INTENCLR_ADDRESS_Clear            (1UL)
+#define RADIO_INTENCLR_DISABLED_Pos             (4UL)
+#define RADIO_INTENCLR_DISABLED_Clear           (1UL)
+#define RADIO_MODE_MODE_Pos                     (0UL)
+#define RADIO_MODE_MODE_Msk                     (0xFUL << RADIO_MODE_MODE_Pos)
+#define RADIO_MODE_MODE_Ble_1Mbit               (3UL)
+#define RADIO_PCNF0_LFLEN_Pos                   (0UL)
+#define RADIO_PCNF0_LFLEN_Msk                   (0xFUL << RADIO_PCNF0_LFLEN_Pos)
+#define RADIO_PCNF0_S0LEN_Pos                   (8UL)
+#define RADIO_PCNF0_S0LEN_Msk                   (0x1UL << RADIO_PCNF0_S0LEN_Pos)
+#define RADIO_PCNF0_S1LEN_Pos                   (16UL)
+#define RADIO_PCNF0_S1LEN_Msk                   (0xFUL << RADIO_PCNF0_S1LEN_Pos)
+#define RADIO_PCNF1_MAXLEN_Pos                  (0UL)
+#define RADIO_PCNF1_MAXLEN_Msk                  (0xFFUL << RADIO_PCNF1_MAXLEN_Pos)
+#define RADIO_PCNF1_STATLEN_Pos                 (8UL)
+#define RADIO_PCNF1_STATLEN_Msk                 (0xFFUL << RADIO_PCNF1_STATLEN_Pos)
+#define RADIO_PCNF1_BALEN_Pos                   (16UL)
+#define RADIO_PCNF1_BALEN_Msk                   (0x7UL << RADIO_PCNF1_BALEN_Pos)
+#define RADIO_PCNF1_ENDIAN_Pos                  (24UL)
+#define RADIO_PCNF1_ENDIAN_Msk                  (0x1UL << RADIO_PCNF1_ENDIAN_Pos)
+#define RADIO_PCNF1_ENDIAN_Little               (0UL)
+#define RADIO_PCNF1_WHITEEN_Pos                 (25UL)
+#define RADIO_PCNF1_WHITEEN_Msk                 (0x1UL << RADIO_PCNF1_WHITEEN_Pos)
+#define RADIO_PCNF1_WHITEEN_Enabled             (1UL)
+#define RADIO_CRCCNF_LEN_Pos                    (0UL)
+#define RADIO_CRCCNF_LEN_Msk                    (0x3UL << RADIO_CRCCNF_LEN_Pos)
+#define RADIO_CRCCNF_LEN_Three                  (3UL)
+#define RADIO_CRCCNF_SKIPADDR_Pos               (8UL)
+#define RADIO_CRCCNF_SKIPADDR_Msk               (0x1UL << RADIO_CRCCNF_SKIPADDR_Pos)
+#define RADIO_CRCCNF_SKIPADDR_Skip              (1UL)
+#define RADIO_RXADDRESSES_ADDR0_Pos             (0UL)
+#define RADIO_RXADDRESSES_ADDR0_Enabled         (1UL)
+#define RADIO_POWER_POWER_Pos                   (0UL)
+#define RADIO_POWER_POWER_Disabled              (0UL)
+#define RADIO_POWER_POWER_Enabled               (1UL)
+#define RADIO_STATE_STATE_Disabled              (0UL)
+#define RADIO_STATE_STATE_TxRu                  (9UL)
+#define RADIO_STATE_STATE_TxIdle                (10UL)
+#define RADIO_STATE_STATE_Tx                    (11UL)
+#define RADIO_STATE_STATE_TxDisable             (12UL)
+
+/* RNG */
+#define RNG_CONFIG_DERCEN_Pos                   (0UL)
+#define RNG_CONFIG_DERCEN_Enabled               (1UL)
+
+/* RTC */
+#define RTC_INTENSET_OVRFLW_Pos                 (1UL)
+#define RTC_INTENSET_OVRFLW_Enabled             (1UL)
+#define RTC_INTENSET_COMPARE0_Pos               (16UL)
+#define RTC_INTENSET_COMPARE0_Enabled           (1UL)
+#define RTC_INTENCLR_COMPARE0_Pos               (16UL)
+#define RTC_INTENCLR_COMPARE0_Enabled           (1UL)
+#define RTC_EVTENSET_COMPARE0_Pos               (16UL)
+#define RTC_EVTENSET_COMPARE0_Enabled           (1UL)
+#define RTC_EVTENCLR_COMPARE0_Pos               (16UL)
+#define RTC_EVTENCLR_COMPARE0_Enabled           (1UL)
+#define RTC_EVTENSET_COMPARE1_Pos               (17UL)
+#define RTC_EVTENSET_COMPARE1_Enabled           (1UL)
+#define RTC_EVTENCLR_COMPARE1_Pos               (17UL)
+#define RTC_EVTENCLR_COMPARE1_Enabled           (1UL)
+
+/* SPI */
+#define SPI_ENABLE_ENABLE_Pos                   (0UL)
+#define SPI_ENABLE_ENABLE_Disabled              (0UL)
+#define SPI_ENABLE_ENABLE_Enabled               (1UL)
+
+/* TEMP */
+#define TEMP_INTENSET_DATARDY_Pos               (0UL)
+#define TEMP_INTENSET_DATARDY_Enabled           (1UL)
+#define TEMP_INTENCLR_DATARDY_Pos               (0UL)
+#define TEMP_INTENCLR_DATARDY_Enabled           (1UL)
+
+/* TIMER */
+#define TIMER_MODE_MODE_Pos                     (0UL)
+#define TIMER_MODE_MODE_Timer                   (0UL)
+#define TIMER_BITMODE_BITMODE_Pos               (0UL)
+#define TIMER_BITMODE_BITMODE_16Bit             (0UL)
+#define TIMER_BITMODE_BITMODE_32Bit             (3UL)
+#define TIMER_SHORTS_COMPARE0_CLEAR_Pos         (0UL)
+#define TIMER_SHORTS_COMPARE0_STOP_Pos          (8UL)
+#define TIMER_SHORTS_COMPARE0_CLEAR_Enabled     (1UL)
+#define TIMER_SHORTS_COMPARE0_STOP_Enabled      (1UL)
+#define TIMER_INTENSET_COMPARE0_Pos             (16UL)
+#define TIMER_INTENSET_COMPARE0_Enabled         (1UL)
+
+/* TWI */
+#define TWI_ENABLE_ENABLE_Pos                   (0UL)
+#define TWI_ENABLE_ENABLE_Disabled              (0UL)
+#define TWI_ENABLE_ENABLE_Enabled               (5UL)
+#define TWI_ADDRESS_ADDRESS_Pos                 (0UL)
+#define TWI_FREQUENCY_FREQUENCY_Pos             (0UL)
+#define TWI_FREQUENCY_FREQUENCY_K100            (0x01980000UL)
+#define TWI_FREQUENCY_FREQUENCY_K250            (0x04000000UL)
+#define TWI_FREQUENCY_FREQUENCY_K400            (0x06680000UL)
+#define TWI_SHORTS_BB_SUSPEND_Pos               (0UL)
+#define TWI_SHORTS_BB_SUSPEND_Enabled           (1UL)
+#define TWI_SHORTS_BB_STOP_Pos                  (1UL)
+#define TWI_SHORTS_BB_STOP_Enabled              (1UL)
+#define TWI_INTENSET_STOPPED_Pos                (1UL)
+#define TWI_INTENSET_RXDREADY_Pos               (2UL)
+#define TWI_INTENSET_RXDREADY_Enabled           (1UL)
+#define TWI_INTENSET_TXDSENT_Pos                (7UL)
+#define TWI_INTENSET_TXDSENT_Enabled            (1UL)
+#define TWI_INTENSET_ERROR_Pos                  (9UL)
+#define TWI_INTENSET_ERROR_Enabled              (1UL)
+#define TWI_INTENCLR_RXDREADY_Pos               (2UL)
+#define TWI_INTENCLR_RXDREADY_Clear             (1UL)
+#define TWI_INTENCLR_TXDSENT_Pos                (7UL)
+#define TWI_INTENCLR_TXDSENT_Clear              (1UL)
+#define TWI_INTENCLR_ERROR_Clear                (1UL)
+
+/* TWIM */
+#define TWIM_ENABLE_ENABLE_Pos                  (0UL)
+#define TWIM_ENABLE_ENABLE_Enabled              (6UL)
+#define TWIM_FREQUENCY_FREQUENCY_Pos            (0UL)
+#define TWIM_FREQUENCY_FREQUENCY_K100           (0x01980000UL)
+#define TWIM_FREQUENCY_FREQUENCY_K250           (0x04000000UL)
+#define TWIM_FREQUENCY_FREQUENCY_K400           (0x06400000UL)
+#define TWIM_SHORTS_LASTTX_STARTRX_Pos          (7UL)
+#define TWIM_SHORTS_LASTTX_STARTRX_Enabled      (1UL)
+#define TWIM_SHORTS_LASTTX_SUSPEND_Pos          (8UL)
+#define TWIM_SHORTS_LASTTX_SUSPEND_Enabled      (1UL)
+#define TWIM_SHORTS_LASTTX_STOP_Pos             (9UL)
+#define TWIM_SHORTS_LASTTX_STOP_Enabled         (1UL)
+#define TWIM_SHORTS_LASTRX_STARTTX_Pos          (10UL)
+#define TWIM_SHORTS_LASTRX_STOP_Pos             (12UL)
+#define TWIM_SHORTS_LASTRX_STOP_Enabled         (1UL)
+#define TWIM_INTENSET_STOPPED_Pos               (1UL)
+#define TWIM_INTENSET_STOPPED_Enabled           (1UL)
+#define TWIM_INTENSET_ERROR_Pos                 (9UL)
+#define TWIM_INTENSET_ERROR_Enabled             (1UL)
+#define TWIM_INTENSET_SUSPENDED_Pos             (18UL)
+#define TWIM_INTENSET_SUSPENDED_Enabled         (1UL)
+#define TWIM_INTENCLR_ERROR_Pos                 (9UL)
+#define TWIM_INTENCLR_ERROR_Clear               (1UL)
+
+#endif // NRF_BITFIELDS_H__
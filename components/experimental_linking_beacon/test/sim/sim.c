@@ -0,0 +1,2686 @@
+/* Copyright (c) Nordic Semiconductor ASA
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ *   1. Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ *   2. Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ *   3. Neither the name of Nordic Semiconductor ASA nor the names of other
+ *   contributors to this software may be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ * 
+ *   4. This software must only be used in a processor manufactured by Nordic
+ *   Semiconductor ASA, or in a processor manufactured by a third party that
+ *   is used in combination with a processor manufactured by Nordic Semiconductor.
+ * 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#define _GNU_SOURCE
+#include "sim.h"
+
+#include <signal.h>
+#include <setjmp.h>
+#include <ucontext.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+
+#define M_PAGE_SIZE             (4096UL)
+#define M_APB_BASE              (0x40000000UL)
+#define M_APB_PAGES             (32)
+#define M_GPIO_PAGE             (M_APB_PAGES)
+#define M_FLASH_PAGE            (M_APB_PAGES + 1)
+#define M_PAGES                 (M_FLASH_PAGE + SIM_FLASH_SIM_PAGES)
+#define M_FIRMWARE_STACK_SIZE   (1024 * 1024)
+#define M_TIME_NONE             (UINT64_MAX)
+#define M_THREAD_PRIORITY       (256)
+#define M_CALLBACKS_MAX         (8)
+#define M_STEPS_MAX             (4)
+
+#define M_HFXO_STARTUP_US       (360)
+#define M_RADIO_RAMPUP_NS       (140000)
+#define M_RADIO_DISABLE_NS      (6000)
+#define M_TEMP_NS               (36000)
+#define M_RNG_NS                (30000)
+#define M_FLASH_WRITE_NS        (41000)
+#define M_FLASH_ERASE_NS        (85000000)
+#define M_WAKEUP_NS             (3000)
+
+#define M_FLASH_SIZE            (SIM_FLASH_PAGES * SIM_FLASH_PAGE_SIZE)
+
+/* Direct access to a register of a model, bypassing the access qualifiers. */
+#define REG(p_block, reg)       (*(uint32_t *)&((p_block)->reg))
+
+/* Activities accounted in sim_time_t. */
+#define A_HFXO                  (1UL << 0)
+#define A_RAMP                  (1UL << 1)
+#define A_TX                    (1UL << 2)
+#define A_TWI                   (1UL << 3)
+#define A_TEMP                  (1UL << 4)
+#define A_FLASH                 (1UL << 5)
+#define A_DEVICE                (1UL << 6)
+
+
+/* A peripheral model. The read handler returns the value seen by the firmware; registers that
+   it does not handle are kept in the alias page. The write handler is called after the firmware
+   wrote the value to the alias page. */
+typedef struct
+{
+    uint32_t   base;
+    IRQn_Type  irqn;
+    uint32_t (*read)(uint32_t offset);
+    void     (*write)(uint32_t offset, uint32_t value);
+    bool     (*irq_line)(void);
+    uint64_t (*next)(void);
+    void     (*fire)(void);
+    void     (*reset)(void);
+} model_t;
+
+
+/* A register access that is being single stepped. */
+typedef struct
+{
+    uint8_t * p_page;
+    uint32_t  address;
+    bool      write;
+    uint32_t  old_value;
+} step_t;
+
+
+/* Virtual CPU and engine state. */
+static uint8_t *    m_alias;
+static uint64_t     m_now;
+static uint64_t     m_until;
+static uint32_t     m_activity;
+static bool         m_sleeping;
+static bool         m_halted;
+static sim_stats_t  m_stats;
+static uint32_t     m_access_cost = 250;
+static uint32_t     m_preempt_countdown;
+static uint64_t     m_preempt_delay;
+
+static step_t       m_steps[M_STEPS_MAX];
+static uint32_t     m_step_count;
+
+static bool         m_event_register;
+static uint32_t     m_primask;
+static int32_t      m_exec_priority = M_THREAD_PRIORITY;
+static uint64_t     m_nvic_enabled;
+static uint64_t     m_nvic_pending;
+static uint64_t     m_nvic_active;
+static uint8_t      m_nvic_priority[SIM_IRQ_COUNT];
+
+static sigjmp_buf   m_exit_jmp;
+static bool         m_running;
+static ucontext_t   m_firmware_context;
+static uint8_t *    m_firmware_stack;
+static void       (*m_entry)(void);
+
+static struct
+{
+    void   (*callback)(void);
+    uint64_t at;
+} m_callbacks[M_CALLBACKS_MAX];
+
+
+static uint64_t time_next(void);
+static void     time_advance(uint64_t target);
+static void     irq_dispatch(void);
+static void     ppi_event(volatile uint32_t * p_event);
+static void     gpio_update(void);
+static const model_t * model_get(uint32_t address);
+
+
+/* Gets the alias of a firmware address in one of the mapped pages. */
+static void * alias(uint32_t address)
+{
+    if ( (address >= M_APB_BASE) && (address < M_APB_BASE + M_APB_PAGES * M_PAGE_SIZE) )
+    {
+        return ( m_alias + (address - M_APB_BASE) );
+    }
+    if ( (address >= NRF_P0_BASE) && (address < NRF_P0_BASE + M_PAGE_SIZE) )
+    {
+        return ( m_alias + M_GPIO_PAGE * M_PAGE_SIZE + (address - NRF_P0_BASE) );
+    }
+    if ( (address >= SIM_FLASH_SIM_BASE) && (address < M_FLASH_SIZE) )
+    {
+        return ( m_alias + M_FLASH_PAGE * M_PAGE_SIZE + (address - SIM_FLASH_SIM_BASE) );
+    }
+    return ( NULL );
+}
+
+
+static bool address_is_flash(uint32_t address)
+{
+    return ( (address >= SIM_FLASH_SIM_BASE) && (address < M_FLASH_SIZE) );
+}
+
+
+static __attribute__((noreturn)) void fatal(const char * p_message, uint32_t value)
+{
+    fprintf(stderr, "sim: %s (0x%08x) at %llu ns\n", p_message, value, (unsigned long long)m_now);
+    abort();
+}
+
+
+static __attribute__((noreturn)) void sim_exit(sim_exit_t reason)
+{
+    siglongjmp(m_exit_jmp, (int)reason + 1);
+}
+
+
+/*******************************************************************************************
+ * RTC0
+ *******************************************************************************************/
+
+#define M_RTC           ((NRF_RTC_Type *)alias(NRF_RTC0_BASE))
+#define M_RTC_MASK      (0x00FFFFFFUL)
+
+static int32_t m_lfclk_ppb;
+
+static struct
+{
+    bool     running;
+    uint64_t offset;            /* COUNTER = (ticks + offset) & mask while running. */
+    uint32_t stopped_counter;
+    uint64_t armed_from[4];     /* First tick at which CC[n] can match. */
+    uint64_t last_tick;         /* Last tick whose events were generated. */
+} m_rtc;
+
+
+uint64_t sim_lfclk_ticks_at(uint64_t t_ns)
+{
+    unsigned __int128 rate = (unsigned __int128)32768 * (uint64_t)(1000000000LL + m_lfclk_ppb);
+    return ( (uint64_t)(((unsigned __int128)t_ns * rate) / ((unsigned __int128)1000000000 * 1000000000)) );
+}
+
+
+static uint64_t lfclk_time_of_tick(uint64_t tick)
+{
+    unsigned __int128 rate = (unsigned __int128)32768 * (uint64_t)(1000000000LL + m_lfclk_ppb);
+    unsigned __int128 scaled = (unsigned __int128)tick * 1000000000 * 1000000000;
+    return ( (uint64_t)((scaled + rate - 1) / rate) );
+}
+
+
+static uint32_t rtc_counter_at(uint64_t tick)
+{
+    return ( (uint32_t)((tick + m_rtc.offset) & M_RTC_MASK) );
+}
+
+
+static uint32_t rtc_counter(void)
+{
+    return ( m_rtc.running ? rtc_counter_at(sim_lfclk_ticks_at(m_now)) : m_rtc.stopped_counter );
+}
+
+
+static void rtc_counter_set(uint32_t counter)
+{
+    if ( m_rtc.running )
+    {
+        m_rtc.offset = (uint64_t)counter - sim_lfclk_ticks_at(m_now);
+    }
+    m_rtc.stopped_counter = counter;
+}
+
+
+static uint32_t rtc_event_enable(void)
+{
+    return ( REG(M_RTC, INTENSET) | REG(M_RTC, EVTEN) );
+}
+
+
+static uint32_t rtc_read(uint32_t offset)
+{
+    if ( offset == offsetof(NRF_RTC_Type, COUNTER) )
+    {
+        return ( rtc_counter() );
+    }
+    return ( *(uint32_t *)alias(NRF_RTC0_BASE + offset) );
+}
+
+
+static void rtc_write(uint32_t offset, uint32_t value)
+{
+    NRF_RTC_Type * p_rtc = M_RTC;
+    uint64_t       tick  = sim_lfclk_ticks_at(m_now);
+
+    switch ( offset )
+    {
+        case offsetof(NRF_RTC_Type, TASKS_START):
+            if ( value && !m_rtc.running )
+            {
+                m_rtc.running = true;
+                m_rtc.offset  = (uint64_t)m_rtc.stopped_counter - tick;
+            }
+            REG(p_rtc, TASKS_START) = 0;
+            break;
+        case offsetof(NRF_RTC_Type, TASKS_STOP):
+            if ( value && m_rtc.running )
+            {
+                m_rtc.stopped_counter = rtc_counter();
+                m_rtc.running = false;
+            }
+            REG(p_rtc, TASKS_STOP) = 0;
+            break;
+        case offsetof(NRF_RTC_Type, TASKS_CLEAR):
+            if ( value )
+            {
+                rtc_counter_set(0);
+            }
+            REG(p_rtc, TASKS_CLEAR) = 0;
+            break;
+        case offsetof(NRF_RTC_Type, TASKS_TRIGOVRFLW):
+            if ( value )
+            {
+                rtc_counter_set(0xFFFFF0);
+            }
+            REG(p_rtc, TASKS_TRIGOVRFLW) = 0;
+            break;
+        case offsetof(NRF_RTC_Type, INTENSET):
+            REG(p_rtc, INTENCLR) |= value;
+            REG(p_rtc, INTENSET)  = REG(p_rtc, INTENCLR);
+            break;
+        case offsetof(NRF_RTC_Type, INTENCLR):
+            REG(p_rtc, INTENSET) &= ~value;
+            REG(p_rtc, INTENCLR)  = REG(p_rtc, INTENSET);
+            break;
+        case offsetof(NRF_RTC_Type, EVTENSET):
+            REG(p_rtc, EVTEN) |= value;
+            REG(p_rtc, EVTENSET) = REG(p_rtc, EVTENCLR) = REG(p_rtc, EVTEN);
+            break;
+        case offsetof(NRF_RTC_Type, EVTENCLR):
+            REG(p_rtc, EVTEN) &= ~value;
+            REG(p_rtc, EVTENSET) = REG(p_rtc, EVTENCLR) = REG(p_rtc, EVTEN);
+            break;
+        case offsetof(NRF_RTC_Type, EVTEN):
+            REG(p_rtc, EVTENSET) = REG(p_rtc, EVTENCLR) = value;
+            break;
+        case offsetof(NRF_RTC_Type, CC[0]):
+        case offsetof(NRF_RTC_Type, CC[1]):
+        case offsetof(NRF_RTC_Type, CC[2]):
+        case offsetof(NRF_RTC_Type, CC[3]):
+            /* The worst case of the specification: when COUNTER is N, writing N or N + 1 to CC
+               does not generate a compare event. */
+            REG(p_rtc, CC[(offset - offsetof(NRF_RTC_Type, CC[0])) / 4]) = value & M_RTC_MASK;
+            m_rtc.armed_from[(offset - offsetof(NRF_RTC_Type, CC[0])) / 4] = tick + 2;
+            break;
+        default:
+            break;
+    }
+}
+
+
+static uint64_t rtc_next_tick(void)
+{
+    uint64_t first = sim_lfclk_ticks_at(m_now) + 1;
+    uint64_t next  = M_TIME_NONE;
+    uint32_t enable;
+
+    if ( !m_rtc.running )
+    {
+        return ( M_TIME_NONE );
+    }
+    if ( first <= m_rtc.last_tick )
+    {
+        first = m_rtc.last_tick + 1;
+    }
+
+    enable = rtc_event_enable();
+    if ( enable & (1UL << 1) )
+    {
+        next = first + ((0 - rtc_counter_at(first)) & M_RTC_MASK);
+    }
+    for ( uint32_t i = 0; i < 4; ++i )
+    {
+        if ( enable & (1UL << (16 + i)) )
+        {
+            uint64_t start = (m_rtc.armed_from[i] > first) ? m_rtc.armed_from[i] : first;
+            uint64_t tick  = start + ((REG(M_RTC, CC[i]) - rtc_counter_at(start)) & M_RTC_MASK);
+
+            if ( tick < next )
+            {
+                next = tick;
+            }
+        }
+    }
+    return ( next );
+}
+
+
+static uint64_t rtc_next(void)
+{
+    uint64_t tick = rtc_next_tick();
+    return ( (tick == M_TIME_NONE) ? M_TIME_NONE : lfclk_time_of_tick(tick) );
+}
+
+
+static void rtc_fire(void)
+{
+    NRF_RTC_Type * p_rtc  = M_RTC;
+    uint64_t       tick   = sim_lfclk_ticks_at(m_now);
+    uint32_t       enable = rtc_event_enable();
+
+    if ( !m_rtc.running || (tick <= m_rtc.last_tick) )
+    {
+        return;
+    }
+    m_rtc.last_tick = tick;
+
+    if ( (enable & (1UL << 1)) && (rtc_counter_at(tick) == 0) )
+    {
+        REG(p_rtc, EVENTS_OVRFLW) = 1;
+        if ( REG(p_rtc, EVTEN) & (1UL << 1) )
+        {
+            ppi_event(&NRF_RTC0->EVENTS_OVRFLW);
+        }
+    }
+    for ( uint32_t i = 0; i < 4; ++i )
+    {
+        if ( (enable & (1UL << (16 + i)))
+        &&   (tick >= m_rtc.armed_from[i])
+        &&   (rtc_counter_at(tick) == REG(p_rtc, CC[i])) )
+        {
+            REG(p_rtc, EVENTS_COMPARE[i]) = 1;
+            if ( REG(p_rtc, EVTEN) & (1UL << (16 + i)) )
+            {
+                ppi_event(&NRF_RTC0->EVENTS_COMPARE[i]);
+            }
+        }
+    }
+}
+
+
+static bool rtc_irq_line(void)
+{
+    NRF_RTC_Type * p_rtc  = M_RTC;
+    uint32_t       inten  = REG(p_rtc, INTENSET);
+    bool           line   = ((inten & (1UL << 0)) && REG(p_rtc, EVENTS_TICK))
+                         || ((inten & (1UL << 1)) && REG(p_rtc, EVENTS_OVRFLW));
+
+    for ( uint32_t i = 0; i < 4; ++i )
+    {
+        line = line || ((inten & (1UL << (16 + i))) && REG(p_rtc, EVENTS_COMPARE[i]));
+    }
+    return ( line );
+}
+
+
+static void rtc_reset(void)
+{
+    memset(&m_rtc, 0, sizeof(m_rtc));
+}
+
+
+/*******************************************************************************************
+ * CLOCK
+ *******************************************************************************************/
+
+#define M_CLOCK     ((NRF_CLOCK_Type *)alias(NRF_CLOCK_BASE))
+
+static uint32_t m_hfxo_startup_us = M_HFXO_STARTUP_US;
+
+static struct
+{
+    bool     hfxo_starting;
+    bool     hfxo_running;
+    uint64_t hfxo_ready_at;
+} m_clock;
+
+
+static uint32_t clock_read(uint32_t offset)
+{
+    if ( offset == offsetof(NRF_CLOCK_Type, HFCLKSTAT) )
+    {
+        return ( m_clock.hfxo_running ? ((1UL << 16) | 1UL) : 0 );
+    }
+    if ( offset == offsetof(NRF_CLOCK_Type, HFCLKRUN) )
+    {
+        return ( (m_clock.hfxo_starting || m_clock.hfxo_running) ? 1 : 0 );
+    }
+    return ( *(uint32_t *)alias(NRF_CLOCK_BASE + offset) );
+}
+
+
+static void clock_hfclk_started(void)
+{
+    REG(M_CLOCK, EVENTS_HFCLKSTARTED) = 1;
+    ppi_event(&NRF_CLOCK->EVENTS_HFCLKSTARTED);
+}
+
+
+static void clock_write(uint32_t offset, uint32_t value)
+{
+    NRF_CLOCK_Type * p_clock = M_CLOCK;
+
+    switch ( offset )
+    {
+        case offsetof(NRF_CLOCK_Type, TASKS_HFCLKSTART):
+            if ( value )
+            {
+                if ( m_clock.hfxo_running )
+                {
+                    clock_hfclk_started();
+                }
+                else if ( !m_clock.hfxo_starting )
+                {
+                    m_clock.hfxo_starting = true;
+                    m_clock.hfxo_ready_at = m_now + (uint64_t)m_hfxo_startup_us * 1000;
+                    m_activity |= A_HFXO;
+                    ++m_stats.hfxo_starts;
+                }
+            }
+            REG(p_clock, TASKS_HFCLKSTART) = 0;
+            break;
+        case offsetof(NRF_CLOCK_Type, TASKS_HFCLKSTOP):
+            if ( value )
+            {
+                m_clock.hfxo_starting = false;
+                m_clock.hfxo_running  = false;
+                m_activity &= ~A_HFXO;
+            }
+            REG(p_clock, TASKS_HFCLKSTOP) = 0;
+            break;
+        case offsetof(NRF_CLOCK_Type, TASKS_LFCLKSTART):
+            if ( value )
+            {
+                REG(p_clock, EVENTS_LFCLKSTARTED) = 1;
+                ppi_event(&NRF_CLOCK->EVENTS_LFCLKSTARTED);
+            }
+            REG(p_clock, TASKS_LFCLKSTART) = 0;
+            break;
+        case offsetof(NRF_CLOCK_Type, INTENSET):
+            REG(p_clock, INTENCLR) |= value;
+            REG(p_clock, INTENSET)  = REG(p_clock, INTENCLR);
+            break;
+        case offsetof(NRF_CLOCK_Type, INTENCLR):
+            REG(p_clock, INTENSET) &= ~value;
+            REG(p_clock, INTENCLR)  = REG(p_clock, INTENSET);
+            break;
+        default:
+            break;
+    }
+}
+
+
+static uint64_t clock_next(void)
+{
+    return ( m_clock.hfxo_starting ? m_clock.hfxo_ready_at : M_TIME_NONE );
+}
+
+
+static void clock_fire(void)
+{
+    if ( m_clock.hfxo_starting && (m_now >= m_clock.hfxo_ready_at) )
+    {
+        m_clock.hfxo_starting = false;
+        m_clock.hfxo_running  = true;
+        clock_hfclk_started();
+    }
+}
+
+
+static bool clock_irq_line(void)
+{
+    NRF_CLOCK_Type * p_clock = M_CLOCK;
+    uint32_t         inten   = REG(p_clock, INTENSET);
+
+    return ( ((inten & (1UL << 0)) && REG(p_clock, EVENTS_HFCLKSTARTED))
+          || ((inten & (1UL << 1)) && REG(p_clock, EVENTS_LFCLKSTARTED)) );
+}
+
+
+static void clock_reset(void)
+{
+    memset(&m_clock, 0, sizeof(m_clock));
+}
+
+
+bool sim_hfclk_running(void)
+{
+    return ( m_clock.hfxo_running );
+}
+
+
+/*******************************************************************************************
+ * RADIO
+ *******************************************************************************************/
+
+#define M_RADIO     ((NRF_RADIO_Type *)alias(NRF_RADIO_BASE))
+
+typedef enum
+{
+    RADIO_DISABLED  = 0,
+    RADIO_TXRU      = 9,
+    RADIO_TXIDLE    = 10,
+    RADIO_TX        = 11,
+    RADIO_TXDISABLE = 12,
+} radio_state_t;
+
+static struct
+{
+    radio_state_t state;
+    uint64_t      event_at;       /* Time of the next state transition. */
+    uint32_t      frequency;
+    bool          address_sent;
+    sim_packet_t  packet;
+} m_radio;
+
+static sim_packet_t m_packets[SIM_PACKET_LOG_SIZE];
+static uint32_t     m_packet_count;
+
+
+static void radio_event(volatile uint32_t * p_event)
+{
+    *(uint32_t *)alias((uint32_t)(uintptr_t)p_event) = 1;
+    ppi_event(p_event);
+}
+
+
+static void radio_task_disable(void)
+{
+    if ( (m_radio.state == RADIO_TXRU) || (m_radio.state == RADIO_TXIDLE) || (m_radio.state == RADIO_TX) )
+    {
+        m_radio.state    = RADIO_TXDISABLE;
+        m_radio.event_at = m_now + M_RADIO_DISABLE_NS;
+        m_activity       = (m_activity & ~A_TX) | A_RAMP;
+    }
+}
+
+
+static void radio_task_start(void)
+{
+    NRF_RADIO_Type * p_radio = M_RADIO;
+    const uint8_t  * p_pdu   = (const uint8_t *)(uintptr_t)REG(p_radio, PACKETPTR);
+    uint32_t         length;
+
+    if ( m_radio.state != RADIO_TXIDLE )
+    {
+        return;
+    }
+    if ( p_pdu == NULL )
+    {
+        fatal("radio started without PACKETPTR", 0);
+    }
+    length = p_pdu[1] & 0x3F;
+    if ( length > 37 )
+    {
+        fatal("advertising payload too long", length);
+    }
+
+    memset(&m_radio.packet, 0, sizeof(m_radio.packet));
+    memcpy(m_radio.packet.pdu, p_pdu, 3 + length);
+    m_radio.packet.start_ns    = m_now;
+    m_radio.packet.frequency   = m_radio.frequency;
+    m_radio.packet.datawhiteiv = REG(p_radio, DATAWHITEIV) & 0x7F;
+
+    /* Preamble, access address, header, payload and CRC at 1 Mbit/s. */
+    m_radio.state        = RADIO_TX;
+    m_radio.address_sent = false;
+    m_radio.event_at     = m_now + 8000ULL * (1 + 4);
+    m_radio.packet.end_ns = m_now + 8000ULL * (1 + 4 + 2 + length + 3);
+    m_activity = (m_activity & ~A_RAMP) | A_TX;
+}
+
+
+static void radio_write(uint32_t offset, uint32_t value)
+{
+    NRF_RADIO_Type * p_radio = M_RADIO;
+
+    switch ( offset )
+    {
+        case offsetof(NRF_RADIO_Type, TASKS_TXEN):
+            if ( value && (m_radio.state == RADIO_DISABLED) )
+            {
+                if ( REG(p_radio, POWER) == 0 )
+                {
+                    fatal("radio enabled while powered off", 0);
+                }
+                m_radio.state     = RADIO_TXRU;
+                m_radio.frequency = REG(p_radio, FREQUENCY);
+                m_radio.event_at  = m_now + M_RADIO_RAMPUP_NS;
+                m_activity       |= A_RAMP;
+                if ( !m_clock.hfxo_running )
+                {
+                    ++m_stats.radio_without_hfxo;
+                }
+            }
+            REG(p_radio, TASKS_TXEN) = 0;
+            break;
+        case offsetof(NRF_RADIO_Type, TASKS_RXEN):
+            if ( value )
+            {
+                fatal("radio receive is not simulated", 0);
+            }
+            break;
+        case offsetof(NRF_RADIO_Type, TASKS_START):
+            if ( value )
+            {
+                radio_task_start();
+            }
+            REG(p_radio, TASKS_START) = 0;
+            break;
+        case offsetof(NRF_RADIO_Type, TASKS_DISABLE):
+            if ( value )
+            {
+                radio_task_disable();
+            }
+            REG(p_radio, TASKS_DISABLE) = 0;
+            break;
+        case offsetof(NRF_RADIO_Type, INTENSET):
+            REG(p_radio, INTENCLR) |= value;
+            REG(p_radio, INTENSET)  = REG(p_radio, INTENCLR);
+            break;
+        case offsetof(NRF_RADIO_Type, INTENCLR):
+            REG(p_radio, INTENSET) &= ~value;
+            REG(p_radio, INTENCLR)  = REG(p_radio, INTENSET);
+            break;
+        case offsetof(NRF_RADIO_Type, POWER):
+            if ( (value & 1) == 0 )
+            {
+                uint32_t power = REG(p_radio, POWER);
+                memset(p_radio, 0, offsetof(NRF_RADIO_Type, POWER));
+                REG(p_radio, POWER) = power;
+                memset(&m_radio, 0, sizeof(m_radio));
+                m_activity &= ~(A_RAMP | A_TX);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+
+static uint32_t radio_read(uint32_t offset)
+{
+    if ( offset == offsetof(NRF_RADIO_Type, STATE) )
+    {
+        return ( m_radio.state );
+    }
+    return ( *(uint32_t *)alias(NRF_RADIO_BASE + offset) );
+}
+
+
+static uint64_t radio_next(void)
+{
+    return ( (m_radio.state == RADIO_DISABLED) || (m_radio.state == RADIO_TXIDLE) ? M_TIME_NONE : m_radio.event_at );
+}
+
+
+static void radio_fire(void)
+{
+    NRF_RADIO_Type * p_radio = M_RADIO;
+    uint32_t         shorts  = REG(p_radio, SHORTS);
+
+    if ( (radio_next() == M_TIME_NONE) || (m_now < m_radio.event_at) )
+    {
+        return;
+    }
+
+    switch ( m_radio.state )
+    {
+        case RADIO_TXRU:
+            m_radio.state = RADIO_TXIDLE;
+            m_activity   &= ~A_RAMP;
+            radio_event(&NRF_RADIO->EVENTS_READY);
+            if ( shorts & (1UL << 0) )
+            {
+                radio_task_start();
+            }
+            break;
+        case RADIO_TX:
+            if ( !m_radio.address_sent )
+            {
+                m_radio.address_sent = true;
+                m_radio.event_at     = m_radio.packet.end_ns;
+                radio_event(&NRF_RADIO->EVENTS_ADDRESS);
+                break;
+            }
+            m_radio.packet.end_ns = m_now;
+            m_packets[m_packet_count % SIM_PACKET_LOG_SIZE] = m_radio.packet;
+            ++m_packet_count;
+            m_radio.state = RADIO_TXIDLE;
+            m_activity   &= ~A_TX;
+            radio_event(&NRF_RADIO->EVENTS_PAYLOAD);
+            radio_event(&NRF_RADIO->EVENTS_END);
+            if ( shorts & (1UL << 1) )
+            {
+                radio_task_disable();
+            }
+            break;
+        case RADIO_TXDISABLE:
+            m_radio.state = RADIO_DISABLED;
+            m_activity   &= ~A_RAMP;
+            radio_event(&NRF_RADIO->EVENTS_DISABLED);
+            if ( (shorts & (1UL << 2)) && (m_radio.state == RADIO_DISABLED) )
+            {
+                radio_write(offsetof(NRF_RADIO_Type, TASKS_TXEN), 1);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+
+static bool radio_irq_line(void)
+{
+    NRF_RADIO_Type * p_radio = M_RADIO;
+    uint32_t         inten   = REG(p_radio, INTENSET);
+
+    return ( ((inten & (1UL << 0)) && REG(p_radio, EVENTS_READY))
+          || ((inten & (1UL << 1)) && REG(p_radio, EVENTS_ADDRESS))
+          || ((inten & (1UL << 2)) && REG(p_radio, EVENTS_PAYLOAD))
+          || ((inten & (1UL << 3)) && REG(p_radio, EVENTS_END))
+          || ((inten & (1UL << 4)) && REG(p_radio, EVENTS_DISABLED)) );
+}
+
+
+static void radio_reset(void)
+{
+    memset(&m_radio, 0, sizeof(m_radio));
+    REG(M_RADIO, POWER) = 1;
+    m_packet_count = 0;
+}
+
+
+const sim_packet_t * sim_packets_get(uint32_t * p_count)
+{
+    *p_count = m_packet_count;
+    return ( m_packets );
+}
+
+
+/*******************************************************************************************
+ * TIMER0..2
+ *******************************************************************************************/
+
+static struct
+{
+    bool     running;
+    uint64_t base;              /* Unwrapped count when started, or while stopped. */
+    uint64_t started_at;
+    uint64_t fired[6];          /* Unwrapped count at the last compare event, plus one. */
+} m_timer[3];
+
+
+static uint32_t timer_index(uint32_t base)
+{
+    return ( (base - NRF_TIMER0_BASE) / M_PAGE_SIZE );
+}
+
+
+static NRF_TIMER_Type * timer_regs(uint32_t index)
+{
+    return ( (NRF_TIMER_Type *)alias(NRF_TIMER0_BASE + index * M_PAGE_SIZE) );
+}
+
+
+static uint32_t timer_mask(uint32_t index)
+{
+    static const uint32_t masks[4] = { 0xFFFF, 0xFF, 0xFFFFFF, 0xFFFFFFFF };
+    return ( masks[REG(timer_regs(index), BITMODE) & 3] );
+}
+
+
+static uint64_t timer_tick_ns_x16(uint32_t index)
+{
+    /* Tick period in 1/16 ns: 1 us / 16 MHz shifted by the prescaler. */
+    return ( 1000ULL << (REG(timer_regs(index), PRESCALER) & 0xF) );
+}
+
+
+static uint64_t timer_count(uint32_t index)
+{
+    if ( !m_timer[index].running )
+    {
+        return ( m_timer[index].base );
+    }
+    return ( m_timer[index].base + ((m_now - m_timer[index].started_at) * 16) / timer_tick_ns_x16(index) );
+}
+
+
+static void timer_task(uint32_t index, uint32_t offset)
+{
+    NRF_TIMER_Type * p_timer = timer_regs(index);
+
+    switch ( offset )
+    {
+        case offsetof(NRF_TIMER_Type, TASKS_START):
+            if ( !m_timer[index].running )
+            {
+                m_timer[index].running    = true;
+                m_timer[index].started_at = m_now;
+                for ( uint32_t i = 0; i < 6; ++i )
+                {
+                    m_timer[index].fired[i] = m_timer[index].base + 1;
+                }
+            }
+            break;
+        case offsetof(NRF_TIMER_Type, TASKS_STOP):
+        case offsetof(NRF_TIMER_Type, TASKS_SHUTDOWN):
+            m_timer[index].base    = timer_count(index);
+            m_timer[index].running = false;
+            break;
+        case offsetof(NRF_TIMER_Type, TASKS_CLEAR):
+            /* A compare event is only generated when the counter increments to CC. */
+            m_timer[index].base       = 0;
+            m_timer[index].started_at = m_now;
+            for ( uint32_t i = 0; i < 6; ++i )
+            {
+                m_timer[index].fired[i] = 1;
+            }
+            break;
+        default:
+            if ( (offset >= offsetof(NRF_TIMER_Type, TASKS_CAPTURE[0]))
+            &&   (offset <= offsetof(NRF_TIMER_Type, TASKS_CAPTURE[5])) )
+            {
+                REG(p_timer, CC[(offset - offsetof(NRF_TIMER_Type, TASKS_CAPTURE[0])) / 4]) =
+                    (uint32_t)(timer_count(index) & timer_mask(index));
+            }
+            break;
+    }
+}
+
+
+static void timer_write(uint32_t base, uint32_t offset, uint32_t value)
+{
+    uint32_t         index   = timer_index(base);
+    NRF_TIMER_Type * p_timer = timer_regs(index);
+
+    if ( offset < 0x100 )
+    {
+        if ( value )
+        {
+            timer_task(index, offset);
+        }
+        *(uint32_t *)alias(base + offset) = 0;
+    }
+    else if ( offset == offsetof(NRF_TIMER_Type, INTENSET) )
+    {
+        REG(p_timer, INTENCLR) |= value;
+        REG(p_timer, INTENSET)  = REG(p_timer, INTENCLR);
+    }
+    else if ( offset == offsetof(NRF_TIMER_Type, INTENCLR) )
+    {
+        REG(p_timer, INTENSET) &= ~value;
+        REG(p_timer, INTENCLR)  = REG(p_timer, INTENSET);
+    }
+}
+
+
+static uint64_t timer_next_of(uint32_t index)
+{
+    NRF_TIMER_Type * p_timer = timer_regs(index);
+    uint64_t         next    = M_TIME_NONE;
+    uint64_t         count   = timer_count(index);
+    uint32_t         mask    = timer_mask(index);
+
+    if ( !m_timer[index].running )
+    {
+        return ( M_TIME_NONE );
+    }
+    for ( uint32_t i = 0; i < 6; ++i )
+    {
+        uint64_t delta  = (REG(p_timer, CC[i]) - count) & mask;
+        uint64_t target;
+        uint64_t at;
+
+        if ( delta == 0 )
+        {
+            delta = (uint64_t)mask + 1;
+        }
+        target = count + delta;
+        at     = m_timer[index].started_at
+               + ((target - m_timer[index].base) * timer_tick_ns_x16(index) + 15) / 16;
+        if ( at < next )
+        {
+            next = at;
+        }
+    }
+    return ( next );
+}
+
+
+static void timer_fire_of(uint32_t index, uint32_t base)
+{
+    NRF_TIMER_Type * p_timer = timer_regs(index);
+    uint64_t         count   = timer_count(index);
+    uint32_t         shorts  = REG(p_timer, SHORTS);
+
+    if ( !m_timer[index].running )
+    {
+        return;
+    }
+    for ( uint32_t i = 0; i < 6; ++i )
+    {
+        if ( ((count & timer_mask(index)) == REG(p_timer, CC[i])) && (m_timer[index].fired[i] != count + 1) )
+        {
+            m_timer[index].fired[i] = count + 1;
+            REG(p_timer, EVENTS_COMPARE[i]) = 1;
+            ppi_event(&((NRF_TIMER_Type *)(uintptr_t)base)->EVENTS_COMPARE[i]);
+            if ( shorts & (1UL << i) )
+            {
+                timer_task(index, offsetof(NRF_TIMER_Type, TASKS_CLEAR));
+            }
+            if ( shorts & (1UL << (8 + i)) )
+            {
+                timer_task(index, offsetof(NRF_TIMER_Type, TASKS_STOP));
+            }
+        }
+    }
+}
+
+
+static bool timer_irq_line_of(uint32_t index)
+{
+    NRF_TIMER_Type * p_timer = timer_regs(index);
+    uint32_t         inten   = REG(p_timer, INTENSET);
+
+    for ( uint32_t i = 0; i < 6; ++i )
+    {
+        if ( (inten & (1UL << (16 + i))) && REG(p_timer, EVENTS_COMPARE[i]) )
+        {
+            return ( true );
+        }
+    }
+    return ( false );
+}
+
+
+static void timer0_write(uint32_t offset, uint32_t value) { timer_write(NRF_TIMER0_BASE, offset, value); }
+static void timer1_write(uint32_t offset, uint32_t value) { timer_write(NRF_TIMER1_BASE, offset, value); }
+static void timer2_write(uint32_t offset, uint32_t value) { timer_write(NRF_TIMER2_BASE, offset, value); }
+static uint64_t timer0_next(void) { return ( timer_next_of(0) ); }
+static uint64_t timer1_next(void) { return ( timer_next_of(1) ); }
+static uint64_t timer2_next(void) { return ( timer_next_of(2) ); }
+static void timer0_fire(void) { timer_fire_of(0, NRF_TIMER0_BASE); }
+static void timer1_fire(void) { timer_fire_of(1, NRF_TIMER1_BASE); }
+static void timer2_fire(void) { timer_fire_of(2, NRF_TIMER2_BASE); }
+static bool timer0_irq_line(void) { return ( timer_irq_line_of(0) ); }
+static bool timer1_irq_line(void) { return ( timer_irq_line_of(1) ); }
+static bool timer2_irq_line(void) { return ( timer_irq_line_of(2) ); }
+
+
+static void timer_reset(void)
+{
+    memset(m_timer, 0, sizeof(m_timer));
+}
+
+
+/*******************************************************************************************
+ * PPI
+ *******************************************************************************************/
+
+#define M_PPI       ((NRF_PPI_Type *)alias(NRF_PPI_BASE))
+#define M_PPI_DEPTH (8)
+
+static uint32_t m_ppi_depth;
+
+
+static void ppi_task(uint32_t address)
+{
+    const model_t * p_model = model_get(address);
+
+    if ( address == 0 )
+    {
+        return;
+    }
+    if ( (p_model == NULL) || (p_model->write == NULL) )
+    {
+        fatal("PPI task in an unsimulated peripheral", address);
+    }
+    *(uint32_t *)alias(address) = 1;
+    p_model->write(address - p_model->base, 1);
+}
+
+
+static void ppi_event(volatile uint32_t * p_event)
+{
+    NRF_PPI_Type * p_ppi   = M_PPI;
+    uint32_t       address = (uint32_t)(uintptr_t)p_event;
+    uint32_t       chen    = REG(p_ppi, CHEN);
+
+    if ( ++m_ppi_depth > M_PPI_DEPTH )
+    {
+        fatal("PPI loop", address);
+    }
+    for ( uint32_t i = 0; i < 20; ++i )
+    {
+        if ( (chen & (1UL << i)) && (REG(p_ppi, CH[i].EEP) == address) )
+        {
+            ppi_task(REG(p_ppi, CH[i].TEP));
+            ppi_task(REG(p_ppi, FORK[i].TEP));
+        }
+    }
+    --m_ppi_depth;
+}
+
+
+static void ppi_write(uint32_t offset, uint32_t value)
+{
+    NRF_PPI_Type * p_ppi = M_PPI;
+
+    if ( offset < sizeof(p_ppi->TASKS_CHG) )
+    {
+        uint32_t group = offset / sizeof(PPI_TASKS_CHG_Type);
+
+        if ( value )
+        {
+            if ( (offset % sizeof(PPI_TASKS_CHG_Type)) == 0 )
+            {
+                REG(p_ppi, CHEN) |= REG(p_ppi, CHG[group]);
+            }
+            else
+            {
+                REG(p_ppi, CHEN) &= ~REG(p_ppi, CHG[group]);
+            }
+        }
+        *(uint32_t *)alias(NRF_PPI_BASE + offset) = 0;
+    }
+    else if ( offset == offsetof(NRF_PPI_Type, CHENSET) )
+    {
+        REG(p_ppi, CHEN) |= value;
+    }
+    else if ( offset == offsetof(NRF_PPI_Type, CHENCLR) )
+    {
+        REG(p_ppi, CHEN) &= ~value;
+    }
+    REG(p_ppi, CHENSET) = REG(p_ppi, CHENCLR) = REG(p_ppi, CHEN);
+}
+
+
+/*******************************************************************************************
+ * TEMP and RNG
+ *******************************************************************************************/
+
+#define M_TEMP      ((NRF_TEMP_Type *)alias(NRF_TEMP_BASE))
+#define M_RNG       ((NRF_RNG_Type *)alias(NRF_RNG_BASE))
+
+static int32_t  m_temperature = 25 * 4;
+static uint64_t m_temp_ready_at = M_TIME_NONE;
+static uint64_t m_rng_ready_at  = M_TIME_NONE;
+static uint32_t m_rng_state     = 0x2545F491;
+
+
+static void temp_write(uint32_t offset, uint32_t value)
+{
+    NRF_TEMP_Type * p_temp = M_TEMP;
+
+    switch ( offset )
+    {
+        case offsetof(NRF_TEMP_Type, TASKS_START):
+            if ( value && (m_temp_ready_at == M_TIME_NONE) )
+            {
+                m_temp_ready_at = m_now + M_TEMP_NS;
+                m_activity     |= A_TEMP;
+            }
+            REG(p_temp, TASKS_START) = 0;
+            break;
+        case offsetof(NRF_TEMP_Type, TASKS_STOP):
+            if ( value )
+            {
+                m_temp_ready_at = M_TIME_NONE;
+                m_activity     &= ~A_TEMP;
+            }
+            REG(p_temp, TASKS_STOP) = 0;
+            break;
+        case offsetof(NRF_TEMP_Type, INTENSET):
+            REG(p_temp, INTENCLR) |= value;
+            REG(p_temp, INTENSET)  = REG(p_temp, INTENCLR);
+            break;
+        case offsetof(NRF_TEMP_Type, INTENCLR):
+            REG(p_temp, INTENSET) &= ~value;
+            REG(p_temp, INTENCLR)  = REG(p_temp, INTENSET);
+            break;
+        default:
+            break;
+    }
+}
+
+
+static uint64_t temp_next(void)
+{
+    return ( m_temp_ready_at );
+}
+
+
+static void temp_fire(void)
+{
+    if ( m_now >= m_temp_ready_at )
+    {
+        m_temp_ready_at = M_TIME_NONE;
+        m_activity     &= ~A_TEMP;
+        REG(M_TEMP, TEMP) = (uint32_t)m_temperature;
+        REG(M_TEMP, EVENTS_DATARDY) = 1;
+        ppi_event(&NRF_TEMP->EVENTS_DATARDY);
+    }
+}
+
+
+static bool temp_irq_line(void)
+{
+    return ( (REG(M_TEMP, INTENSET) & 1) && REG(M_TEMP, EVENTS_DATARDY) );
+}
+
+
+void sim_temp_set(int32_t quarter_degrees)
+{
+    m_temperature = quarter_degrees;
+}
+
+
+static void rng_write(uint32_t offset, uint32_t value)
+{
+    NRF_RNG_Type * p_rng = M_RNG;
+
+    switch ( offset )
+    {
+        case offsetof(NRF_RNG_Type, TASKS_START):
+            if ( value && (m_rng_ready_at == M_TIME_NONE) )
+            {
+                m_rng_ready_at = m_now + M_RNG_NS;
+            }
+            REG(p_rng, TASKS_START) = 0;
+            break;
+        case offsetof(NRF_RNG_Type, TASKS_STOP):
+            if ( value )
+            {
+                m_rng_ready_at = M_TIME_NONE;
+            }
+            REG(p_rng, TASKS_STOP) = 0;
+            break;
+        case offsetof(NRF_RNG_Type, INTENSET):
+            REG(p_rng, INTENCLR) |= value;
+            REG(p_rng, INTENSET)  = REG(p_rng, INTENCLR);
+            break;
+        case offsetof(NRF_RNG_Type, INTENCLR):
+            REG(p_rng, INTENSET) &= ~value;
+            REG(p_rng, INTENCLR)  = REG(p_rng, INTENSET);
+            break;
+        default:
+            break;
+    }
+}
+
+
+static uint64_t rng_next(void)
+{
+    return ( m_rng_ready_at );
+}
+
+
+static void rng_fire(void)
+{
+    if ( m_now >= m_rng_ready_at )
+    {
+        m_rng_state ^= m_rng_state << 13;
+        m_rng_state ^= m_rng_state >> 17;
+        m_rng_state ^= m_rng_state << 5;
+        REG(M_RNG, VALUE) = m_rng_state & 0xFF;
+        REG(M_RNG, EVENTS_VALRDY) = 1;
+        m_rng_ready_at = (REG(M_RNG, SHORTS) & 1) ? M_TIME_NONE : m_now + M_RNG_NS;
+        ppi_event(&NRF_RNG->EVENTS_VALRDY);
+    }
+}
+
+
+static bool rng_irq_line(void)
+{
+    return ( (REG(M_RNG, INTENSET) & 1) && REG(M_RNG, EVENTS_VALRDY) );
+}
+
+
+/*******************************************************************************************
+ * NVMC and flash
+ *******************************************************************************************/
+
+#define M_NVMC      ((NRF_NVMC_Type *)alias(NRF_NVMC_BASE))
+
+static uint32_t m_flash_operations;
+static uint32_t m_flash_power_fail_at;
+
+
+/* Counts a flash operation, and tells if the power fails during it. */
+static bool flash_operation_fails(void)
+{
+    ++m_flash_operations;
+    return ( (m_flash_power_fail_at != 0) && (m_flash_operations == m_flash_power_fail_at) );
+}
+
+
+static void flash_busy(uint64_t duration_ns)
+{
+    /* The CPU is halted while the flash is busy, but the peripherals keep running. */
+    m_halted    = true;
+    m_activity |= A_FLASH;
+    time_advance(m_now + duration_ns);
+    m_activity &= ~A_FLASH;
+    m_halted    = false;
+}
+
+
+static void flash_word_write(uint32_t address, uint32_t old_value, uint32_t value)
+{
+    uint32_t * p_word = (uint32_t *)alias(address);
+
+    if ( (REG(M_NVMC, CONFIG) & 3) != NVMC_CONFIG_WEN_Wen )
+    {
+        ++m_stats.flash_violations;
+        *p_word = old_value;
+        return;
+    }
+    ++m_stats.flash_writes;
+    if ( flash_operation_fails() )
+    {
+        /* Only some of the bits to be programmed have been programmed. */
+        *p_word = old_value & (value | (rand() & rand()));
+        flash_busy(M_FLASH_WRITE_NS / 2);
+        sim_exit(SIM_EXIT_POWER_FAIL);
+    }
+    *p_word = old_value & value;
+    flash_busy(M_FLASH_WRITE_NS);
+}
+
+
+static void nvmc_write(uint32_t offset, uint32_t value)
+{
+    NRF_NVMC_Type * p_nvmc = M_NVMC;
+
+    if ( offset == offsetof(NRF_NVMC_Type, ERASEPAGE) )
+    {
+        uint32_t * p_page = (uint32_t *)alias(value);
+
+        if ( ((REG(p_nvmc, CONFIG) & 3) != NVMC_CONFIG_WEN_Een)
+        ||   !address_is_flash(value) || ((value % SIM_FLASH_PAGE_SIZE) != 0) )
+        {
+            ++m_stats.flash_violations;
+            return;
+        }
+        ++m_stats.flash_erases;
+        if ( flash_operation_fails() )
+        {
+            /* Some of the words have been erased, one of them partially. */
+            uint32_t erased = (uint32_t)rand() % (SIM_FLASH_PAGE_SIZE / 4);
+
+            for ( uint32_t i = 0; i < SIM_FLASH_PAGE_SIZE / 4; ++i )
+            {
+                if ( (rand() & 1) != 0 )
+                {
+                    p_page[i] = 0xFFFFFFFF;
+                }
+            }
+            p_page[erased] |= (uint32_t)rand();
+            flash_busy(M_FLASH_ERASE_NS / 2);
+            sim_exit(SIM_EXIT_POWER_FAIL);
+        }
+        memset(p_page, 0xFF, SIM_FLASH_PAGE_SIZE);
+        flash_busy(M_FLASH_ERASE_NS);
+    }
+}
+
+
+static uint32_t nvmc_read(uint32_t offset)
+{
+    if ( offset == offsetof(NRF_NVMC_Type, READY) )
+    {
+        return ( NVMC_READY_READY_Ready );
+    }
+    return ( *(uint32_t *)alias(NRF_NVMC_BASE + offset) );
+}
+
+
+void sim_flash_power_fail_set(uint32_t operation)
+{
+    m_flash_operations    = 0;
+    m_flash_power_fail_at = operation;
+}
+
+
+uint32_t * sim_flash_word(uint32_t address)
+{
+    if ( !address_is_flash(address) )
+    {
+        fatal("address outside the simulated flash", address);
+    }
+    return ( (uint32_t *)alias(address) );
+}
+
+
+/*******************************************************************************************
+ * GPIO and GPIOTE
+ *******************************************************************************************/
+
+#define M_GPIO      ((NRF_GPIO_Type *)alias(NRF_P0_BASE))
+#define M_GPIOTE    ((NRF_GPIOTE_Type *)alias(NRF_GPIOTE_BASE))
+
+static struct
+{
+    uint32_t                  driven;         /* Pins driven by external devices. */
+    uint32_t                  driven_level;
+    uint32_t                  level;          /* Last computed pin levels. */
+    bool                      detect;
+    sim_gpio_output_handler_t output_handler;
+} m_gpio;
+
+
+static uint32_t gpio_levels(void)
+{
+    NRF_GPIO_Type * p_gpio = M_GPIO;
+    uint32_t        levels = 0;
+
+    for ( uint32_t pin = 0; pin < 32; ++pin )
+    {
+        uint32_t cnf = REG(p_gpio, PIN_CNF[pin]);
+        bool     level;
+
+        if ( cnf & 1 )
+        {
+            level = (REG(p_gpio, OUT) >> pin) & 1;
+        }
+        else if ( m_gpio.driven & (1UL << pin) )
+        {
+            level = (m_gpio.driven_level >> pin) & 1;
+        }
+        else
+        {
+            level = (((cnf >> 2) & 3) == GPIO_PIN_CNF_PULL_Pullup);
+        }
+        levels |= (uint32_t)level << pin;
+    }
+    return ( levels );
+}
+
+
+static void gpio_update(void)
+{
+    NRF_GPIO_Type * p_gpio   = M_GPIO;
+    uint32_t        levels   = gpio_levels();
+    uint32_t        changed  = levels ^ m_gpio.level;
+    bool            detect   = false;
+
+    m_gpio.level = levels;
+
+    for ( uint32_t pin = 0; pin < 32; ++pin )
+    {
+        uint32_t cnf   = REG(p_gpio, PIN_CNF[pin]);
+        uint32_t sense = (cnf >> 16) & 3;
+        bool     level = (levels >> pin) & 1;
+
+        if ( ((cnf & 2) == 0)
+        &&   (((sense == GPIO_PIN_CNF_SENSE_High) && level) || ((sense == GPIO_PIN_CNF_SENSE_Low) && !level)) )
+        {
+            detect = true;
+        }
+        /* A pin driven high and then released to a floating input changes its level as well. */
+        if ( (changed & (1UL << pin)) && ((cnf & 1) || ((m_gpio.driven & (1UL << pin)) == 0))
+        &&   (m_gpio.output_handler != NULL) )
+        {
+            m_gpio.output_handler(pin, level);
+        }
+    }
+    for ( uint32_t i = 0; i < 8; ++i )
+    {
+        uint32_t config = REG(M_GPIOTE, CONFIG[i]);
+        uint32_t pin    = (config >> 8) & 0x1F;
+        uint32_t edge   = (config >> 16) & 3;
+        bool     level  = (levels >> pin) & 1;
+
+        if ( ((config & 3) == GPIOTE_CONFIG_MODE_Event) && (changed & (1UL << pin))
+        &&   ((edge == GPIOTE_CONFIG_POLARITY_Toggle)
+          ||  ((edge == GPIOTE_CONFIG_POLARITY_LoToHi) && level)
+          ||  ((edge == GPIOTE_CONFIG_POLARITY_HiToLo) && !level)) )
+        {
+            REG(M_GPIOTE, EVENTS_IN[i]) = 1;
+            ppi_event(&NRF_GPIOTE->EVENTS_IN[i]);
+        }
+    }
+    if ( detect && !m_gpio.detect )
+    {
+        REG(M_GPIOTE, EVENTS_PORT) = 1;
+        ppi_event(&NRF_GPIOTE->EVENTS_PORT);
+    }
+    m_gpio.detect = detect;
+}
+
+
+static uint32_t gpio_read(uint32_t offset)
+{
+    if ( offset == offsetof(NRF_GPIO_Type, IN) )
+    {
+        uint32_t levels = gpio_levels();
+        uint32_t input  = 0;
+
+        for ( uint32_t pin = 0; pin < 32; ++pin )
+        {
+            if ( (REG(M_GPIO, PIN_CNF[pin]) & 2) == 0 )
+            {
+                input |= levels & (1UL << pin);
+            }
+        }
+        return ( input );
+    }
+    return ( *(uint32_t *)alias(NRF_P0_BASE + offset) );
+}
+
+
+static void gpio_write(uint32_t offset, uint32_t value)
+{
+    NRF_GPIO_Type * p_gpio = M_GPIO;
+    uint32_t        dir    = 0;
+
+    switch ( offset )
+    {
+        case offsetof(NRF_GPIO_Type, OUTSET):
+            REG(p_gpio, OUT) |= value;
+            break;
+        case offsetof(NRF_GPIO_Type, OUTCLR):
+            REG(p_gpio, OUT) &= ~value;
+            break;
+        case offsetof(NRF_GPIO_Type, DIR):
+        case offsetof(NRF_GPIO_Type, DIRSET):
+        case offsetof(NRF_GPIO_Type, DIRCLR):
+            for ( uint32_t pin = 0; pin < 32; ++pin )
+            {
+                dir |= (REG(p_gpio, PIN_CNF[pin]) & 1) << pin;
+            }
+            dir = (offset == offsetof(NRF_GPIO_Type, DIRSET)) ? (dir | value)
+                : (offset == offsetof(NRF_GPIO_Type, DIRCLR)) ? (dir & ~value) : value;
+            for ( uint32_t pin = 0; pin < 32; ++pin )
+            {
+                REG(p_gpio, PIN_CNF[pin]) = (REG(p_gpio, PIN_CNF[pin]) & ~1UL) | ((dir >> pin) & 1);
+            }
+            break;
+        default:
+            break;
+    }
+
+    dir = 0;
+    for ( uint32_t pin = 0; pin < 32; ++pin )
+    {
+        dir |= (REG(p_gpio, PIN_CNF[pin]) & 1) << pin;
+    }
+    REG(p_gpio, OUTSET) = REG(p_gpio, OUTCLR) = REG(p_gpio, OUT);
+    REG(p_gpio, DIR) = REG(p_gpio, DIRSET) = REG(p_gpio, DIRCLR) = dir;
+    gpio_update();
+}
+
+
+static void gpiote_write(uint32_t offset, uint32_t value)
+{
+    NRF_GPIOTE_Type * p_gpiote = M_GPIOTE;
+
+    if ( offset < offsetof(NRF_GPIOTE_Type, EVENTS_IN[0]) )
+    {
+        /* Task mode outputs are only used for debug signals, which are not simulated. */
+        *(uint32_t *)alias(NRF_GPIOTE_BASE + offset) = 0;
+    }
+    else if ( offset == offsetof(NRF_GPIOTE_Type, INTENSET) )
+    {
+        REG(p_gpiote, INTENCLR) |= value;
+        REG(p_gpiote, INTENSET)  = REG(p_gpiote, INTENCLR);
+    }
+    else if ( offset == offsetof(NRF_GPIOTE_Type, INTENCLR) )
+    {
+        REG(p_gpiote, INTENSET) &= ~value;
+        REG(p_gpiote, INTENCLR)  = REG(p_gpiote, INTENSET);
+    }
+    else if ( offset == offsetof(NRF_GPIOTE_Type, EVENTS_PORT) )
+    {
+        /* Clearing PORT while DETECT is still high does not generate a new event. */
+    }
+}
+
+
+static bool gpiote_irq_line(void)
+{
+    NRF_GPIOTE_Type * p_gpiote = M_GPIOTE;
+    uint32_t          inten    = REG(p_gpiote, INTENSET);
+
+    if ( (inten & (1UL << 31)) && REG(p_gpiote, EVENTS_PORT) )
+    {
+        return ( true );
+    }
+    for ( uint32_t i = 0; i < 8; ++i )
+    {
+        if ( (inten & (1UL << i)) && REG(p_gpiote, EVENTS_IN[i]) )
+        {
+            return ( true );
+        }
+    }
+    return ( false );
+}
+
+
+static void gpio_reset(void)
+{
+    sim_gpio_output_handler_t handler = m_gpio.output_handler;
+
+    memset(&m_gpio, 0, sizeof(m_gpio));
+    m_gpio.output_handler = handler;
+    for ( uint32_t pin = 0; pin < 32; ++pin )
+    {
+        REG(M_GPIO, PIN_CNF[pin]) = (GPIO_PIN_CNF_INPUT_Disconnect << GPIO_PIN_CNF_INPUT_Pos);
+    }
+}
+
+
+void sim_gpio_input_set(uint32_t pin, bool level)
+{
+    m_gpio.driven |= (1UL << pin);
+    m_gpio.driven_level = (m_gpio.driven_level & ~(1UL << pin)) | ((uint32_t)level << pin);
+    gpio_update();
+}
+
+
+bool sim_gpio_level_get(uint32_t pin)
+{
+    return ( (gpio_levels() >> pin) & 1 );
+}
+
+
+void sim_gpio_output_handler_set(sim_gpio_output_handler_t handler)
+{
+    m_gpio.output_handler = handler;
+}
+
+
+/*******************************************************************************************
+ * TWIM0 and TWIM1
+ *******************************************************************************************/
+
+#define M_TWI_DEVICES_MAX   (4)
+
+static const sim_twi_device_t * m_twi_devices[M_TWI_DEVICES_MAX];
+
+typedef enum
+{
+    TWIM_IDLE,
+    TWIM_TX,
+    TWIM_RX,
+    TWIM_SUSPENDED,
+    TWIM_STOPPING,
+} twim_state_t;
+
+static struct
+{
+    twim_state_t state;
+    uint64_t     event_at;
+    bool         bus_held;     /* A start condition has been sent and no stop condition yet. */
+    bool         stop_pending;
+    bool         suspend_pending;
+    bool         nack;
+} m_twim[2];
+
+
+static uint32_t twim_index(uint32_t base)
+{
+    return ( (base - NRF_TWI0_BASE) / M_PAGE_SIZE );
+}
+
+
+static NRF_TWIM_Type * twim_regs(uint32_t index)
+{
+    return ( (NRF_TWIM_Type *)alias(NRF_TWI0_BASE + index * M_PAGE_SIZE) );
+}
+
+
+static NRF_TWIM_Type * twim_fw_regs(uint32_t index)
+{
+    return ( (NRF_TWIM_Type *)(uintptr_t)(NRF_TWI0_BASE + index * M_PAGE_SIZE) );
+}
+
+
+static uint32_t twim_bit_ns(uint32_t index)
+{
+    switch ( REG(twim_regs(index), FREQUENCY) )
+    {
+        case TWIM_FREQUENCY_FREQUENCY_K100: return ( 10000 );
+        case TWIM_FREQUENCY_FREQUENCY_K250: return ( 4000 );
+        default:                            return ( 2500 );
+    }
+}
+
+
+uint64_t sim_twi_bytes_ns(uint32_t bytes)
+{
+    return ( (uint64_t)twim_bit_ns(0) * (1 + 9 * bytes) );
+}
+
+
+static const sim_twi_device_t * twi_device_get(uint32_t address)
+{
+    for ( uint32_t i = 0; i < M_TWI_DEVICES_MAX; ++i )
+    {
+        if ( (m_twi_devices[i] != NULL) && (m_twi_devices[i]->address == address) )
+        {
+            return ( m_twi_devices[i] );
+        }
+    }
+    return ( NULL );
+}
+
+
+static void twim_event(uint32_t index, uint32_t offset)
+{
+    *(uint32_t *)((uint8_t *)twim_regs(index) + offset) = 1;
+    ppi_event((volatile uint32_t *)((uint8_t *)twim_fw_regs(index) + offset));
+}
+
+
+static void twim_transfer_start(uint32_t index, twim_state_t state)
+{
+    NRF_TWIM_Type * p_twim = twim_regs(index);
+    uint32_t        bytes  = (state == TWIM_TX) ? REG(p_twim, TXD.MAXCNT) : REG(p_twim, RXD.MAXCNT);
+
+    if ( (m_twim[index].state != TWIM_IDLE) && (m_twim[index].state != TWIM_SUSPENDED) )
+    {
+        fatal("TWIM transfer started while busy", state);
+    }
+    if ( !m_twim[index].bus_held )
+    {
+        ++m_stats.twi_transfers;
+    }
+    m_twim[index].state    = state;
+    m_twim[index].bus_held = true;
+    m_twim[index].nack     = false;
+    m_twim[index].event_at = m_now + (uint64_t)twim_bit_ns(index) * (1 + 9 * (1 + bytes));
+    m_activity |= A_TWI;
+    twim_event(index, (state == TWIM_TX) ? offsetof(NRF_TWIM_Type, EVENTS_TXSTARTED)
+                                         : offsetof(NRF_TWIM_Type, EVENTS_RXSTARTED));
+}
+
+
+static void twim_stop(uint32_t index)
+{
+    m_twim[index].state    = TWIM_STOPPING;
+    m_twim[index].event_at = m_now + twim_bit_ns(index);
+}
+
+
+static void twim_transfer_end(uint32_t index)
+{
+    NRF_TWIM_Type          * p_twim   = twim_regs(index);
+    uint32_t                 shorts   = REG(p_twim, SHORTS);
+    const sim_twi_device_t * p_device = twi_device_get(REG(p_twim, ADDRESS));
+    bool                     ack;
+
+    if ( m_twim[index].state == TWIM_TX )
+    {
+        ack = (p_device != NULL)
+           && p_device->write((const uint8_t *)(uintptr_t)REG(p_twim, TXD.PTR), REG(p_twim, TXD.MAXCNT));
+        REG(p_twim, TXD.AMOUNT) = ack ? REG(p_twim, TXD.MAXCNT) : 0;
+    }
+    else
+    {
+        ack = (p_device != NULL)
+           && p_device->read((uint8_t *)(uintptr_t)REG(p_twim, RXD.PTR), REG(p_twim, RXD.MAXCNT));
+        REG(p_twim, RXD.AMOUNT) = ack ? REG(p_twim, RXD.MAXCNT) : 0;
+    }
+
+    if ( !ack )
+    {
+        /* The master keeps the bus until the firmware stops it. */
+        REG(p_twim, ERRORSRC) |= (1UL << 1);
+        m_twim[index].state = TWIM_SUSPENDED;
+        twim_event(index, offsetof(NRF_TWIM_Type, EVENTS_ERROR));
+        if ( m_twim[index].stop_pending )
+        {
+            m_twim[index].stop_pending = false;
+            twim_stop(index);
+        }
+        return;
+    }
+
+    if ( m_twim[index].state == TWIM_TX )
+    {
+        m_twim[index].state = TWIM_SUSPENDED;
+        twim_event(index, offsetof(NRF_TWIM_Type, EVENTS_LASTTX));
+        if ( shorts & (1UL << 7) )
+        {
+            twim_transfer_start(index, TWIM_RX);
+        }
+        else if ( (shorts & (1UL << 9)) || m_twim[index].stop_pending )
+        {
+            twim_stop(index);
+        }
+        else if ( (shorts & (1UL << 8)) || m_twim[index].suspend_pending )
+        {
+            twim_event(index, offsetof(NRF_TWIM_Type, EVENTS_SUSPENDED));
+        }
+    }
+    else
+    {
+        m_twim[index].state = TWIM_SUSPENDED;
+        twim_event(index, offsetof(NRF_TWIM_Type, EVENTS_LASTRX));
+        if ( shorts & (1UL << 10) )
+        {
+            twim_transfer_start(index, TWIM_TX);
+        }
+        else if ( (shorts & (1UL << 12)) || m_twim[index].stop_pending )
+        {
+            twim_stop(index);
+        }
+        else if ( m_twim[index].suspend_pending )
+        {
+            twim_event(index, offsetof(NRF_TWIM_Type, EVENTS_SUSPENDED));
+        }
+    }
+    m_twim[index].stop_pending    = false;
+    m_twim[index].suspend_pending = false;
+}
+
+
+static void twim_write(uint32_t base, uint32_t offset, uint32_t value)
+{
+    uint32_t        index  = twim_index(base);
+    NRF_TWIM_Type * p_twim = twim_regs(index);
+    bool            busy   = (m_twim[index].state == TWIM_TX) || (m_twim[index].state == TWIM_RX);
+
+    if ( (offset < 0x100) && ((REG(p_twim, ENABLE) & 0xF) != TWIM_ENABLE_ENABLE_Enabled) )
+    {
+        if ( value )
+        {
+            fatal("task of a serial peripheral that is not enabled as TWIM", base + offset);
+        }
+        return;
+    }
+
+    switch ( offset )
+    {
+        case offsetof(NRF_TWIM_Type, TASKS_STARTTX):
+            twim_transfer_start(index, TWIM_TX);
+            break;
+        case offsetof(NRF_TWIM_Type, TASKS_STARTRX):
+            twim_transfer_start(index, TWIM_RX);
+            break;
+        case offsetof(NRF_TWIM_Type, TASKS_STOP):
+            if ( busy )
+            {
+                m_twim[index].stop_pending = true;
+            }
+            else if ( m_twim[index].bus_held )
+            {
+                twim_stop(index);
+            }
+            else
+            {
+                twim_event(index, offsetof(NRF_TWIM_Type, EVENTS_STOPPED));
+            }
+            break;
+        case offsetof(NRF_TWIM_Type, TASKS_SUSPEND):
+            if ( busy )
+            {
+                m_twim[index].suspend_pending = true;
+            }
+            else
+            {
+                twim_event(index, offsetof(NRF_TWIM_Type, EVENTS_SUSPENDED));
+            }
+            break;
+        case offsetof(NRF_TWIM_Type, TASKS_RESUME):
+            break;
+        case offsetof(NRF_TWIM_Type, INTEN):
+            REG(p_twim, INTENSET) = REG(p_twim, INTENCLR) = value;
+            break;
+        case offsetof(NRF_TWIM_Type, INTENSET):
+            REG(p_twim, INTEN) |= value;
+            REG(p_twim, INTENSET) = REG(p_twim, INTENCLR) = REG(p_twim, INTEN);
+            break;
+        case offsetof(NRF_TWIM_Type, INTENCLR):
+            REG(p_twim, INTEN) &= ~value;
+            REG(p_twim, INTENSET) = REG(p_twim, INTENCLR) = REG(p_twim, INTEN);
+            break;
+        case offsetof(NRF_TWIM_Type, ERRORSRC):
+            REG(p_twim, ERRORSRC) = 0;
+            break;
+        case offsetof(NRF_TWIM_Type, ENABLE):
+            if ( (value & 0xF) != TWIM_ENABLE_ENABLE_Enabled )
+            {
+                memset(&m_twim[index], 0, sizeof(m_twim[index]));
+                m_activity &= ~A_TWI;
+            }
+            break;
+        default:
+            break;
+    }
+    if ( offset < 0x100 )
+    {
+        *(uint32_t *)((uint8_t *)p_twim + offset) = 0;
+    }
+}
+
+
+static uint64_t twim_next_of(uint32_t index)
+{
+    twim_state_t state = m_twim[index].state;
+
+    return ( ((state == TWIM_TX) || (state == TWIM_RX) || (state == TWIM_STOPPING)) ? m_twim[index].event_at : M_TIME_NONE );
+}
+
+
+static void twim_fire_of(uint32_t index)
+{
+    if ( (twim_next_of(index) == M_TIME_NONE) || (m_now < m_twim[index].event_at) )
+    {
+        return;
+    }
+    if ( m_twim[index].state == TWIM_STOPPING )
+    {
+        m_twim[index].state    = TWIM_IDLE;
+        m_twim[index].bus_held = false;
+        if ( (m_twim[1 - index].state == TWIM_IDLE) )
+        {
+            m_activity &= ~A_TWI;
+        }
+        twim_event(index, offsetof(NRF_TWIM_Type, EVENTS_STOPPED));
+        return;
+    }
+    twim_transfer_end(index);
+}
+
+
+static bool twim_irq_line_of(uint32_t index)
+{
+    NRF_TWIM_Type * p_twim = twim_regs(index);
+    uint32_t        inten  = REG(p_twim, INTEN);
+
+    if ( (REG(p_twim, ENABLE) & 0xF) != TWIM_ENABLE_ENABLE_Enabled )
+    {
+        return ( false );
+    }
+    return ( ((inten & (1UL << 1))  && REG(p_twim, EVENTS_STOPPED))
+          || ((inten & (1UL << 9))  && REG(p_twim, EVENTS_ERROR))
+          || ((inten & (1UL << 18)) && REG(p_twim, EVENTS_SUSPENDED))
+          || ((inten & (1UL << 19)) && REG(p_twim, EVENTS_RXSTARTED))
+          || ((inten & (1UL << 20)) && REG(p_twim, EVENTS_TXSTARTED))
+          || ((inten & (1UL << 23)) && REG(p_twim, EVENTS_LASTRX))
+          || ((inten & (1UL << 24)) && REG(p_twim, EVENTS_LASTTX)) );
+}
+
+
+static void twim0_write(uint32_t offset, uint32_t value) { twim_write(NRF_TWI0_BASE, offset, value); }
+static void twim1_write(uint32_t offset, uint32_t value) { twim_write(NRF_TWI1_BASE, offset, value); }
+static uint64_t twim0_next(void) { return ( twim_next_of(0) ); }
+static uint64_t twim1_next(void) { return ( twim_next_of(1) ); }
+static void twim0_fire(void) { twim_fire_of(0); }
+static void twim1_fire(void) { twim_fire_of(1); }
+static bool twim0_irq_line(void) { return ( twim_irq_line_of(0) ); }
+static bool twim1_irq_line(void) { return ( twim_irq_line_of(1) ); }
+
+
+static void twim_reset(void)
+{
+    memset(m_twim, 0, sizeof(m_twim));
+}
+
+
+void sim_twi_device_add(const sim_twi_device_t * p_device)
+{
+    for ( uint32_t i = 0; i < M_TWI_DEVICES_MAX; ++i )
+    {
+        if ( (m_twi_devices[i] == NULL) || (m_twi_devices[i] == p_device) )
+        {
+            m_twi_devices[i] = p_device;
+            return;
+        }
+    }
+    fatal("too many TWI devices", p_device->address);
+}
+
+
+/*******************************************************************************************
+ * Model table
+ *******************************************************************************************/
+
+static const model_t m_models[] =
+{
+    { NRF_CLOCK_BASE,  POWER_CLOCK_IRQn, clock_read, clock_write, clock_irq_line, clock_next, clock_fire, clock_reset },
+    { NRF_RADIO_BASE,  RADIO_IRQn,       radio_read, radio_write, radio_irq_line, radio_next, radio_fire, radio_reset },
+    { NRF_TWI0_BASE,   SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQn, NULL, twim0_write, twim0_irq_line, twim0_next, twim0_fire, twim_reset },
+    { NRF_TWI1_BASE,   SPIM1_SPIS1_TWIM1_TWIS1_SPI1_TWI1_IRQn, NULL, twim1_write, twim1_irq_line, twim1_next, twim1_fire, NULL },
+    { NRF_GPIOTE_BASE, GPIOTE_IRQn,      NULL,       gpiote_write, gpiote_irq_line, NULL, NULL, NULL },
+    { NRF_TIMER0_BASE, TIMER0_IRQn,      NULL,       timer0_write, timer0_irq_line, timer0_next, timer0_fire, timer_reset },
+    { NRF_TIMER1_BASE, TIMER1_IRQn,      NULL,       timer1_write, timer1_irq_line, timer1_next, timer1_fire, NULL },
+    { NRF_TIMER2_BASE, TIMER2_IRQn,      NULL,       timer2_write, timer2_irq_line, timer2_next, timer2_fire, NULL },
+    { NRF_RTC0_BASE,   RTC0_IRQn,        rtc_read,   rtc_write,   rtc_irq_line,   rtc_next,   rtc_fire,   rtc_reset },
+    { NRF_TEMP_BASE,   TEMP_IRQn,        NULL,       temp_write,  temp_irq_line,  temp_next,  temp_fire,  NULL },
+    { NRF_RNG_BASE,    RNG_IRQn,         NULL,       rng_write,   rng_irq_line,   rng_next,   rng_fire,   NULL },
+    { NRF_NVMC_BASE,   SIM_IRQ_COUNT,    nvmc_read,  nvmc_write,  NULL,           NULL,       NULL,       NULL },
+    { NRF_PPI_BASE,    SIM_IRQ_COUNT,    NULL,       ppi_write,   NULL,           NULL,       NULL,       NULL },
+    { NRF_P0_BASE,     SIM_IRQ_COUNT,    gpio_read,  gpio_write,  NULL,           NULL,       NULL,       gpio_reset },
+};
+
+
+static const model_t * model_get(uint32_t address)
+{
+    uint32_t base = address & ~(M_PAGE_SIZE - 1);
+
+    for ( uint32_t i = 0; i < sizeof(m_models) / sizeof(m_models[0]); ++i )
+    {
+        if ( m_models[i].base == base )
+        {
+            return ( &m_models[i] );
+        }
+    }
+    return ( NULL );
+}
+
+
+/*******************************************************************************************
+ * Time and interrupts
+ *******************************************************************************************/
+
+static void time_accrue(uint64_t delta)
+{
+    if ( m_sleeping )
+    {
+        m_stats.time.sleep_ns += delta;
+    }
+    else if ( !m_halted )
+    {
+        m_stats.time.cpu_ns += delta;
+    }
+    if ( m_activity & A_HFXO )   m_stats.time.hfxo_ns       += delta;
+    if ( m_activity & A_RAMP )   m_stats.time.radio_ramp_ns += delta;
+    if ( m_activity & A_TX )     m_stats.time.radio_tx_ns   += delta;
+    if ( m_activity & A_TWI )    m_stats.time.twi_ns        += delta;
+    if ( m_activity & A_TEMP )   m_stats.time.temp_ns       += delta;
+    if ( m_activity & A_FLASH )  m_stats.time.flash_ns      += delta;
+    if ( m_activity & A_DEVICE ) m_stats.time.device_ns     += delta;
+}
+
+
+static uint64_t time_next(void)
+{
+    uint64_t next = M_TIME_NONE;
+
+    for ( uint32_t i = 0; i < sizeof(m_models) / sizeof(m_models[0]); ++i )
+    {
+        if ( m_models[i].next != NULL )
+        {
+            uint64_t at = m_models[i].next();
+            if ( at < next )
+            {
+                next = at;
+            }
+        }
+    }
+    for ( uint32_t i = 0; i < M_CALLBACKS_MAX; ++i )
+    {
+        if ( (m_callbacks[i].callback != NULL) && (m_callbacks[i].at < next) )
+        {
+            next = m_callbacks[i].at;
+        }
+    }
+    return ( next );
+}
+
+
+/* Advances the virtual time to the target, generating all peripheral events on the way. */
+static void time_advance(uint64_t target)
+{
+    enum { MODELS = sizeof(m_models) / sizeof(m_models[0]) };
+
+    for ( ;; )
+    {
+        uint64_t due[MODELS];
+        uint64_t next = M_TIME_NONE;
+
+        /* The models compute their next event relative to the current time, so the due models
+           are determined before the time moves on. */
+        for ( uint32_t i = 0; i < MODELS; ++i )
+        {
+            due[i] = (m_models[i].next != NULL) ? m_models[i].next() : M_TIME_NONE;
+            next   = (due[i] < next) ? due[i] : next;
+        }
+        for ( uint32_t i = 0; i < M_CALLBACKS_MAX; ++i )
+        {
+            if ( (m_callbacks[i].callback != NULL) && (m_callbacks[i].at < next) )
+            {
+                next = m_callbacks[i].at;
+            }
+        }
+        if ( (next > target) || (next == M_TIME_NONE) )
+        {
+            break;
+        }
+
+        if ( next > m_now )
+        {
+            time_accrue(next - m_now);
+            m_now = next;
+        }
+        for ( uint32_t i = 0; i < MODELS; ++i )
+        {
+            if ( due[i] <= m_now )
+            {
+                m_models[i].fire();
+            }
+        }
+        for ( uint32_t i = 0; i < M_CALLBACKS_MAX; ++i )
+        {
+            if ( (m_callbacks[i].callback != NULL) && (m_callbacks[i].at <= m_now) )
+            {
+                void (*callback)(void) = m_callbacks[i].callback;
+                m_callbacks[i].callback = NULL;
+                callback();
+            }
+        }
+    }
+    if ( target > m_now )
+    {
+        time_accrue(target - m_now);
+        m_now = target;
+    }
+}
+
+
+/* Pends the interrupts whose peripheral interrupt line is high. */
+static void irq_lines_update(void)
+{
+    for ( uint32_t i = 0; i < sizeof(m_models) / sizeof(m_models[0]); ++i )
+    {
+        if ( (m_models[i].irq_line != NULL) && m_models[i].irq_line()
+        &&   ((m_nvic_active & (1ULL << m_models[i].irqn)) == 0) )
+        {
+            m_nvic_pending |= (1ULL << m_models[i].irqn);
+        }
+    }
+}
+
+
+/* Gets the pending and enabled interrupt with the highest priority, or -1. */
+static int32_t irq_highest_pending(void)
+{
+    uint64_t candidates = m_nvic_pending & m_nvic_enabled;
+    int32_t  highest    = -1;
+
+    for ( int32_t irqn = 0; irqn < SIM_IRQ_COUNT; ++irqn )
+    {
+        if ( (candidates & (1ULL << irqn))
+        &&   ((highest < 0) || (m_nvic_priority[irqn] < m_nvic_priority[highest])) )
+        {
+            highest = irqn;
+        }
+    }
+    return ( highest );
+}
+
+
+void POWER_CLOCK_IRQHandler(void) __attribute__((weak));
+void RADIO_IRQHandler(void) __attribute__((weak));
+void SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQHandler(void) __attribute__((weak));
+void SPIM1_SPIS1_TWIM1_TWIS1_SPI1_TWI1_IRQHandler(void) __attribute__((weak));
+void GPIOTE_IRQHandler(void) __attribute__((weak));
+void TIMER0_IRQHandler(void) __attribute__((weak));
+void TIMER1_IRQHandler(void) __attribute__((weak));
+void TIMER2_IRQHandler(void) __attribute__((weak));
+void RTC0_IRQHandler(void) __attribute__((weak));
+void TEMP_IRQHandler(void) __attribute__((weak));
+void RNG_IRQHandler(void) __attribute__((weak));
+void SWI0_EGU0_IRQHandler(void) __attribute__((weak));
+void SWI1_EGU1_IRQHandler(void) __attribute__((weak));
+void SWI2_EGU2_IRQHandler(void) __attribute__((weak));
+void SWI3_EGU3_IRQHandler(void) __attribute__((weak));
+void SWI4_EGU4_IRQHandler(void) __attribute__((weak));
+void SWI5_EGU5_IRQHandler(void) __attribute__((weak));
+void FPU_IRQHandler(void) __attribute__((weak));
+
+
+static void (* irq_handler_get(int32_t irqn))(void)
+{
+    switch ( irqn )
+    {
+        case POWER_CLOCK_IRQn:                          return ( POWER_CLOCK_IRQHandler );
+        case RADIO_IRQn:                                return ( RADIO_IRQHandler );
+        case SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQn:    return ( SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQHandler );
+        case SPIM1_SPIS1_TWIM1_TWIS1_SPI1_TWI1_IRQn:    return ( SPIM1_SPIS1_TWIM1_TWIS1_SPI1_TWI1_IRQHandler );
+        case GPIOTE_IRQn:                               return ( GPIOTE_IRQHandler );
+        case TIMER0_IRQn:                               return ( TIMER0_IRQHandler );
+        case TIMER1_IRQn:                               return ( TIMER1_IRQHandler );
+        case TIMER2_IRQn:                               return ( TIMER2_IRQHandler );
+        case RTC0_IRQn:                                 return ( RTC0_IRQHandler );
+        case TEMP_IRQn:                                 return ( TEMP_IRQHandler );
+        case RNG_IRQn:                                  return ( RNG_IRQHandler );
+        case SWI0_EGU0_IRQn:                            return ( SWI0_EGU0_IRQHandler );
+        case SWI1_EGU1_IRQn:                            return ( SWI1_EGU1_IRQHandler );
+        case SWI2_EGU2_IRQn:                            return ( SWI2_EGU2_IRQHandler );
+        case SWI3_EGU3_IRQn:                            return ( SWI3_EGU3_IRQHandler );
+        case SWI4_EGU4_IRQn:                            return ( SWI4_EGU4_IRQHandler );
+        case SWI5_EGU5_IRQn:                            return ( SWI5_EGU5_IRQHandler );
+        case FPU_IRQn:                                  return ( FPU_IRQHandler );
+        default:                                        return ( NULL );
+    }
+}
+
+
+/* Takes the pending interrupts that have a higher priority than the executing code. */
+static void irq_dispatch(void)
+{
+    for ( ;; )
+    {
+        int32_t irqn;
+        int32_t preempted_priority;
+        void  (*handler)(void);
+
+        irq_lines_update();
+        irqn = irq_highest_pending();
+        if ( (irqn < 0) || (m_primask != 0) || (m_nvic_priority[irqn] >= m_exec_priority) )
+        {
+            return;
+        }
+
+        handler = irq_handler_get(irqn);
+        if ( handler == NULL )
+        {
+            fatal("no handler for enabled interrupt", (uint32_t)irqn);
+        }
+
+        m_nvic_pending &= ~(1ULL << irqn);
+        m_nvic_active  |=  (1ULL << irqn);
+        preempted_priority = m_exec_priority;
+        m_exec_priority    = m_nvic_priority[irqn];
+        ++m_stats.isr_count[irqn];
+
+        handler();
+
+        m_exec_priority = preempted_priority;
+        m_nvic_active  &= ~(1ULL << irqn);
+        m_event_register = true;
+    }
+}
+
+
+/* Charges one register access and generates the peripheral events up to the new time. */
+static void access_charge(void)
+{
+    ++m_stats.accesses;
+    time_advance(m_now + m_access_cost);
+    if ( (m_preempt_countdown != 0) && (--m_preempt_countdown == 0) )
+    {
+        time_advance(m_now + m_preempt_delay);
+    }
+}
+
+
+void NVIC_EnableIRQ(IRQn_Type irqn)
+{
+    m_nvic_enabled |= (1ULL << irqn);
+    irq_dispatch();
+}
+
+
+void NVIC_DisableIRQ(IRQn_Type irqn)
+{
+    m_nvic_enabled &= ~(1ULL << irqn);
+}
+
+
+void NVIC_SetPendingIRQ(IRQn_Type irqn)
+{
+    m_nvic_pending |= (1ULL << irqn);
+    irq_dispatch();
+}
+
+
+void NVIC_ClearPendingIRQ(IRQn_Type irqn)
+{
+    m_nvic_pending &= ~(1ULL << irqn);
+}
+
+
+uint32_t NVIC_GetPendingIRQ(IRQn_Type irqn)
+{
+    irq_lines_update();
+    return ( (m_nvic_pending >> irqn) & 1 );
+}
+
+
+void NVIC_SetPriority(IRQn_Type irqn, uint32_t priority)
+{
+    m_nvic_priority[irqn] = (uint8_t)priority;
+}
+
+
+void __disable_irq(void)
+{
+    m_primask = 1;
+}
+
+
+void __enable_irq(void)
+{
+    m_primask = 0;
+    irq_dispatch();
+}
+
+
+uint32_t __get_PRIMASK(void)
+{
+    return ( m_primask );
+}
+
+
+void __set_PRIMASK(uint32_t primask)
+{
+    m_primask = primask & 1;
+    irq_dispatch();
+}
+
+
+uint32_t __get_FPSCR(void)
+{
+    return ( 0 );
+}
+
+
+void __set_FPSCR(uint32_t fpscr)
+{
+    (void)fpscr;
+}
+
+
+void sim_nop(void)
+{
+    time_advance(m_now + 16);
+    irq_dispatch();
+}
+
+
+void sim_sev(void)
+{
+    m_event_register = true;
+}
+
+
+void sim_wfe(void)
+{
+    if ( m_event_register )
+    {
+        m_event_register = false;
+        return;
+    }
+
+    m_sleeping = true;
+    for ( ;; )
+    {
+        uint64_t next;
+        int32_t  irqn;
+
+        irq_lines_update();
+        irqn = irq_highest_pending();
+        if ( (irqn >= 0) && (m_nvic_priority[irqn] < m_exec_priority) )
+        {
+            break;
+        }
+        next = time_next();
+        if ( next == M_TIME_NONE )
+        {
+            m_sleeping = false;
+            sim_exit(SIM_EXIT_DEADLOCK);
+        }
+        if ( next >= m_until )
+        {
+            time_advance(m_until);
+            m_sleeping = false;
+            sim_exit(SIM_EXIT_TIME_LIMIT);
+        }
+        time_advance(next);
+    }
+    m_sleeping = false;
+
+    ++m_stats.wakeups;
+    time_advance(m_now + M_WAKEUP_NS);
+    irq_dispatch();
+}
+
+
+/*******************************************************************************************
+ * Register access traps
+ *******************************************************************************************/
+
+static uint8_t * page_of(uint32_t address)
+{
+    return ( (uint8_t *)(uintptr_t)(address & ~(M_PAGE_SIZE - 1)) );
+}
+
+
+static void segv_handler(int signal, siginfo_t * p_info, void * p_context)
+{
+    ucontext_t * p_ucontext = p_context;
+    uintptr_t    fault      = (uintptr_t)p_info->si_addr;
+    uint32_t     address    = (uint32_t)fault & ~3UL;
+    bool         write      = (p_ucontext->uc_mcontext.gregs[REG_ERR] & 2) != 0;
+    step_t     * p_step;
+
+    (void)signal;
+    if ( (fault > UINT32_MAX) || (alias(address) == NULL) || (m_step_count == M_STEPS_MAX) )
+    {
+        fprintf(stderr, "sim: invalid access to %p\n", p_info->si_addr);
+        abort();
+    }
+
+    access_charge();
+    if ( m_running && (m_now >= m_until) && (m_step_count == 0) )
+    {
+        /* Busy waiting past the time limit. */
+        sim_exit(SIM_EXIT_TIME_LIMIT);
+    }
+
+    p_step            = &m_steps[m_step_count++];
+    p_step->p_page    = page_of(address);
+    p_step->address   = address;
+    p_step->write     = write;
+    p_step->old_value = *(uint32_t *)alias(address);
+
+    if ( !address_is_flash(address) )
+    {
+        const model_t * p_model = model_get(address);
+
+        if ( (p_model != NULL) && (p_model->read != NULL) )
+        {
+            *(uint32_t *)alias(address) = p_model->read(address - p_model->base);
+        }
+    }
+
+    mprotect(p_step->p_page, M_PAGE_SIZE, PROT_READ | PROT_WRITE);
+    p_ucontext->uc_mcontext.gregs[REG_EFL] |= 0x100;
+}
+
+
+static void trap_handler(int signal, siginfo_t * p_info, void * p_context)
+{
+    ucontext_t * p_ucontext = p_context;
+    step_t       steps[M_STEPS_MAX];
+    uint32_t     count = m_step_count;
+
+    (void)signal;
+    (void)p_info;
+    p_ucontext->uc_mcontext.gregs[REG_EFL] &= ~0x100;
+
+    memcpy(steps, m_steps, sizeof(steps));
+    m_step_count = 0;
+    for ( uint32_t i = 0; i < count; ++i )
+    {
+        mprotect(steps[i].p_page, M_PAGE_SIZE, address_is_flash(steps[i].address) ? PROT_READ : PROT_NONE);
+    }
+
+    for ( uint32_t i = 0; i < count; ++i )
+    {
+        uint32_t value = *(uint32_t *)alias(steps[i].address);
+
+        if ( !steps[i].write )
+        {
+            continue;
+        }
+        if ( address_is_flash(steps[i].address) )
+        {
+            flash_word_write(steps[i].address, steps[i].old_value, value);
+        }
+        else
+        {
+            const model_t * p_model = model_get(steps[i].address);
+
+            if ( (p_model != NULL) && (p_model->write != NULL) )
+            {
+                p_model->write(steps[i].address - p_model->base, value);
+            }
+        }
+    }
+
+    irq_dispatch();
+}
+
+
+/*******************************************************************************************
+ * Control
+ *******************************************************************************************/
+
+static void * map_fixed(uint32_t address, size_t size, int protection, int fd, off_t offset)
+{
+    void * p_map = mmap((void *)(uintptr_t)address, size, protection, MAP_SHARED | MAP_FIXED_NOREPLACE, fd, offset);
+
+    if ( p_map != (void *)(uintptr_t)address )
+    {
+        perror("sim: mmap");
+        abort();
+    }
+    return ( p_map );
+}
+
+
+void sim_init(void)
+{
+    struct sigaction action;
+    int              fd = memfd_create("sim", 0);
+    NRF_FICR_Type  * p_ficr;
+
+    if ( (fd < 0) || (ftruncate(fd, M_PAGES * M_PAGE_SIZE) != 0) )
+    {
+        perror("sim: memfd");
+        abort();
+    }
+    m_alias = mmap(NULL, M_PAGES * M_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if ( m_alias == MAP_FAILED )
+    {
+        perror("sim: mmap");
+        abort();
+    }
+    map_fixed(M_APB_BASE, M_APB_PAGES * M_PAGE_SIZE, PROT_NONE, fd, 0);
+    map_fixed(NRF_P0_BASE, M_PAGE_SIZE, PROT_NONE, fd, M_GPIO_PAGE * M_PAGE_SIZE);
+    map_fixed(SIM_FLASH_SIM_BASE, SIM_FLASH_SIM_PAGES * M_PAGE_SIZE, PROT_READ, fd, M_FLASH_PAGE * M_PAGE_SIZE);
+    memset(m_alias + M_FLASH_PAGE * M_PAGE_SIZE, 0xFF, SIM_FLASH_SIM_PAGES * M_PAGE_SIZE);
+
+    p_ficr = mmap((void *)(uintptr_t)NRF_FICR_BASE, M_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if ( p_ficr != (void *)(uintptr_t)NRF_FICR_BASE )
+    {
+        perror("sim: mmap");
+        abort();
+    }
+    REG(p_ficr, CODEPAGESIZE)  = SIM_FLASH_PAGE_SIZE;
+    REG(p_ficr, CODESIZE)      = SIM_FLASH_PAGES;
+    REG(p_ficr, DEVICEADDR[0]) = 0x8E89BED6;
+    REG(p_ficr, DEVICEADDR[1]) = 0x0000C0DE;
+    mprotect(p_ficr, M_PAGE_SIZE, PROT_READ);
+
+    m_firmware_stack = mmap(NULL, M_FIRMWARE_STACK_SIZE, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+    if ( m_firmware_stack == MAP_FAILED )
+    {
+        perror("sim: stack");
+        abort();
+    }
+
+    memset(&action, 0, sizeof(action));
+    action.sa_flags     = SA_SIGINFO | SA_NODEFER;
+    action.sa_sigaction = segv_handler;
+    sigaction(SIGSEGV, &action, NULL);
+    action.sa_sigaction = trap_handler;
+    sigaction(SIGTRAP, &action, NULL);
+
+    sim_reset();
+}
+
+
+void sim_reset(void)
+{
+    memset(m_alias, 0, M_FLASH_PAGE * M_PAGE_SIZE);
+    for ( uint32_t i = 0; i < sizeof(m_models) / sizeof(m_models[0]); ++i )
+    {
+        if ( m_models[i].reset != NULL )
+        {
+            m_models[i].reset();
+        }
+    }
+    memset(m_callbacks, 0, sizeof(m_callbacks));
+    m_temp_ready_at   = M_TIME_NONE;
+    m_rng_ready_at    = M_TIME_NONE;
+    m_activity        = 0;
+    m_event_register  = false;
+    m_primask         = 0;
+    m_exec_priority   = M_THREAD_PRIORITY;
+    m_nvic_enabled    = 0;
+    m_nvic_pending    = 0;
+    m_nvic_active     = 0;
+    m_preempt_countdown = 0;
+    memset(m_nvic_priority, 0, sizeof(m_nvic_priority));
+    sim_stats_clear();
+}
+
+
+static void firmware_start(void)
+{
+    m_entry();
+    sim_exit(SIM_EXIT_RETURNED);
+}
+
+
+sim_exit_t sim_run(void (*entry)(void), uint64_t until_ns)
+{
+    int reason;
+
+    if ( m_running )
+    {
+        fatal("sim_run() is not reentrant", 0);
+    }
+
+    m_entry = entry;
+    m_until = until_ns;
+
+    reason = sigsetjmp(m_exit_jmp, 1);
+    if ( reason != 0 )
+    {
+        /* Left from within a trap or an interrupt handler. */
+        for ( uint32_t i = 0; i < m_step_count; ++i )
+        {
+            mprotect(m_steps[i].p_page, M_PAGE_SIZE, address_is_flash(m_steps[i].address) ? PROT_READ : PROT_NONE);
+        }
+        m_step_count    = 0;
+        m_sleeping      = false;
+        m_halted        = false;
+        m_ppi_depth     = 0;
+        m_exec_priority = M_THREAD_PRIORITY;
+        m_nvic_active   = 0;
+        m_running       = false;
+        return ( (sim_exit_t)(reason - 1) );
+    }
+
+    m_running = true;
+    getcontext(&m_firmware_context);
+    m_firmware_context.uc_stack.ss_sp   = m_firmware_stack;
+    m_firmware_context.uc_stack.ss_size = M_FIRMWARE_STACK_SIZE;
+    m_firmware_context.uc_link          = NULL;
+    makecontext(&m_firmware_context, firmware_start, 0);
+    setcontext(&m_firmware_context);
+    return ( SIM_EXIT_RETURNED );
+}
+
+
+uint64_t sim_now_ns(void)
+{
+    return ( m_now );
+}
+
+
+const sim_stats_t * sim_stats_get(void)
+{
+    return ( &m_stats );
+}
+
+
+void sim_stats_clear(void)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+
+void sim_access_cost_set(uint32_t ns)
+{
+    m_access_cost = ns;
+}
+
+
+void sim_preempt_set(uint32_t accesses, uint64_t delay_ns)
+{
+    m_preempt_countdown = accesses;
+    m_preempt_delay     = delay_ns;
+}
+
+
+void sim_lfclk_drift_set(int32_t ppb)
+{
+    uint64_t tick = sim_lfclk_ticks_at(m_now);
+    uint64_t delta;
+
+    /* Keep the counter continuous across the change. */
+    m_lfclk_ppb = ppb;
+    delta = sim_lfclk_ticks_at(m_now) - tick;
+    m_rtc.offset    -= delta;
+    m_rtc.last_tick += delta;
+    for ( uint32_t i = 0; i < 4; ++i )
+    {
+        m_rtc.armed_from[i] += delta;
+    }
+}
+
+
+void sim_hfxo_startup_set(uint32_t us)
+{
+    m_hfxo_startup_us = us;
+}
+
+
+void sim_device_active_set(bool active)
+{
+    m_activity = active ? (m_activity | A_DEVICE) : (m_activity & ~A_DEVICE);
+}
+
+
+void sim_callback_schedule(void (*callback)(void), uint64_t at_ns)
+{
+    sim_callback_cancel(callback);
+    for ( uint32_t i = 0; i < M_CALLBACKS_MAX; ++i )
+    {
+        if ( m_callbacks[i].callback == NULL )
+        {
+            m_callbacks[i].callback = callback;
+            m_callbacks[i].at       = at_ns;
+            return;
+        }
+    }
+    fatal("too many scheduled callbacks", 0);
+}
+
+
+void sim_callback_cancel(void (*callback)(void))
+{
+    for ( uint32_t i = 0; i < M_CALLBACKS_MAX; ++i )
+    {
+        if ( m_callbacks[i].callback == callback )
+        {
+            m_callbacks[i].callback = NULL;
+        }
+    }
+}
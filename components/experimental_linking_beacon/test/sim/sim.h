@@ -0,0 +1,237 @@
+/* Copyright (c) Nordic Semiconductor ASA
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ *   1. Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ *   2. Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ *   3. Neither the name of Nordic Semiconductor ASA nor the names of other
+ *   contributors to this software may be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ * 
+ *   4. This software must only be used in a processor manufactured by Nordic
+ *   Semiconductor ASA, or in a processor manufactured by a third party that
+ *   is used in combination with a processor manufactured by Nordic Semiconductor.
+ * 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef SIM_H__
+#define SIM_H__
+
+/* Host simulation of the nRF52 peripherals used by the beacon sources.
+
+   The firmware sources are compiled unmodified for the host against nrf.h. The register blocks
+   are mapped at their real addresses without access rights, so that every register access of
+   the firmware traps. The trap handler brings the peripheral models up to date, lets the access
+   complete, and passes written values to the models. Time is virtual: it advances by a fixed
+   cost per register access, and jumps to the next peripheral event while the CPU sleeps in WFE.
+   Interrupts are dispatched between register accesses, so an interrupt handler can preempt the
+   thread at any access, the same as on target.
+
+   Firmware buffers handed to EasyDMA or PPI are addressed with 32-bit values, so the tests are
+   linked without PIE and the firmware runs on a stack below 4 GB. */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "nrf.h"
+
+
+/* Reasons for sim_run() to return. */
+typedef enum
+{
+    SIM_EXIT_RETURNED,      ///< The entry function returned.
+    SIM_EXIT_TIME_LIMIT,    ///< The time limit was reached while the CPU slept.
+    SIM_EXIT_POWER_FAIL,    ///< A power failure was injected during a flash operation.
+    SIM_EXIT_DEADLOCK,      ///< The CPU went to sleep with no event that could wake it up.
+} sim_exit_t;
+
+
+/* Accumulated time per activity, in nanoseconds. The activities overlap, e.g. the CPU and the
+   HFCLK are on while the radio transmits. */
+typedef struct
+{
+    uint64_t cpu_ns;            ///< CPU running, i.e. not sleeping in WFE.
+    uint64_t sleep_ns;          ///< CPU sleeping in WFE.
+    uint64_t hfxo_ns;           ///< HFCLK crystal oscillator running or starting.
+    uint64_t radio_ramp_ns;     ///< Radio ramping up or disabling.
+    uint64_t radio_tx_ns;       ///< Radio transmitting.
+    uint64_t twi_ns;            ///< TWI bus transfer in progress.
+    uint64_t temp_ns;           ///< TEMP measurement in progress.
+    uint64_t flash_ns;          ///< Flash write or erase in progress, with the CPU halted.
+    uint64_t device_ns;         ///< External device (sensor) converting, see sim_device_active_set().
+} sim_time_t;
+
+
+/* Counters of the simulation. */
+typedef struct
+{
+    sim_time_t time;                        ///< Accumulated time per activity.
+    uint32_t   wakeups;                     ///< Wake-ups from WFE sleep.
+    uint32_t   isr_count[SIM_IRQ_COUNT];    ///< Interrupt handler invocations per IRQn.
+    uint32_t   accesses;                    ///< Register accesses.
+    uint32_t   hfxo_starts;                 ///< HFCLKSTART tasks that started the crystal.
+    uint32_t   twi_transfers;               ///< TWI transfers (start condition to stop or suspend).
+    uint32_t   flash_writes;                ///< Flash word writes.
+    uint32_t   flash_erases;                ///< Flash page erases.
+    uint32_t   flash_violations;            ///< Flash writes without write enable, or erases of
+                                            ///< pages outside the simulated flash.
+    uint32_t   radio_without_hfxo;          ///< Radio enabled without the HFCLK crystal running.
+} sim_stats_t;
+
+
+/* One packet sent by the radio. */
+typedef struct
+{
+    uint64_t start_ns;          ///< Start of the preamble.
+    uint64_t end_ns;            ///< END event.
+    uint32_t frequency;         ///< FREQUENCY when the radio was enabled.
+    uint32_t datawhiteiv;       ///< DATAWHITEIV at START.
+    uint8_t  pdu[3 + 37];       ///< S0, LENGTH, S1 and payload at PACKETPTR at START, as laid out in RAM.
+} sim_packet_t;
+
+
+#define SIM_PACKET_LOG_SIZE     (4096)
+
+
+/* A device on the TWI bus. Both functions return false to not acknowledge. */
+typedef struct
+{
+    uint8_t address;                                                ///< 7-bit address.
+    bool (*write)(const uint8_t * p_data, uint32_t length);         ///< Data written by the master.
+    bool (*read)(uint8_t * p_data, uint32_t length);                ///< Data read by the master.
+} sim_twi_device_t;
+
+
+/* Called when the firmware changes the level of a pin that is not driven by an external device,
+   by its output or by its direction or pull. */
+typedef void (*sim_gpio_output_handler_t)(uint32_t pin, bool level);
+
+
+/* Maps the register blocks and installs the trap handlers. Shall be called once. */
+void sim_init(void);
+
+
+/* Resets all peripherals, NVIC and CPU state as by a power-on reset. Virtual time and the
+   flash contents are kept; the counters are cleared. */
+void sim_reset(void);
+
+
+/* Runs the function on the simulated CPU until it returns, or until the CPU sleeps at or past the
+   absolute time limit. Can be called again to continue with another entry function. */
+sim_exit_t sim_run(void (*entry)(void), uint64_t until_ns);
+
+
+/* Gets the virtual time. */
+uint64_t sim_now_ns(void);
+
+
+/* Gets the counters since the last reset. */
+const sim_stats_t * sim_stats_get(void);
+
+
+/* Clears the counters. */
+void sim_stats_clear(void);
+
+
+/* Sets the cost of one register access. Default 250 ns. */
+void sim_access_cost_set(uint32_t ns);
+
+
+/* Adds a delay of the CPU after the specified number of further register accesses, as by a
+   higher priority interrupt or a SoftDevice event preempting the firmware. Zero disables. */
+void sim_preempt_set(uint32_t accesses, uint64_t delay_ns);
+
+
+/* Sets the deviation of the LFCLK crystal from 32768 Hz, in parts per billion. */
+void sim_lfclk_drift_set(int32_t ppb);
+
+
+/* Gets the LFCLK ticks elapsed since power-on at the specified time. */
+uint64_t sim_lfclk_ticks_at(uint64_t t_ns);
+
+
+/* Sets the startup time of the HFCLK crystal oscillator. Default 360 us. */
+void sim_hfxo_startup_set(uint32_t us);
+
+
+/* Tells if the HFCLK crystal oscillator is running. */
+bool sim_hfclk_running(void);
+
+
+/* Sets the temperature reported by TEMP, in units of 0.25 degrees Celsius. */
+void sim_temp_set(int32_t quarter_degrees);
+
+
+/* Gets the radio packet log and the number of packets sent since the last reset. The log wraps. */
+const sim_packet_t * sim_packets_get(uint32_t * p_count);
+
+
+/* Attaches a device to the TWI bus. */
+void sim_twi_device_add(const sim_twi_device_t * p_device);
+
+
+/* Gets the duration of the TWI bus transfer of the specified number of bytes (including the
+   address byte) at the configured frequency. */
+uint64_t sim_twi_bytes_ns(uint32_t bytes);
+
+
+/* Sets the level that an external device drives on the input pin. */
+void sim_gpio_input_set(uint32_t pin, bool level);
+
+
+/* Gets the level of the pin as driven by the firmware or the external device. */
+bool sim_gpio_level_get(uint32_t pin);
+
+
+/* Sets the handler of GPIO output changes. */
+void sim_gpio_output_handler_set(sim_gpio_output_handler_t handler);
+
+
+/* Marks an external device as active (converting) or idle, for the activity time. */
+void sim_device_active_set(bool active);
+
+
+/* Schedules a call of the function at the specified absolute time, e.g. a device finishing a
+   conversion. Only one such call is pending at a time per function. */
+void sim_callback_schedule(void (*callback)(void), uint64_t at_ns);
+
+
+/* Cancels a call scheduled by sim_callback_schedule(). */
+void sim_callback_cancel(void (*callback)(void));
+
+
+/* Injects a power failure at the specified flash operation (counting from one, zero disables).
+   The operation takes partial effect and sim_run() returns SIM_EXIT_POWER_FAIL. */
+void sim_flash_power_fail_set(uint32_t operation);
+
+
+/* Gets the address of the simulated flash word at the specified address. Used by tests to
+   inspect and prepare the flash contents. */
+uint32_t * sim_flash_word(uint32_t address);
+
+
+/* Base and size of the simulated flash, the last pages of a 512 kB part. */
+#define SIM_FLASH_PAGE_SIZE     (4096UL)
+#define SIM_FLASH_PAGES         (128UL)
+#define SIM_FLASH_SIM_PAGES     (4UL)
+#define SIM_FLASH_SIM_BASE      ((SIM_FLASH_PAGES - SIM_FLASH_SIM_PAGES) * SIM_FLASH_PAGE_SIZE)
+
+#endif // SIM_H__
@@ -31,17 +31,33 @@
  * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
-#ifndef HAL_CLOCK_H__
-#define HAL_CLOCK_H__
+#ifndef TEST_H__
+#define TEST_H__
 
-#include <stdint.h>
+/* Minimal checks for the host tests. A test program returns test_result() from main. */
 
-void hal_clock_lfclk_enable(void);
+#include <stdio.h>
+#include <stdint.h>
 
+static unsigned int m_test_failures;
 
-void hal_clock_hfclk_enable(void);
+#define TEST_CHECK(condition, ...)                                                      \
+do                                                                                      \
+{                                                                                       \
+    if ( !(condition) )                                                                 \
+    {                                                                                   \
+        ++m_test_failures;                                                              \
+        printf("%s:%d: check failed: %s: ", __FILE__, __LINE__, #condition);            \
+        printf(__VA_ARGS__);                                                            \
+        printf("\n");                                                                   \
+    }                                                                                   \
+} while ( 0 )
 
 
-void hal_clock_hfclk_disable(void);
+static inline int test_result(const char * p_name)
+{
+    printf("%s: %s\n", p_name, (m_test_failures == 0) ? "PASS" : "FAIL");
+    return ( (m_test_failures == 0) ? 0 : 1 );
+}
 
-#endif // HAL_CLOCK_H__
+#endif // TEST_H__
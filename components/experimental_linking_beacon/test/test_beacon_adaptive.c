@@ -0,0 +1,288 @@
+/* Copyright (c) Nordic Semiconductor ASA
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ *   1. Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ *   2. Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ *   3. Neither the name of Nordic Semiconductor ASA nor the names of other
+ *   contributors to this software may be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ * 
+ *   4. This software must only be used in a processor manufactured by Nordic
+ *   Semiconductor ASA, or in a processor manufactured by a third party that
+ *   is used in combination with a processor manufactured by Nordic Semiconductor.
+ * 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* Runs the beacon loop of sensor_beacon.c with the adaptive advertising interval for two hours of
+   virtual time, while the sensor follows a temperature trace: a quiet hour of slow drift, then an
+   hour with a door opened every ten minutes. Reports the advertising events per hour and the
+   worst-case staleness of the advertised temperature in each hour, next to the figures of the
+   fixed interval, and checks that every interval stays between the burst and the idle interval
+   and that the adaptive interval is never staler than the fixed one.
+   A change of the temperature is stale until an advertising event carries it or a later value. */
+
+#define main beacon_main
+#include "sensor_beacon.c"
+#undef main
+
+#include "sim.h"
+#include "test.h"
+#ifdef SENSOR_BEACON_BACKEND_LPS25H
+#include "lps25h_model.h"
+#endif
+
+#include <stdio.h>
+
+
+#define M_HOUR_NS               (3600ULL * 1000000000)
+#define M_RUN_NS                (2 * M_HOUR_NS)
+#define M_TRACE_STEP_NS         (1000000000ULL)
+#define M_EVENT_GAP_NS          (2000000)       /* Packets closer than this belong to one advertising event. */
+#define M_INTERVAL_SLACK_NS     (1000000)       /* The interval tolerance for the HFCLK startup and the RTC resolution. */
+#define M_PRESSURE_PA           (101325)
+#define M_CHANGES_MAX           (1024)          /* Changes not yet advertised. */
+
+#ifdef ADV_DELAY_ENABLE
+#define M_ADV_DELAY_MAX_NS      (ADV_DELAY_MAX_US * 1000ULL)
+#else
+#define M_ADV_DELAY_MAX_NS      (0)
+#endif
+
+#define M_INTERVAL_MIN_NS       (ADAPTIVE_INTERVAL_MIN_US * 1000ULL)
+#define M_INTERVAL_MAX_NS       ((ADAPTIVE_INTERVAL_MIN_US * 1000ULL) << ADAPTIVE_INTERVAL_MAX_SHIFT)
+
+/* The sensor is read on its own deadline every read interval, whatever the advertising interval,
+   and a changed temperature is advertised at the burst interval after the latest event. */
+#define M_STALENESS_MAX_NS      (SENSOR_READ_INTERVAL_US * 1000ULL + SENSOR_FIRST_READ_TIME_US * 1000ULL \
+                                 + M_INTERVAL_MIN_NS + M_ADV_DELAY_MAX_NS + M_INTERVAL_SLACK_NS)
+
+/* The same with the fixed interval, where the sensor is read every SENSOR_SKIP_READ_COUNT events. */
+#define M_FIXED_EVENTS_PER_HOUR (3600ULL * 1000000 / INTERVAL_US)
+#define M_FIXED_STALENESS_NS    ((sizeof(m_service_schedule) * SENSOR_SKIP_READ_COUNT + 1) * (INTERVAL_US * 1000ULL + M_ADV_DELAY_MAX_NS))
+
+
+/* The figures of one hour of the trace. */
+typedef struct
+{
+    const char * p_name;
+    uint32_t     events;                ///< Advertising events started in the hour.
+    uint32_t     burst_intervals;       ///< Intervals at the burst interval.
+    uint32_t     changes;               ///< Changes of the temperature.
+    uint64_t     worst_staleness_ns;    ///< The longest time the advertised temperature lagged a change.
+} phase_t;
+
+static phase_t m_phases[2] =
+{
+    { .p_name = "quiet" },
+    { .p_name = "door" },
+};
+
+/* A change of the temperature not yet advertised. */
+typedef struct
+{
+    uint64_t t_ns;
+    uint16_t value;             ///< The Linking value.
+} change_t;
+
+static change_t m_changes[M_CHANGES_MAX];
+static uint32_t m_changes_first;
+static uint32_t m_changes_end;
+static int32_t  m_temperature_quarters = INT32_MIN;
+
+static uint32_t m_packets_seen;
+static uint64_t m_last_end_ns;
+static uint64_t m_last_event_ns;
+static uint32_t m_event_count;
+
+
+static void beacon_entry(void)
+{
+    (void)beacon_main();
+}
+
+
+static phase_t * phase_get(uint64_t t_ns)
+{
+    return ( &m_phases[(t_ns < M_HOUR_NS) ? 0 : 1] );
+}
+
+
+/* Gets the temperature of the trace in milli degrees Celsius. The first hour drifts from 21 to 22
+   degrees. In the second hour a door is opened at the start of every ten minutes, the temperature
+   drops by 3 degrees within half a minute and recovers over five minutes. */
+static int32_t trace_temperature_get(uint64_t t_ns)
+{
+    uint32_t t_s = (uint32_t)(t_ns / 1000000000);
+
+    if ( t_ns < M_HOUR_NS )
+    {
+        return ( 21000 + (int32_t)(t_s * 1000 / 3600) );
+    }
+    else
+    {
+        uint32_t open_s = (t_s - 3600) % 600;
+
+        if ( open_s < 30 )
+        {
+            return ( 22000 - (int32_t)(open_s * 3000 / 30) );
+        }
+        else if ( open_s < 330 )
+        {
+            return ( 19000 + (int32_t)((open_s - 30) * 3000 / 300) );
+        }
+        return ( 22000 );
+    }
+}
+
+
+/* Ends the staleness of the changes up to the latest one to the advertised value. The oldest of
+   them has been stale the longest. */
+static void changes_advertised(uint16_t value, uint64_t t_ns)
+{
+    for ( uint32_t i = m_changes_end; i > m_changes_first; --i )
+    {
+        if ( m_changes[(i - 1) % M_CHANGES_MAX].value == value )
+        {
+            const change_t * p_oldest  = &m_changes[m_changes_first % M_CHANGES_MAX];
+            phase_t        * p_phase   = phase_get(p_oldest->t_ns);
+            uint64_t         staleness = t_ns - p_oldest->t_ns;
+
+            if ( staleness > p_phase->worst_staleness_ns )
+            {
+                p_phase->worst_staleness_ns = staleness;
+            }
+            m_changes_first = i;
+            return;
+        }
+    }
+}
+
+
+/* Takes the advertising events out of the packet log, and ends the staleness of the temperature
+   of the changes it advertises. */
+static void events_drain(void)
+{
+    uint32_t             count;
+    const sim_packet_t * p_packets = sim_packets_get(&count);
+
+    TEST_CHECK(count - m_packets_seen <= SIM_PACKET_LOG_SIZE, "%u packets lost", count - m_packets_seen - SIM_PACKET_LOG_SIZE);
+    for ( ; m_packets_seen < count; ++m_packets_seen )
+    {
+        const sim_packet_t * p_packet = &p_packets[m_packets_seen % SIM_PACKET_LOG_SIZE];
+        const uint8_t      * p_data   = &p_packet->pdu[SINT16_SERVICE_DATA_OFFS];
+
+        if ( (m_packets_seen == 0) || (p_packet->start_ns - m_last_end_ns > M_EVENT_GAP_NS) )
+        {
+            phase_t * p_phase = phase_get(p_packet->start_ns);
+
+            if ( m_event_count > 0 )
+            {
+                uint64_t interval = p_packet->start_ns - m_last_event_ns;
+
+                TEST_CHECK((interval + M_INTERVAL_SLACK_NS >= M_INTERVAL_MIN_NS)
+                        && (interval <= M_INTERVAL_MAX_NS + M_ADV_DELAY_MAX_NS + M_INTERVAL_SLACK_NS),
+                           "interval %llu ns at %.3f s", (unsigned long long)interval, p_packet->start_ns / 1e9);
+                p_phase->burst_intervals += (interval < 2 * M_INTERVAL_MIN_NS) ? 1 : 0;
+            }
+            ++p_phase->events;
+            ++m_event_count;
+            m_last_event_ns = p_packet->start_ns;
+
+            if ( linking_service_data_id_unpack(p_data) == LINKING_SERVICE_TYPE_TEMPERATURE )
+            {
+                changes_advertised(linking_service_data_value_unpack(p_data), p_packet->start_ns);
+            }
+        }
+        m_last_end_ns = p_packet->end_ns;
+    }
+}
+
+
+/* Follows the trace in steps of 0.25 degrees, the resolution of the SoC temperature sensor. */
+static void trace_step(void)
+{
+    int32_t quarters = trace_temperature_get(sim_now_ns()) / 250;
+
+    events_drain();
+    if ( quarters != m_temperature_quarters )
+    {
+        m_temperature_quarters = quarters;
+#ifdef SENSOR_BEACON_BACKEND_LPS25H
+        lps25h_model_values_set(quarters * 250, M_PRESSURE_PA);
+#else
+        sim_temp_set(quarters);
+#endif
+        ++phase_get(sim_now_ns())->changes;
+        TEST_CHECK(m_changes_end - m_changes_first < M_CHANGES_MAX, "%u changes not advertised", M_CHANGES_MAX);
+        m_changes[m_changes_end % M_CHANGES_MAX].t_ns  = sim_now_ns();
+        m_changes[m_changes_end % M_CHANGES_MAX].value = IEEE754_Convert_Temperature(quarters * 0.25f);
+        ++m_changes_end;
+    }
+    sim_callback_schedule(trace_step, sim_now_ns() + M_TRACE_STEP_NS);
+}
+
+
+int main(void)
+{
+    sim_exit_t exit_reason;
+
+    sim_init();
+#ifdef SENSOR_BEACON_BACKEND_LPS25H
+    lps25h_model_init(LPS25H_MODEL_PIN_NONE);
+#endif
+    trace_step();
+
+    exit_reason = sim_run(beacon_entry, M_RUN_NS);
+    TEST_CHECK(exit_reason == SIM_EXIT_TIME_LIMIT, "exit %d", exit_reason);
+    events_drain();
+
+    printf("%s: interval %.3f to %.3f s, fixed interval %.3f s\n", TEST_NAME, M_INTERVAL_MIN_NS / 1e9,
+           M_INTERVAL_MAX_NS / 1e9, INTERVAL_US / 1e6);
+    printf("  fixed interval by its schedule: %llu events per hour, staleness up to %.1f s\n",
+           (unsigned long long)M_FIXED_EVENTS_PER_HOUR, M_FIXED_STALENESS_NS / 1e9);
+    for ( uint32_t i = 0; i < sizeof(m_phases) / sizeof(m_phases[0]); ++i )
+    {
+        const phase_t * p_phase = &m_phases[i];
+
+        printf("  %-6s %3u changes: %5u events per hour (%u at the burst interval), staleness up to %.1f s\n",
+               p_phase->p_name, p_phase->changes, p_phase->events, p_phase->burst_intervals,
+               p_phase->worst_staleness_ns / 1e9);
+        TEST_CHECK(p_phase->changes > 0, "no changes in the %s hour", p_phase->p_name);
+        TEST_CHECK(p_phase->worst_staleness_ns <= M_STALENESS_MAX_NS, "%s hour: staleness %llu ns",
+                   p_phase->p_name, (unsigned long long)p_phase->worst_staleness_ns);
+        TEST_CHECK(p_phase->worst_staleness_ns <= M_FIXED_STALENESS_NS, "%s hour: staleness %llu ns, fixed %llu ns",
+                   p_phase->p_name, (unsigned long long)p_phase->worst_staleness_ns,
+                   (unsigned long long)M_FIXED_STALENESS_NS);
+        TEST_CHECK(p_phase->burst_intervals >= p_phase->changes, "%s hour: %u burst intervals for %u changes",
+                   p_phase->p_name, p_phase->burst_intervals, p_phase->changes);
+    }
+    TEST_CHECK(m_changes_end - m_changes_first <= 1, "%u changes not advertised at the end", m_changes_end - m_changes_first);
+
+    /* A quiet sensor idles at the longest interval after the burst and back-off of each change,
+       counting the first reading as one. A busy one bursts. */
+    TEST_CHECK(m_phases[0].events * 2 < M_FIXED_EVENTS_PER_HOUR, "%u events in the quiet hour", m_phases[0].events);
+    TEST_CHECK(m_phases[0].events <= M_HOUR_NS / M_INTERVAL_MAX_NS
+                                   + (m_phases[0].changes + 1) * (ADAPTIVE_INTERVAL_BURST_COUNT + ADAPTIVE_INTERVAL_MAX_SHIFT),
+               "%u events in the quiet hour", m_phases[0].events);
+    TEST_CHECK(m_phases[1].events > m_phases[0].events, "%u events in the door hour", m_phases[1].events);
+
+    return ( test_result(TEST_NAME) );
+}
@@ -0,0 +1,385 @@
+/* Copyright (c) Nordic Semiconductor ASA
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ *   1. Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ *   2. Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ *   3. Neither the name of Nordic Semiconductor ASA nor the names of other
+ *   contributors to this software may be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ * 
+ *   4. This software must only be used in a processor manufactured by Nordic
+ *   Semiconductor ASA, or in a processor manufactured by a third party that
+ *   is used in combination with a processor manufactured by Nordic Semiconductor.
+ * 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Simulates the advertising of a number of beacons at one gateway, with and without the advDelay.
+   The beacons are powered up together, within a few milliseconds, and each runs on its own LFCLK
+   crystal with a constant drift of up to M_DRIFT_PPB_MAX. Every beacon advances its advertising
+   events with the interval and the advDelay generator of sensor_beacon.c, seeded from its own
+   device address, and sends the packets of an advertising event as laid out by a short simulation
+   of one beacon. The gateway scans the advertising channels in turn, and loses the packets that
+   overlap on its channel. Reports the share of advertising events that reach the gateway per
+   beacon, and checks that the advDelay keeps the worst beacon from losing its events to a
+   neighbour with nearly the same drift. The advDelay spreads beacons switched on together only as
+   a random walk, by some 100 ms over the run, so they still collide more often than beacons
+   switched on at random times would. */
+
+#define main beacon_main
+#include "sensor_beacon.c"
+#undef main
+
+#include "sim.h"
+#include "test.h"
+#ifdef SENSOR_BEACON_BACKEND_LPS25H
+#include "lps25h_model.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef ADV_DELAY_ENABLE
+#error "The simulation compares the advertising with and without the advDelay of the board!"
+#endif
+
+
+#define M_TEMPLATE_RUN_NS       (3ULL * INTERVAL_US * 1000 + INITIAL_TIMEOUT * 1000ULL)
+#define M_RUN_NS                (600ULL * 1000000000)
+#define M_EVENT_GAP_NS          (2000000)       /* Packets closer than this belong to one advertising event. */
+#define M_PACKETS_PER_EVENT     (3)
+#define M_DRIFT_PPB_MAX         (40000)         /* The LFCLK crystal tolerance over temperature. */
+#define M_POWERUP_SPREAD_NS     (2000000)       /* The spread of the power-up of beacons switched on together. */
+#define M_SCAN_WINDOW_NS        (100000000)     /* The time the gateway listens on each advertising channel. */
+#define M_BEACONS_LISTED        (20)            /* The deployment small enough to list every beacon. */
+#define M_BEACONS_MAX           (100)
+#define M_DELIVERY_MIN_PERCENT  (80)            /* The worst delivery ratio accepted with the advDelay. */
+
+
+/* One packet of the advertising event template. */
+typedef struct
+{
+    uint64_t offset_ns;         ///< The start from the start of the advertising event.
+    uint64_t duration_ns;
+    uint8_t  channel;
+} template_packet_t;
+
+
+/* One packet of the deployment on the air. */
+typedef struct
+{
+    uint64_t start_ns;
+    uint64_t end_ns;
+    uint32_t event;             ///< The advertising event of the beacon.
+    uint8_t  beacon;
+    uint8_t  channel;
+    bool     collided;
+} air_packet_t;
+
+
+/* One beacon of the deployment. */
+typedef struct
+{
+    uint32_t           address[2];      ///< The device address, as in FICR DEVICEADDR.
+    int32_t            drift_ppb;       ///< The LFCLK drift.
+    uint64_t           powerup_ns;      ///< The point in time of starting the RTC.
+    hal_timer_period_t interval;        ///< The state of the advertising interval.
+    uint32_t           adv_delay_state; ///< The state of the advDelay generator.
+    uint32_t           events;          ///< The advertising events sent.
+    uint32_t           delivered;       ///< The advertising events received by the gateway.
+} sim_beacon_t;
+
+
+static template_packet_t m_template[M_PACKETS_PER_EVENT];
+static sim_beacon_t      m_beacons[M_BEACONS_MAX];
+static air_packet_t    * mp_air;
+static uint32_t          m_air_count;
+static uint32_t          m_random = 0x9E3779B9;
+
+
+static void beacon_entry(void)
+{
+    (void)beacon_main();
+}
+
+
+static uint32_t random_get(void)
+{
+    m_random ^= m_random << 13;
+    m_random ^= m_random >> 17;
+    m_random ^= m_random << 5;
+    return ( m_random );
+}
+
+
+/* Seeds the advDelay generator from a device address, as adv_delay_init() does from FICR. */
+static uint32_t adv_delay_seed_get(const uint32_t * p_address)
+{
+    uint32_t seed = p_address[0] ^ (p_address[1] << 16) ^ (p_address[1] >> 16);
+
+    return ( (seed == 0) ? 0x2545F491 : seed );
+}
+
+
+/* Takes the layout of an advertising event from the packets of a short simulation of one beacon. */
+static void template_take(void)
+{
+    const sim_packet_t * p_packets;
+    uint32_t             count;
+    uint32_t             first = 0;
+
+    (void)sim_run(beacon_entry, M_TEMPLATE_RUN_NS);
+    p_packets = sim_packets_get(&count);
+
+    // The second advertising event, after the HFCLK startup time is learned.
+    for ( uint32_t i = 1; i < count; ++i )
+    {
+        if ( p_packets[i].start_ns - p_packets[i - 1].end_ns > M_EVENT_GAP_NS )
+        {
+            first = i;
+            break;
+        }
+    }
+    TEST_CHECK((first != 0) && (first + M_PACKETS_PER_EVENT <= count), "%u packets, second event at %u", count, first);
+    for ( uint32_t i = 0; (i < M_PACKETS_PER_EVENT) && (first + i < count); ++i )
+    {
+        const sim_packet_t * p_packet = &p_packets[first + i];
+
+        m_template[i].offset_ns   = p_packet->start_ns - p_packets[first].start_ns;
+        m_template[i].duration_ns = p_packet->end_ns - p_packet->start_ns;
+        m_template[i].channel     = (uint8_t)(p_packet->datawhiteiv & 0x3F);
+    }
+}
+
+
+/* Places the beacons, each with its own address, drift and power-up time. */
+static void beacons_place(uint32_t count)
+{
+    for ( uint32_t i = 0; i < count; ++i )
+    {
+        sim_beacon_t * p_beacon = &m_beacons[i];
+
+        p_beacon->address[0] = random_get();
+        p_beacon->address[1] = 0xC000 | (random_get() & 0xFFFF);
+        p_beacon->drift_ppb  = (int32_t)(random_get() % (2 * M_DRIFT_PPB_MAX + 1)) - M_DRIFT_PPB_MAX;
+        p_beacon->powerup_ns = random_get() % M_POWERUP_SPREAD_NS;
+    }
+}
+
+
+/* Converts the RTC ticks of a beacon to the simulation time. */
+static uint64_t beacon_ticks_to_ns(const sim_beacon_t * p_beacon, uint64_t ticks)
+{
+    double ns = (double)ticks * 1e9 / HAL_TIMER_TICKS_PER_SECOND;
+
+    return ( p_beacon->powerup_ns + (uint64_t)(ns + ns * p_beacon->drift_ppb / 1e9) );
+}
+
+
+/* Puts the packets of all advertising events of the beacons on the air, with or without the advDelay. */
+static void air_fill(uint32_t count, bool adv_delay)
+{
+    m_air_count = 0;
+    for ( uint32_t i = 0; i < count; ++i )
+    {
+        sim_beacon_t * p_beacon = &m_beacons[i];
+        uint64_t       time_ticks = INITIAL_TIMEOUT_TICKS;
+        uint64_t       start_ns;
+
+        p_beacon->interval        = (hal_timer_period_t)HAL_TIMER_PERIOD_INIT(INTERVAL_US);
+        p_beacon->adv_delay_state = adv_delay_seed_get(p_beacon->address);
+        p_beacon->events          = 0;
+        p_beacon->delivered       = 0;
+
+        while ( (start_ns = beacon_ticks_to_ns(p_beacon, time_ticks + HFCLK_STARTUP_TIME_TICKS)) < M_RUN_NS )
+        {
+            for ( uint32_t k = 0; k < M_PACKETS_PER_EVENT; ++k )
+            {
+                air_packet_t * p_packet = &mp_air[m_air_count++];
+
+                p_packet->start_ns = start_ns + m_template[k].offset_ns;
+                p_packet->end_ns   = p_packet->start_ns + m_template[k].duration_ns;
+                p_packet->event    = p_beacon->events;
+                p_packet->beacon   = (uint8_t)i;
+                p_packet->channel  = m_template[k].channel;
+                p_packet->collided = false;
+            }
+            ++p_beacon->events;
+
+            // The interval of the firmware, with the advDelay generator of this beacon.
+            if ( adv_delay )
+            {
+                m_interval        = p_beacon->interval;
+                m_adv_delay_state = p_beacon->adv_delay_state;
+                time_ticks        = adv_interval_advance(time_ticks);
+                p_beacon->interval        = m_interval;
+                p_beacon->adv_delay_state = m_adv_delay_state;
+            }
+            else
+            {
+                time_ticks = hal_timer_period_advance(&p_beacon->interval, time_ticks);
+            }
+        }
+    }
+}
+
+
+static int air_packet_compare(const void * p_a, const void * p_b)
+{
+    const air_packet_t * p_packet_a = p_a;
+    const air_packet_t * p_packet_b = p_b;
+
+    return ( (p_packet_a->start_ns > p_packet_b->start_ns) - (p_packet_a->start_ns < p_packet_b->start_ns) );
+}
+
+
+/* Marks the packets that overlap another one on the same channel, and counts the advertising
+   events of which the gateway receives at least one packet on the channel it scans. */
+static void air_receive(uint32_t count)
+{
+    uint64_t busy_end_ns[40] = {0};
+    uint32_t busy_packet[40] = {0};
+    uint32_t delivered_event[M_BEACONS_MAX];
+
+    qsort(mp_air, m_air_count, sizeof(mp_air[0]), air_packet_compare);
+    for ( uint32_t i = 0; i < m_air_count; ++i )
+    {
+        air_packet_t * p_packet = &mp_air[i];
+
+        if ( p_packet->start_ns < busy_end_ns[p_packet->channel] )
+        {
+            p_packet->collided = true;
+            mp_air[busy_packet[p_packet->channel]].collided = true;
+        }
+        if ( p_packet->end_ns > busy_end_ns[p_packet->channel] )
+        {
+            busy_end_ns[p_packet->channel] = p_packet->end_ns;
+            busy_packet[p_packet->channel] = i;
+        }
+    }
+
+    for ( uint32_t i = 0; i < count; ++i )
+    {
+        delivered_event[i] = UINT32_MAX;
+    }
+    for ( uint32_t i = 0; i < m_air_count; ++i )
+    {
+        const air_packet_t * p_packet = &mp_air[i];
+        uint64_t             window   = p_packet->start_ns / M_SCAN_WINDOW_NS;
+        uint8_t              scanned  = (uint8_t)(37 + window % 3);
+
+        if ( (p_packet->channel == scanned)
+        &&   (p_packet->end_ns / M_SCAN_WINDOW_NS == window)
+        &&   !p_packet->collided
+        &&   (delivered_event[p_packet->beacon] != p_packet->event) )
+        {
+            delivered_event[p_packet->beacon] = p_packet->event;
+            ++m_beacons[p_packet->beacon].delivered;
+        }
+    }
+}
+
+
+/* Simulates a deployment of the specified number of beacons, and gets the mean and the worst delivery ratio. */
+static void deployment_run(uint32_t count, bool adv_delay, bool list, double * p_mean, double * p_worst)
+{
+    double sum = 0;
+
+    air_fill(count, adv_delay);
+    air_receive(count);
+
+    *p_worst = 1.0;
+    for ( uint32_t i = 0; i < count; ++i )
+    {
+        double ratio = (double)m_beacons[i].delivered / m_beacons[i].events;
+
+        sum     += ratio;
+        *p_worst = (ratio < *p_worst) ? ratio : *p_worst;
+        if ( list )
+        {
+            printf("  beacon %2u  drift %+6.1f ppm  power-up %4.2f ms  %5u events  %5.1f%% delivered\n", i,
+                   m_beacons[i].drift_ppb / 1000.0, m_beacons[i].powerup_ns / 1e6, m_beacons[i].events, ratio * 100);
+        }
+    }
+    *p_mean = sum / count;
+}
+
+
+int main(void)
+{
+    static const uint32_t counts[] = { M_BEACONS_LISTED, 50, M_BEACONS_MAX };
+    uint32_t              adv_delay_state;
+
+    sim_init();
+#ifdef SENSOR_BEACON_BACKEND_LPS25H
+    lps25h_model_init(LPS25H_MODEL_PIN_NONE);
+#endif
+    template_take();
+    printf("%s: advertising event of", TEST_NAME);
+    for ( uint32_t k = 0; k < M_PACKETS_PER_EVENT; ++k )
+    {
+        printf(" channel %u at %.1f us for %.1f us,", m_template[k].channel, m_template[k].offset_ns / 1e3,
+               m_template[k].duration_ns / 1e3);
+    }
+    printf(" every %u ms plus up to %u ms advDelay\n", INTERVAL_US / 1000, ADV_DELAY_MAX_US / 1000);
+
+    // The seed matches the one the firmware takes from FICR.
+    adv_delay_init();
+    adv_delay_state = m_adv_delay_state;
+    TEST_CHECK(adv_delay_state == adv_delay_seed_get((const uint32_t *)NRF_FICR->DEVICEADDR), "seed 0x%08x", adv_delay_state);
+
+    mp_air = malloc(sizeof(mp_air[0]) * M_BEACONS_MAX * M_PACKETS_PER_EVENT * (M_RUN_NS / (INTERVAL_US * 1000ULL) + 1));
+    TEST_CHECK(mp_air != NULL, "no memory");
+    if ( mp_air == NULL )
+    {
+        return ( test_result(TEST_NAME) );
+    }
+
+    for ( uint32_t n = 0; n < sizeof(counts) / sizeof(counts[0]); ++n )
+    {
+        double mean_without, worst_without, mean_with, worst_with;
+
+        beacons_place(counts[n]);
+        if ( counts[n] == M_BEACONS_LISTED )
+        {
+            printf("%u beacons without advDelay:\n", counts[n]);
+        }
+        deployment_run(counts[n], false, counts[n] == M_BEACONS_LISTED, &mean_without, &worst_without);
+        if ( counts[n] == M_BEACONS_LISTED )
+        {
+            printf("%u beacons with advDelay:\n", counts[n]);
+        }
+        deployment_run(counts[n], true, counts[n] == M_BEACONS_LISTED, &mean_with, &worst_with);
+
+        printf("%3u beacons for %llu s: delivered without advDelay %.1f%% mean, %.1f%% worst;"
+               " with advDelay %.1f%% mean, %.1f%% worst\n", counts[n], M_RUN_NS / 1000000000ULL,
+               mean_without * 100, worst_without * 100, mean_with * 100, worst_with * 100);
+
+        TEST_CHECK(worst_with > worst_without, "%u beacons: worst %.3f with advDelay, %.3f without", counts[n], worst_with, worst_without);
+        if ( counts[n] == M_BEACONS_LISTED )
+        {
+            TEST_CHECK(worst_with * 100 >= M_DELIVERY_MIN_PERCENT, "%u beacons: worst %.3f with advDelay", counts[n], worst_with);
+        }
+    }
+    free(mp_air);
+
+    return ( test_result(TEST_NAME) );
+}
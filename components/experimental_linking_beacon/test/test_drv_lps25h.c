@@ -0,0 +1,336 @@
+/* Copyright (c) Nordic Semiconductor ASA
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ *   1. Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ *   2. Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ *   3. Neither the name of Nordic Semiconductor ASA nor the names of other
+ *   contributors to this software may be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ * 
+ *   4. This software must only be used in a processor manufactured by Nordic
+ *   Semiconductor ASA, or in a processor manufactured by a third party that
+ *   is used in combination with a processor manufactured by Nordic Semiconductor.
+ * 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Runs drv_lps25h and hal_twi against the LPS25H model on the simulated TWIM. Checks that the
+   driver's copy of the control registers follows the device, including across BOOT and SWRESET,
+   which the device clears by itself, and that its accesses share the TWI transaction queue with
+   another device, which keeps the bus when the driver closes while it still has transactions queued. */
+
+#include "drv_lps25h.h"
+#include "drv_lps25h_bitfields.h"
+#include "hal_serial.h"
+#include "hal_twi.h"
+#include "lps25h_model.h"
+#include "sim.h"
+#include "test.h"
+
+
+#define M_LIMIT_NS          (10000000000ULL)
+#define M_CTRL1_PD          (DRV_LSP25H_CTRL_REG_PD_Active << DRV_LSP25H_CTRL_REG_PD_Pos)
+#define M_CTRL2_FIFO_EN     (DRV_LSP25H_CTRL_REG_FIFO_EN_Enabled << DRV_LSP25H_CTRL_REG_FIFO_EN_Pos)
+#define M_CTRL2_BOOT        (DRV_LSP25H_CTRL_REG_BOOT_Reboot << DRV_LSP25H_CTRL_REG_BOOT_Pos)
+#define M_CTRL2_SWRESET     (DRV_LSP25H_CTRL_REG_SWRESET_Reset << DRV_LSP25H_CTRL_REG_SWRESET_Pos)
+#define M_CTRL2_ONE_SHOT    (DRV_LSP25H_CTRL_REG_ONE_SHOT_Start << DRV_LSP25H_CTRL_REG_ONE_SHOT_Pos)
+#define M_CTRL4_P1_DRDY     (1UL << DRV_LSP25H_CTRL_REG_P1_DRDY_Pos)
+#define M_OTHER_ADDRESS     (0x40)
+
+
+static const hal_serial_cfg_t m_serial_cfg =
+{
+    .twi0.psel.scl = 27,
+    .twi0.psel.sda = 26,
+};
+
+
+static uint32_t          m_other_writes;
+static hal_twi_xfer_t    m_other_xfers[2];
+static volatile uint32_t m_other_xfers_done;
+
+
+/* Another device on the bus, which acknowledges everything. */
+static bool other_write(const uint8_t * p_data, uint32_t length)
+{
+    ++m_other_writes;
+    return ( true );
+}
+
+
+static bool other_read(uint8_t * p_data, uint32_t length)
+{
+    return ( true );
+}
+
+
+static const sim_twi_device_t m_other_device =
+{
+    .address = M_OTHER_ADDRESS,
+    .write   = other_write,
+    .read    = other_read,
+};
+
+
+static void other_xfer_callback(hal_twi_xfer_t * p_xfer, bool success)
+{
+    TEST_CHECK(success, "transaction of the other device failed");
+    ++m_other_xfers_done;
+}
+
+
+static void sleep_hook(void)
+{
+    __WFE();
+}
+
+
+static const drv_lps25h_cfg_t m_drv_lps25h_cfg =
+{
+    .twi_id            = HAL_TWI_ID_TWI0,
+    .twi_cfg.address   = (LPS25H_MODEL_ADDRESS << TWI_ADDRESS_ADDRESS_Pos),
+    .twi_cfg.frequency = (TWI_FREQUENCY_FREQUENCY_K400 << TWI_FREQUENCY_FREQUENCY_Pos),
+    .p_sleep_hook      = sleep_hook,
+};
+
+
+static void sensor_power_set(bool on)
+{
+    if ( on )
+    {
+        NRF_GPIO->OUTSET = (1 << 5) | (1 << 7) | (1 << 8);
+        NRF_GPIO->DIRSET = (1 << 5) | (1 << 7) | (1 << 8);
+    }
+    else
+    {
+        NRF_GPIO->DIRCLR = (1 << 5) | (1 << 7) | (1 << 8);
+        NRF_GPIO->OUTCLR = (1 << 5) | (1 << 7) | (1 << 8);
+    }
+}
+
+
+/* Opens the driver right after powering up the device, as the beacon does. */
+static void driver_open(void)
+{
+    sensor_power_set(true);
+    TEST_CHECK(drv_lps25h_open(&m_drv_lps25h_cfg) == DRV_LPS25H_STATUS_CODE_SUCCESS, "open failed");
+    TEST_CHECK(drv_lps25h_access_mode_set(DRV_LPS25H_ACCESS_MODE_CPU_INACTIVE) == DRV_LPS25H_STATUS_CODE_SUCCESS,
+               "access mode not set");
+    (void)drv_lps25h_ctrl_reg_reset_assume();
+}
+
+
+static void driver_close(void)
+{
+    TEST_CHECK(drv_lps25h_close() == DRV_LPS25H_STATUS_CODE_SUCCESS, "close failed");
+    sensor_power_set(false);
+}
+
+
+static void ctrl_reg_modify(uint32_t set_mask, uint32_t clr_mask)
+{
+    TEST_CHECK(drv_lps25h_ctrl_reg_modify(set_mask, clr_mask) == DRV_LPS25H_STATUS_CODE_SUCCESS,
+               "modify 0x%08x 0x%08x failed", set_mask, clr_mask);
+}
+
+
+/* Gets the four control registers of the device, CTRL_REG1 in the low byte. */
+static uint32_t model_ctrl_regs_get(void)
+{
+    return ( (uint32_t)lps25h_model_register_get(LPS25H_MODEL_REG_CTRL1)
+           | ((uint32_t)lps25h_model_register_get(LPS25H_MODEL_REG_CTRL2) << 8)
+           | ((uint32_t)lps25h_model_register_get(LPS25H_MODEL_REG_CTRL3) << 16)
+           | ((uint32_t)lps25h_model_register_get(LPS25H_MODEL_REG_CTRL4) << 24) );
+}
+
+
+/* The copy of the control registers saves the reads, and follows ONE_SHOT clearing itself. */
+static void shadow_test(void)
+{
+    driver_open();
+    lps25h_model_stats_clear();
+    
+    ctrl_reg_modify(M_CTRL1_PD | M_CTRL4_P1_DRDY, 0);
+    ctrl_reg_modify(M_CTRL2_ONE_SHOT, 0);
+    ctrl_reg_modify(M_CTRL2_FIFO_EN, 0);
+    ctrl_reg_modify(M_CTRL2_FIFO_EN, 0);
+    TEST_CHECK(model_ctrl_regs_get() == (M_CTRL1_PD | M_CTRL2_FIFO_EN | M_CTRL4_P1_DRDY), "control registers 0x%08x",
+               model_ctrl_regs_get());
+    TEST_CHECK(lps25h_model_stats_get()->reads == 0, "%u reads", lps25h_model_stats_get()->reads);
+    TEST_CHECK(lps25h_model_stats_get()->writes == 3, "%u writes", lps25h_model_stats_get()->writes);
+    
+    driver_close();
+}
+
+
+/* SWRESET resets the control registers of the device, so the driver shall not skip writing a bit
+   that it set before. */
+static void swreset_test(void)
+{
+    driver_open();
+    
+    ctrl_reg_modify(M_CTRL1_PD | M_CTRL2_FIFO_EN, 0);
+    lps25h_model_stats_clear();
+    ctrl_reg_modify(M_CTRL2_SWRESET, 0);
+    TEST_CHECK(lps25h_model_stats_get()->resets == 1, "%u resets", lps25h_model_stats_get()->resets);
+    TEST_CHECK(model_ctrl_regs_get() == 0, "control registers 0x%08x after SWRESET", model_ctrl_regs_get());
+    
+    ctrl_reg_modify(M_CTRL1_PD, 0);
+    TEST_CHECK(model_ctrl_regs_get() == M_CTRL1_PD, "control registers 0x%08x", model_ctrl_regs_get());
+    TEST_CHECK(lps25h_model_stats_get()->reads == 1, "%u reads", lps25h_model_stats_get()->reads);
+    TEST_CHECK(lps25h_model_stats_get()->resets == 1, "%u resets", lps25h_model_stats_get()->resets);
+    
+    driver_close();
+}
+
+
+/* BOOT clears itself, so the driver shall not write it again with the next modification of CTRL_REG2. */
+static void boot_test(void)
+{
+    driver_open();
+    
+    ctrl_reg_modify(M_CTRL1_PD, 0);
+    lps25h_model_stats_clear();
+    ctrl_reg_modify(M_CTRL2_BOOT, 0);
+    TEST_CHECK(lps25h_model_stats_get()->resets == 1, "%u resets", lps25h_model_stats_get()->resets);
+    
+    ctrl_reg_modify(M_CTRL2_FIFO_EN, 0);
+    ctrl_reg_modify(0, M_CTRL2_FIFO_EN);
+    TEST_CHECK(lps25h_model_stats_get()->resets == 1, "%u resets", lps25h_model_stats_get()->resets);
+    TEST_CHECK(model_ctrl_regs_get() == M_CTRL1_PD, "control registers 0x%08x", model_ctrl_regs_get());
+    
+    driver_close();
+}
+
+
+static bool twi_enabled(void)
+{
+    return ( (NRF_TWIM0->ENABLE & 0xF) == TWIM_ENABLE_ENABLE_Enabled );
+}
+
+
+/* Queues two writes of the other device, as its own driver would. */
+static void other_xfers_schedule(void)
+{
+    static uint8_t other_tx[2] = {0x01, 0x02};
+
+    for ( uint32_t i = 0; i < 2; i++ )
+    {
+        m_other_xfers[i] = (hal_twi_xfer_t)
+        {
+            .address   = M_OTHER_ADDRESS,
+            .frequency = (TWI_FREQUENCY_FREQUENCY_K100 << TWI_FREQUENCY_FREQUENCY_Pos),
+            .tx_length = sizeof(other_tx),
+            .p_tx      = other_tx,
+            .callback  = other_xfer_callback,
+        };
+    }
+    m_other_xfers[0].p_next = &(m_other_xfers[1]);
+    m_other_writes     = 0;
+    m_other_xfers_done = 0;
+
+    TEST_CHECK(hal_twi_xfer_schedule(HAL_TWI_ID_TWI0, &(m_other_xfers[0])) == HAL_TWI_STATUS_CODE_SUCCESS,
+               "transactions of the other device not queued");
+}
+
+
+/* Transactions of another device queued before a register read run first, back-to-back with it. */
+static void shared_bus_test(void)
+{
+    uint8_t status;
+
+    driver_open();
+    lps25h_model_stats_clear();
+    sim_stats_clear();
+
+    other_xfers_schedule();
+    TEST_CHECK(drv_lps25h_status_reg_get(&status) == DRV_LPS25H_STATUS_CODE_SUCCESS, "status not read");
+    TEST_CHECK((m_other_xfers_done == 2) && (m_other_writes == 2), "%u transactions, %u writes of the other device",
+               m_other_xfers_done, m_other_writes);
+    TEST_CHECK(lps25h_model_stats_get()->reads == 1, "%u reads", lps25h_model_stats_get()->reads);
+    TEST_CHECK(sim_stats_get()->twi_transfers == 3, "%u transfers", sim_stats_get()->twi_transfers);
+    TEST_CHECK(sim_stats_get()->isr_count[SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQn] == 3, "%u interrupts",
+               sim_stats_get()->isr_count[SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQn]);
+
+    // The driver address is set again for its own transaction.
+    ctrl_reg_modify(M_CTRL1_PD, 0);
+    TEST_CHECK(model_ctrl_regs_get() == M_CTRL1_PD, "control registers 0x%08x", model_ctrl_regs_get());
+
+    driver_close();
+    TEST_CHECK(!twi_enabled(), "peripheral not released");
+}
+
+
+/* The driver closes while the other device still has transactions queued. They run to the end on
+   the bus the queue holds, which is released after them. */
+static void shared_bus_close_test(void)
+{
+    uint8_t status;
+
+    driver_open();
+    TEST_CHECK(drv_lps25h_status_reg_get(&status) == DRV_LPS25H_STATUS_CODE_SUCCESS, "status not read");
+    other_xfers_schedule();
+    driver_close();
+    TEST_CHECK((m_other_xfers_done < 2) && twi_enabled(), "%u transactions of the other device done, bus %s",
+               m_other_xfers_done, twi_enabled() ? "held" : "released");
+
+    while ( m_other_xfers_done < 2 )
+    {
+        __WFE();
+    }
+    TEST_CHECK(m_other_writes == 2, "%u writes of the other device", m_other_writes);
+    TEST_CHECK(!twi_enabled(), "peripheral not released");
+
+    // The driver opens again on the released bus.
+    driver_open();
+    TEST_CHECK(drv_lps25h_status_reg_get(&status) == DRV_LPS25H_STATUS_CODE_SUCCESS, "status not read after");
+    driver_close();
+}
+
+
+static void test_entry(void)
+{
+    hal_serial_init(&m_serial_cfg);
+    hal_twi_init();
+    drv_lps25h_init();
+    
+    shadow_test();
+    swreset_test();
+    boot_test();
+    shared_bus_test();
+    shared_bus_close_test();
+}
+
+
+int main(void)
+{
+    sim_exit_t exit_reason;
+    
+    sim_init();
+    lps25h_model_init(LPS25H_MODEL_PIN_NONE);
+    sim_twi_device_add(&m_other_device);
+    
+    exit_reason = sim_run(test_entry, M_LIMIT_NS);
+    TEST_CHECK(exit_reason == SIM_EXIT_RETURNED, "exit %d", exit_reason);
+    TEST_CHECK(lps25h_model_stats_get()->nacks == 0, "%u transfers not acknowledged", lps25h_model_stats_get()->nacks);
+    
+    return ( test_result("test_drv_lps25h") );
+}
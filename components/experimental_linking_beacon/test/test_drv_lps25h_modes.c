@@ -0,0 +1,417 @@
+/* Copyright (c) Nordic Semiconductor ASA
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ *   1. Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ *   2. Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ *   3. Neither the name of Nordic Semiconductor ASA nor the names of other
+ *   contributors to this software may be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ * 
+ *   4. This software must only be used in a processor manufactured by Nordic
+ *   Semiconductor ASA, or in a processor manufactured by a third party that
+ *   is used in combination with a processor manufactured by Nordic Semiconductor.
+ * 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Compares the measurement modes of the LPS25H for the beacon: a one-shot measurement against
+   the continuous 25 Hz mode with the FIFO mean of 2, 4 and 8 samples, and polling the status
+   against sleeping until the data-ready signal. Each mode takes a series of samples with the
+   schedule of sensor_beacon.c, i.e. power up, set up, wait until both values are available, read
+   them and power down. The model adds noise to every measurement. Prints the bus transactions,
+   the wake-ups, the active times, the charge and the noise per sample, and checks that a FIFO mean
+   averages its samples, that the one-shot measurement costs the least, and that the data-ready
+   signal saves the polls. */
+
+#include "drv_lps25h.h"
+#include "drv_lps25h_bitfields.h"
+#include "hal_serial.h"
+#include "hal_timer.h"
+#include "hal_twi.h"
+#include "lps25h_model.h"
+#include "sim.h"
+#include "test.h"
+#include "energy.h"
+
+#include <math.h>
+
+
+#define M_LIMIT_NS              (1000000000000ULL)
+#define M_SAMPLE_COUNT          (64)
+#define M_SAMPLE_PERIOD_US      (1000000)
+#define M_TEMPERATURE_MILLI_DEG (21500)
+#define M_PRESSURE_PA           (101325)
+#define M_TEMPERATURE_NOISE     (500)           /* The noise amplitude of one measurement in millidegrees, above the 0.1 degree driver resolution. */
+#define M_PRESSURE_NOISE        (30)            /* The noise amplitude of one measurement in Pa. */
+#define M_MODE_ONE_SHOT         (0xFF)          /* The mode without the FIFO mean. */
+#define M_DRDY_PIN              (2)
+
+/* The sensor schedule of sensor_beacon.c. */
+#define M_POWERUP_TIME_US       (10000)
+#define M_ONE_SHOT_READ_TIME_US (40000)
+#define M_FIFO_MEAN_PERIOD_US   (40000)
+#define M_RETRY_INTERVAL_US     (10000)
+#define M_RETRY_COUNT           (10)
+
+#define M_CTRL1_PD              (DRV_LSP25H_CTRL_REG_PD_Active << DRV_LSP25H_CTRL_REG_PD_Pos)
+#define M_CTRL1_ODR_25HZ        (DRV_LSP25H_CTRL_REG_ODR_25HZ0 << DRV_LSP25H_CTRL_REG_ODR_Pos)
+#define M_CTRL2_ONE_SHOT        (DRV_LSP25H_CTRL_REG_ONE_SHOT_Start << DRV_LSP25H_CTRL_REG_ONE_SHOT_Pos)
+#define M_CTRL4_P1_DRDY         (DRV_LSP25H_CTRL_REG_P1_DRDY_Enabled << DRV_LSP25H_CTRL_REG_P1_DRDY_Pos)
+#define M_STATUS_DA             ((DRV_LSP25H_STATUS_REG_T_DA_Available << DRV_LSP25H_STATUS_REG_T_DA_Pos) | \
+                                 (DRV_LSP25H_STATUS_REG_P_DA_Available << DRV_LSP25H_STATUS_REG_P_DA_Pos))
+
+
+/* The cost and the result of one mode, per sample. */
+typedef struct
+{
+    const char * p_name;
+    uint8_t      wtm_point;         ///< The FIFO mean watermark, or M_MODE_ONE_SHOT.
+    bool         drdy;              ///< Sleep until the data-ready signal instead of polling.
+    uint32_t     samples;           ///< The samples read.
+    double       transfers;         ///< TWI transfers.
+    double       twi_us;            ///< TWI active time.
+    double       cpu_us;            ///< CPU time.
+    double       wakeups;           ///< CPU wake-ups.
+    double       latency_us;        ///< The time from powering up until reading the values.
+    double       converting_us;     ///< Sensor converting time.
+    double       powered_us;        ///< Sensor powered time.
+    double       charge_uc;         ///< Charge above the sleep current.
+    double       temperature_sd;    ///< Standard deviation of the temperature in millidegrees.
+    double       pressure_sd;       ///< Standard deviation of the air pressure in Pa.
+} mode_result_t;
+
+
+enum
+{
+    MODE_ONE_SHOT,
+    MODE_FIFO_MEAN_2,
+    MODE_FIFO_MEAN_4,
+    MODE_FIFO_MEAN_8,
+    MODE_ONE_SHOT_DRDY,
+    MODE_COUNT
+};
+
+static mode_result_t m_modes[MODE_COUNT] =
+{
+    [MODE_ONE_SHOT]      = { .p_name = "one-shot",    .wtm_point = M_MODE_ONE_SHOT },
+    [MODE_FIFO_MEAN_2]   = { .p_name = "FIFO mean 2", .wtm_point = DRV_LSP25H_FIFO_CTRL_WTM_POINT_Mean2 },
+    [MODE_FIFO_MEAN_4]   = { .p_name = "FIFO mean 4", .wtm_point = DRV_LSP25H_FIFO_CTRL_WTM_POINT_Mean4 },
+    [MODE_FIFO_MEAN_8]   = { .p_name = "FIFO mean 8", .wtm_point = DRV_LSP25H_FIFO_CTRL_WTM_POINT_Mean8 },
+    [MODE_ONE_SHOT_DRDY] = { .p_name = "one-shot DRDY", .wtm_point = M_MODE_ONE_SHOT, .drdy = true },
+};
+
+static const hal_serial_cfg_t m_serial_cfg =
+{
+    .twi0.psel.scl = 27,
+    .twi0.psel.sda = 26,
+};
+
+static volatile bool m_expired;
+static volatile bool m_drdy;
+
+
+void RTC0_IRQHandler(void)
+{
+    if ( hal_timer_isr_handler() )
+    {
+        m_expired = true;
+    }
+}
+
+
+void GPIOTE_IRQHandler(void)
+{
+    if ( drv_lps25h_drdy_isr_handler() )
+    {
+        m_drdy = true;
+    }
+}
+
+
+static void sleep_hook(void)
+{
+    __WFE();
+}
+
+
+static const drv_lps25h_cfg_t m_drv_lps25h_cfg =
+{
+    .twi_id            = HAL_TWI_ID_TWI0,
+    .twi_cfg.address   = (LPS25H_MODEL_ADDRESS << TWI_ADDRESS_ADDRESS_Pos),
+    .twi_cfg.frequency = (TWI_FREQUENCY_FREQUENCY_K400 << TWI_FREQUENCY_FREQUENCY_Pos),
+    .p_sleep_hook      = sleep_hook,
+};
+
+
+static const drv_lps25h_cfg_t m_drv_lps25h_drdy_cfg =
+{
+    .twi_id              = HAL_TWI_ID_TWI0,
+    .twi_cfg.address     = (LPS25H_MODEL_ADDRESS << TWI_ADDRESS_ADDRESS_Pos),
+    .twi_cfg.frequency   = (TWI_FREQUENCY_FREQUENCY_K400 << TWI_FREQUENCY_FREQUENCY_Pos),
+    .p_sleep_hook        = sleep_hook,
+    .drdy_wakeup_enabled = true,
+    .drdy_pin            = M_DRDY_PIN,
+};
+
+
+static void sleep_until(uint64_t deadline_ticks)
+{
+    m_expired = false;
+    hal_timer_deadline_set(deadline_ticks);
+    while ( !m_expired )
+    {
+        __WFE();
+    }
+}
+
+
+/* Sleeps until the data-ready signal, or at the latest until the specified point in time. */
+static void sleep_until_drdy(uint64_t deadline_ticks)
+{
+    m_expired = false;
+    hal_timer_deadline_set(deadline_ticks);
+    while ( !m_expired && !m_drdy )
+    {
+        __WFE();
+    }
+    hal_timer_deadline_cancel();
+}
+
+
+static void sensor_power_set(bool on)
+{
+    if ( on )
+    {
+        NRF_GPIO->OUTSET = (1 << 5) | (1 << 7) | (1 << 8);
+        NRF_GPIO->DIRSET = (1 << 5) | (1 << 7) | (1 << 8);
+    }
+    else
+    {
+        NRF_GPIO->DIRCLR = (1 << 5) | (1 << 7) | (1 << 8);
+        NRF_GPIO->OUTCLR = (1 << 5) | (1 << 7) | (1 << 8);
+    }
+}
+
+
+/* Sets up the measurement right after powering up the device, as the beacon does. */
+static bool measurement_setup(const mode_result_t * p_mode)
+{
+    uint32_t drdy_mask = p_mode->drdy ? M_CTRL4_P1_DRDY : 0;
+
+    m_drdy = false;
+    if ( drv_lps25h_open(p_mode->drdy ? &m_drv_lps25h_drdy_cfg : &m_drv_lps25h_cfg) != DRV_LPS25H_STATUS_CODE_SUCCESS )
+    {
+        return ( false );
+    }
+    (void)drv_lps25h_access_mode_set(DRV_LPS25H_ACCESS_MODE_CPU_INACTIVE);
+    (void)drv_lps25h_ctrl_reg_reset_assume();
+    if ( p_mode->wtm_point == M_MODE_ONE_SHOT )
+    {
+        (void)drv_lps25h_ctrl_reg_modify(M_CTRL1_PD | M_CTRL2_ONE_SHOT | drdy_mask, 0);
+    }
+    else
+    {
+        (void)drv_lps25h_fifo_mean_mode_set(p_mode->wtm_point);
+        (void)drv_lps25h_ctrl_reg_modify(M_CTRL1_PD | M_CTRL1_ODR_25HZ | drdy_mask, 0);
+    }
+
+    return ( true );
+}
+
+
+/* Takes one sample starting at the specified point in time. Returns false if none was available.
+   With the data-ready signal there is one read attempt, at the signal or at the end of the polling
+   window. */
+static bool sample_take(const mode_result_t * p_mode, uint64_t start_ticks, int32_t * p_temperature, uint32_t * p_pressure,
+                        uint64_t * p_latency_ns)
+{
+    uint32_t first_read_us = (p_mode->wtm_point == M_MODE_ONE_SHOT)
+                           ? M_ONE_SHOT_READ_TIME_US
+                           : (M_POWERUP_TIME_US + (p_mode->wtm_point + 1) * M_FIFO_MEAN_PERIOD_US);
+    uint64_t deadline      = start_ticks + HAL_TIMER_US_TO_TICKS_ROUNDUP(first_read_us);
+    uint32_t attempts      = p_mode->drdy ? 1 : M_RETRY_COUNT;
+    bool     available     = false;
+
+    uint64_t powerup_ns;
+
+    sleep_until(start_ticks);
+    powerup_ns = sim_now_ns();
+    sensor_power_set(true);
+    sleep_until(start_ticks + HAL_TIMER_US_TO_TICKS_ROUNDUP(M_POWERUP_TIME_US));
+    if ( measurement_setup(p_mode) )
+    {
+        if ( p_mode->drdy )
+        {
+            deadline += (M_RETRY_COUNT - 1) * HAL_TIMER_US_TO_TICKS_ROUNDUP(M_RETRY_INTERVAL_US);
+        }
+        for ( uint32_t retry = 0; (retry < attempts) && !available; ++retry )
+        {
+            uint8_t status = 0;
+
+            if ( p_mode->drdy )
+            {
+                sleep_until_drdy(deadline);
+            }
+            else
+            {
+                sleep_until(deadline);
+            }
+            (void)drv_lps25h_status_reg_get(&status);
+            available = ((status & M_STATUS_DA) == M_STATUS_DA);
+            deadline += HAL_TIMER_US_TO_TICKS_ROUNDUP(M_RETRY_INTERVAL_US);
+        }
+        if ( available )
+        {
+            (void)drv_lps25h_outputs_get(p_temperature, p_pressure);
+            *p_latency_ns = sim_now_ns() - powerup_ns;
+        }
+        (void)drv_lps25h_close();
+    }
+    sensor_power_set(false);
+
+    return ( available );
+}
+
+
+/* Takes the samples of one mode and sums up its cost. */
+static void mode_run(mode_result_t * p_mode)
+{
+    const sim_stats_t          * p_stats  = sim_stats_get();
+    const lps25h_model_stats_t * p_sensor = lps25h_model_stats_get();
+    uint32_t                     samples  = (p_mode->wtm_point == M_MODE_ONE_SHOT) ? 1 : (p_mode->wtm_point + 1U);
+    uint64_t                     start    = hal_timer_ticks_get() + HAL_TIMER_US_TO_TICKS(M_SAMPLE_PERIOD_US);
+    uint64_t                     start_ns;
+    uint64_t                     latency_ns = 0;
+    double                       temperature_sum = 0, temperature_sq = 0, pressure_sum = 0, pressure_sq = 0;
+
+    sleep_until(start);
+    start   += HAL_TIMER_US_TO_TICKS(M_SAMPLE_PERIOD_US);
+    start_ns = sim_now_ns();
+    sim_stats_clear();
+    lps25h_model_stats_clear();
+
+    for ( uint32_t i = 0; i < M_SAMPLE_COUNT; ++i )
+    {
+        int32_t  temperature;
+        uint32_t pressure;
+        uint64_t latency;
+
+        if ( sample_take(p_mode, start + (uint64_t)i * HAL_TIMER_US_TO_TICKS(M_SAMPLE_PERIOD_US), &temperature, &pressure, &latency) )
+        {
+            ++p_mode->samples;
+            latency_ns      += latency;
+            temperature_sum += temperature;
+            temperature_sq  += (double)temperature * temperature;
+            pressure_sum    += pressure;
+            pressure_sq     += (double)pressure * pressure;
+        }
+        TEST_CHECK(p_sensor->mean_samples == samples, "%s: %u samples in the mean", p_mode->p_name, p_sensor->mean_samples);
+    }
+    sleep_until(start + (uint64_t)M_SAMPLE_COUNT * HAL_TIMER_US_TO_TICKS(M_SAMPLE_PERIOD_US));
+
+    TEST_CHECK(p_mode->samples == M_SAMPLE_COUNT, "%s: %u samples", p_mode->p_name, p_mode->samples);
+    TEST_CHECK(p_sensor->conversions == samples * M_SAMPLE_COUNT, "%s: %u conversions", p_mode->p_name, p_sensor->conversions);
+    if ( p_mode->wtm_point == M_MODE_ONE_SHOT )
+    {
+        TEST_CHECK(p_sensor->overruns == 0, "%s: %u overruns", p_mode->p_name, p_sensor->overruns);
+    }
+    if ( p_mode->samples == 0 )
+    {
+        return;
+    }
+
+    p_mode->transfers      = (double)p_stats->twi_transfers / p_mode->samples;
+    p_mode->twi_us         = (double)p_stats->time.twi_ns / 1000 / p_mode->samples;
+    p_mode->cpu_us         = (double)p_stats->time.cpu_ns / 1000 / p_mode->samples;
+    p_mode->wakeups        = (double)p_stats->wakeups / p_mode->samples;
+    p_mode->latency_us     = (double)latency_ns / 1000 / p_mode->samples;
+    p_mode->converting_us  = (double)p_stats->time.device_ns / 1000 / p_mode->samples;
+    p_mode->powered_us     = (double)p_sensor->powered_ns / 1000 / p_mode->samples;
+    p_mode->charge_uc      = (double)(energy_average_current_na(&p_stats->time, sim_now_ns() - start_ns) - ENERGY_CURRENT_SLEEP_NA)
+                           * (sim_now_ns() - start_ns) / 1e12 / p_mode->samples;
+    temperature_sum       /= p_mode->samples;
+    pressure_sum          /= p_mode->samples;
+    p_mode->temperature_sd = sqrt(temperature_sq / p_mode->samples - temperature_sum * temperature_sum);
+    p_mode->pressure_sd    = sqrt(pressure_sq / p_mode->samples - pressure_sum * pressure_sum);
+}
+
+
+static void test_entry(void)
+{
+    hal_serial_init(&m_serial_cfg);
+    hal_twi_init();
+    drv_lps25h_init();
+    hal_timer_start();
+
+    for ( uint32_t i = 0; i < MODE_COUNT; ++i )
+    {
+        mode_run(&m_modes[i]);
+    }
+}
+
+
+int main(void)
+{
+    const mode_result_t * p_polling = &m_modes[MODE_ONE_SHOT];
+    const mode_result_t * p_drdy    = &m_modes[MODE_ONE_SHOT_DRDY];
+    sim_exit_t            exit_reason;
+
+    sim_init();
+    lps25h_model_init(M_DRDY_PIN);
+    lps25h_model_values_set(M_TEMPERATURE_MILLI_DEG, M_PRESSURE_PA);
+    lps25h_model_noise_set(M_TEMPERATURE_NOISE, M_PRESSURE_NOISE);
+
+    exit_reason = sim_run(test_entry, M_LIMIT_NS);
+    TEST_CHECK(exit_reason == SIM_EXIT_RETURNED, "exit %d", exit_reason);
+    TEST_CHECK(lps25h_model_stats_get()->nacks == 0, "%u transfers not acknowledged", lps25h_model_stats_get()->nacks);
+
+    printf("per sample:     transfers  twi us  cpu us  wake-ups  latency us  converting us  powered us  charge uC"
+           "  temp sd mC  press sd Pa\n");
+    for ( uint32_t i = 0; i < MODE_COUNT; ++i )
+    {
+        const mode_result_t * p_mode = &m_modes[i];
+
+        printf("%-14s  %9.1f  %6.1f  %6.1f  %8.1f  %10.0f  %13.0f  %10.0f  %9.2f  %10.1f  %11.1f\n", p_mode->p_name,
+               p_mode->transfers, p_mode->twi_us, p_mode->cpu_us, p_mode->wakeups, p_mode->latency_us,
+               p_mode->converting_us, p_mode->powered_us, p_mode->charge_uc, p_mode->temperature_sd, p_mode->pressure_sd);
+    }
+
+    /* Each FIFO mean converts and stays powered longer than the mode before it, and averages out
+       the noise by the square root of its samples. */
+    for ( uint32_t i = MODE_FIFO_MEAN_2; i <= MODE_FIFO_MEAN_8; ++i )
+    {
+        TEST_CHECK(m_modes[i].charge_uc > m_modes[i - 1].charge_uc, "%s: %.2f uC", m_modes[i].p_name, m_modes[i].charge_uc);
+        TEST_CHECK(m_modes[i].powered_us > m_modes[i - 1].powered_us, "%s: powered %.0f us", m_modes[i].p_name, m_modes[i].powered_us);
+    }
+    TEST_CHECK(m_modes[MODE_FIFO_MEAN_8].temperature_sd * 2 < m_modes[MODE_ONE_SHOT].temperature_sd,
+               "temperature noise %.1f, one-shot %.1f", m_modes[MODE_FIFO_MEAN_8].temperature_sd, m_modes[MODE_ONE_SHOT].temperature_sd);
+    TEST_CHECK(m_modes[MODE_FIFO_MEAN_8].pressure_sd * 2 < m_modes[MODE_ONE_SHOT].pressure_sd,
+               "pressure noise %.1f, one-shot %.1f", m_modes[MODE_FIFO_MEAN_8].pressure_sd, m_modes[MODE_ONE_SHOT].pressure_sd);
+
+    /* The data-ready signal wakes up once for a single status read as soon as the conversion is done,
+       where polling from the first read time takes one read attempt more. */
+    TEST_CHECK(p_drdy->wakeups < p_polling->wakeups, "%.1f wake-ups, polling %.1f", p_drdy->wakeups, p_polling->wakeups);
+    TEST_CHECK(p_drdy->transfers < p_polling->transfers, "%.1f transfers, polling %.1f", p_drdy->transfers, p_polling->transfers);
+    TEST_CHECK(p_drdy->latency_us < p_polling->latency_us, "latency %.0f us, polling %.0f us", p_drdy->latency_us, p_polling->latency_us);
+    TEST_CHECK(p_drdy->charge_uc < p_polling->charge_uc, "%.2f uC, polling %.2f uC", p_drdy->charge_uc, p_polling->charge_uc);
+
+    return ( test_result("test_drv_lps25h_modes") );
+}
@@ -0,0 +1,190 @@
+/* Copyright (c) Nordic Semiconductor ASA
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ *   1. Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ *   2. Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ *   3. Neither the name of Nordic Semiconductor ASA nor the names of other
+ *   contributors to this software may be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ * 
+ *   4. This software must only be used in a processor manufactured by Nordic
+ *   Semiconductor ASA, or in a processor manufactured by a third party that
+ *   is used in combination with a processor manufactured by Nordic Semiconductor.
+ * 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Runs hal_nvm_counter on the simulated flash. Checks that the value survives resets across page
+   switches with one erase per page switch, and injects a power failure at every flash operation
+   around a page switch to check that no completed update is lost. */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "hal_nvm_counter.h"
+#include "sim.h"
+#include "test.h"
+
+
+#define M_LIMIT_NS          (100000000000ULL)
+#define M_PAGES_BASE        ((SIM_FLASH_PAGES - 2) * SIM_FLASH_PAGE_SIZE)
+#define M_PAGES_SIZE        (2 * SIM_FLASH_PAGE_SIZE)
+#define M_RECORDS_PER_PAGE  ((SIM_FLASH_PAGE_SIZE / 4 - 2) / 2)
+#define M_FAIL_WINDOW       (12)    ///< Flash operations covering a full page, a page switch with an erase and the next update.
+#define M_FAIL_SEEDS        (20)
+
+
+static uint32_t          m_updates;     ///< The number of increments to do in the next run.
+static volatile uint32_t m_read;        ///< The value found by the init of the last run.
+static volatile uint32_t m_attempt;     ///< The value being stored.
+static volatile uint32_t m_done;        ///< The last value stored.
+static uint8_t           m_snapshot[M_PAGES_SIZE];
+
+
+/* Boots, reads the counter and increments it m_updates times. */
+static void boot_entry(void)
+{
+    hal_nvm_counter_init();
+    m_read = hal_nvm_counter_get();
+    m_done = m_read;
+
+    for ( uint32_t i = 0; i < m_updates; ++i )
+    {
+        m_attempt = m_done + 1;
+        hal_nvm_counter_set(m_attempt);
+        m_done = m_attempt;
+    }
+}
+
+
+static sim_exit_t boot(uint32_t updates)
+{
+    m_updates = updates;
+    sim_reset();
+    return ( sim_run(boot_entry, M_LIMIT_NS) );
+}
+
+
+static void pages_erase(void)
+{
+    memset(sim_flash_word(M_PAGES_BASE), 0xFF, M_PAGES_SIZE);
+}
+
+
+/* Counts up across four page starts, two of which erase a page. */
+static void wear_test(void)
+{
+    uint32_t updates = 3 * M_RECORDS_PER_PAGE + 7;
+    uint32_t expected_writes;
+
+    pages_erase();
+    TEST_CHECK(boot(0) == SIM_EXIT_RETURNED, "boot failed");
+    TEST_CHECK(m_read == 0, "erased pages read %u", m_read);
+
+    TEST_CHECK(boot(updates) == SIM_EXIT_RETURNED, "boot failed");
+    expected_writes = 2 * updates + 2 * 4;
+    TEST_CHECK(sim_stats_get()->flash_erases == 2, "%u erases", sim_stats_get()->flash_erases);
+    TEST_CHECK(sim_stats_get()->flash_writes == expected_writes, "%u writes, expected %u",
+               sim_stats_get()->flash_writes, expected_writes);
+    TEST_CHECK(sim_stats_get()->flash_violations == 0, "%u violations", sim_stats_get()->flash_violations);
+
+    TEST_CHECK(boot(1) == SIM_EXIT_RETURNED, "boot failed");
+    TEST_CHECK(m_read == updates, "read %u after %u updates", m_read, updates);
+    TEST_CHECK(boot(0) == SIM_EXIT_RETURNED, "boot failed");
+    TEST_CHECK(m_read == updates + 1, "read %u, expected %u", m_read, updates + 1);
+}
+
+
+/* The largest value reads back, unlike an erased word. */
+static void max_value_entry(void)
+{
+    hal_nvm_counter_init();
+    hal_nvm_counter_set(0xFFFFFFFF);
+    hal_nvm_counter_init();
+    m_read = hal_nvm_counter_get();
+}
+
+
+static void max_value_test(void)
+{
+    pages_erase();
+    sim_reset();
+    TEST_CHECK(sim_run(max_value_entry, M_LIMIT_NS) == SIM_EXIT_RETURNED, "run failed");
+    TEST_CHECK(m_read == 0xFFFFFFFF, "read 0x%08x", m_read);
+}
+
+
+/* Cuts the power at each flash operation from a state where page 0 is full, page 1 has one free
+   record and page 0 is erased by the second next update. After the failure, the counter holds the
+   last completed value or the one being stored, and counts on from there. */
+static void power_fail_test(void)
+{
+    uint32_t failures = 0;
+
+    pages_erase();
+    TEST_CHECK(boot(2 * M_RECORDS_PER_PAGE - 1) == SIM_EXIT_RETURNED, "boot failed");
+    memcpy(m_snapshot, sim_flash_word(M_PAGES_BASE), M_PAGES_SIZE);
+
+    for ( uint32_t seed = 1; seed <= M_FAIL_SEEDS; ++seed )
+    {
+        srand(seed);
+        for ( uint32_t operation = 1; operation <= M_FAIL_WINDOW; ++operation )
+        {
+            sim_exit_t exit_reason;
+            uint32_t   done;
+            uint32_t   attempt;
+
+            memcpy(sim_flash_word(M_PAGES_BASE), m_snapshot, M_PAGES_SIZE);
+            sim_flash_power_fail_set(operation);
+            exit_reason = boot(4);
+            sim_flash_power_fail_set(0);
+            if ( exit_reason != SIM_EXIT_POWER_FAIL )
+            {
+                TEST_CHECK(exit_reason == SIM_EXIT_RETURNED, "exit %d", exit_reason);
+                continue;
+            }
+            ++failures;
+            done    = m_done;
+            attempt = m_attempt;
+
+            TEST_CHECK(boot(1) == SIM_EXIT_RETURNED, "boot failed");
+            TEST_CHECK((m_read == done) || (m_read == attempt), "seed %u, operation %u: read %u after %u, storing %u",
+                       seed, operation, m_read, done, attempt);
+            TEST_CHECK(boot(0) == SIM_EXIT_RETURNED, "boot failed");
+            TEST_CHECK(m_read == m_done, "seed %u, operation %u: read %u, stored %u", seed, operation, m_read,
+                       m_done);
+        }
+    }
+
+    TEST_CHECK(failures == M_FAIL_SEEDS * (M_FAIL_WINDOW - 1), "%u power failures", failures);
+}
+
+
+int main(void)
+{
+    sim_init();
+
+    wear_test();
+    max_value_test();
+    power_fail_test();
+
+    return ( test_result("test_hal_nvm_counter") );
+}
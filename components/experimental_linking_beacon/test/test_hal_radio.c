@@ -0,0 +1,234 @@
+/* Copyright (c) Nordic Semiconductor ASA
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ *   1. Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ *   2. Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ *   3. Neither the name of Nordic Semiconductor ASA nor the names of other
+ *   contributors to this software may be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ * 
+ *   4. This software must only be used in a processor manufactured by Nordic
+ *   Semiconductor ASA, or in a processor manufactured by a third party that
+ *   is used in combination with a processor manufactured by Nordic Semiconductor.
+ * 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Runs chains of advertising packets of hal_radio_send_chained() on the register-level radio and
+   PPI models. Checks the channel and whitening of each packet, the gap between the packets, that
+   the CPU is woken up once per packet but the last, and that the end task (HFCLKSTOP) is
+   triggered by the last packet and leaves the PPI channels of the chain disabled. */
+
+#include "hal_clock.h"
+#include "hal_radio.h"
+#include "sim.h"
+#include "test.h"
+
+#include <string.h>
+
+
+#define M_LIMIT_NS          (1000000000ULL)
+
+/* The gap between the END event of a packet and the start of the next one: the radio disables
+   and ramps up again, see the radio model of sim.c. */
+#define M_GAP_NS            (6000 + 140000)
+#define M_GAP_SLACK_NS      (2000)
+
+/* The DISABLED event follows the END event of the last packet by the disable time. */
+#define M_DISABLE_NS        (6000)
+
+
+static volatile bool m_hfclk_started;
+static volatile bool m_radio_done;
+
+static uint8_t       m_pdu[3 + 37];
+static uint8_t       m_channels[HAL_RADIO_CHAIN_COUNT_MAX] = { 37, 38, 39 };
+static uint8_t       m_count;
+static uint32_t      m_end_task;
+static uint32_t      m_packets_before;
+static uint64_t      m_sent_at;
+static uint32_t      m_wakeups_sent;
+static uint32_t      m_isr_sent;
+static uint32_t      m_chen;
+static uint32_t      m_state;
+
+
+void POWER_CLOCK_IRQHandler(void)
+{
+    if ( hal_clock_isr_handler() )
+    {
+        m_hfclk_started = true;
+    }
+}
+
+
+void RADIO_IRQHandler(void)
+{
+    if ( hal_radio_isr_handler() )
+    {
+        m_radio_done = true;
+    }
+}
+
+
+static uint8_t frequency_of(uint8_t channel_index)
+{
+    return ( (channel_index == 37) ? 2 : ((channel_index == 38) ? 26 : 80) );
+}
+
+
+/* Starts the HF clock, sends the chain and returns when hal_radio_isr_handler() reports it done. */
+static void chain_entry(void)
+{
+    hal_clock_hfclk_enable();
+    hal_clock_hfclk_started_irq_enable();
+    m_hfclk_started = false;
+    while ( !m_hfclk_started )
+    {
+        __WFE();
+    }
+    
+    sim_stats_clear();
+    (void)sim_packets_get(&m_packets_before);
+    m_sent_at    = sim_now_ns();
+    m_radio_done = false;
+    
+    hal_radio_send_chained(m_pdu, m_channels, m_count, m_end_task);
+    while ( !m_radio_done )
+    {
+        __WFE();
+    }
+    
+    m_wakeups_sent = sim_stats_get()->wakeups;
+    m_isr_sent     = sim_stats_get()->isr_count[RADIO_IRQn];
+}
+
+
+/* Sleeps until nothing is left that could wake up the CPU. */
+static void sleep_entry(void)
+{
+    for ( ;; )
+    {
+        __WFE();
+    }
+}
+
+
+static void registers_entry(void)
+{
+    m_chen  = NRF_PPI->CHEN;
+    m_state = NRF_RADIO->STATE;
+}
+
+
+static void chain_run(uint8_t count, bool end_task)
+{
+    const sim_packet_t * p_log;
+    const sim_stats_t  * p_stats = sim_stats_get();
+    uint32_t             packets;
+    sim_exit_t           exit_reason;
+    uint32_t             chain_mask = (1UL << HAL_RADIO_PPI_CH_REENABLE) | (1UL << HAL_RADIO_PPI_CH_LAST_READY) |
+                                      (1UL << HAL_RADIO_PPI_CH_END);
+#ifndef NRF52
+    chain_mask |= (1UL << HAL_RADIO_PPI_CH_LAST_READY_ARM) | (1UL << HAL_RADIO_PPI_CH_END_DISARM);
+#endif
+    
+    m_count    = count;
+    m_end_task = end_task ? hal_clock_hfclk_disable_task_get() : 0;
+    for ( uint32_t i = 0; i < sizeof(m_pdu); ++i )
+    {
+        m_pdu[i] = (uint8_t)(count * 16 + i);
+    }
+    m_pdu[1] = 37;
+    
+    exit_reason = sim_run(chain_entry, sim_now_ns() + M_LIMIT_NS);
+    TEST_CHECK(exit_reason == SIM_EXIT_RETURNED, "count %u: exit %d", count, exit_reason);
+    TEST_CHECK(m_wakeups_sent == count - 1, "count %u: %u wake-ups", count, m_wakeups_sent);
+    TEST_CHECK(m_isr_sent == count - 1, "count %u: %u RADIO interrupts", count, m_isr_sent);
+    
+    exit_reason = sim_run(sleep_entry, sim_now_ns() + M_LIMIT_NS);
+    TEST_CHECK(exit_reason == SIM_EXIT_DEADLOCK, "count %u: exit %d after the chain", count, exit_reason);
+    TEST_CHECK(p_stats->isr_count[RADIO_IRQn] == count - 1, "count %u: %u RADIO interrupts in total", count,
+               p_stats->isr_count[RADIO_IRQn]);
+    TEST_CHECK(p_stats->radio_without_hfxo == 0, "count %u: radio enabled without HFXO", count);
+    TEST_CHECK(sim_hfclk_running() == !end_task, "count %u: HFCLK running %d", count, sim_hfclk_running());
+    
+    (void)sim_run(registers_entry, sim_now_ns() + M_LIMIT_NS);
+    TEST_CHECK((m_chen & chain_mask) == 0, "count %u: PPI channels 0x%08x left enabled", count, m_chen & chain_mask);
+    TEST_CHECK(m_state == RADIO_STATE_STATE_Disabled, "count %u: radio state %u", count, m_state);
+    
+    p_log = sim_packets_get(&packets);
+    TEST_CHECK(packets - m_packets_before == count, "count %u: %u packets", count, packets - m_packets_before);
+    if ( packets - m_packets_before != count )
+    {
+        return;
+    }
+    p_log = &p_log[m_packets_before % SIM_PACKET_LOG_SIZE];
+    
+    for ( uint32_t i = 0; i < count; ++i )
+    {
+        TEST_CHECK(p_log[i].frequency == frequency_of(m_channels[i]), "count %u: packet %u on frequency %u", count, i,
+                   p_log[i].frequency);
+        TEST_CHECK(p_log[i].datawhiteiv == m_channels[i], "count %u: packet %u whitened with %u", count, i,
+                   p_log[i].datawhiteiv);
+        TEST_CHECK(memcmp(p_log[i].pdu, m_pdu, 3 + m_pdu[1]) == 0, "count %u: packet %u PDU differs", count, i);
+        if ( i > 0 )
+        {
+            uint64_t gap = p_log[i].start_ns - p_log[i - 1].end_ns;
+            
+            TEST_CHECK((gap >= M_GAP_NS) && (gap <= M_GAP_NS + M_GAP_SLACK_NS), "count %u: gap %llu ns before packet %u",
+                       count, (unsigned long long)gap, i);
+        }
+    }
+    
+    /* The HF clock stops as the last packet disables the radio, not when the CPU gets to it. */
+    if ( end_task )
+    {
+        uint64_t hfxo_expected = p_log[count - 1].end_ns + M_DISABLE_NS - m_sent_at;
+        
+        TEST_CHECK((p_stats->time.hfxo_ns >= hfxo_expected) && (p_stats->time.hfxo_ns <= hfxo_expected + 1000),
+                   "count %u: HFXO on for %llu ns, expected %llu ns", count, (unsigned long long)p_stats->time.hfxo_ns,
+                   (unsigned long long)hfxo_expected);
+    }
+}
+
+
+static void reset_entry(void)
+{
+    hal_radio_reset();
+    hal_clock_hfclk_disable();
+}
+
+
+int main(void)
+{
+    sim_init();
+    
+    (void)sim_run(reset_entry, M_LIMIT_NS);
+    
+    chain_run(3, true);
+    chain_run(2, true);
+    chain_run(3, false);
+    (void)sim_run(reset_entry, sim_now_ns() + M_LIMIT_NS);
+    chain_run(3, true);
+    
+    return ( test_result("test_hal_radio") );
+}
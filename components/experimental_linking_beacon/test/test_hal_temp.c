@@ -0,0 +1,255 @@
+/* Copyright (c) Nordic Semiconductor ASA
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ *   1. Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ *   2. Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ *   3. Neither the name of Nordic Semiconductor ASA nor the names of other
+ *   contributors to this software may be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ * 
+ *   4. This software must only be used in a processor manufactured by Nordic
+ *   Semiconductor ASA, or in a processor manufactured by a third party that
+ *   is used in combination with a processor manufactured by Nordic Semiconductor.
+ * 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Runs hal_temp on the simulated TEMP, bare-metal and, built with SOFTDEVICE_PRESENT, through a
+   stand-in for the SoftDevice. Checks that the callback comes from the interrupt after the start
+   has returned, with the sign of the temperature kept, that a second start is refused while a
+   sample is ongoing, and that the CPU sleeps during a bare-metal conversion. */
+
+#include "hal_temp.h"
+#include "nrf_temp.h"
+#include "sim.h"
+#include "test.h"
+#ifdef SOFTDEVICE_PRESENT
+#include "nrf_soc.h"
+#endif
+
+
+#define M_LIMIT_NS          (1000000000ULL)
+#define M_TEMP              (-21)   ///< -5.25 degrees Celsius.
+#ifdef SOFTDEVICE_PRESENT
+#define M_IRQN              (HAL_TEMP_SWI_IRQn)
+#define M_CALLER_IRQN       (SWI2_EGU2_IRQn)    ///< Runs the start at the priority of the SoftDevice events.
+#define M_TEST_NAME         "test_hal_temp_sd"
+#else
+#define M_IRQN              (TEMP_IRQn)
+#define M_TEST_NAME         "test_hal_temp"
+#endif
+
+
+static volatile uint32_t m_callbacks;       ///< The number of callbacks.
+static volatile int32_t  m_temp;            ///< The temperature of the last callback.
+static volatile bool     m_started;         ///< The start of the last run succeeded.
+static volatile bool     m_busy_refused;    ///< A second start in the last run failed.
+static volatile uint32_t m_early_callbacks; ///< Callbacks before the start returned.
+
+
+static void temp_callback(int32_t temp)
+{
+    m_temp = temp;
+    ++m_callbacks;
+}
+
+
+static void sample_start(void)
+{
+    uint32_t callbacks = m_callbacks;
+
+    m_started         = hal_temp_sample_start(temp_callback);
+    m_early_callbacks = m_callbacks - callbacks;
+    m_busy_refused    = !hal_temp_sample_start(temp_callback);
+}
+
+
+#ifdef SOFTDEVICE_PRESENT
+static uint32_t m_sd_error;     ///< The error returned by sd_temp_get, NRF_SUCCESS to sample.
+
+
+/* Takes the sample as the SoftDevice does, waiting for the conversion with the CPU running. */
+uint32_t sd_temp_get(int32_t * p_temp)
+{
+    if ( m_sd_error != NRF_SUCCESS )
+    {
+        return ( m_sd_error );
+    }
+
+    NRF_TEMP->EVENTS_DATARDY = 0;
+    NRF_TEMP->TASKS_START    = 1;
+    while ( NRF_TEMP->EVENTS_DATARDY == 0 )
+    {
+    }
+    NRF_TEMP->EVENTS_DATARDY = 0;
+    *p_temp = nrf_temp_read();
+    NRF_TEMP->TASKS_STOP = 1;
+
+    return ( NRF_SUCCESS );
+}
+
+
+uint32_t sd_nvic_SetPriority(IRQn_Type irqn, uint32_t priority)
+{
+    NVIC_SetPriority(irqn, priority);
+    return ( NRF_SUCCESS );
+}
+
+
+uint32_t sd_nvic_ClearPendingIRQ(IRQn_Type irqn)
+{
+    NVIC_ClearPendingIRQ(irqn);
+    return ( NRF_SUCCESS );
+}
+
+
+uint32_t sd_nvic_EnableIRQ(IRQn_Type irqn)
+{
+    NVIC_EnableIRQ(irqn);
+    return ( NRF_SUCCESS );
+}
+
+
+uint32_t sd_nvic_SetPendingIRQ(IRQn_Type irqn)
+{
+    NVIC_SetPendingIRQ(irqn);
+    return ( NRF_SUCCESS );
+}
+
+
+void HAL_TEMP_SWI_IRQHandler(void)
+{
+    (void)hal_temp_isr_handler();
+}
+
+
+void SWI2_EGU2_IRQHandler(void)
+{
+    sample_start();
+}
+
+
+/* Starts the sample from a SoftDevice event handler and waits for it. */
+static void sample_entry(void)
+{
+    uint32_t callbacks = m_callbacks;
+
+    NVIC_SetPriority(M_CALLER_IRQN, NRF_APP_PRIORITY_LOW);
+    NVIC_EnableIRQ(M_CALLER_IRQN);
+    NVIC_SetPendingIRQ(M_CALLER_IRQN);
+
+    while ( m_callbacks == callbacks )
+    {
+        __WFE();
+    }
+}
+#else
+void TEMP_IRQHandler(void)
+{
+    (void)hal_temp_isr_handler();
+}
+
+
+/* Starts the sample from thread mode and sleeps until it is done. */
+static void sample_entry(void)
+{
+    uint32_t callbacks = m_callbacks;
+
+    sample_start();
+
+    while ( m_callbacks == callbacks )
+    {
+        __WFE();
+    }
+}
+#endif
+
+
+static void sample_test(void)
+{
+    const sim_stats_t * p_stats = sim_stats_get();
+    sim_exit_t exit;
+
+    sim_reset();
+    sim_temp_set(M_TEMP);
+    m_callbacks = 0;
+
+    exit = sim_run(sample_entry, M_LIMIT_NS);
+    TEST_CHECK(exit == SIM_EXIT_RETURNED, "exit %d", exit);
+    TEST_CHECK(m_started, "start failed");
+    TEST_CHECK(m_busy_refused, "second start accepted during the sample");
+    TEST_CHECK(m_early_callbacks == 0, "%u callbacks before the start returned", (unsigned int)m_early_callbacks);
+    TEST_CHECK(m_callbacks == 1, "%u callbacks", (unsigned int)m_callbacks);
+    TEST_CHECK(m_temp == M_TEMP, "temperature %d", (int)m_temp);
+    TEST_CHECK(p_stats->isr_count[M_IRQN] == 1, "%u interrupts", (unsigned int)p_stats->isr_count[M_IRQN]);
+    TEST_CHECK(p_stats->time.temp_ns > 0, "no conversion");
+#ifndef SOFTDEVICE_PRESENT
+    TEST_CHECK(p_stats->time.sleep_ns >= p_stats->time.temp_ns / 2,
+               "slept %u of %u ns", (unsigned int)p_stats->time.sleep_ns, (unsigned int)p_stats->time.temp_ns);
+#endif
+
+    /* The next sample can be started from the callback state. */
+    m_callbacks = 0;
+    sim_temp_set(-M_TEMP);
+    exit = sim_run(sample_entry, M_LIMIT_NS);
+    TEST_CHECK((exit == SIM_EXIT_RETURNED) && (m_callbacks == 1) && (m_temp == -M_TEMP),
+               "exit %d, %u callbacks, temperature %d", exit, (unsigned int)m_callbacks, (int)m_temp);
+}
+
+
+#ifdef SOFTDEVICE_PRESENT
+/* A sample failed by the SoftDevice gives no callback and does not block the next one. */
+static void sd_error_entry(void)
+{
+    sample_start();
+}
+
+
+static void sd_error_test(void)
+{
+    sim_exit_t exit;
+
+    sim_reset();
+    m_callbacks = 0;
+    m_sd_error  = NRF_ERROR_BUSY;
+    exit = sim_run(sd_error_entry, M_LIMIT_NS);
+    TEST_CHECK((exit == SIM_EXIT_RETURNED) && m_started && (m_callbacks == 0),
+               "exit %d, started %d, %u callbacks", exit, m_started, (unsigned int)m_callbacks);
+
+    m_sd_error = NRF_SUCCESS;
+    exit = sim_run(sample_entry, M_LIMIT_NS);
+    TEST_CHECK((exit == SIM_EXIT_RETURNED) && m_started && (m_callbacks == 1),
+               "exit %d, started %d, %u callbacks", exit, m_started, (unsigned int)m_callbacks);
+}
+#endif
+
+
+int main(void)
+{
+    sim_init();
+
+    sample_test();
+#ifdef SOFTDEVICE_PRESENT
+    sd_error_test();
+#endif
+
+    return ( test_result(M_TEST_NAME) );
+}
@@ -0,0 +1,271 @@
+/* Copyright (c) Nordic Semiconductor ASA
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ *   1. Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ *   2. Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ *   3. Neither the name of Nordic Semiconductor ASA nor the names of other
+ *   contributors to this software may be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ * 
+ *   4. This software must only be used in a processor manufactured by Nordic
+ *   Semiconductor ASA, or in a processor manufactured by a third party that
+ *   is used in combination with a processor manufactured by Nordic Semiconductor.
+ * 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Runs the RTC timeline and deadlines of hal_timer for three weeks of virtual time, across
+   thousands of wraps of the 24-bit counter, with a drifting LFCLK and preemption of the thread
+   at every register access of hal_timer_deadline_set(). Checks that no deadline expires early,
+   none expires later than the preemption allows, and the timeline does not lose or gain ticks.
+   Checks that the task trigger starts the HF clock the requested fraction of a tick after the
+   requested tick. */
+
+#include "hal_clock.h"
+#include "hal_timer.h"
+#include "sim.h"
+#include "test.h"
+
+#include <stdlib.h>
+
+
+#define M_DURATION_NS       (21ULL * 24 * 3600 * 1000000000)
+#define M_DRIFT_PPB         (40000)
+#define M_TICK_NS           (30518)
+#define M_SLACK_TICKS       (2)
+
+/* Deadlines closer than this when set expire right away, see hal_timer_deadline_set(). */
+#define M_COMPARE_MIN_TICKS (2)
+
+#define M_HFXO_STARTUP_US   (360)
+
+
+static volatile bool     m_expired;
+static volatile uint64_t m_expired_ticks;
+static uint64_t          m_tick0;
+
+static volatile bool     m_hfclk_started;
+static volatile uint64_t m_hfclk_started_ns;
+static volatile uint64_t m_hfclk_on_ns;
+
+static uint32_t m_deadline_count;
+static uint32_t m_preempted_count;
+static uint64_t m_max_late_ticks;
+
+
+void RTC0_IRQHandler(void)
+{
+    if ( hal_timer_isr_handler() )
+    {
+        m_expired       = true;
+        m_expired_ticks = hal_timer_ticks_get();
+    }
+}
+
+
+void POWER_CLOCK_IRQHandler(void)
+{
+    if ( hal_clock_isr_handler() )
+    {
+        m_hfclk_started    = true;
+        m_hfclk_started_ns = sim_now_ns();
+        m_hfclk_on_ns      = sim_stats_get()->time.hfxo_ns;
+    }
+}
+
+
+/* Arms the task trigger to start the HF clock the specified delay after a tick, and checks from the
+   HFCLKSTARTED event that it was started at that point in time. */
+static void trigger_run(uint32_t distance, uint32_t delay_us)
+{
+    uint64_t trigger_ticks = hal_timer_ticks_get() + distance;
+    uint64_t triggered_ns;
+    bool     armed;
+
+    m_hfclk_started = false;
+    sim_stats_clear();
+    hal_clock_hfclk_started_irq_enable();
+    armed = hal_timer_task_trigger_set(trigger_ticks, delay_us, hal_clock_hfclk_enable_task_get());
+    TEST_CHECK(armed == (distance >= HAL_TIMER_TRIGGER_LEAD_TICKS), "distance %u: armed %d", distance, armed);
+    if ( !armed )
+    {
+        return;
+    }
+    while ( !m_hfclk_started )
+    {
+        __WFE();
+    }
+    hal_timer_task_trigger_cancel();
+    hal_clock_hfclk_disable();
+
+    /* The HF clock has been on since it was triggered, and the timer counts whole microseconds from the RTC event. */
+    TEST_CHECK(m_hfclk_on_ns >= M_HFXO_STARTUP_US * 1000ULL, "HF clock on for %llu ns", (unsigned long long)m_hfclk_on_ns);
+    triggered_ns = m_hfclk_started_ns - m_hfclk_on_ns - delay_us * 1000ULL;
+    TEST_CHECK(sim_lfclk_ticks_at(triggered_ns + 100) - m_tick0 == trigger_ticks,
+               "delay %u us: triggered in tick %llu, not %llu", delay_us,
+               (unsigned long long)(sim_lfclk_ticks_at(triggered_ns + 100) - m_tick0), (unsigned long long)trigger_ticks);
+    TEST_CHECK(sim_lfclk_ticks_at(triggered_ns - 1000) - m_tick0 == trigger_ticks - 1,
+               "delay %u us: triggered more than 1 us after tick %llu", delay_us, (unsigned long long)trigger_ticks);
+}
+
+
+/* Checks that the timeline matches the LFCLK ticks elapsed since the timer was started. */
+static void timeline_check(void)
+{
+    uint64_t lfclk_ticks = sim_lfclk_ticks_at(sim_now_ns()) - m_tick0;
+    uint64_t timeline    = hal_timer_ticks_get();
+
+    TEST_CHECK((timeline <= lfclk_ticks) && (timeline + 1 >= lfclk_ticks),
+               "timeline %llu, LFCLK %llu", (unsigned long long)timeline, (unsigned long long)lfclk_ticks);
+}
+
+
+/* Sets a deadline, preempting the thread for the delay at the specified register access of
+   hal_timer_deadline_set(), and waits for the expiry. */
+static void deadline_run(uint64_t deadline, uint32_t preempt_access, uint32_t preempt_ticks)
+{
+    uint64_t before = hal_timer_ticks_get();
+    uint64_t latest;
+
+    m_expired = false;
+    if ( preempt_access != 0 )
+    {
+        sim_preempt_set(preempt_access, (uint64_t)preempt_ticks * M_TICK_NS);
+        ++m_preempted_count;
+    }
+    hal_timer_deadline_set(deadline);
+    sim_preempt_set(0, 0);
+
+    while ( !m_expired )
+    {
+        __WFE();
+    }
+    ++m_deadline_count;
+
+    /* One tick for the reads of the timeline, plus the preemption. */
+    latest = ((deadline > before) ? deadline : before) + M_SLACK_TICKS + preempt_ticks;
+
+    TEST_CHECK(m_expired_ticks + (M_COMPARE_MIN_TICKS - 1) >= deadline, "deadline %llu expired early at %llu",
+               (unsigned long long)deadline, (unsigned long long)m_expired_ticks);
+    TEST_CHECK(m_expired_ticks <= latest,
+               "deadline %llu (set at %llu, preempted %u ticks at access %u) expired late at %llu",
+               (unsigned long long)deadline, (unsigned long long)before, preempt_ticks, preempt_access,
+               (unsigned long long)m_expired_ticks);
+
+    if ( (m_expired_ticks > deadline) && (m_expired_ticks - deadline > m_max_late_ticks) && (deadline >= before) )
+    {
+        m_max_late_ticks = m_expired_ticks - deadline;
+    }
+}
+
+
+static void test_entry(void)
+{
+    static const uint32_t preempt_ticks[] = { 1, 2, 3, 5, 40 };
+
+    hal_timer_start();
+    m_tick0 = sim_lfclk_ticks_at(sim_now_ns()) - hal_timer_ticks_get();
+
+    /* The task trigger, at every microsecond within a tick, and too close to be armed. */
+    for ( uint32_t delay_us = 0; delay_us < 31; ++delay_us )
+    {
+        trigger_run(3 + delay_us % 5, delay_us);
+    }
+    trigger_run(0, 10);
+    trigger_run(1, 10);
+
+    /* Close deadlines, with the thread preempted at each access while arming the compare. */
+    for ( uint32_t access = 1; access <= 16; ++access )
+    {
+        for ( uint32_t i = 0; i < sizeof(preempt_ticks) / sizeof(preempt_ticks[0]); ++i )
+        {
+            for ( uint32_t distance = 0; distance <= 6; ++distance )
+            {
+                deadline_run(hal_timer_ticks_get() + distance, access, preempt_ticks[i]);
+            }
+        }
+    }
+
+    /* Deadlines in the past. */
+    for ( uint32_t distance = 1; distance <= 4; ++distance )
+    {
+        deadline_run(hal_timer_ticks_get() - distance, 0, 0);
+    }
+
+    /* Three weeks of random deadlines, from immediate to beyond one counter period. */
+    srand(1);
+    for ( ;; )
+    {
+        uint32_t choice = (uint32_t)rand() % 100;
+        uint64_t now    = hal_timer_ticks_get();
+        uint64_t deadline;
+
+        if ( choice < 40 )
+        {
+            deadline = now + (uint32_t)rand() % 64;
+        }
+        else if ( choice < 80 )
+        {
+            deadline = now + (uint32_t)rand() % (16 * HAL_TIMER_TICKS_PER_SECOND);
+        }
+        else if ( choice < 95 )
+        {
+            deadline = now + (uint32_t)rand() % (600 * HAL_TIMER_TICKS_PER_SECOND);
+        }
+        else
+        {
+            deadline = now - (uint32_t)rand() % 8;
+        }
+
+        if ( (choice % 2) == 0 )
+        {
+            deadline_run(deadline, 1 + (uint32_t)rand() % 16,
+                         preempt_ticks[(uint32_t)rand() % (sizeof(preempt_ticks) / sizeof(preempt_ticks[0]))]);
+        }
+        else
+        {
+            deadline_run(deadline, 0, 0);
+        }
+        timeline_check();
+    }
+}
+
+
+int main(void)
+{
+    sim_exit_t exit_reason;
+    uint64_t   ticks;
+
+    sim_init();
+    sim_lfclk_drift_set(M_DRIFT_PPB);
+    sim_hfxo_startup_set(M_HFXO_STARTUP_US);
+
+    exit_reason = sim_run(test_entry, M_DURATION_NS);
+    TEST_CHECK(exit_reason == SIM_EXIT_TIME_LIMIT, "exit %d", exit_reason);
+
+    ticks = sim_lfclk_ticks_at(sim_now_ns()) - m_tick0;
+    printf("%u deadlines (%u preempted) over %llu counter periods, latest expiry %llu ticks after the deadline\n",
+           m_deadline_count, m_preempted_count, (unsigned long long)(ticks >> HAL_TIMER_COUNTER_BITS),
+           (unsigned long long)m_max_late_ticks);
+    TEST_CHECK(m_deadline_count > 10000, "%u deadlines", m_deadline_count);
+
+    return ( test_result("test_hal_timer") );
+}
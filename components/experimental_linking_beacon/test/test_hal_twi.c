@@ -0,0 +1,564 @@
+/* Copyright (c) Nordic Semiconductor ASA
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ *   1. Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ *   2. Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ *   3. Neither the name of Nordic Semiconductor ASA nor the names of other
+ *   contributors to this software may be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ * 
+ *   4. This software must only be used in a processor manufactured by Nordic
+ *   Semiconductor ASA, or in a processor manufactured by a third party that
+ *   is used in combination with a processor manufactured by Nordic Semiconductor.
+ * 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Runs hal_twi on the simulated TWIM against two devices that log what they are sent. Checks that
+   every write reaches the bus whatever the stop mode, that a write and a read share one transfer
+   with a repeated start, and that errors are reported, both blocking and with a signal callback.
+   Also runs lists of transactions for both devices through the queue, including transactions queued
+   from the callbacks, transactions that fail and two drivers interleaving their transactions, and
+   checks that the queue holds the peripheral only while it has transactions. */
+
+#include <string.h>
+
+#include "hal_serial.h"
+#include "hal_twi.h"
+#include "sim.h"
+#include "test.h"
+
+
+#define M_LIMIT_NS          (1000000000ULL)
+#define M_ADDRESS           (0x29)
+#define M_ADDRESS_OTHER     (0x5D)
+#define M_IRQN              (SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQn)
+#define M_SIGNAL_NONE       (0xFF)
+#define M_XFER_COUNT        (6)
+
+
+static const hal_serial_cfg_t m_serial_cfg =
+{
+    .twi0.psel.scl = 27,
+    .twi0.psel.sda = 26,
+};
+
+
+static const hal_twi_cfg_t m_twi_cfg =
+{
+    .frequency = (TWI_FREQUENCY_FREQUENCY_K400 << TWI_FREQUENCY_FREQUENCY_Pos),
+    .address   = (M_ADDRESS << TWI_ADDRESS_ADDRESS_Pos),
+};
+
+
+typedef struct
+{
+    bool     nack;              ///< Do not acknowledge the next transfers.
+    uint32_t writes;            ///< Acknowledged writes.
+    uint32_t reads;             ///< Acknowledged reads.
+    uint8_t  last_write[8];     ///< The bytes of the last write.
+    uint32_t last_write_length; ///< The length of the last write.
+    uint64_t bit_ns;            ///< The bit time of the last acknowledged transfer, by the frequency setting.
+} device_t;
+
+
+static device_t          m_device;          ///< The device at M_ADDRESS.
+static device_t          m_other;           ///< The device at M_ADDRESS_OTHER.
+static volatile uint8_t  m_signal;
+static volatile uint32_t m_signal_count;
+static bool              m_use_callback;
+
+static hal_twi_xfer_t    m_xfers[M_XFER_COUNT];
+static uint8_t           m_xfer_rx[M_XFER_COUNT][3];
+static hal_twi_xfer_t *  mp_xfer_then[M_XFER_COUNT];    ///< The transaction to queue from the callback of each.
+static volatile uint32_t m_xfer_done_count;
+static uint8_t           m_xfer_order[M_XFER_COUNT];    ///< The transactions in the order their callbacks were called.
+static bool              m_xfer_success[M_XFER_COUNT];
+
+
+static bool device_write(device_t * p_device, const uint8_t * p_data, uint32_t length)
+{
+    if ( p_device->nack || (length > sizeof(p_device->last_write)) )
+    {
+        return ( false );
+    }
+    memcpy(p_device->last_write, p_data, length);
+    p_device->last_write_length = length;
+    p_device->bit_ns            = sim_twi_bytes_ns(0);
+    ++p_device->writes;
+    return ( true );
+}
+
+
+/* Returns the first written byte plus the index, as a register read with auto increment would. */
+static bool device_read(device_t * p_device, uint8_t * p_data, uint32_t length)
+{
+    if ( p_device->nack )
+    {
+        return ( false );
+    }
+    for ( uint32_t i = 0; i < length; ++i )
+    {
+        p_data[i] = (uint8_t)(p_device->last_write[0] + i);
+    }
+    p_device->bit_ns = sim_twi_bytes_ns(0);
+    ++p_device->reads;
+    return ( true );
+}
+
+
+static bool device_write_main(const uint8_t * p_data, uint32_t length)
+{
+    return ( device_write(&m_device, p_data, length) );
+}
+
+
+static bool device_read_main(uint8_t * p_data, uint32_t length)
+{
+    return ( device_read(&m_device, p_data, length) );
+}
+
+
+static bool device_write_other(const uint8_t * p_data, uint32_t length)
+{
+    return ( device_write(&m_other, p_data, length) );
+}
+
+
+static bool device_read_other(uint8_t * p_data, uint32_t length)
+{
+    return ( device_read(&m_other, p_data, length) );
+}
+
+
+static const sim_twi_device_t m_twi_devices[] =
+{
+    {.address = M_ADDRESS,       .write = device_write_main,  .read = device_read_main},
+    {.address = M_ADDRESS_OTHER, .write = device_write_other, .read = device_read_other},
+};
+
+
+static void twi_sig_callback(hal_twi_signal_type_t hal_twi_signal_type)
+{
+    m_signal = hal_twi_signal_type;
+    ++m_signal_count;
+}
+
+
+/* Clears the counters of the devices, the signals and the simulation. */
+static void counters_clear(void)
+{
+    memset(&m_device, 0, sizeof(m_device));
+    memset(&m_other, 0, sizeof(m_other));
+    m_signal       = M_SIGNAL_NONE;
+    m_signal_count = 0;
+    sim_stats_clear();
+}
+
+
+/* Opens the driver in the mode of the current pass, and clears the counters. */
+static void twi_open(void)
+{
+    TEST_CHECK(hal_twi_open(HAL_TWI_ID_TWI0, &m_twi_cfg) == HAL_TWI_STATUS_CODE_SUCCESS, "open failed");
+    hal_twi_callback_set(HAL_TWI_ID_TWI0, m_use_callback ? twi_sig_callback : NULL);
+    hal_twi_address_set(HAL_TWI_ID_TWI0, M_ADDRESS);
+    counters_clear();
+}
+
+
+static bool twi_enabled(void)
+{
+    return ( (NRF_TWIM0->ENABLE & 0xF) == TWIM_ENABLE_ENABLE_Enabled );
+}
+
+
+static void twi_close(void)
+{
+    TEST_CHECK(hal_twi_close(HAL_TWI_ID_TWI0) == HAL_TWI_STATUS_CODE_SUCCESS, "close failed");
+}
+
+
+/* Waits for the signal of the last call in callback mode, and checks it. */
+static void signal_wait(hal_twi_signal_type_t expected)
+{
+    if ( m_use_callback )
+    {
+        while ( m_signal == M_SIGNAL_NONE )
+        {
+            __WFE();
+        }
+        TEST_CHECK(m_signal == expected, "signal %u, expected %u", m_signal, expected);
+        m_signal = M_SIGNAL_NONE;
+    }
+}
+
+
+/* A write in a stop mode without a stop after it reaches the device at once, even if no read follows. */
+static void write_alone_test(hal_twi_stop_mode_t stop_mode)
+{
+    uint8_t tx[2] = {0x20, 0x90};
+
+    twi_open();
+    hal_twi_stop_mode_set(HAL_TWI_ID_TWI0, stop_mode);
+    TEST_CHECK(hal_twi_write(HAL_TWI_ID_TWI0, sizeof(tx), tx) == HAL_TWI_STATUS_CODE_SUCCESS, "write failed");
+    signal_wait(HAL_TWI_SIGNAL_TYPE_TX_COMPLETE);
+    TEST_CHECK(m_device.writes == 1, "stop mode %u: %u writes", stop_mode, m_device.writes);
+    TEST_CHECK((m_device.last_write_length == sizeof(tx)) && (memcmp(m_device.last_write, tx, sizeof(tx)) == 0),
+               "stop mode %u: write of %u bytes", stop_mode, m_device.last_write_length);
+
+    // The held bus does not get in the way of the next transfer.
+    tx[0] = 0x21;
+    hal_twi_stop_mode_set(HAL_TWI_ID_TWI0, HAL_TWI_STOP_MODE_STOP_ON_TX_BUF_END);
+    TEST_CHECK(hal_twi_write(HAL_TWI_ID_TWI0, sizeof(tx), tx) == HAL_TWI_STATUS_CODE_SUCCESS, "write failed");
+    signal_wait(HAL_TWI_SIGNAL_TYPE_TX_COMPLETE);
+    TEST_CHECK((m_device.writes == 2) && (m_device.last_write[0] == 0x21), "stop mode %u: %u writes, last 0x%02x",
+               stop_mode, m_device.writes, m_device.last_write[0]);
+    TEST_CHECK(sim_stats_get()->twi_transfers == 1, "stop mode %u: %u transfers", stop_mode,
+               sim_stats_get()->twi_transfers);
+    twi_close();
+}
+
+
+/* A write and a read: one transfer with a repeated start unless the stop mode stops after the write. */
+static void write_then_read_test(hal_twi_stop_mode_t stop_mode, uint32_t expected_transfers)
+{
+    uint8_t reg = 0x28;
+    uint8_t rx[3];
+
+    twi_open();
+    hal_twi_stop_mode_set(HAL_TWI_ID_TWI0, stop_mode);
+    TEST_CHECK(hal_twi_write(HAL_TWI_ID_TWI0, 1, &reg) == HAL_TWI_STATUS_CODE_SUCCESS, "write failed");
+    signal_wait(HAL_TWI_SIGNAL_TYPE_TX_COMPLETE);
+    TEST_CHECK(hal_twi_read(HAL_TWI_ID_TWI0, sizeof(rx), rx) == HAL_TWI_STATUS_CODE_SUCCESS, "read failed");
+    signal_wait(HAL_TWI_SIGNAL_TYPE_RX_COMPLETE);
+    TEST_CHECK((m_device.writes == 1) && (m_device.reads == 1), "%u writes, %u reads", m_device.writes, m_device.reads);
+    TEST_CHECK((rx[0] == 0x28) && (rx[2] == 0x2A), "read 0x%02x 0x%02x", rx[0], rx[2]);
+    TEST_CHECK(sim_stats_get()->twi_transfers == expected_transfers, "stop mode %u: %u transfers", stop_mode,
+               sim_stats_get()->twi_transfers);
+    twi_close();
+}
+
+
+/* A combined write and read is one transfer, and ends with one interrupt in callback mode. */
+static void write_read_test(void)
+{
+    uint8_t reg = 0x28;
+    uint8_t rx[3];
+
+    twi_open();
+    hal_twi_stop_mode_set(HAL_TWI_ID_TWI0, HAL_TWI_STOP_MODE_STOP_ON_TX_BUF_END);
+    TEST_CHECK(hal_twi_write_read(HAL_TWI_ID_TWI0, 1, &reg, sizeof(rx), rx) == HAL_TWI_STATUS_CODE_SUCCESS,
+               "write read failed");
+    signal_wait(HAL_TWI_SIGNAL_TYPE_RX_COMPLETE);
+    TEST_CHECK((m_device.writes == 1) && (m_device.reads == 1), "%u writes, %u reads", m_device.writes, m_device.reads);
+    TEST_CHECK((rx[0] == 0x28) && (rx[1] == 0x29) && (rx[2] == 0x2A), "read 0x%02x 0x%02x 0x%02x", rx[0], rx[1], rx[2]);
+    TEST_CHECK(sim_stats_get()->twi_transfers == 1, "%u transfers", sim_stats_get()->twi_transfers);
+    TEST_CHECK(sim_stats_get()->isr_count[M_IRQN] == (m_use_callback ? 1 : 0), "%u interrupts",
+               sim_stats_get()->isr_count[M_IRQN]);
+    TEST_CHECK(m_signal_count == (m_use_callback ? 1 : 0), "%u signals", m_signal_count);
+
+    // The bus is released after the read: the next transfer starts anew.
+    TEST_CHECK(hal_twi_write_read(HAL_TWI_ID_TWI0, 1, &reg, 1, rx) == HAL_TWI_STATUS_CODE_SUCCESS, "write read failed");
+    signal_wait(HAL_TWI_SIGNAL_TYPE_RX_COMPLETE);
+    TEST_CHECK(sim_stats_get()->twi_transfers == 2, "%u transfers", sim_stats_get()->twi_transfers);
+    twi_close();
+}
+
+
+/* A device not acknowledging fails the call, and the driver recovers for the next transfer. */
+static void nack_test(void)
+{
+    uint8_t  reg = 0x28;
+    uint8_t  rx[2];
+    uint32_t status;
+
+    twi_open();
+    m_device.nack = true;
+
+    hal_twi_stop_mode_set(HAL_TWI_ID_TWI0, HAL_TWI_STOP_MODE_STOP_ON_TX_BUF_END);
+    status = hal_twi_write(HAL_TWI_ID_TWI0, 1, &reg);
+    TEST_CHECK(status == (m_use_callback ? HAL_TWI_STATUS_CODE_SUCCESS : HAL_TWI_STATUS_CODE_WRITE_ERROR),
+               "write status %u", status);
+    signal_wait(HAL_TWI_SIGNAL_TYPE_TX_ERROR);
+
+    status = hal_twi_write_read(HAL_TWI_ID_TWI0, 1, &reg, sizeof(rx), rx);
+    TEST_CHECK(status == (m_use_callback ? HAL_TWI_STATUS_CODE_SUCCESS : HAL_TWI_STATUS_CODE_READ_ERROR),
+               "write read status %u", status);
+    signal_wait(HAL_TWI_SIGNAL_TYPE_RX_ERROR);
+
+    m_device.nack = false;
+    TEST_CHECK(hal_twi_write_read(HAL_TWI_ID_TWI0, 1, &reg, sizeof(rx), rx) == HAL_TWI_STATUS_CODE_SUCCESS,
+               "write read failed after a NACK");
+    signal_wait(HAL_TWI_SIGNAL_TYPE_RX_COMPLETE);
+    TEST_CHECK((m_device.reads == 1) && (rx[1] == 0x29), "%u reads, read 0x%02x", m_device.reads, rx[1]);
+    twi_close();
+}
+
+
+static void xfer_callback(hal_twi_xfer_t * p_xfer, bool success)
+{
+    uint32_t index = p_xfer - &(m_xfers[0]);
+
+    m_xfer_success[index] = success;
+    m_xfer_order[m_xfer_done_count++] = index;
+    if ( mp_xfer_then[index] != NULL )
+    {
+        TEST_CHECK(hal_twi_xfer_schedule(HAL_TWI_ID_TWI0, mp_xfer_then[index]) == HAL_TWI_STATUS_CODE_SUCCESS,
+                   "transaction %u not queued from the callback of %u",
+                   (unsigned int)(mp_xfer_then[index] - &(m_xfers[0])), index);
+    }
+}
+
+
+/* Sets up a transaction, with no next one. */
+static void xfer_set(uint32_t index, uint8_t address, uint8_t tx_length, uint8_t * p_tx, uint8_t rx_length)
+{
+    m_xfers[index] = (hal_twi_xfer_t)
+    {
+        .address   = address,
+        .frequency = m_twi_cfg.frequency,
+        .tx_length = tx_length,
+        .p_tx      = p_tx,
+        .rx_length = rx_length,
+        .p_rx      = m_xfer_rx[index],
+        .callback  = xfer_callback,
+    };
+    mp_xfer_then[index]   = NULL;
+    m_xfer_success[index] = false;
+    memset(m_xfer_rx[index], 0, sizeof(m_xfer_rx[index]));
+}
+
+
+static void xfers_wait(uint32_t count)
+{
+    while ( m_xfer_done_count < count )
+    {
+        __WFE();
+    }
+}
+
+
+static void xfer_order_check(const char * p_test, uint8_t o0, uint8_t o1, uint8_t o2, uint8_t o3)
+{
+    TEST_CHECK((m_xfer_done_count == 4) && (m_xfer_order[0] == o0) && (m_xfer_order[1] == o1) &&
+               (m_xfer_order[2] == o2) && (m_xfer_order[3] == o3), "%s: %u done, order %u %u %u %u", p_test,
+               m_xfer_done_count, m_xfer_order[0], m_xfer_order[1], m_xfer_order[2], m_xfer_order[3]);
+}
+
+
+/* A list for both devices, and a transaction queued while it runs, are run back-to-back with one
+   interrupt each on the peripheral acquired by the queue. The peripheral is released when the queue
+   is done, and the signal callback, the stop mode and the address set before are restored. */
+static void queue_test(void)
+{
+    uint8_t reg       = 0x28;
+    uint8_t other[2]  = {0x10, 0x11};
+    uint8_t other_reg = 0x40;
+    uint8_t rx[2];
+
+    hal_twi_callback_set(HAL_TWI_ID_TWI0, m_use_callback ? twi_sig_callback : NULL);
+    hal_twi_stop_mode_set(HAL_TWI_ID_TWI0, HAL_TWI_STOP_MODE_STOP_ON_RX_BUF_END);
+    hal_twi_address_set(HAL_TWI_ID_TWI0, M_ADDRESS);
+    counters_clear();
+    m_xfer_done_count = 0;
+    xfer_set(0, M_ADDRESS,       1, &reg,      2);
+    xfer_set(1, M_ADDRESS_OTHER, 2, other,     0);
+    xfer_set(2, M_ADDRESS,       0, NULL,      1);
+    xfer_set(3, M_ADDRESS_OTHER, 1, &other_reg, 3);
+    m_xfers[0].p_next = &(m_xfers[1]);
+    m_xfers[1].p_next = &(m_xfers[2]);
+
+    TEST_CHECK(hal_twi_xfer_schedule(HAL_TWI_ID_TWI0, &(m_xfers[0])) == HAL_TWI_STATUS_CODE_SUCCESS, "list not queued");
+    TEST_CHECK(hal_twi_xfer_schedule(HAL_TWI_ID_TWI0, &(m_xfers[3])) == HAL_TWI_STATUS_CODE_SUCCESS, "not queued");
+    xfers_wait(4);
+
+    xfer_order_check("queue", 0, 1, 2, 3);
+    TEST_CHECK(m_xfer_success[0] && m_xfer_success[1] && m_xfer_success[2] && m_xfer_success[3], "failed");
+    TEST_CHECK((m_device.writes == 1) && (m_device.reads == 2), "%u writes, %u reads", m_device.writes, m_device.reads);
+    TEST_CHECK((m_other.writes == 2) && (m_other.reads == 1), "other: %u writes, %u reads", m_other.writes,
+               m_other.reads);
+    TEST_CHECK((m_xfer_rx[0][0] == 0x28) && (m_xfer_rx[0][1] == 0x29) && (m_xfer_rx[2][0] == 0x28) &&
+               (m_xfer_rx[3][2] == 0x42), "read 0x%02x 0x%02x 0x%02x 0x%02x", m_xfer_rx[0][0], m_xfer_rx[0][1],
+               m_xfer_rx[2][0], m_xfer_rx[3][2]);
+    TEST_CHECK(sim_stats_get()->twi_transfers == 4, "%u transfers", sim_stats_get()->twi_transfers);
+    TEST_CHECK(sim_stats_get()->isr_count[M_IRQN] == 4, "%u interrupts", sim_stats_get()->isr_count[M_IRQN]);
+    TEST_CHECK(m_signal_count == 0, "%u signals to the driver callback", m_signal_count);
+    TEST_CHECK(!twi_enabled(), "peripheral not released");
+    TEST_CHECK(NRF_TWIM0->ADDRESS == M_ADDRESS, "address 0x%02x", (unsigned int)NRF_TWIM0->ADDRESS);
+
+    // Back to direct transfers, blocking or signalled, and without a stop between the write and the read as before the queue.
+    TEST_CHECK(hal_twi_open(HAL_TWI_ID_TWI0, &m_twi_cfg) == HAL_TWI_STATUS_CODE_SUCCESS, "open failed");
+    sim_stats_clear();
+    TEST_CHECK(hal_twi_write(HAL_TWI_ID_TWI0, 1, &reg) == HAL_TWI_STATUS_CODE_SUCCESS, "write failed");
+    signal_wait(HAL_TWI_SIGNAL_TYPE_TX_COMPLETE);
+    TEST_CHECK(hal_twi_read(HAL_TWI_ID_TWI0, sizeof(rx), rx) == HAL_TWI_STATUS_CODE_SUCCESS, "read failed");
+    TEST_CHECK(m_use_callback || (m_device.reads == 3), "blocking read not done on return");
+    signal_wait(HAL_TWI_SIGNAL_TYPE_RX_COMPLETE);
+    TEST_CHECK((m_device.writes == 2) && (m_device.reads == 3), "%u writes, %u reads", m_device.writes, m_device.reads);
+    TEST_CHECK(sim_stats_get()->twi_transfers == 1, "%u transfers", sim_stats_get()->twi_transfers);
+    twi_close();
+}
+
+
+/* Transactions queued from a callback: appended while the queue runs, and started from the callback
+   when it was the last one. */
+static void queue_callback_test(void)
+{
+    uint8_t reg = 0x30;
+
+    counters_clear();
+    m_xfer_done_count = 0;
+    xfer_set(0, M_ADDRESS,       1, &reg, 0);
+    xfer_set(1, M_ADDRESS_OTHER, 1, &reg, 1);
+    xfer_set(2, M_ADDRESS,       1, &reg, 2);
+    xfer_set(3, M_ADDRESS_OTHER, 0, NULL, 1);
+    m_xfers[0].p_next = &(m_xfers[1]);
+    mp_xfer_then[0]   = &(m_xfers[2]);
+    mp_xfer_then[2]   = &(m_xfers[3]);
+
+    TEST_CHECK(hal_twi_xfer_schedule(HAL_TWI_ID_TWI0, &(m_xfers[0])) == HAL_TWI_STATUS_CODE_SUCCESS, "list not queued");
+    xfers_wait(4);
+
+    xfer_order_check("queue from callback", 0, 1, 2, 3);
+    TEST_CHECK(m_xfer_success[0] && m_xfer_success[1] && m_xfer_success[2] && m_xfer_success[3], "failed");
+    TEST_CHECK((m_xfer_rx[2][1] == 0x31) && (m_xfer_rx[3][0] == 0x30), "read 0x%02x 0x%02x", m_xfer_rx[2][1],
+               m_xfer_rx[3][0]);
+    TEST_CHECK(sim_stats_get()->isr_count[M_IRQN] == 4, "%u interrupts", sim_stats_get()->isr_count[M_IRQN]);
+    TEST_CHECK(!twi_enabled(), "peripheral not released");
+}
+
+
+/* Two drivers, each queueing its next transaction from the callback of the previous one, without
+   opening the peripheral. Their transactions interleave, each at the frequency of its device, and
+   the peripheral is released once both are done. */
+static void queue_drivers_test(void)
+{
+    uint8_t reg       = 0x28;
+    uint8_t other_reg = 0x40;
+
+    counters_clear();
+    m_xfer_done_count = 0;
+    for ( uint32_t i = 0; i < 3; ++i )
+    {
+        xfer_set(i,     M_ADDRESS,       1, &reg,       (i == 2) ? 2 : 0);
+        xfer_set(i + 3, M_ADDRESS_OTHER, 1, &other_reg, (i == 2) ? 1 : 0);
+        m_xfers[i + 3].frequency = (TWI_FREQUENCY_FREQUENCY_K100 << TWI_FREQUENCY_FREQUENCY_Pos);
+    }
+    for ( uint32_t i = 0; i < 2; ++i )
+    {
+        mp_xfer_then[i]     = &(m_xfers[i + 1]);
+        mp_xfer_then[i + 3] = &(m_xfers[i + 4]);
+    }
+
+    TEST_CHECK(hal_twi_xfer_schedule(HAL_TWI_ID_TWI0, &(m_xfers[0])) == HAL_TWI_STATUS_CODE_SUCCESS, "first not queued");
+    TEST_CHECK(hal_twi_xfer_schedule(HAL_TWI_ID_TWI0, &(m_xfers[3])) == HAL_TWI_STATUS_CODE_SUCCESS, "other not queued");
+    TEST_CHECK(hal_twi_open(HAL_TWI_ID_TWI0, &m_twi_cfg) == HAL_TWI_STATUS_CODE_DISALLOWED, "opened while queued");
+    TEST_CHECK(hal_twi_close(HAL_TWI_ID_TWI0) == HAL_TWI_STATUS_CODE_DISALLOWED, "closed while queued");
+    xfers_wait(6);
+
+    TEST_CHECK((m_xfer_order[0] == 0) && (m_xfer_order[1] == 3) && (m_xfer_order[2] == 1) &&
+               (m_xfer_order[3] == 4) && (m_xfer_order[4] == 2) && (m_xfer_order[5] == 5),
+               "order %u %u %u %u %u %u", m_xfer_order[0], m_xfer_order[1], m_xfer_order[2], m_xfer_order[3],
+               m_xfer_order[4], m_xfer_order[5]);
+    TEST_CHECK((m_device.writes == 3) && (m_device.reads == 1) && (m_other.writes == 3) && (m_other.reads == 1),
+               "%u writes, %u reads, other: %u writes, %u reads", m_device.writes, m_device.reads, m_other.writes,
+               m_other.reads);
+    TEST_CHECK((m_xfer_rx[2][1] == 0x29) && (m_xfer_rx[5][0] == 0x40), "read 0x%02x 0x%02x", m_xfer_rx[2][1],
+               m_xfer_rx[5][0]);
+    TEST_CHECK((m_device.bit_ns == 2500) && (m_other.bit_ns == 10000), "bit time %llu ns, other %llu ns",
+               (unsigned long long)m_device.bit_ns, (unsigned long long)m_other.bit_ns);
+    TEST_CHECK(!twi_enabled(), "peripheral not released");
+}
+
+
+/* A failed transaction is reported to its callback only, and the queue goes on with the next ones. */
+static void queue_error_test(void)
+{
+    uint8_t reg = 0x28;
+
+    counters_clear();
+    m_xfer_done_count = 0;
+    m_other.nack = true;
+    xfer_set(0, M_ADDRESS_OTHER, 1, &reg, 2);
+    xfer_set(1, M_ADDRESS,       1, &reg, 2);
+    xfer_set(2, M_ADDRESS_OTHER, 1, &reg, 0);
+    xfer_set(3, M_ADDRESS,       1, &reg, 0);
+    m_xfers[0].p_next = &(m_xfers[1]);
+    m_xfers[1].p_next = &(m_xfers[2]);
+    m_xfers[2].p_next = &(m_xfers[3]);
+
+    TEST_CHECK(hal_twi_xfer_schedule(HAL_TWI_ID_TWI0, &(m_xfers[0])) == HAL_TWI_STATUS_CODE_SUCCESS, "list not queued");
+    xfers_wait(4);
+
+    xfer_order_check("queue with errors", 0, 1, 2, 3);
+    TEST_CHECK(!m_xfer_success[0] && m_xfer_success[1] && !m_xfer_success[2] && m_xfer_success[3],
+               "success %u %u %u %u", m_xfer_success[0], m_xfer_success[1], m_xfer_success[2], m_xfer_success[3]);
+    TEST_CHECK((m_device.writes == 2) && (m_device.reads == 1) && (m_xfer_rx[1][1] == 0x29),
+               "%u writes, %u reads, read 0x%02x", m_device.writes, m_device.reads, m_xfer_rx[1][1]);
+
+    // The peripheral opened for direct transfers keeps the queue out until it is closed.
+    twi_open();
+    TEST_CHECK(hal_twi_xfer_schedule(HAL_TWI_ID_TWI0, &(m_xfers[3])) == HAL_TWI_STATUS_CODE_DISALLOWED,
+               "queued while open");
+    twi_close();
+    m_xfers[3].p_next = NULL;
+    TEST_CHECK(hal_twi_xfer_schedule(HAL_TWI_ID_TWI0, &(m_xfers[3])) == HAL_TWI_STATUS_CODE_SUCCESS, "not queued");
+    xfers_wait(5);
+    TEST_CHECK(m_xfer_success[3] && (m_device.writes == 1), "%u writes", m_device.writes);
+}
+
+
+static void test_entry(void)
+{
+    hal_serial_init(&m_serial_cfg);
+    hal_twi_init();
+
+    for ( int pass = 0; pass < 2; ++pass )
+    {
+        m_use_callback = (pass == 1);
+
+        write_alone_test(HAL_TWI_STOP_MODE_STOP_ON_RX_BUF_END);
+        write_alone_test(HAL_TWI_STOP_MODE_NONE);
+        write_then_read_test(HAL_TWI_STOP_MODE_STOP_ON_RX_BUF_END, 1);
+        write_then_read_test(HAL_TWI_STOP_MODE_STOP_ON_TX_BUF_END, 2);
+        write_read_test();
+        nack_test();
+        queue_test();
+        queue_callback_test();
+        queue_drivers_test();
+        queue_error_test();
+    }
+}
+
+
+int main(void)
+{
+    sim_exit_t exit_reason;
+
+    sim_init();
+    sim_twi_device_add(&(m_twi_devices[0]));
+    sim_twi_device_add(&(m_twi_devices[1]));
+
+    exit_reason = sim_run(test_entry, M_LIMIT_NS);
+    TEST_CHECK(exit_reason == SIM_EXIT_RETURNED, "exit %d", exit_reason);
+
+    return ( test_result("test_hal_twi") );
+}
@@ -0,0 +1,282 @@
+/* Copyright (c) Nordic Semiconductor ASA
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ *   1. Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ *   2. Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ *   3. Neither the name of Nordic Semiconductor ASA nor the names of other
+ *   contributors to this software may be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ * 
+ *   4. This software must only be used in a processor manufactured by Nordic
+ *   Semiconductor ASA, or in a processor manufactured by a third party that
+ *   is used in combination with a processor manufactured by Nordic Semiconductor.
+ * 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* Runs the unmodified beacon loop of sensor_beacon.c with the configuration of a board, in
+   virtual time against the simulated peripherals, and checks the advertising it produces: three
+   packets on channels 37, 38 and 39 per advertising event, the interval and advDelay, and the
+   sensor values in the PDU. Prints the time per second in each power state and the estimated
+   average current, so that configurations can be compared without a board, e.g.
+
+       make test_beacon_solar SOLAR_CONFIG_DIR=my_config EXTRA_CFLAGS=-DENERGY_CURRENT_SLEEP_NA=2400 */
+
+#define main beacon_main
+#include "sensor_beacon.c"
+#undef main
+
+#include "sim.h"
+#include "test.h"
+#include "energy.h"
+#ifdef SENSOR_BEACON_BACKEND_LPS25H
+#include "lps25h_model.h"
+#endif
+
+#include <stdio.h>
+#include <math.h>
+
+
+#define M_RUN_NS                (120ULL * 1000000000)
+#define M_EVENT_GAP_NS          (2000000)       /* Packets closer than this belong to one advertising event. */
+#define M_INTERVAL_SLACK_NS     (1000000)       /* The interval tolerance for the HFCLK startup and the RTC resolution. */
+#define M_EVENTS_MAX            (SIM_PACKET_LOG_SIZE / 3)
+
+/* The sensor values, and the average current of the board configuration with the default figures
+   of energy.h plus some headroom, as a limit for regressions. */
+#ifdef SENSOR_BEACON_BACKEND_LPS25H
+#define M_TEMPERATURE           (21.5f)
+#define M_PRESSURE_HPA          (1013.25f)
+#ifdef SENSOR_FIFO_MEAN_ENABLE
+#define M_CURRENT_BUDGET_NA     (18000)         /* The sensor converts once per sample of the mean. */
+#else
+#define M_CURRENT_BUDGET_NA     (15000)
+#endif
+#else
+#define M_TEMPERATURE           (23.0f)
+#define M_CURRENT_BUDGET_NA     (36000)
+#endif
+
+#ifdef HFCLK_PRECISION_MODE_ENABLE
+#define M_FIRST_EARLY_NS        (HFCLK_STARTUP_TIME_US * 1000ULL)   /* The startup time is not learned before the first event. */
+#else
+#define M_FIRST_EARLY_NS        (0)
+#endif
+
+#ifdef ADV_DELAY_ENABLE
+#define M_ADV_DELAY_MAX_NS      (ADV_DELAY_MAX_US * 1000ULL)
+#else
+#define M_ADV_DELAY_MAX_NS      (0)
+#endif
+
+
+/* One advertising event in the packet log. */
+typedef struct
+{
+    uint32_t first;             ///< The index of the first packet.
+    uint32_t count;             ///< The number of packets.
+} adv_event_t;
+
+static adv_event_t m_events[M_EVENTS_MAX];
+static uint32_t    m_event_count;
+
+
+static void beacon_entry(void)
+{
+    (void)beacon_main();
+}
+
+
+/* Groups the packet log into advertising events. */
+static void events_collect(const sim_packet_t * p_packets, uint32_t count)
+{
+    m_event_count = 0;
+    for ( uint32_t i = 0; (i < count) && (m_event_count < M_EVENTS_MAX); ++i )
+    {
+        if ( (i == 0) || (p_packets[i].start_ns - p_packets[i - 1].end_ns > M_EVENT_GAP_NS) )
+        {
+            m_events[m_event_count].first = i;
+            m_events[m_event_count].count = 0;
+            ++m_event_count;
+        }
+        ++m_events[m_event_count - 1].count;
+    }
+}
+
+
+/* Checks that every advertising event sends the same PDU on the three advertising channels. */
+static void events_channels_check(const sim_packet_t * p_packets)
+{
+    static const uint32_t frequencies[] = {2, 26, 80};
+
+    for ( uint32_t e = 0; e < m_event_count; ++e )
+    {
+        const sim_packet_t * p_event = &p_packets[m_events[e].first];
+
+        TEST_CHECK(m_events[e].count == 3, "event %u has %u packets", e, m_events[e].count);
+        for ( uint32_t i = 0; (i < m_events[e].count) && (i < 3); ++i )
+        {
+            TEST_CHECK(p_event[i].frequency == frequencies[i], "event %u packet %u on %u", e, i, p_event[i].frequency);
+            TEST_CHECK(p_event[i].datawhiteiv == 37 + i, "event %u packet %u whitening %u", e, i, p_event[i].datawhiteiv);
+            TEST_CHECK(memcmp(p_event[i].pdu, p_event[0].pdu, sizeof(p_event[0].pdu)) == 0, "event %u packet %u PDU differs", e, i);
+        }
+    }
+}
+
+
+/* Checks the first advertising event and the intervals, and that advDelay averages half its range. */
+static void events_timing_check(const sim_packet_t * p_packets)
+{
+    uint64_t delay_sum = 0;
+    uint64_t first_ns  = p_packets[m_events[0].first].start_ns;
+
+    TEST_CHECK((first_ns + M_INTERVAL_SLACK_NS + M_FIRST_EARLY_NS >= INITIAL_TIMEOUT * 1000ULL)
+            && (first_ns <= INITIAL_TIMEOUT * 1000ULL + M_INTERVAL_SLACK_NS),
+               "first event at %llu ns", (unsigned long long)first_ns);
+
+    for ( uint32_t e = 1; e < m_event_count; ++e )
+    {
+        uint64_t interval = p_packets[m_events[e].first].start_ns - p_packets[m_events[e - 1].first].start_ns;
+        int64_t  delay    = (int64_t)interval - (int64_t)INTERVAL_US * 1000;
+
+        TEST_CHECK((delay >= -(int64_t)M_INTERVAL_SLACK_NS) && (delay <= (int64_t)(M_ADV_DELAY_MAX_NS + M_INTERVAL_SLACK_NS)),
+                   "interval %u is %llu ns", e, (unsigned long long)interval);
+        delay_sum += (delay > 0) ? (uint64_t)delay : 0;
+    }
+#ifdef ADV_DELAY_ENABLE
+    {
+        double mean = (double)delay_sum / (m_event_count - 1);
+
+        printf("  mean advDelay %.2f ms\n", mean / 1e6);
+        TEST_CHECK(fabs(mean - M_ADV_DELAY_MAX_NS / 2.0) < M_ADV_DELAY_MAX_NS / 8.0, "mean advDelay %.0f ns", mean);
+    }
+#endif
+}
+
+
+/* Checks the sensor values advertised once the first reading is in. */
+static void events_values_check(const sim_packet_t * p_packets)
+{
+    uint32_t temperatures = 0;
+    uint32_t pressures    = 0;
+
+    for ( uint32_t e = 0; e < m_event_count; ++e )
+    {
+        const uint8_t * p_data = &p_packets[m_events[e].first].pdu[SINT16_SERVICE_DATA_OFFS];
+        uint8_t         type   = linking_service_data_id_unpack(p_data);
+        uint16_t        value  = linking_service_data_value_unpack(p_data);
+
+        if ( value == 0 )
+        {
+            continue;
+        }
+        if ( type == LINKING_SERVICE_TYPE_TEMPERATURE )
+        {
+            float temperature = IEEE754_Decode_Temperature(value);
+
+            ++temperatures;
+            TEST_CHECK(fabsf(temperature - M_TEMPERATURE) <= 0.25f, "event %u temperature %.2f", e, temperature);
+        }
+#ifdef SENSOR_BEACON_BACKEND_LPS25H
+        else if ( type == LINKING_SERVICE_TYPE_AIRPRESSURE )
+        {
+            float pressure = IEEE754_Decode_Air_Pressure(value);
+
+            ++pressures;
+            TEST_CHECK(fabsf(pressure - M_PRESSURE_HPA) <= M_PRESSURE_HPA * 0.01f, "event %u pressure %.2f", e, pressure);
+        }
+#endif
+    }
+    printf("  %u events with temperature, %u with air pressure\n", temperatures, pressures);
+    TEST_CHECK(temperatures >= m_event_count / (3 * SENSOR_SKIP_READ_COUNT) / 2, "%u temperatures", temperatures);
+#ifdef SENSOR_BEACON_BACKEND_LPS25H
+    TEST_CHECK(pressures >= m_event_count / (3 * SENSOR_SKIP_READ_COUNT) / 2, "%u pressures", pressures);
+#endif
+}
+
+
+int main(void)
+{
+    const sim_stats_t  * p_stats;
+    const sim_packet_t * p_packets;
+    uint32_t             packet_count;
+    sim_exit_t           exit_reason;
+    uint64_t             average_na;
+
+    sim_init();
+#ifdef SENSOR_BEACON_BACKEND_LPS25H
+#ifdef SENSOR_DRDY_PIN
+    lps25h_model_init(SENSOR_DRDY_PIN);
+#else
+    lps25h_model_init(LPS25H_MODEL_PIN_NONE);
+#endif
+    lps25h_model_values_set((int32_t)(M_TEMPERATURE * 1000), (uint32_t)(M_PRESSURE_HPA * 100));
+#else
+    sim_temp_set((int32_t)(M_TEMPERATURE * 4));
+#endif
+
+    exit_reason = sim_run(beacon_entry, M_RUN_NS);
+    TEST_CHECK(exit_reason == SIM_EXIT_TIME_LIMIT, "exit %d", exit_reason);
+
+    p_stats   = sim_stats_get();
+    p_packets = sim_packets_get(&packet_count);
+    events_collect(p_packets, packet_count);
+    TEST_CHECK(m_event_count >= (M_RUN_NS / 1000) / (INTERVAL_US + M_ADV_DELAY_MAX_NS / 1000) - 1, "%u events", m_event_count);
+
+    average_na = energy_report(TEST_NAME, &p_stats->time, sim_now_ns());
+    printf("  %u advertising events, %.2f wake-ups, %.1f us CPU and %.1f us HFXO per event\n", m_event_count,
+           (double)p_stats->wakeups / m_event_count,
+           (double)p_stats->time.cpu_ns / 1000 / m_event_count, (double)p_stats->time.hfxo_ns / 1000 / m_event_count);
+
+    events_channels_check(p_packets);
+    events_timing_check(p_packets);
+    events_values_check(p_packets);
+
+    TEST_CHECK(p_stats->time.cpu_ns + p_stats->time.sleep_ns == sim_now_ns(), "CPU and sleep time do not add up");
+    TEST_CHECK(p_stats->radio_without_hfxo == 0, "%u radio starts without the HFXO", p_stats->radio_without_hfxo);
+    TEST_CHECK(p_stats->hfxo_starts == m_event_count, "%u HFXO starts for %u events", p_stats->hfxo_starts, m_event_count);
+    TEST_CHECK(average_na <= M_CURRENT_BUDGET_NA, "average current %llu nA", (unsigned long long)average_na);
+#ifdef HFCLK_PRECISION_MODE_ENABLE
+    TEST_CHECK(m_hfclk.timeout_count == 0, "%u HFCLK startup timeouts", m_hfclk.timeout_count);
+#endif
+#ifdef SENSOR_BEACON_BACKEND_LPS25H
+    {
+        const lps25h_model_stats_t * p_sensor = lps25h_model_stats_get();
+
+        printf("  sensor powered %.1f us per second, %u conversions\n",
+               (double)p_sensor->powered_ns * 1e6 / sim_now_ns(), p_sensor->conversions);
+        TEST_CHECK(p_sensor->nacks == 0, "%u sensor transfers not acknowledged", p_sensor->nacks);
+#ifdef SENSOR_FIFO_MEAN_ENABLE
+        TEST_CHECK(p_sensor->conversions == p_sensor->power_ups * (SENSOR_FIFO_MEAN_WTM_POINT + 1),
+                   "%u conversions for %u power-ups", p_sensor->conversions, p_sensor->power_ups);
+        TEST_CHECK(p_sensor->mean_samples == SENSOR_FIFO_MEAN_WTM_POINT + 1, "%u samples in the mean", p_sensor->mean_samples);
+#else
+        TEST_CHECK(p_sensor->conversions == p_sensor->power_ups, "%u conversions for %u power-ups", p_sensor->conversions, p_sensor->power_ups);
+#endif
+#ifdef SENSOR_DRDY_PIN
+        // One status read on the data-ready signal and one read of the outputs per measurement.
+        TEST_CHECK(p_sensor->reads == 2 * p_sensor->power_ups, "%u reads for %u power-ups", p_sensor->reads, p_sensor->power_ups);
+#endif
+        TEST_CHECK(p_sensor->powered_ns * 100 < sim_now_ns(), "sensor powered %llu ns", (unsigned long long)p_sensor->powered_ns);
+    }
+#endif
+
+    return ( test_result(TEST_NAME) );
+}
@@ -0,0 +1,106 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+#ifndef BLE_PDLP_AGGREGATOR_H__
+#define BLE_PDLP_AGGREGATOR_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "ble_pdlp_beacon_parser.h"
+
+/* Last value aggregator of Linking readings per device and service, for gateways.
+ * A beacon sends each advertising event on three channels, and several gateways may receive it, so the same
+ * reading arrives several times. A reading with the same value as the last one passed on, and within window_us
+ * of it, is a duplicate: it updates the counters and the RSSI statistics but is not passed on.
+ * The entries are kept in an open addressing hash table in a buffer given by the caller, see
+ * ble_pdlp_aggregator_memory_size. Entries are never removed, so the table is sized for all the devices of a
+ * site, e.g. 262144 slots for 100000 devices with up to two services each.
+ */
+
+#define BLE_PDLP_AGGREGATOR_RSSI_UNKNOWN    (127)   /* An RSSI that is not available, as in HCI and BLE_PDLP_CAPTURE_RSSI_UNKNOWN, not used in the statistics. */
+
+/**@brief The aggregate of one device and service. */
+typedef struct
+{
+    uint64_t first_seen_us;                     /**< The time of the first packet. */
+    uint64_t last_seen_us;                      /**< The time of the latest packet, duplicates included. */
+    uint64_t accepted_us;                       /**< The time of the last reading passed on. */
+    int64_t  rssi_sum;                          /**< The sum of the RSSI, divide by rssi_count for the mean. */
+    uint32_t rssi_count;                        /**< The number of packets with an RSSI. */
+    uint32_t packet_count;                      /**< The number of packets, duplicates included. */
+    uint32_t duplicate_count;                   /**< The number of duplicate and out of date packets. */
+    uint16_t value;                             /**< The 12-bit value of the last reading passed on. */
+    uint8_t  bd_addr[M_BD_ADDR_SIZE];           /**< The device address, least significant byte first. */
+    uint8_t  service_id;                        /**< The service ID, see LINKING_SERVICE_TYPE_*. */
+    uint8_t  used;                              /**< The slot holds an entry. */
+    int8_t   rssi_min;                          /**< The weakest RSSI in dBm, BLE_PDLP_AGGREGATOR_RSSI_UNKNOWN while rssi_count is 0. */
+    int8_t   rssi_max;                          /**< The strongest RSSI in dBm, BLE_PDLP_AGGREGATOR_RSSI_UNKNOWN while rssi_count is 0. */
+} ble_pdlp_aggregator_entry_t;
+
+/**@brief Aggregator state. */
+typedef struct
+{
+    ble_pdlp_aggregator_entry_t * p_slots;      /**< The hash table. */
+    uint32_t                      mask;         /**< The number of slots - 1. */
+    uint32_t                      window_us;    /**< The window in which a repeated value is a duplicate. */
+    uint32_t                      entry_count;  /**< The number of entries. */
+    uint64_t                      update_count; /**< The number of packets. */
+    uint64_t                      accept_count; /**< The number of readings passed on. */
+    uint64_t                      full_count;   /**< The number of packets of new entries dropped because the table was full. */
+} ble_pdlp_aggregator_t;
+
+/**@brief Returns the size of the buffer for a table of slot_count slots, in bytes. */
+size_t ble_pdlp_aggregator_memory_size(uint32_t slot_count);
+
+/**@brief Initializes an empty aggregator.
+ *
+ * @param[in] p_slots    A buffer of ble_pdlp_aggregator_memory_size(slot_count) bytes.
+ * @param[in] slot_count The number of slots, a power of 2. At most 7/8 of them are used.
+ * @param[in] window_us  The window of an advertising event, e.g. 10000.
+ *
+ * @return false if slot_count is not a power of 2.
+ */
+bool ble_pdlp_aggregator_init(ble_pdlp_aggregator_t * p_aggregator, void * p_slots, uint32_t slot_count, uint32_t window_us);
+
+/**@brief Adds a packet of a reading.
+ *
+ * @return true if the reading is new and is to be passed on, false if it is a duplicate, is out of date
+ *         or the table is full.
+ */
+bool ble_pdlp_aggregator_update(ble_pdlp_aggregator_t * p_aggregator,
+                                uint8_t const         * p_bd_addr,
+                                uint8_t                 service_id,
+                                uint16_t                value,
+                                int8_t                  rssi,
+                                uint64_t                timestamp_us);
+
+/**@brief Adds the readings of a parsed beacon. new_mask has bit i set if service data entry i is new.
+ *
+ * @return The number of new readings.
+ */
+uint8_t ble_pdlp_aggregator_update_beacon(ble_pdlp_aggregator_t   * p_aggregator,
+                                          ble_pdlp_beacon_t const * p_beacon,
+                                          int8_t                    rssi,
+                                          uint64_t                  timestamp_us,
+                                          uint16_t                * p_new_mask);
+
+/**@brief Finds the aggregate of a device and service.
+ *
+ * @return NULL if there is none.
+ */
+ble_pdlp_aggregator_entry_t const * ble_pdlp_aggregator_find(ble_pdlp_aggregator_t const * p_aggregator,
+                                                             uint8_t const               * p_bd_addr,
+                                                             uint8_t                       service_id);
+
+#endif // BLE_PDLP_AGGREGATOR_H__
+
+/** @} */
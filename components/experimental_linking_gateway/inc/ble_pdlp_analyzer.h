@@ -0,0 +1,106 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+#ifndef BLE_PDLP_ANALYZER_H__
+#define BLE_PDLP_ANALYZER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ble_pdlp_capture.h"
+
+/* Offline analyzer of PDLP transactions, fed with the ATT records of one connection in time order.
+ * A transaction is the request written by the phone, in one or more packets, and the response indicated
+ * by the device, in one or more packets each confirmed by the phone. Its time is split into:
+ *   think:    from the end of the previous transaction until the first request packet (phone).
+ *   request:  from the first until the last request packet (phone and radio).
+ *   firmware: from the last request packet until the first response packet (device).
+ *   confirm:  from the first response packet until the confirmation of the last one (radio and phone).
+ */
+
+#define BLE_PDLP_ANALYZER_SUMMARY_MAX   (32)    /* The number of service and message ID pairs summarized. */
+
+/**@brief One analyzed transaction. */
+typedef struct
+{
+    uint8_t  service;                           /**< The PDLP service of the request. */
+    uint16_t msgid;                             /**< The message ID of the request. */
+    bool     responded;                         /**< A response was indicated, false if the next request came first. */
+    bool     nack;                              /**< The response was or ended with an error or cancel message. */
+    bool     cancelled;                         /**< The phone cancelled the transaction, the cancel packet ends the request. */
+    uint8_t  request_packets;                   /**< The number of request packets, with the cancel packet. */
+    uint8_t  response_packets;                  /**< The number of response packets. */
+    uint32_t think_us;                          /**< Phone think time, 0 for the first transaction. */
+    uint32_t request_us;                        /**< Time to write the request. */
+    uint32_t firmware_us;                       /**< Device response time. */
+    uint32_t confirm_us;                        /**< Time to indicate and confirm the response. */
+} ble_pdlp_transaction_t;
+
+/**@brief The summary of the transactions of one service and message ID. */
+typedef struct
+{
+    uint8_t  service;                           /**< The PDLP service. */
+    uint16_t msgid;                             /**< The message ID of the request. */
+    uint32_t count;                             /**< The number of transactions. */
+    uint32_t unanswered_count;                  /**< The number of transactions without a response. */
+    uint32_t nack_count;                        /**< The number of error or cancel responses. */
+    uint64_t think_us_sum;                      /**< The sums of the times, divide by count for the mean. */
+    uint64_t request_us_sum;
+    uint64_t firmware_us_sum;
+    uint64_t confirm_us_sum;
+    uint32_t think_us_max;                      /**< The longest times. */
+    uint32_t request_us_max;
+    uint32_t firmware_us_max;
+    uint32_t confirm_us_max;
+} ble_pdlp_summary_t;
+
+/**@brief Analyzer state of one connection. */
+typedef struct
+{
+    uint16_t               write_handle;        /**< The handle of the Write Message characteristic, 0 for any. */
+    uint16_t               ind_handle;          /**< The handle of the Indicate Message characteristic, 0 for any. */
+    enum
+    {
+        BLE_PDLP_ANALYZER_STATE_IDLE,
+        BLE_PDLP_ANALYZER_STATE_WRITING,
+        BLE_PDLP_ANALYZER_STATE_WAITING,
+        BLE_PDLP_ANALYZER_STATE_INDICATING,
+    }                      state;               /**< The state of the current transaction. */
+    bool                   last_indicated;      /**< The last response packet has been indicated. */
+    bool                   has_previous;        /**< A transaction has ended, for the think time. */
+    uint64_t               previous_end_us;     /**< The end of the previous transaction. */
+    uint64_t               request_first_us;    /**< The first request packet. */
+    uint64_t               request_last_us;     /**< The last request packet. */
+    uint64_t               response_first_us;   /**< The first response packet. */
+    ble_pdlp_transaction_t current;             /**< The current transaction. */
+    ble_pdlp_transaction_t last;                /**< The last finished transaction. */
+    uint32_t               summary_count;       /**< The number of entries in summary. */
+    uint32_t               dropped_count;       /**< The transactions not summarized because summary is full. */
+    ble_pdlp_summary_t     summary[BLE_PDLP_ANALYZER_SUMMARY_MAX];  /**< The summary per service and message ID. */
+} ble_pdlp_analyzer_t;
+
+/**@brief Resets the analyzer. The characteristic handles may be 0 to take PDLP packets from any handle. */
+void ble_pdlp_analyzer_init(ble_pdlp_analyzer_t * p_analyzer, uint16_t write_handle, uint16_t ind_handle);
+
+/**@brief Feeds one ATT record of the connection.
+ *
+ * @return true if a transaction has finished, it is then in p_analyzer->last.
+ */
+bool ble_pdlp_analyzer_att_record(ble_pdlp_analyzer_t * p_analyzer, ble_pdlp_capture_record_t const * p_record);
+
+/**@brief Finishes a transaction left waiting for its response, at the end of the capture.
+ *
+ * @return true if a transaction has finished, it is then in p_analyzer->last.
+ */
+bool ble_pdlp_analyzer_flush(ble_pdlp_analyzer_t * p_analyzer);
+
+#endif // BLE_PDLP_ANALYZER_H__
+
+/** @} */
@@ -0,0 +1,63 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+#ifndef BLE_PDLP_BEACON_PARSER_H__
+#define BLE_PDLP_BEACON_PARSER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ble_pdlp_beacon.h"
+
+/* Parser of Linking beacons from received advertising reports, for gateways and other scanners.
+ * It keeps no state and does not allocate, so batches may be parsed from several threads at once.
+ */
+
+#define LINKING_COMPANY_ID          (0x02E2)    /* The company ID of the Linking manufacturer specific data (DoCoMo). */
+#define LINKING_ADV_DATA_MAX_LEN    (31)        /* The maximum length of the advertising data. */
+#define LINKING_SERVICE_DATA_MAX    (10)        /* The maximum number of service data entries that fit in the advertising data. */
+
+/**@brief A received advertising report. */
+typedef struct
+{
+    uint8_t bd_addr[M_BD_ADDR_SIZE];                /**< The advertiser address, least significant byte first. */
+    uint8_t data_len;                               /**< The length of data. */
+    uint8_t data[LINKING_ADV_DATA_MAX_LEN];         /**< The advertising data. */
+} ble_pdlp_adv_report_t;
+
+/**@brief A parsed Linking beacon. */
+typedef struct
+{
+    uint32_t report_index;                          /**< The index of the report in the batch. */
+    uint8_t  bd_addr[M_BD_ADDR_SIZE];               /**< The advertiser address, least significant byte first. */
+    bool     has_uuid;                              /**< The Linking 128-bit service UUID is present. */
+    uint8_t  version;                               /**< The 4-bit version. */
+    uint8_t  vendor_id;                             /**< The 8-bit vendor ID. */
+    uint32_t class_id;                              /**< The 20-bit class ID. */
+    uint8_t  service_count;                         /**< The number of service data entries. */
+    uint8_t  service_ids[LINKING_SERVICE_DATA_MAX]; /**< The service ID of each entry, see LINKING_SERVICE_TYPE_*. */
+    uint16_t values[LINKING_SERVICE_DATA_MAX];      /**< The 12-bit value of each entry, see the unpack functions of ble_pdlp_beacon.h and IEEE754_Decode_*. */
+} ble_pdlp_beacon_t;
+
+/**@brief Parses the advertising data of one report.
+ *
+ * @return true if it is a Linking beacon. p_beacon is only written in that case, except for report_index.
+ */
+bool ble_pdlp_beacon_parse(uint8_t const * p_data, uint8_t data_len, ble_pdlp_beacon_t * p_beacon);
+
+/**@brief Parses a batch of reports and keeps the Linking beacons.
+ *
+ * @return The number of beacons written to p_beacons, at most count.
+ */
+uint32_t ble_pdlp_beacon_parse_batch(ble_pdlp_adv_report_t const * p_reports, uint32_t count, ble_pdlp_beacon_t * p_beacons);
+
+#endif // BLE_PDLP_BEACON_PARSER_H__
+
+/** @} */
@@ -0,0 +1,103 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+#ifndef BLE_PDLP_CAPTURE_H__
+#define BLE_PDLP_CAPTURE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Reader of btsnoop (HCI H4) and pcap (BLE link layer) captures, for replaying Linking traffic on a host.
+ * The capture is read in place from a buffer, typically a file mapped with mmap, and the records point
+ * into it, so memory use does not grow with the size of the capture. Advertising reports are meant for
+ * ble_pdlp_beacon_parse, and the ATT values of writes and indications for the pdls_decode_* functions.
+ * For a paced replay, the caller waits for the timestamp of each record before handling it.
+ */
+
+#define BLE_PDLP_ATT_OP_WRITE_REQ       (0x12)  /**< ATT Write Request. */
+#define BLE_PDLP_ATT_OP_WRITE_CMD       (0x52)  /**< ATT Write Command. */
+#define BLE_PDLP_ATT_OP_NOTIFY          (0x1B)  /**< ATT Handle Value Notification. */
+#define BLE_PDLP_ATT_OP_INDICATE        (0x1D)  /**< ATT Handle Value Indication. */
+#define BLE_PDLP_ATT_OP_CONFIRM         (0x1E)  /**< ATT Handle Value Confirmation. */
+
+#define BLE_PDLP_CAPTURE_RSSI_UNKNOWN   (127)   /**< The RSSI of a record without one, as HCI reports it when it is not available. */
+
+/**@brief Capture file formats. */
+typedef enum
+{
+    BLE_PDLP_CAPTURE_FORMAT_BTSNOOP,                /**< btsnoop with HCI H4 (UART) or unencapsulated HCI framing. */
+    BLE_PDLP_CAPTURE_FORMAT_PCAP_BLE_LL,            /**< pcap with LINKTYPE_BLUETOOTH_LE_LL. */
+    BLE_PDLP_CAPTURE_FORMAT_PCAP_BLE_LL_WITH_PHDR,  /**< pcap with LINKTYPE_BLUETOOTH_LE_LL_WITH_PHDR. */
+} ble_pdlp_capture_format_t;
+
+/**@brief Capture reader state. */
+typedef struct
+{
+    uint8_t const *           p_buf;                /**< The capture. */
+    size_t                    len;                  /**< Length of p_buf. */
+    size_t                    offs;                 /**< Offset of the next record. */
+    ble_pdlp_capture_format_t format;               /**< The format of the capture. */
+    bool                      h4;                   /**< The btsnoop records start with the H4 packet type. */
+    bool                      swapped;              /**< The pcap header fields are byte-swapped. */
+    bool                      nanoseconds;          /**< The pcap timestamps are in nanoseconds. */
+} ble_pdlp_capture_t;
+
+/**@brief Record types. */
+typedef enum
+{
+    BLE_PDLP_CAPTURE_RECORD_OTHER,                  /**< Any other record, only the timestamp is valid. */
+    BLE_PDLP_CAPTURE_RECORD_ADV,                    /**< An advertising report or advertising channel PDU. */
+    BLE_PDLP_CAPTURE_RECORD_ATT,                    /**< An ATT PDU carrying an attribute value. */
+} ble_pdlp_capture_record_type_t;
+
+/**@brief A capture record. The pointers are into the capture buffer. */
+typedef struct
+{
+    ble_pdlp_capture_record_type_t type;            /**< The record type. */
+    uint64_t                       timestamp_us;    /**< The time of the record, in microseconds since 1970. */
+    union
+    {
+        struct
+        {
+            uint8_t const * p_bd_addr;              /**< The advertiser address, least significant byte first. */
+            uint8_t const * p_data;                 /**< The advertising data. */
+            uint8_t         data_len;               /**< Length of p_data. */
+            int8_t          rssi;                   /**< The RSSI in dBm, from the HCI report or the signal power of the RF info header,
+                                                         BLE_PDLP_CAPTURE_RSSI_UNKNOWN if the capture has none. */
+        } adv;
+        struct
+        {
+            uint16_t        conn_handle;            /**< The HCI connection handle. */
+            bool            received;               /**< The PDU was received by the host, not sent. */
+            uint8_t         opcode;                 /**< The ATT opcode: write request or command, notification, indication or confirmation. */
+            uint16_t        attr_handle;            /**< The attribute handle, 0 for a confirmation. */
+            uint8_t const * p_value;                /**< The attribute value. */
+            uint16_t        value_len;              /**< Length of p_value. */
+        } att;
+    } params;
+} ble_pdlp_capture_record_t;
+
+/**@brief Starts reading a capture, detecting its format from the file header.
+ *
+ * @return false if the format is not supported.
+ */
+bool ble_pdlp_capture_open(ble_pdlp_capture_t * p_capture, uint8_t const * p_buf, size_t len);
+
+/**@brief Reads the next record.
+ *
+ * @return false at the end of the capture, or at a truncated record.
+ */
+bool ble_pdlp_capture_next(ble_pdlp_capture_t * p_capture, ble_pdlp_capture_record_t * p_record);
+
+#endif // BLE_PDLP_CAPTURE_H__
+
+/** @} */
@@ -0,0 +1,120 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+#ifndef BLE_PDLP_PIPELINE_H__
+#define BLE_PDLP_PIPELINE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ble_pdlp_ring.h"
+#include "ble_pdlp_capture.h"
+#include "ble_pdlp_beacon_parser.h"
+#include "ble_pdlp_aggregator.h"
+#include "ble_pdlp_store.h"
+
+/* Gateway pipeline stages: capture -> decode -> aggregate -> store, connected by ble_pdlp_ring rings of
+ * ble_pdlp_pipeline_report_t and ble_pdlp_pipeline_beacon_t. The aggregate stage passes on the new readings
+ * only, so the store does not keep the copies of a reading sent on the three advertising channels.
+ * Each stage is a step function handling up to batch_max elements, for a thread of its own which the caller
+ * creates and pins to a core with the API of its system:
+ *
+ *     while (!ble_pdlp_ring_is_drained(&reports))
+ *     {
+ *         if (ble_pdlp_pipeline_decode_step(&decode, &reports, &beacons) == 0)
+ *         {
+ *             // Nothing to do, yield or sleep
+ *         }
+ *     }
+ *
+ * A ring has one producer and one consumer, so with several radios each capture stage has its own ring to its
+ * decode stage, and a decode stage may serve several rings in turn. The store needs its timestamps in order, the
+ * readings of several radios that would go backwards are dropped. The counters of a stage are written by its
+ * own thread only, other threads may read them for monitoring but can see values one step old.
+ */
+
+/**@brief What a stage does when its output ring is full. */
+typedef enum
+{
+    BLE_PDLP_PIPELINE_BACKPRESSURE_WAIT,        /**< Leave the input unread until there is room, so the stages before slow down. */
+    BLE_PDLP_PIPELINE_BACKPRESSURE_DROP,        /**< Read the input anyway and drop the output that has no room. */
+} ble_pdlp_pipeline_backpressure_t;
+
+/**@brief An advertising report from a capture. */
+typedef struct
+{
+    uint64_t              timestamp_us;         /**< The time of the report, in microseconds since 1970. */
+    int8_t                rssi;                 /**< The RSSI in dBm, BLE_PDLP_CAPTURE_RSSI_UNKNOWN if the capture has none. */
+    ble_pdlp_adv_report_t report;               /**< The report. */
+} ble_pdlp_pipeline_report_t;
+
+/**@brief A parsed Linking beacon. */
+typedef struct
+{
+    uint64_t          timestamp_us;             /**< The time of the report, in microseconds since 1970. */
+    int8_t            rssi;                     /**< The RSSI of the report. */
+    ble_pdlp_beacon_t beacon;                   /**< The beacon, report_index is not used. */
+} ble_pdlp_pipeline_beacon_t;
+
+/**@brief Stage settings and counters. */
+typedef struct
+{
+    ble_pdlp_pipeline_backpressure_t backpressure;  /**< What to do when the output ring is full. */
+    uint32_t                         batch_max;     /**< The maximum number of input elements per step. */
+    uint64_t                         step_count;    /**< The number of steps that handled input. */
+    uint64_t                         in_count;      /**< The number of input elements handled. */
+    uint64_t                         out_count;     /**< The number of output elements written. */
+    uint64_t                         drop_count;    /**< The number of output elements dropped. */
+    uint32_t                         depth_max;     /**< The largest depth seen of the input ring. */
+} ble_pdlp_pipeline_stage_t;
+
+/**@brief Resets the counters and sets the settings of a stage. */
+void ble_pdlp_pipeline_stage_init(ble_pdlp_pipeline_stage_t      * p_stage,
+                                  ble_pdlp_pipeline_backpressure_t backpressure,
+                                  uint32_t                         batch_max);
+
+/**@brief Reads capture records and writes their advertising reports to p_out, which is closed at the end of the capture.
+ *
+ * @return The number of records read.
+ */
+uint32_t ble_pdlp_pipeline_capture_step(ble_pdlp_pipeline_stage_t * p_stage,
+                                        ble_pdlp_capture_t        * p_capture,
+                                        ble_pdlp_ring_t           * p_out);
+
+/**@brief Parses reports from p_in and writes the Linking beacons to p_out, which is closed once p_in is drained.
+ *
+ * @return The number of reports read.
+ */
+uint32_t ble_pdlp_pipeline_decode_step(ble_pdlp_pipeline_stage_t * p_stage,
+                                       ble_pdlp_ring_t           * p_in,
+                                       ble_pdlp_ring_t           * p_out);
+
+/**@brief Adds the beacons from p_in to an aggregator and writes the beacons with new readings to p_out, with
+ *        only their new readings. p_out is closed once p_in is drained. A beacon without new readings is read
+ *        but not written, the aggregator counts its duplicates.
+ *
+ * @return The number of beacons read.
+ */
+uint32_t ble_pdlp_pipeline_aggregate_step(ble_pdlp_pipeline_stage_t * p_stage,
+                                          ble_pdlp_ring_t           * p_in,
+                                          ble_pdlp_aggregator_t     * p_aggregator,
+                                          ble_pdlp_ring_t           * p_out);
+
+/**@brief Appends the beacons from p_in to a store. Readings that do not fit in the store are counted as dropped.
+ *
+ * @return The number of beacons read.
+ */
+uint32_t ble_pdlp_pipeline_store_step(ble_pdlp_pipeline_stage_t * p_stage,
+                                      ble_pdlp_ring_t           * p_in,
+                                      ble_pdlp_store_t          * p_store);
+
+#endif // BLE_PDLP_PIPELINE_H__
+
+/** @} */
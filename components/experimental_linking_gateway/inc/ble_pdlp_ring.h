@@ -0,0 +1,78 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+#ifndef BLE_PDLP_RING_H__
+#define BLE_PDLP_RING_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Bounded lock-free ring of fixed-size elements between one producer and one consumer, each in its own thread
+ * or one of them in an interrupt handler. Elements are handed off in batches, in place: the producer reserves
+ * free elements, fills them and commits them, and the consumer reserves the filled elements, handles them and
+ * commits them back. The head and the tail are kept a cache line apart so the two sides do not share it.
+ */
+
+#define BLE_PDLP_RING_CACHE_LINE    (64)    /* The assumed size of a cache line, in bytes. */
+
+/**@brief Ring state. */
+typedef struct
+{
+    uint8_t * p_buf;                            /**< The elements. */
+    uint32_t  elem_size;                        /**< The size of an element, in bytes. */
+    uint32_t  mask;                             /**< The number of elements - 1. */
+    uint8_t   pad0[BLE_PDLP_RING_CACHE_LINE];
+    uint32_t  head;                             /**< The count of elements written, written by the producer only. */
+    uint32_t  tail_cached;                      /**< The producer's copy of tail. */
+    uint32_t  closed;                           /**< The producer will write no more elements. */
+    uint8_t   pad1[BLE_PDLP_RING_CACHE_LINE];
+    uint32_t  tail;                             /**< The count of elements read, written by the consumer only. */
+    uint32_t  head_cached;                      /**< The consumer's copy of head. */
+    uint8_t   pad2[BLE_PDLP_RING_CACHE_LINE];
+} ble_pdlp_ring_t;
+
+/**@brief Initializes an empty ring over a buffer of count elements of elem_size bytes.
+ *
+ * @return false if count is not a power of 2.
+ */
+bool ble_pdlp_ring_init(ble_pdlp_ring_t * p_ring, void * p_buf, uint32_t elem_size, uint32_t count);
+
+/**@brief Reserves free elements, for the producer. The elements are contiguous, so there may be
+ *        fewer than the free ones when the ring wraps around.
+ *
+ * @return The number of elements at *pp_elems, at most max.
+ */
+uint32_t ble_pdlp_ring_write_reserve(ble_pdlp_ring_t * p_ring, void ** pp_elems, uint32_t max);
+
+/**@brief Hands the first count reserved elements to the consumer. */
+void ble_pdlp_ring_write_commit(ble_pdlp_ring_t * p_ring, uint32_t count);
+
+/**@brief Tells the consumer that no more elements will be written. */
+void ble_pdlp_ring_close(ble_pdlp_ring_t * p_ring);
+
+/**@brief Reserves written elements, for the consumer. As with writing, they are contiguous.
+ *
+ * @return The number of elements at *pp_elems, at most max.
+ */
+uint32_t ble_pdlp_ring_read_reserve(ble_pdlp_ring_t * p_ring, void ** pp_elems, uint32_t max);
+
+/**@brief Gives the first count reserved elements back to the producer. */
+void ble_pdlp_ring_read_commit(ble_pdlp_ring_t * p_ring, uint32_t count);
+
+/**@brief Returns the number of written elements not read yet. It may be stale when read by the producer. */
+uint32_t ble_pdlp_ring_depth(ble_pdlp_ring_t * p_ring);
+
+/**@brief Returns true when the ring is closed and all its elements are read, for the consumer. */
+bool ble_pdlp_ring_is_drained(ble_pdlp_ring_t * p_ring);
+
+#endif // BLE_PDLP_RING_H__
+
+/** @} */
@@ -0,0 +1,150 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+#ifndef BLE_PDLP_STORE_H__
+#define BLE_PDLP_STORE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ble_pdlp_beacon_parser.h"
+
+/* Append-only columnar store of decoded Linking readings, for gateways.
+ * The store is a segment in a buffer given by the caller, which may be a memory-mapped file. The segment starts
+ * with a header, the hash table and the dictionary of device addresses, sized for the devices of the site when the
+ * store is created. Blocks of up to BLE_PDLP_STORE_BLOCK_RECORDS readings follow, each with one summary per device
+ * and service in it, sorted so that queries find them by binary search, then its columns: the values, service IDs
+ * and RSSIs, the dictionary indexes of the devices as varints and the timestamps as varint deltas.
+ * The last block is open. It is written in place with room for a full block in each column, and is sealed when it
+ * is full: its summaries are sorted and its columns moved down to their used length, so a sealed block only takes
+ * the bytes of its readings and summaries, rounded up to 8. A block of more devices than fit its summaries well,
+ * with fewer than BLE_PDLP_STORE_SUMMARY_READINGS_MIN readings per summary, is sealed without them.
+ * The segment is in the byte order and alignment of the host, it must be reopened on the same kind of host.
+ */
+
+#define BLE_PDLP_STORE_MAGIC                (0x3253544C)    /* "LTS2" in the byte order of a little-endian host. */
+#define BLE_PDLP_STORE_DEVICE_MAX           (0x200000)      /* The largest dictionary, its indexes take up to 3 varint bytes. */
+#define BLE_PDLP_STORE_BLOCK_RECORDS        (4096)          /* The maximum number of readings in a block. */
+#define BLE_PDLP_STORE_BLOCK_TIMESTAMP_LEN  (BLE_PDLP_STORE_BLOCK_RECORDS * 3)  /* Deltas under 2 seconds take 3 bytes. */
+#define BLE_PDLP_STORE_BLOCK_DEVICE_LEN     (BLE_PDLP_STORE_BLOCK_RECORDS * 3)  /* The longest device index column. */
+#define BLE_PDLP_STORE_SUMMARY_READINGS_MIN (4)             /* The fewest readings per summary on average for a block to keep its summaries. */
+#define BLE_PDLP_STORE_SUMMARY_HASH_SIZE    (BLE_PDLP_STORE_BLOCK_RECORDS * 2)  /* The size of the summary hash table of the open block, a power of 2. */
+
+/**@brief The summary of the readings of one device and service in a block. */
+typedef struct
+{
+    double   sum;                                                   /**< The sum of the values. */
+    float    min;                                                   /**< The smallest value. */
+    float    max;                                                   /**< The largest value. */
+    uint32_t device;                                                /**< The dictionary index of the device. */
+    uint16_t count;                                                 /**< The number of readings. */
+    uint8_t  service_id;                                            /**< The service ID, see LINKING_SERVICE_TYPE_*. */
+} ble_pdlp_store_summary_t;
+
+/**@brief The header of a block, followed by its summaries and columns. */
+typedef struct
+{
+    uint64_t first_timestamp_us;                                    /**< The time of the first reading. */
+    uint64_t last_timestamp_us;                                     /**< The time of the last reading. */
+    uint32_t len;                                                   /**< The length of the sealed block with this header, 0 while open. */
+    uint16_t count;                                                 /**< The number of readings. */
+    uint16_t summary_count;                                         /**< The number of summaries, 0 if a sealed block has none. */
+    uint16_t device_len;                                            /**< The number of bytes in the device column. */
+    uint16_t timestamp_len;                                         /**< The number of bytes in the timestamp column. */
+} ble_pdlp_store_block_t;
+
+/**@brief The header at the start of a segment, followed by the device hash table and dictionary. */
+typedef struct
+{
+    uint32_t magic;                                                 /**< BLE_PDLP_STORE_MAGIC. */
+    uint32_t len;                                                   /**< The length of the segment. */
+    uint32_t device_max;                                            /**< The size of the dictionary. */
+    uint32_t device_hash_size;                                      /**< The size of the device hash table, a power of 2. */
+    uint32_t device_count;                                          /**< The number of devices in the dictionary. */
+    uint32_t block_offset;                                          /**< The offset of the first block in the segment. */
+    uint32_t open_offset;                                           /**< The offset of the open block, the end of the sealed ones. */
+    uint32_t block_count;                                           /**< The number of blocks, the last one is open. */
+} ble_pdlp_store_header_t;
+
+/**@brief A store, pointing into its segment. */
+typedef struct
+{
+    ble_pdlp_store_header_t * p_header;                             /**< The segment header. */
+    uint32_t                * p_device_hash;                        /**< The dictionary index + 1 of the addresses, 0 for an empty slot. */
+    uint8_t                 * p_devices;                            /**< The dictionary of device addresses, M_BD_ADDR_SIZE bytes each. */
+    uint16_t                  summary_hash[BLE_PDLP_STORE_SUMMARY_HASH_SIZE];  /**< The summary index + 1 of the open block per device and service. */
+} ble_pdlp_store_t;
+
+/**@brief The result of a query. */
+typedef struct
+{
+    uint32_t count;                                                 /**< The number of readings. */
+    float    min;                                                   /**< The smallest value, valid if count is not 0. */
+    float    max;                                                   /**< The largest value, valid if count is not 0. */
+    double   sum;                                                   /**< The sum of the values, divide by count for the mean. */
+} ble_pdlp_store_result_t;
+
+/**@brief Decodes the 12-bit value of a service. Temperature, humidity and air pressure are decoded with
+ *        IEEE754_Decode_*, the other values are returned as they are.
+ */
+float ble_pdlp_store_value_decode(uint8_t service_id, uint16_t value);
+
+/**@brief Returns the length of a segment with a dictionary of device_max devices and room for block_count full blocks.
+ *        Sealed blocks are shorter, the segment is full when the rest of it has no room for an open block.
+ */
+uint32_t ble_pdlp_store_segment_len(uint32_t device_max, uint32_t block_count);
+
+/**@brief Creates an empty store for up to device_max devices in a segment aligned to 8 bytes.
+ *
+ * @return false if device_max is 0 or over BLE_PDLP_STORE_DEVICE_MAX, or the segment is too small for one block.
+ */
+bool ble_pdlp_store_create(ble_pdlp_store_t * p_store, void * p_segment, uint32_t len, uint32_t device_max);
+
+/**@brief Opens a store from a segment written by ble_pdlp_store_create and ble_pdlp_store_append.
+ *
+ * @return false if the segment is not a store or is shorter than when it was created.
+ */
+bool ble_pdlp_store_open(ble_pdlp_store_t * p_store, void * p_segment, uint32_t len);
+
+/**@brief Appends a reading. The timestamps must not go backwards.
+ *
+ * @return false if the timestamp goes backwards, the dictionary is full or the segment is full.
+ */
+bool ble_pdlp_store_append(ble_pdlp_store_t * p_store,
+                           uint8_t const    * p_bd_addr,
+                           uint8_t            service_id,
+                           uint16_t           value,
+                           int8_t             rssi,
+                           uint64_t           timestamp_us);
+
+/**@brief Appends the service data of a parsed beacon, all with the same RSSI and timestamp.
+ *
+ * @return The number of readings appended, less than p_beacon->service_count if an append failed.
+ */
+uint8_t ble_pdlp_store_append_beacon(ble_pdlp_store_t        * p_store,
+                                     ble_pdlp_beacon_t const * p_beacon,
+                                     int8_t                    rssi,
+                                     uint64_t                  timestamp_us);
+
+/**@brief Computes the count, minimum, maximum and sum of the decoded values of one device and service,
+ *        from from_us up to but not including to_us.
+ *
+ * @return false if the device is not in the store.
+ */
+bool ble_pdlp_store_query(ble_pdlp_store_t const  * p_store,
+                          uint8_t const           * p_bd_addr,
+                          uint8_t                   service_id,
+                          uint64_t                  from_us,
+                          uint64_t                  to_us,
+                          ble_pdlp_store_result_t * p_result);
+
+#endif // BLE_PDLP_STORE_H__
+
+/** @} */
@@ -0,0 +1,159 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+#include "ble_pdlp_aggregator.h"
+#include <string.h>
+
+// FNV-1a of the address and the service ID
+static uint32_t key_hash(uint8_t const * p_bd_addr, uint8_t service_id)
+{
+    uint32_t hash = 2166136261UL;
+    uint8_t  i;
+
+    for (i = 0; i < M_BD_ADDR_SIZE; i++)
+    {
+        hash = (hash ^ p_bd_addr[i]) * 16777619UL;
+    }
+    return (hash ^ service_id) * 16777619UL;
+}
+
+// Returns the slot of the key, or the empty slot where it would go
+static ble_pdlp_aggregator_entry_t * slot_find(ble_pdlp_aggregator_t const * p_aggregator,
+                                               uint8_t const               * p_bd_addr,
+                                               uint8_t                       service_id)
+{
+    uint32_t                      index = key_hash(p_bd_addr, service_id) & p_aggregator->mask;
+    ble_pdlp_aggregator_entry_t * p_entry = &p_aggregator->p_slots[index];
+
+    while (p_entry->used
+    &&     ((p_entry->service_id != service_id) || (memcmp(p_entry->bd_addr, p_bd_addr, M_BD_ADDR_SIZE) != 0)))
+    {
+        index   = (index + 1) & p_aggregator->mask;
+        p_entry = &p_aggregator->p_slots[index];
+    }
+    return p_entry;
+}
+
+size_t ble_pdlp_aggregator_memory_size(uint32_t slot_count)
+{
+    return (size_t)slot_count * sizeof(ble_pdlp_aggregator_entry_t);
+}
+
+bool ble_pdlp_aggregator_init(ble_pdlp_aggregator_t * p_aggregator, void * p_slots, uint32_t slot_count, uint32_t window_us)
+{
+    if ((slot_count == 0) || ((slot_count & (slot_count - 1)) != 0))
+    {
+        return false;
+    }
+
+    memset(p_aggregator, 0, sizeof(*p_aggregator));
+    memset(p_slots, 0, ble_pdlp_aggregator_memory_size(slot_count));
+    p_aggregator->p_slots   = (ble_pdlp_aggregator_entry_t *)p_slots;
+    p_aggregator->mask      = slot_count - 1;
+    p_aggregator->window_us = window_us;
+    return true;
+}
+
+bool ble_pdlp_aggregator_update(ble_pdlp_aggregator_t * p_aggregator,
+                                uint8_t const         * p_bd_addr,
+                                uint8_t                 service_id,
+                                uint16_t                value,
+                                int8_t                  rssi,
+                                uint64_t                timestamp_us)
+{
+    ble_pdlp_aggregator_entry_t * p_entry = slot_find(p_aggregator, p_bd_addr, service_id);
+    bool                          accepted = true;
+
+    p_aggregator->update_count++;
+
+    if (!p_entry->used)
+    {
+        // Keep 1/8 of the slots empty so that probing stays short
+        if (p_aggregator->entry_count >= (p_aggregator->mask + 1) - ((p_aggregator->mask + 1) >> 3))
+        {
+            p_aggregator->full_count++;
+            return false;
+        }
+        memcpy(p_entry->bd_addr, p_bd_addr, M_BD_ADDR_SIZE);
+        p_entry->service_id    = service_id;
+        p_entry->used          = 1;
+        p_entry->value         = value;
+        p_entry->first_seen_us = timestamp_us;
+        p_entry->last_seen_us  = timestamp_us;
+        p_entry->accepted_us   = timestamp_us;
+        p_entry->rssi_min      = BLE_PDLP_AGGREGATOR_RSSI_UNKNOWN;
+        p_entry->rssi_max      = BLE_PDLP_AGGREGATOR_RSSI_UNKNOWN;
+        p_aggregator->entry_count++;
+    }
+    else if (((value == p_entry->value)
+    &&        (timestamp_us < (p_entry->accepted_us + p_aggregator->window_us))
+    &&        ((timestamp_us + p_aggregator->window_us) > p_entry->accepted_us))
+    ||       (timestamp_us < p_entry->accepted_us))
+    {
+        // The same reading from another channel or gateway, or an older one arriving late
+        p_entry->duplicate_count++;
+        accepted = false;
+    }
+    else
+    {
+        p_entry->value       = value;
+        p_entry->accepted_us = timestamp_us;
+    }
+
+    p_entry->packet_count++;
+    p_entry->last_seen_us = (timestamp_us > p_entry->last_seen_us) ? timestamp_us : p_entry->last_seen_us;
+    if (rssi != BLE_PDLP_AGGREGATOR_RSSI_UNKNOWN)
+    {
+        if (p_entry->rssi_count == 0)
+        {
+            p_entry->rssi_min = rssi;
+            p_entry->rssi_max = rssi;
+        }
+        p_entry->rssi_sum += rssi;
+        p_entry->rssi_count++;
+        p_entry->rssi_min = (rssi < p_entry->rssi_min) ? rssi : p_entry->rssi_min;
+        p_entry->rssi_max = (rssi > p_entry->rssi_max) ? rssi : p_entry->rssi_max;
+    }
+
+    p_aggregator->accept_count += accepted;
+    return accepted;
+}
+
+uint8_t ble_pdlp_aggregator_update_beacon(ble_pdlp_aggregator_t   * p_aggregator,
+                                          ble_pdlp_beacon_t const * p_beacon,
+                                          int8_t                    rssi,
+                                          uint64_t                  timestamp_us,
+                                          uint16_t                * p_new_mask)
+{
+    uint8_t count = 0;
+    uint8_t i;
+
+    *p_new_mask = 0;
+    for (i = 0; i < p_beacon->service_count; i++)
+    {
+        if (ble_pdlp_aggregator_update(p_aggregator, p_beacon->bd_addr, p_beacon->service_ids[i], p_beacon->values[i], rssi, timestamp_us))
+        {
+            *p_new_mask |= (uint16_t)(1 << i);
+            count++;
+        }
+    }
+    return count;
+}
+
+ble_pdlp_aggregator_entry_t const * ble_pdlp_aggregator_find(ble_pdlp_aggregator_t const * p_aggregator,
+                                                             uint8_t const               * p_bd_addr,
+                                                             uint8_t                       service_id)
+{
+    ble_pdlp_aggregator_entry_t const * p_entry = slot_find(p_aggregator, p_bd_addr, service_id);
+
+    return p_entry->used ? p_entry : NULL;
+}
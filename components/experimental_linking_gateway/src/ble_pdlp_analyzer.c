@@ -0,0 +1,229 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+#include "ble_pdlp_analyzer.h"
+#include "ble_pdlp_common.h"
+#include <string.h>
+
+static uint32_t elapsed_us(uint64_t from_us, uint64_t to_us)
+{
+    return (to_us > from_us) ? (uint32_t)(to_us - from_us) : 0;
+}
+
+static void summary_update(ble_pdlp_analyzer_t * p_analyzer, ble_pdlp_transaction_t const * p_transaction)
+{
+    ble_pdlp_summary_t * p_summary = NULL;
+    uint32_t             i;
+
+    for (i = 0; i < p_analyzer->summary_count; i++)
+    {
+        if ((p_analyzer->summary[i].service == p_transaction->service) && (p_analyzer->summary[i].msgid == p_transaction->msgid))
+        {
+            p_summary = &p_analyzer->summary[i];
+            break;
+        }
+    }
+
+    if (p_summary == NULL)
+    {
+        if (p_analyzer->summary_count == BLE_PDLP_ANALYZER_SUMMARY_MAX)
+        {
+            p_analyzer->dropped_count++;
+            return;
+        }
+        p_summary = &p_analyzer->summary[p_analyzer->summary_count++];
+        memset(p_summary, 0, sizeof(*p_summary));
+        p_summary->service = p_transaction->service;
+        p_summary->msgid   = p_transaction->msgid;
+    }
+
+    p_summary->count++;
+    p_summary->unanswered_count += !p_transaction->responded;
+    p_summary->nack_count       += p_transaction->nack;
+    p_summary->think_us_sum     += p_transaction->think_us;
+    p_summary->request_us_sum   += p_transaction->request_us;
+    p_summary->firmware_us_sum  += p_transaction->firmware_us;
+    p_summary->confirm_us_sum   += p_transaction->confirm_us;
+    p_summary->think_us_max      = (p_transaction->think_us    > p_summary->think_us_max)    ? p_transaction->think_us    : p_summary->think_us_max;
+    p_summary->request_us_max    = (p_transaction->request_us  > p_summary->request_us_max)  ? p_transaction->request_us  : p_summary->request_us_max;
+    p_summary->firmware_us_max   = (p_transaction->firmware_us > p_summary->firmware_us_max) ? p_transaction->firmware_us : p_summary->firmware_us_max;
+    p_summary->confirm_us_max    = (p_transaction->confirm_us  > p_summary->confirm_us_max)  ? p_transaction->confirm_us  : p_summary->confirm_us_max;
+}
+
+static void transaction_finish(ble_pdlp_analyzer_t * p_analyzer, uint64_t end_us)
+{
+    p_analyzer->current.request_us = elapsed_us(p_analyzer->request_first_us, p_analyzer->request_last_us);
+    if (p_analyzer->current.responded)
+    {
+        p_analyzer->current.firmware_us = elapsed_us(p_analyzer->request_last_us, p_analyzer->response_first_us);
+        p_analyzer->current.confirm_us  = elapsed_us(p_analyzer->response_first_us, end_us);
+    }
+
+    summary_update(p_analyzer, &p_analyzer->current);
+    p_analyzer->last            = p_analyzer->current;
+    p_analyzer->previous_end_us = end_us;
+    p_analyzer->has_previous    = true;
+    p_analyzer->state           = BLE_PDLP_ANALYZER_STATE_IDLE;
+}
+
+// Handles a packet written by the phone, returns true if it finished the previous transaction
+static bool on_write(ble_pdlp_analyzer_t * p_analyzer, uint64_t time_us, uint8_t const * p_data, uint16_t len)
+{
+    uint8_t header = p_data[0];
+    bool    finished = false;
+
+    if (((header >> PDLS_HEADER_SOURCE_Pos) & 0x01) == 1)
+    {
+        return false;
+    }
+
+    // A cancel ends the request, the device answers it with a cancel message or not at all. The transaction then
+    // finishes as any other, so the packets of the next request do not join the cancelled one.
+    if (((header >> PDLS_HEADER_CANCEL_Pos) & 0x01) == 1)
+    {
+        if (p_analyzer->state == BLE_PDLP_ANALYZER_STATE_IDLE)
+        {
+            return false;
+        }
+        p_analyzer->current.cancelled = true;
+        if (p_analyzer->state == BLE_PDLP_ANALYZER_STATE_WRITING)
+        {
+            p_analyzer->current.request_packets++;
+            p_analyzer->request_last_us = time_us;
+            p_analyzer->state           = BLE_PDLP_ANALYZER_STATE_WAITING;
+        }
+        return false;
+    }
+
+    // A request without a response is finished by the next request
+    if ((p_analyzer->state == BLE_PDLP_ANALYZER_STATE_WAITING) || (p_analyzer->state == BLE_PDLP_ANALYZER_STATE_INDICATING))
+    {
+        transaction_finish(p_analyzer, p_analyzer->request_last_us);
+        finished = true;
+    }
+
+    if (p_analyzer->state == BLE_PDLP_ANALYZER_STATE_IDLE)
+    {
+        memset(&p_analyzer->current, 0, sizeof(p_analyzer->current));
+        if (len >= 4)
+        {
+            p_analyzer->current.service = p_data[1];
+            p_analyzer->current.msgid   = (uint16_t)(p_data[2] | (p_data[3] << 8));
+        }
+        p_analyzer->current.think_us = p_analyzer->has_previous ? elapsed_us(p_analyzer->previous_end_us, time_us) : 0;
+        p_analyzer->request_first_us = time_us;
+        p_analyzer->state            = BLE_PDLP_ANALYZER_STATE_WRITING;
+    }
+
+    p_analyzer->current.request_packets++;
+    p_analyzer->request_last_us = time_us;
+    if (((header >> PDLS_HEADER_EXECUTE_Pos) & 0x01) == 1)
+    {
+        p_analyzer->state = BLE_PDLP_ANALYZER_STATE_WAITING;
+    }
+
+    return finished;
+}
+
+// Handles a packet indicated by the device
+static void on_indication(ble_pdlp_analyzer_t * p_analyzer, uint64_t time_us, uint8_t const * p_data, uint16_t len)
+{
+    uint8_t header = p_data[0];
+
+    if (((header >> PDLS_HEADER_SOURCE_Pos) & 0x01) == 0)
+    {
+        return;
+    }
+
+    if (p_analyzer->state == BLE_PDLP_ANALYZER_STATE_WAITING)
+    {
+        p_analyzer->current.responded = true;
+        p_analyzer->response_first_us = time_us;
+        p_analyzer->state             = BLE_PDLP_ANALYZER_STATE_INDICATING;
+
+        // An error or cancel message repeats the message ID of the request, a response has its own
+        if ((((header >> PDLS_HEADER_CANCEL_Pos) & 0x01) == 1)
+        ||  ((len >= 4) && ((uint16_t)(p_data[2] | (p_data[3] << 8)) == p_analyzer->current.msgid)))
+        {
+            p_analyzer->current.nack = true;
+        }
+    }
+    else if (p_analyzer->state != BLE_PDLP_ANALYZER_STATE_INDICATING)
+    {
+        return;
+    }
+    else if (p_analyzer->current.cancelled && (((header >> PDLS_HEADER_CANCEL_Pos) & 0x01) == 1))
+    {
+        // The cancel message that cuts a response short
+        p_analyzer->current.nack = true;
+    }
+
+    p_analyzer->current.response_packets++;
+    p_analyzer->last_indicated = (((header >> PDLS_HEADER_EXECUTE_Pos) & 0x01) == 1);
+}
+
+void ble_pdlp_analyzer_init(ble_pdlp_analyzer_t * p_analyzer, uint16_t write_handle, uint16_t ind_handle)
+{
+    memset(p_analyzer, 0, sizeof(*p_analyzer));
+    p_analyzer->write_handle = write_handle;
+    p_analyzer->ind_handle   = ind_handle;
+}
+
+bool ble_pdlp_analyzer_att_record(ble_pdlp_analyzer_t * p_analyzer, ble_pdlp_capture_record_t const * p_record)
+{
+    uint8_t  opcode;
+    uint16_t handle;
+
+    if (p_record->type != BLE_PDLP_CAPTURE_RECORD_ATT)
+    {
+        return false;
+    }
+
+    opcode = p_record->params.att.opcode;
+    handle = p_record->params.att.attr_handle;
+
+    if ((opcode == BLE_PDLP_ATT_OP_WRITE_REQ) || (opcode == BLE_PDLP_ATT_OP_WRITE_CMD))
+    {
+        if (((p_analyzer->write_handle == 0) || (handle == p_analyzer->write_handle)) && (p_record->params.att.value_len > 1))
+        {
+            return on_write(p_analyzer, p_record->timestamp_us, p_record->params.att.p_value, p_record->params.att.value_len);
+        }
+    }
+    else if (opcode == BLE_PDLP_ATT_OP_INDICATE)
+    {
+        if (((p_analyzer->ind_handle == 0) || (handle == p_analyzer->ind_handle)) && (p_record->params.att.value_len > 1))
+        {
+            on_indication(p_analyzer, p_record->timestamp_us, p_record->params.att.p_value, p_record->params.att.value_len);
+        }
+    }
+    else if ((opcode == BLE_PDLP_ATT_OP_CONFIRM)
+    &&       (p_analyzer->state == BLE_PDLP_ANALYZER_STATE_INDICATING)
+    &&       p_analyzer->last_indicated)
+    {
+        transaction_finish(p_analyzer, p_record->timestamp_us);
+        return true;
+    }
+
+    return false;
+}
+
+bool ble_pdlp_analyzer_flush(ble_pdlp_analyzer_t * p_analyzer)
+{
+    if ((p_analyzer->state == BLE_PDLP_ANALYZER_STATE_WAITING) || (p_analyzer->state == BLE_PDLP_ANALYZER_STATE_INDICATING))
+    {
+        p_analyzer->current.responded = false;
+        transaction_finish(p_analyzer, p_analyzer->request_last_us);
+        return true;
+    }
+
+    return false;
+}
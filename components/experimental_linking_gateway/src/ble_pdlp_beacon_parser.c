@@ -0,0 +1,106 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+#include "ble_pdlp_beacon_parser.h"
+#include <string.h>
+
+#define AD_TYPE_UUID128_COMPLETE    (0x07)
+#define AD_TYPE_MANUFACTURER        (0xFF)
+#define MANUFACTURER_HEADER_LEN     (7)     // AD type, company ID and the 32-bit version, vendor ID and class ID
+
+// The Linking 128-bit service UUID, least significant byte first as in the advertising data
+static const uint8_t m_linking_uuid[16] =
+{
+    0xCD, 0xA6, 0x13, 0x5B, 0x83, 0x50, 0x8D, 0x80, 0x44, 0x40, 0xD3, 0x50, 0x01, 0x69, 0xB3, 0xB3
+};
+
+bool ble_pdlp_beacon_parse(uint8_t const * p_data, uint8_t data_len, ble_pdlp_beacon_t * p_beacon)
+{
+    uint8_t const * p_manufacturer = NULL;
+    uint8_t         manufacturer_len = 0;
+    bool            has_uuid = false;
+    uint32_t        header;
+    uint8_t         i;
+
+    // Walk the AD structures, each a length byte followed by the AD type and the AD data
+    for (i = 0; (i + 1) < data_len; i += p_data[i] + 1)
+    {
+        uint8_t len = p_data[i];
+
+        if ((len == 0) || ((i + 1 + len) > data_len))
+        {
+            break;
+        }
+
+        // The company ID is compared first, it rejects other manufacturers in one step
+        if ((p_data[i + 1] == AD_TYPE_MANUFACTURER)
+        &&  (len >= MANUFACTURER_HEADER_LEN)
+        &&  (p_data[i + 2] == (LINKING_COMPANY_ID & 0xFF))
+        &&  (p_data[i + 3] == (LINKING_COMPANY_ID >> 8)))
+        {
+            p_manufacturer   = &p_data[i + 1];
+            manufacturer_len = len;
+        }
+        else if ((p_data[i + 1] == AD_TYPE_UUID128_COMPLETE)
+        &&       (len == 1 + sizeof(m_linking_uuid))
+        &&       (memcmp(&p_data[i + 2], m_linking_uuid, sizeof(m_linking_uuid)) == 0))
+        {
+            has_uuid = true;
+        }
+    }
+
+    if (p_manufacturer == NULL)
+    {
+        return false;
+    }
+
+    header = ((uint32_t)p_manufacturer[3] << 24) | ((uint32_t)p_manufacturer[4] << 16)
+           | ((uint32_t)p_manufacturer[5] <<  8) |  (uint32_t)p_manufacturer[6];
+
+    p_beacon->has_uuid      = has_uuid;
+    p_beacon->version       = (uint8_t)(header >> 28);
+    p_beacon->vendor_id     = (uint8_t)(header >> 20);
+    p_beacon->class_id      = header & 0xFFFFF;
+    p_beacon->service_count = (manufacturer_len - MANUFACTURER_HEADER_LEN) / SERVICE_DATA_SIZE;
+    if (p_beacon->service_count > LINKING_SERVICE_DATA_MAX)
+    {
+        p_beacon->service_count = LINKING_SERVICE_DATA_MAX;
+    }
+
+    linking_service_data_batch_unpack(&p_manufacturer[MANUFACTURER_HEADER_LEN], p_beacon->service_count,
+                                      p_beacon->service_ids, p_beacon->values);
+    return true;
+}
+
+uint32_t ble_pdlp_beacon_parse_batch(ble_pdlp_adv_report_t const * p_reports, uint32_t count, ble_pdlp_beacon_t * p_beacons)
+{
+    uint32_t found = 0;
+    uint32_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        // The shortest Linking beacon is the manufacturer specific data alone
+        if (p_reports[i].data_len < (1 + MANUFACTURER_HEADER_LEN))
+        {
+            continue;
+        }
+
+        if (ble_pdlp_beacon_parse(p_reports[i].data, p_reports[i].data_len, &p_beacons[found]))
+        {
+            p_beacons[found].report_index = i;
+            memcpy(p_beacons[found].bd_addr, p_reports[i].bd_addr, M_BD_ADDR_SIZE);
+            found++;
+        }
+    }
+
+    return found;
+}
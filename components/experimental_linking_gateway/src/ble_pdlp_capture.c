@@ -0,0 +1,316 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+#include "ble_pdlp_capture.h"
+#include "ble_pdlp_beacon_parser.h"
+#include <string.h>
+
+#define BTSNOOP_HEADER_LEN                  (16)
+#define BTSNOOP_RECORD_HEADER_LEN           (24)
+#define BTSNOOP_DATALINK_HCI                (1001)
+#define BTSNOOP_DATALINK_H4                 (1002)
+#define BTSNOOP_FLAG_RECEIVED               (0x01)
+#define BTSNOOP_FLAG_COMMAND_OR_EVENT       (0x02)
+#define BTSNOOP_EPOCH_TO_UNIX_US            (0x00DCDDB30F2F8000ULL)    // From midnight, January 1st 0 AD to 1970
+
+#define PCAP_HEADER_LEN                     (24)
+#define PCAP_RECORD_HEADER_LEN              (16)
+#define PCAP_MAGIC_MICROSECONDS             (0xA1B2C3D4UL)
+#define PCAP_MAGIC_NANOSECONDS              (0xA1B23C4DUL)
+#define LINKTYPE_BLUETOOTH_LE_LL            (251)
+#define LINKTYPE_BLUETOOTH_LE_LL_WITH_PHDR  (256)
+#define PHDR_LEN                            (10)
+#define PHDR_SIGNAL_POWER_OFFS              (1)
+#define PHDR_FLAGS_OFFS                     (8)
+#define PHDR_FLAG_SIGNAL_POWER_VALID        (0x0002)
+
+#define H4_ACL                              (0x02)
+#define H4_EVENT                            (0x04)
+#define HCI_EVT_LE_META                     (0x3E)
+#define HCI_LE_ADVERTISING_REPORT           (0x02)
+#define HCI_ACL_PB_CONTINUATION             (0x01)
+#define L2CAP_CID_ATT                       (0x0004)
+
+#define LL_ADV_ACCESS_ADDRESS               (0x8E89BED6UL)
+#define LL_ADV_IND                          (0x0)
+#define LL_ADV_NONCONN_IND                  (0x2)
+#define LL_SCAN_RSP                         (0x4)
+#define LL_ADV_SCAN_IND                     (0x6)
+
+static uint16_t le16(uint8_t const * p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t le32(uint8_t const * p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t be32(uint8_t const * p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+// The pcap header fields are in the byte order of the writer, told by the magic number
+static uint32_t pcap32(ble_pdlp_capture_t const * p_capture, uint8_t const * p)
+{
+    return p_capture->swapped ? be32(p) : le32(p);
+}
+
+// Decodes the first report of an HCI LE Advertising Report event, controllers rarely put more than one in an event.
+// The RSSI follows the data of the report.
+static void hci_event_decode(uint8_t const * p, size_t len, ble_pdlp_capture_record_t * p_record)
+{
+    uint8_t data_len;
+
+    if ((len < 13) || (p[0] != HCI_EVT_LE_META) || (p[2] != HCI_LE_ADVERTISING_REPORT) || (p[3] == 0))
+    {
+        return;
+    }
+
+    data_len = p[12];
+    if ((data_len > LINKING_ADV_DATA_MAX_LEN) || ((size_t)(13 + data_len) > len))
+    {
+        return;
+    }
+
+    p_record->type                   = BLE_PDLP_CAPTURE_RECORD_ADV;
+    p_record->params.adv.p_bd_addr   = &p[6];
+    p_record->params.adv.p_data      = &p[13];
+    p_record->params.adv.data_len    = data_len;
+    p_record->params.adv.rssi        = ((size_t)(13 + data_len) < len) ? (int8_t)p[13 + data_len] : BLE_PDLP_CAPTURE_RSSI_UNKNOWN;
+}
+
+// Decodes an ATT PDU that fits in one HCI ACL packet, fragmented L2CAP frames are not reassembled
+static void hci_acl_decode(uint8_t const * p, size_t len, bool received, ble_pdlp_capture_record_t * p_record)
+{
+    uint16_t l2cap_len;
+    uint8_t  opcode;
+
+    if ((len < 9) || (((le16(&p[0]) >> 12) & 0x3) == HCI_ACL_PB_CONTINUATION) || (le16(&p[6]) != L2CAP_CID_ATT))
+    {
+        return;
+    }
+
+    l2cap_len = le16(&p[4]);
+    opcode    = p[8];
+    if ((l2cap_len < 1) || ((size_t)(8 + l2cap_len) > len))
+    {
+        return;
+    }
+
+    if (opcode == BLE_PDLP_ATT_OP_CONFIRM)
+    {
+        p_record->type                    = BLE_PDLP_CAPTURE_RECORD_ATT;
+        p_record->params.att.conn_handle  = le16(&p[0]) & 0x0FFF;
+        p_record->params.att.received     = received;
+        p_record->params.att.opcode       = opcode;
+        p_record->params.att.attr_handle  = 0;
+        p_record->params.att.p_value      = NULL;
+        p_record->params.att.value_len    = 0;
+    }
+    else if ((l2cap_len >= 3)
+    &&       ((opcode == BLE_PDLP_ATT_OP_WRITE_REQ) || (opcode == BLE_PDLP_ATT_OP_WRITE_CMD)
+    ||        (opcode == BLE_PDLP_ATT_OP_NOTIFY)    || (opcode == BLE_PDLP_ATT_OP_INDICATE)))
+    {
+        p_record->type                    = BLE_PDLP_CAPTURE_RECORD_ATT;
+        p_record->params.att.conn_handle  = le16(&p[0]) & 0x0FFF;
+        p_record->params.att.received     = received;
+        p_record->params.att.opcode       = opcode;
+        p_record->params.att.attr_handle  = le16(&p[9]);
+        p_record->params.att.p_value      = &p[11];
+        p_record->params.att.value_len    = l2cap_len - 3;
+    }
+}
+
+// Decodes an advertising channel PDU of the link layer, from the access address up to the CRC
+static void ll_decode(uint8_t const * p, size_t len, int8_t rssi, ble_pdlp_capture_record_t * p_record)
+{
+    uint8_t pdu_type;
+    uint8_t pdu_len;
+
+    if ((len < 12) || (le32(&p[0]) != LL_ADV_ACCESS_ADDRESS))
+    {
+        return;
+    }
+
+    pdu_type = p[4] & 0x0F;
+    pdu_len  = p[5];
+    if ((pdu_type != LL_ADV_IND) && (pdu_type != LL_ADV_NONCONN_IND)
+    &&  (pdu_type != LL_SCAN_RSP) && (pdu_type != LL_ADV_SCAN_IND))
+    {
+        return;
+    }
+    if ((pdu_len < 6) || (pdu_len > 6 + LINKING_ADV_DATA_MAX_LEN) || ((size_t)(6 + pdu_len) > len))
+    {
+        return;
+    }
+
+    p_record->type                   = BLE_PDLP_CAPTURE_RECORD_ADV;
+    p_record->params.adv.p_bd_addr   = &p[6];
+    p_record->params.adv.p_data      = &p[12];
+    p_record->params.adv.data_len    = pdu_len - 6;
+    p_record->params.adv.rssi        = rssi;
+}
+
+bool ble_pdlp_capture_open(ble_pdlp_capture_t * p_capture, uint8_t const * p_buf, size_t len)
+{
+    memset(p_capture, 0, sizeof(*p_capture));
+    p_capture->p_buf = p_buf;
+    p_capture->len   = len;
+
+    if ((len >= BTSNOOP_HEADER_LEN) && (memcmp(p_buf, "btsnoop\0", 8) == 0) && (be32(&p_buf[8]) == 1))
+    {
+        uint32_t datalink = be32(&p_buf[12]);
+
+        if ((datalink != BTSNOOP_DATALINK_HCI) && (datalink != BTSNOOP_DATALINK_H4))
+        {
+            return false;
+        }
+        p_capture->format = BLE_PDLP_CAPTURE_FORMAT_BTSNOOP;
+        p_capture->h4     = (datalink == BTSNOOP_DATALINK_H4);
+        p_capture->offs   = BTSNOOP_HEADER_LEN;
+        return true;
+    }
+
+    if (len >= PCAP_HEADER_LEN)
+    {
+        uint32_t magic = le32(p_buf);
+        uint32_t linktype;
+
+        if ((magic == PCAP_MAGIC_MICROSECONDS) || (magic == PCAP_MAGIC_NANOSECONDS))
+        {
+            p_capture->swapped = false;
+        }
+        else if ((be32(p_buf) == PCAP_MAGIC_MICROSECONDS) || (be32(p_buf) == PCAP_MAGIC_NANOSECONDS))
+        {
+            p_capture->swapped = true;
+            magic              = be32(p_buf);
+        }
+        else
+        {
+            return false;
+        }
+        p_capture->nanoseconds = (magic == PCAP_MAGIC_NANOSECONDS);
+
+        linktype = pcap32(p_capture, &p_buf[20]);
+        if (linktype == LINKTYPE_BLUETOOTH_LE_LL)
+        {
+            p_capture->format = BLE_PDLP_CAPTURE_FORMAT_PCAP_BLE_LL;
+        }
+        else if (linktype == LINKTYPE_BLUETOOTH_LE_LL_WITH_PHDR)
+        {
+            p_capture->format = BLE_PDLP_CAPTURE_FORMAT_PCAP_BLE_LL_WITH_PHDR;
+        }
+        else
+        {
+            return false;
+        }
+        p_capture->offs = PCAP_HEADER_LEN;
+        return true;
+    }
+
+    return false;
+}
+
+bool ble_pdlp_capture_next(ble_pdlp_capture_t * p_capture, ble_pdlp_capture_record_t * p_record)
+{
+    uint8_t const * p = &p_capture->p_buf[p_capture->offs];
+    size_t          remaining = p_capture->len - p_capture->offs;
+    uint32_t        incl_len;
+
+    p_record->type = BLE_PDLP_CAPTURE_RECORD_OTHER;
+
+    if (p_capture->format == BLE_PDLP_CAPTURE_FORMAT_BTSNOOP)
+    {
+        uint32_t flags;
+        uint64_t timestamp;
+
+        if (remaining < BTSNOOP_RECORD_HEADER_LEN)
+        {
+            return false;
+        }
+        incl_len = be32(&p[4]);
+        if (incl_len > remaining - BTSNOOP_RECORD_HEADER_LEN)
+        {
+            return false;
+        }
+
+        flags     = be32(&p[8]);
+        timestamp = ((uint64_t)be32(&p[16]) << 32) | be32(&p[20]);
+        p_record->timestamp_us = timestamp - BTSNOOP_EPOCH_TO_UNIX_US;
+        p_capture->offs       += BTSNOOP_RECORD_HEADER_LEN + incl_len;
+        p                     += BTSNOOP_RECORD_HEADER_LEN;
+
+        if (p_capture->h4)
+        {
+            if ((incl_len > 1) && (p[0] == H4_EVENT))
+            {
+                hci_event_decode(&p[1], incl_len - 1, p_record);
+            }
+            else if ((incl_len > 1) && (p[0] == H4_ACL))
+            {
+                hci_acl_decode(&p[1], incl_len - 1, (flags & BTSNOOP_FLAG_RECEIVED) != 0, p_record);
+            }
+        }
+        else if (flags & BTSNOOP_FLAG_COMMAND_OR_EVENT)
+        {
+            if (flags & BTSNOOP_FLAG_RECEIVED)
+            {
+                hci_event_decode(p, incl_len, p_record);
+            }
+        }
+        else
+        {
+            hci_acl_decode(p, incl_len, (flags & BTSNOOP_FLAG_RECEIVED) != 0, p_record);
+        }
+    }
+    else
+    {
+        uint32_t frac;
+
+        if (remaining < PCAP_RECORD_HEADER_LEN)
+        {
+            return false;
+        }
+        incl_len = pcap32(p_capture, &p[8]);
+        if (incl_len > remaining - PCAP_RECORD_HEADER_LEN)
+        {
+            return false;
+        }
+
+        frac = pcap32(p_capture, &p[4]);
+        p_record->timestamp_us = (uint64_t)pcap32(p_capture, &p[0]) * 1000000
+                               + (p_capture->nanoseconds ? (frac / 1000) : frac);
+        p_capture->offs       += PCAP_RECORD_HEADER_LEN + incl_len;
+        p                     += PCAP_RECORD_HEADER_LEN;
+
+        if (p_capture->format == BLE_PDLP_CAPTURE_FORMAT_PCAP_BLE_LL_WITH_PHDR)
+        {
+            if (incl_len > PHDR_LEN)
+            {
+                // The signal power is the RSSI in dBm, when the sniffer has measured it
+                int8_t rssi = (le16(&p[PHDR_FLAGS_OFFS]) & PHDR_FLAG_SIGNAL_POWER_VALID) ? (int8_t)p[PHDR_SIGNAL_POWER_OFFS]
+                                                                                          : BLE_PDLP_CAPTURE_RSSI_UNKNOWN;
+
+                ll_decode(&p[PHDR_LEN], incl_len - PHDR_LEN, rssi, p_record);
+            }
+        }
+        else
+        {
+            ll_decode(p, incl_len, BLE_PDLP_CAPTURE_RSSI_UNKNOWN, p_record);
+        }
+    }
+
+    return true;
+}
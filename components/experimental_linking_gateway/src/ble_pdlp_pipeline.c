@@ -0,0 +1,243 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+#include "ble_pdlp_pipeline.h"
+#include <string.h>
+
+static void stage_count(ble_pdlp_pipeline_stage_t * p_stage, uint32_t in_count, uint32_t out_count, uint32_t drop_count)
+{
+    if (in_count != 0)
+    {
+        p_stage->step_count++;
+        p_stage->in_count   += in_count;
+        p_stage->out_count  += out_count;
+        p_stage->drop_count += drop_count;
+    }
+}
+
+static void stage_depth(ble_pdlp_pipeline_stage_t * p_stage, ble_pdlp_ring_t * p_in)
+{
+    uint32_t depth = ble_pdlp_ring_depth(p_in);
+
+    p_stage->depth_max = (depth > p_stage->depth_max) ? depth : p_stage->depth_max;
+}
+
+void ble_pdlp_pipeline_stage_init(ble_pdlp_pipeline_stage_t      * p_stage,
+                                  ble_pdlp_pipeline_backpressure_t backpressure,
+                                  uint32_t                         batch_max)
+{
+    memset(p_stage, 0, sizeof(*p_stage));
+    p_stage->backpressure = backpressure;
+    p_stage->batch_max    = batch_max;
+}
+
+uint32_t ble_pdlp_pipeline_capture_step(ble_pdlp_pipeline_stage_t * p_stage,
+                                        ble_pdlp_capture_t        * p_capture,
+                                        ble_pdlp_ring_t           * p_out)
+{
+    ble_pdlp_pipeline_report_t * p_reports;
+    ble_pdlp_capture_record_t    record;
+    uint32_t                     room;
+    uint32_t                     in_count = 0;
+    uint32_t                     out_count = 0;
+    uint32_t                     drop_count = 0;
+
+    room = ble_pdlp_ring_write_reserve(p_out, (void **)&p_reports, p_stage->batch_max);
+    if ((room == 0) && (p_stage->backpressure == BLE_PDLP_PIPELINE_BACKPRESSURE_WAIT))
+    {
+        return 0;
+    }
+
+    while (in_count < p_stage->batch_max)
+    {
+        // With WAIT, stop before a report that would not fit
+        if ((out_count == room) && (p_stage->backpressure == BLE_PDLP_PIPELINE_BACKPRESSURE_WAIT))
+        {
+            break;
+        }
+        if (!ble_pdlp_capture_next(p_capture, &record))
+        {
+            ble_pdlp_ring_write_commit(p_out, out_count);
+            ble_pdlp_ring_close(p_out);
+            stage_count(p_stage, in_count, out_count, drop_count);
+            return in_count;
+        }
+        in_count++;
+
+        if (record.type != BLE_PDLP_CAPTURE_RECORD_ADV)
+        {
+            continue;
+        }
+        if (out_count == room)
+        {
+            drop_count++;
+            continue;
+        }
+        p_reports[out_count].timestamp_us = record.timestamp_us;
+        p_reports[out_count].rssi         = record.params.adv.rssi;
+        memcpy(p_reports[out_count].report.bd_addr, record.params.adv.p_bd_addr, M_BD_ADDR_SIZE);
+        p_reports[out_count].report.data_len = (record.params.adv.data_len < LINKING_ADV_DATA_MAX_LEN) ? record.params.adv.data_len : LINKING_ADV_DATA_MAX_LEN;
+        memcpy(p_reports[out_count].report.data, record.params.adv.p_data, p_reports[out_count].report.data_len);
+        out_count++;
+    }
+
+    ble_pdlp_ring_write_commit(p_out, out_count);
+    stage_count(p_stage, in_count, out_count, drop_count);
+    return in_count;
+}
+
+uint32_t ble_pdlp_pipeline_decode_step(ble_pdlp_pipeline_stage_t * p_stage,
+                                       ble_pdlp_ring_t           * p_in,
+                                       ble_pdlp_ring_t           * p_out)
+{
+    ble_pdlp_pipeline_report_t * p_reports;
+    ble_pdlp_pipeline_beacon_t * p_beacons;
+    uint32_t                     count;
+    uint32_t                     room;
+    uint32_t                     in_count = 0;
+    uint32_t                     out_count = 0;
+    uint32_t                     drop_count = 0;
+
+    stage_depth(p_stage, p_in);
+    count = ble_pdlp_ring_read_reserve(p_in, (void **)&p_reports, p_stage->batch_max);
+    if (count == 0)
+    {
+        if (ble_pdlp_ring_is_drained(p_in))
+        {
+            ble_pdlp_ring_close(p_out);
+        }
+        return 0;
+    }
+
+    room = ble_pdlp_ring_write_reserve(p_out, (void **)&p_beacons, count);
+    for (in_count = 0; in_count < count; in_count++)
+    {
+        ble_pdlp_pipeline_report_t const * p_report = &p_reports[in_count];
+
+        // With WAIT, stop before a report that could not be written, it is read again in the next step
+        if ((out_count == room) && (p_stage->backpressure == BLE_PDLP_PIPELINE_BACKPRESSURE_WAIT))
+        {
+            break;
+        }
+        if (out_count == room)
+        {
+            ble_pdlp_pipeline_beacon_t dropped;
+
+            drop_count += ble_pdlp_beacon_parse(p_report->report.data, p_report->report.data_len, &dropped.beacon);
+            continue;
+        }
+        if (ble_pdlp_beacon_parse(p_report->report.data, p_report->report.data_len, &p_beacons[out_count].beacon))
+        {
+            memcpy(p_beacons[out_count].beacon.bd_addr, p_report->report.bd_addr, M_BD_ADDR_SIZE);
+            p_beacons[out_count].beacon.report_index = 0;
+            p_beacons[out_count].timestamp_us = p_report->timestamp_us;
+            p_beacons[out_count].rssi         = p_report->rssi;
+            out_count++;
+        }
+    }
+
+    ble_pdlp_ring_write_commit(p_out, out_count);
+    ble_pdlp_ring_read_commit(p_in, in_count);
+    stage_count(p_stage, in_count, out_count, drop_count);
+    return in_count;
+}
+
+uint32_t ble_pdlp_pipeline_aggregate_step(ble_pdlp_pipeline_stage_t * p_stage,
+                                          ble_pdlp_ring_t           * p_in,
+                                          ble_pdlp_aggregator_t     * p_aggregator,
+                                          ble_pdlp_ring_t           * p_out)
+{
+    ble_pdlp_pipeline_beacon_t * p_beacons;
+    ble_pdlp_pipeline_beacon_t * p_news;
+    uint32_t                     count;
+    uint32_t                     room;
+    uint32_t                     in_count = 0;
+    uint32_t                     out_count = 0;
+    uint32_t                     drop_count = 0;
+
+    stage_depth(p_stage, p_in);
+    count = ble_pdlp_ring_read_reserve(p_in, (void **)&p_beacons, p_stage->batch_max);
+    if (count == 0)
+    {
+        if (ble_pdlp_ring_is_drained(p_in))
+        {
+            ble_pdlp_ring_close(p_out);
+        }
+        return 0;
+    }
+
+    room = ble_pdlp_ring_write_reserve(p_out, (void **)&p_news, count);
+    for (in_count = 0; in_count < count; in_count++)
+    {
+        ble_pdlp_pipeline_beacon_t const * p_beacon = &p_beacons[in_count];
+        uint16_t                           new_mask;
+        uint8_t                            i;
+
+        // With WAIT, stop before a beacon that could not be written, before the aggregator has seen it
+        if ((out_count == room) && (p_stage->backpressure == BLE_PDLP_PIPELINE_BACKPRESSURE_WAIT))
+        {
+            break;
+        }
+        if (ble_pdlp_aggregator_update_beacon(p_aggregator, &p_beacon->beacon, p_beacon->rssi, p_beacon->timestamp_us, &new_mask) == 0)
+        {
+            continue;
+        }
+        if (out_count == room)
+        {
+            drop_count++;
+            continue;
+        }
+
+        p_news[out_count]                      = *p_beacon;
+        p_news[out_count].beacon.service_count = 0;
+        for (i = 0; i < p_beacon->beacon.service_count; i++)
+        {
+            if ((new_mask & (1 << i)) != 0)
+            {
+                p_news[out_count].beacon.service_ids[p_news[out_count].beacon.service_count] = p_beacon->beacon.service_ids[i];
+                p_news[out_count].beacon.values[p_news[out_count].beacon.service_count]      = p_beacon->beacon.values[i];
+                p_news[out_count].beacon.service_count++;
+            }
+        }
+        out_count++;
+    }
+
+    ble_pdlp_ring_write_commit(p_out, out_count);
+    ble_pdlp_ring_read_commit(p_in, in_count);
+    stage_count(p_stage, in_count, out_count, drop_count);
+    return in_count;
+}
+
+uint32_t ble_pdlp_pipeline_store_step(ble_pdlp_pipeline_stage_t * p_stage,
+                                      ble_pdlp_ring_t           * p_in,
+                                      ble_pdlp_store_t          * p_store)
+{
+    ble_pdlp_pipeline_beacon_t * p_beacons;
+    uint32_t                     count;
+    uint32_t                     out_count = 0;
+    uint32_t                     drop_count = 0;
+    uint32_t                     i;
+
+    stage_depth(p_stage, p_in);
+    count = ble_pdlp_ring_read_reserve(p_in, (void **)&p_beacons, p_stage->batch_max);
+    for (i = 0; i < count; i++)
+    {
+        uint8_t appended = ble_pdlp_store_append_beacon(p_store, &p_beacons[i].beacon, p_beacons[i].rssi, p_beacons[i].timestamp_us);
+
+        out_count  += appended;
+        drop_count += p_beacons[i].beacon.service_count - appended;
+    }
+
+    ble_pdlp_ring_read_commit(p_in, count);
+    stage_count(p_stage, count, out_count, drop_count);
+    return count;
+}
@@ -0,0 +1,134 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+#include "ble_pdlp_ring.h"
+#include <stddef.h>
+
+// The producer publishes the elements with a release store of head, the consumer sees them with an acquire
+// load of head, and the same the other way for tail
+#if defined(__GNUC__)
+#define LOAD_ACQUIRE(p)         __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(p, v)     __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#elif defined(__CC_ARM)
+static __inline uint32_t load_acquire(uint32_t * p)
+{
+    uint32_t value = *(volatile uint32_t *)p;
+
+    __dmb(0xF);
+    return value;
+}
+static __inline void store_release(uint32_t * p, uint32_t value)
+{
+    __dmb(0xF);
+    *(volatile uint32_t *)p = value;
+}
+#define LOAD_ACQUIRE(p)         load_acquire(p)
+#define STORE_RELEASE(p, v)     store_release((p), (v))
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+// x86 and x64 do not reorder loads with loads nor stores with stores, only the compiler has to be held back
+static __inline uint32_t load_acquire(uint32_t * p)
+{
+    uint32_t value = *(volatile uint32_t *)p;
+
+    _ReadWriteBarrier();
+    return value;
+}
+static __inline void store_release(uint32_t * p, uint32_t value)
+{
+    _ReadWriteBarrier();
+    *(volatile uint32_t *)p = value;
+}
+#define LOAD_ACQUIRE(p)         load_acquire(p)
+#define STORE_RELEASE(p, v)     store_release((p), (v))
+#else
+#error "No acquire and release operations for this compiler"
+#endif
+
+bool ble_pdlp_ring_init(ble_pdlp_ring_t * p_ring, void * p_buf, uint32_t elem_size, uint32_t count)
+{
+    if ((count == 0) || ((count & (count - 1)) != 0))
+    {
+        return false;
+    }
+
+    p_ring->p_buf       = (uint8_t *)p_buf;
+    p_ring->elem_size   = elem_size;
+    p_ring->mask        = count - 1;
+    p_ring->head        = 0;
+    p_ring->tail_cached = 0;
+    p_ring->closed      = 0;
+    p_ring->tail        = 0;
+    p_ring->head_cached = 0;
+    return true;
+}
+
+uint32_t ble_pdlp_ring_write_reserve(ble_pdlp_ring_t * p_ring, void ** pp_elems, uint32_t max)
+{
+    uint32_t index = p_ring->head & p_ring->mask;
+    uint32_t count = p_ring->mask + 1 - (p_ring->head - p_ring->tail_cached);
+
+    // Only look at the consumer's tail when the cached one shows no room, to keep off its cache line
+    if (count < max)
+    {
+        p_ring->tail_cached = LOAD_ACQUIRE(&p_ring->tail);
+        count = p_ring->mask + 1 - (p_ring->head - p_ring->tail_cached);
+    }
+
+    count = (count < (p_ring->mask + 1 - index)) ? count : (p_ring->mask + 1 - index);
+    count = (count < max) ? count : max;
+    *pp_elems = &p_ring->p_buf[index * p_ring->elem_size];
+    return count;
+}
+
+void ble_pdlp_ring_write_commit(ble_pdlp_ring_t * p_ring, uint32_t count)
+{
+    STORE_RELEASE(&p_ring->head, p_ring->head + count);
+}
+
+void ble_pdlp_ring_close(ble_pdlp_ring_t * p_ring)
+{
+    STORE_RELEASE(&p_ring->closed, 1);
+}
+
+uint32_t ble_pdlp_ring_read_reserve(ble_pdlp_ring_t * p_ring, void ** pp_elems, uint32_t max)
+{
+    uint32_t index = p_ring->tail & p_ring->mask;
+    uint32_t count = p_ring->head_cached - p_ring->tail;
+
+    if (count < max)
+    {
+        p_ring->head_cached = LOAD_ACQUIRE(&p_ring->head);
+        count = p_ring->head_cached - p_ring->tail;
+    }
+
+    count = (count < (p_ring->mask + 1 - index)) ? count : (p_ring->mask + 1 - index);
+    count = (count < max) ? count : max;
+    *pp_elems = &p_ring->p_buf[index * p_ring->elem_size];
+    return count;
+}
+
+void ble_pdlp_ring_read_commit(ble_pdlp_ring_t * p_ring, uint32_t count)
+{
+    STORE_RELEASE(&p_ring->tail, p_ring->tail + count);
+}
+
+uint32_t ble_pdlp_ring_depth(ble_pdlp_ring_t * p_ring)
+{
+    return LOAD_ACQUIRE(&p_ring->head) - LOAD_ACQUIRE(&p_ring->tail);
+}
+
+bool ble_pdlp_ring_is_drained(ble_pdlp_ring_t * p_ring)
+{
+    // Read closed first, the elements written before closing are then seen in head
+    return (LOAD_ACQUIRE(&p_ring->closed) != 0) && (LOAD_ACQUIRE(&p_ring->head) == p_ring->tail);
+}
@@ -0,0 +1,553 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+#include "ble_pdlp_store.h"
+#include "ble_pdlp_common.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define VARINT_MAX_LEN  (10)    // The length of the varint of a 64-bit value
+#define ALIGN8(len)     (((len) + 7) & ~7UL)
+
+// The length of an open block, with room for BLE_PDLP_STORE_BLOCK_RECORDS readings in each column
+#define OPEN_BLOCK_LEN  (sizeof(ble_pdlp_store_block_t)                                                     \
+                       + BLE_PDLP_STORE_BLOCK_RECORDS * (sizeof(ble_pdlp_store_summary_t) + sizeof(uint16_t) + 2)  \
+                       + BLE_PDLP_STORE_BLOCK_DEVICE_LEN + BLE_PDLP_STORE_BLOCK_TIMESTAMP_LEN)
+
+// The summaries and columns of a block
+typedef struct
+{
+    ble_pdlp_store_summary_t * p_summaries;
+    uint16_t                 * p_values;
+    uint8_t                  * p_service_ids;
+    int8_t                   * p_rssi;
+    uint8_t                  * p_devices;
+    uint8_t                  * p_timestamps;
+} block_columns_t;
+
+static uint8_t varint_len(uint64_t value)
+{
+    uint8_t len = 1;
+
+    while (value >= 0x80)
+    {
+        value >>= 7;
+        len++;
+    }
+    return len;
+}
+
+static uint8_t varint_encode(uint64_t value, uint8_t * p_buf)
+{
+    uint8_t len = 0;
+
+    while (value >= 0x80)
+    {
+        p_buf[len++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    p_buf[len++] = (uint8_t)value;
+    return len;
+}
+
+static uint8_t varint_decode(uint8_t const * p_buf, uint64_t * p_value)
+{
+    uint64_t value = 0;
+    uint8_t  len = 0;
+
+    do
+    {
+        value |= (uint64_t)(p_buf[len] & 0x7F) << (7 * len);
+    } while ((p_buf[len++] & 0x80) && (len < VARINT_MAX_LEN));
+
+    *p_value = value;
+    return len;
+}
+
+static uint32_t device_hash_size(uint32_t device_max)
+{
+    uint32_t size = 1;
+
+    while (size < (device_max * 2))
+    {
+        size <<= 1;
+    }
+    return size;
+}
+
+static uint32_t block_offset(uint32_t device_max)
+{
+    return ALIGN8(sizeof(ble_pdlp_store_header_t) + device_hash_size(device_max) * sizeof(uint32_t) + device_max * M_BD_ADDR_SIZE);
+}
+
+// FNV-1a of the address, reduced to the hash table size
+static uint32_t device_hash(uint8_t const * p_bd_addr, uint32_t hash_size)
+{
+    uint32_t hash = 2166136261UL;
+    uint8_t  i;
+
+    for (i = 0; i < M_BD_ADDR_SIZE; i++)
+    {
+        hash = (hash ^ p_bd_addr[i]) * 16777619UL;
+    }
+    return hash & (hash_size - 1);
+}
+
+// Returns the hash slot of the address, holding its dictionary index + 1 or 0 if it is not in the dictionary
+static uint32_t device_slot_find(ble_pdlp_store_t const * p_store, uint8_t const * p_bd_addr)
+{
+    uint32_t hash_size = p_store->p_header->device_hash_size;
+    uint32_t slot = device_hash(p_bd_addr, hash_size);
+
+    while ((p_store->p_device_hash[slot] != 0)
+    &&     (memcmp(&p_store->p_devices[(p_store->p_device_hash[slot] - 1) * M_BD_ADDR_SIZE], p_bd_addr, M_BD_ADDR_SIZE) != 0))
+    {
+        slot = (slot + 1) & (hash_size - 1);
+    }
+    return slot;
+}
+
+// Returns the hash slot of a device and service in the summaries of the open block
+static uint32_t summary_slot_find(ble_pdlp_store_t const         * p_store,
+                                  ble_pdlp_store_summary_t const * p_summaries,
+                                  uint32_t                         device,
+                                  uint8_t                          service_id)
+{
+    uint32_t key = (device << 8) | service_id;
+    uint32_t slot;
+
+    key ^= key >> 16;
+    key *= 0x45D9F3BUL;
+    key ^= key >> 16;
+    slot = key & (BLE_PDLP_STORE_SUMMARY_HASH_SIZE - 1);
+
+    while ((p_store->summary_hash[slot] != 0)
+    &&     ((p_summaries[p_store->summary_hash[slot] - 1].device != device)
+    ||      (p_summaries[p_store->summary_hash[slot] - 1].service_id != service_id)))
+    {
+        slot = (slot + 1) & (BLE_PDLP_STORE_SUMMARY_HASH_SIZE - 1);
+    }
+    return slot;
+}
+
+static int summary_compare(void const * p_a, void const * p_b)
+{
+    ble_pdlp_store_summary_t const * p_summary_a = p_a;
+    ble_pdlp_store_summary_t const * p_summary_b = p_b;
+
+    if (p_summary_a->device != p_summary_b->device)
+    {
+        return (p_summary_a->device < p_summary_b->device) ? -1 : 1;
+    }
+    return (int)p_summary_a->service_id - (int)p_summary_b->service_id;
+}
+
+// Binary search of a device and service in the sorted summaries of a sealed block
+static ble_pdlp_store_summary_t const * summary_search(ble_pdlp_store_summary_t const * p_summaries,
+                                                       uint32_t                         count,
+                                                       uint32_t                         device,
+                                                       uint8_t                          service_id)
+{
+    ble_pdlp_store_summary_t key;
+    uint32_t                 low = 0;
+    uint32_t                 high = count;
+
+    key.device     = device;
+    key.service_id = service_id;
+    while (low < high)
+    {
+        uint32_t mid = (low + high) / 2;
+        int      order = summary_compare(&p_summaries[mid], &key);
+
+        if (order == 0)
+        {
+            return &p_summaries[mid];
+        }
+        if (order < 0)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return NULL;
+}
+
+// Finds the columns of a block, an open one has room for BLE_PDLP_STORE_BLOCK_RECORDS readings in each
+static void block_columns(ble_pdlp_store_block_t const * p_block, bool sealed, block_columns_t * p_columns)
+{
+    uint32_t  records    = sealed ? p_block->count : BLE_PDLP_STORE_BLOCK_RECORDS;
+    uint32_t  summaries  = sealed ? p_block->summary_count : BLE_PDLP_STORE_BLOCK_RECORDS;
+    uint32_t  device_len = sealed ? p_block->device_len : BLE_PDLP_STORE_BLOCK_DEVICE_LEN;
+    uint8_t * p = (uint8_t *)(p_block + 1);
+
+    p_columns->p_summaries   = (ble_pdlp_store_summary_t *)p;
+    p                       += summaries * sizeof(ble_pdlp_store_summary_t);
+    p_columns->p_values      = (uint16_t *)p;
+    p                       += records * sizeof(uint16_t);
+    p_columns->p_service_ids = p;
+    p                       += records;
+    p_columns->p_rssi        = (int8_t *)p;
+    p                       += records;
+    p_columns->p_devices     = p;
+    p                       += device_len;
+    p_columns->p_timestamps  = p;
+}
+
+// A block keeps its summaries when they have enough readings on average, else the queries scan its columns
+static uint16_t block_sealed_summary_count(ble_pdlp_store_block_t const * p_block)
+{
+    return (p_block->count >= (p_block->summary_count * BLE_PDLP_STORE_SUMMARY_READINGS_MIN)) ? p_block->summary_count : 0;
+}
+
+static uint32_t block_sealed_len(ble_pdlp_store_block_t const * p_block)
+{
+    return ALIGN8(sizeof(ble_pdlp_store_block_t)
+                + block_sealed_summary_count(p_block) * sizeof(ble_pdlp_store_summary_t)
+                + p_block->count * (sizeof(uint16_t) + 2)
+                + p_block->device_len + p_block->timestamp_len);
+}
+
+// Sorts the summaries of the open block and moves each column down to the end of the previous one.
+// A column never moves up, so it can not overwrite the columns after it before they are moved.
+static void block_seal(ble_pdlp_store_t * p_store, ble_pdlp_store_block_t * p_block)
+{
+    block_columns_t from;
+    block_columns_t to;
+
+    block_columns(p_block, false, &from);
+    p_block->summary_count = block_sealed_summary_count(p_block);
+    block_columns(p_block, true, &to);
+    qsort(from.p_summaries, p_block->summary_count, sizeof(ble_pdlp_store_summary_t), summary_compare);
+    memmove(to.p_values, from.p_values, p_block->count * sizeof(uint16_t));
+    memmove(to.p_service_ids, from.p_service_ids, p_block->count);
+    memmove(to.p_rssi, from.p_rssi, p_block->count);
+    memmove(to.p_devices, from.p_devices, p_block->device_len);
+    memmove(to.p_timestamps, from.p_timestamps, p_block->timestamp_len);
+
+    p_block->len                    = block_sealed_len(p_block);
+    p_store->p_header->open_offset += p_block->len;
+    memset(p_store->summary_hash, 0, sizeof(p_store->summary_hash));
+}
+
+static ble_pdlp_store_block_t * block_at(ble_pdlp_store_t const * p_store, uint32_t offset)
+{
+    return (ble_pdlp_store_block_t *)((uint8_t *)p_store->p_header + offset);
+}
+
+static void summary_add(ble_pdlp_store_result_t * p_result, uint32_t count, float min, float max, double sum)
+{
+    if (p_result->count == 0)
+    {
+        p_result->min = min;
+        p_result->max = max;
+    }
+    else
+    {
+        p_result->min = (min < p_result->min) ? min : p_result->min;
+        p_result->max = (max > p_result->max) ? max : p_result->max;
+    }
+    p_result->count += count;
+    p_result->sum   += sum;
+}
+
+float ble_pdlp_store_value_decode(uint8_t service_id, uint16_t value)
+{
+    switch (service_id)
+    {
+        case LINKING_SERVICE_TYPE_TEMPERATURE:
+            return IEEE754_Decode_Temperature(value);
+        case LINKING_SERVICE_TYPE_HUMIDITY:
+            return IEEE754_Decode_Humidity(value);
+        case LINKING_SERVICE_TYPE_AIRPRESSURE:
+            return IEEE754_Decode_Air_Pressure(value);
+        default:
+            return (float)value;
+    }
+}
+
+uint32_t ble_pdlp_store_segment_len(uint32_t device_max, uint32_t block_count)
+{
+    return block_offset(device_max) + block_count * OPEN_BLOCK_LEN;
+}
+
+bool ble_pdlp_store_create(ble_pdlp_store_t * p_store, void * p_segment, uint32_t len, uint32_t device_max)
+{
+    ble_pdlp_store_header_t * p_header = (ble_pdlp_store_header_t *)p_segment;
+
+    if ((device_max == 0) || (device_max > BLE_PDLP_STORE_DEVICE_MAX) || (len < ble_pdlp_store_segment_len(device_max, 1)))
+    {
+        return false;
+    }
+
+    memset(p_header, 0, sizeof(ble_pdlp_store_header_t));
+    p_header->magic            = BLE_PDLP_STORE_MAGIC;
+    p_header->len              = len;
+    p_header->device_max       = device_max;
+    p_header->device_hash_size = device_hash_size(device_max);
+    p_header->block_offset     = block_offset(device_max);
+    p_header->open_offset      = p_header->block_offset;
+    memset(p_header + 1, 0, p_header->device_hash_size * sizeof(uint32_t));
+    return ble_pdlp_store_open(p_store, p_segment, len);
+}
+
+bool ble_pdlp_store_open(ble_pdlp_store_t * p_store, void * p_segment, uint32_t len)
+{
+    ble_pdlp_store_header_t * p_header = (ble_pdlp_store_header_t *)p_segment;
+    uint16_t                  i;
+
+    if ((len < sizeof(ble_pdlp_store_header_t))
+    ||  (p_header->magic != BLE_PDLP_STORE_MAGIC)
+    ||  (p_header->len > len)
+    ||  (p_header->device_max == 0)
+    ||  (p_header->device_max > BLE_PDLP_STORE_DEVICE_MAX)
+    ||  (p_header->device_count > p_header->device_max)
+    ||  (p_header->device_hash_size != device_hash_size(p_header->device_max))
+    ||  (p_header->block_offset != block_offset(p_header->device_max))
+    ||  (p_header->len < OPEN_BLOCK_LEN)
+    ||  (p_header->open_offset < p_header->block_offset)
+    ||  (p_header->open_offset > (p_header->len - OPEN_BLOCK_LEN)))
+    {
+        return false;
+    }
+
+    p_store->p_header      = p_header;
+    p_store->p_device_hash = (uint32_t *)(p_header + 1);
+    p_store->p_devices     = (uint8_t *)(p_store->p_device_hash + p_header->device_hash_size);
+
+    // Rebuild the summary hash table of the open block
+    memset(p_store->summary_hash, 0, sizeof(p_store->summary_hash));
+    if (p_header->block_count != 0)
+    {
+        ble_pdlp_store_block_t * p_block = block_at(p_store, p_header->open_offset);
+        block_columns_t          columns;
+
+        block_columns(p_block, false, &columns);
+        for (i = 0; i < p_block->summary_count; i++)
+        {
+            uint32_t slot = summary_slot_find(p_store, columns.p_summaries, columns.p_summaries[i].device, columns.p_summaries[i].service_id);
+
+            p_store->summary_hash[slot] = i + 1;
+        }
+    }
+    return true;
+}
+
+bool ble_pdlp_store_append(ble_pdlp_store_t * p_store,
+                           uint8_t const    * p_bd_addr,
+                           uint8_t            service_id,
+                           uint16_t           value,
+                           int8_t             rssi,
+                           uint64_t           timestamp_us)
+{
+    ble_pdlp_store_header_t  * p_header = p_store->p_header;
+    ble_pdlp_store_block_t   * p_block = NULL;
+    ble_pdlp_store_summary_t * p_summary;
+    block_columns_t            columns;
+    uint64_t                   delta = 0;
+    uint32_t                   device_slot;
+    uint32_t                   summary_slot;
+    uint32_t                   device;
+    float                      f_value;
+
+    if (p_header->block_count != 0)
+    {
+        p_block = block_at(p_store, p_header->open_offset);
+        if (timestamp_us < p_block->last_timestamp_us)
+        {
+            return false;
+        }
+        delta = timestamp_us - p_block->last_timestamp_us;
+    }
+
+    device_slot = device_slot_find(p_store, p_bd_addr);
+    if ((p_store->p_device_hash[device_slot] == 0) && (p_header->device_count == p_header->device_max))
+    {
+        return false;
+    }
+    device = (p_store->p_device_hash[device_slot] != 0) ? (p_store->p_device_hash[device_slot] - 1) : p_header->device_count;
+
+    // Seal the open block when it has no room for the reading, and open the next one after it
+    if ((p_block == NULL)
+    ||  (p_block->count == BLE_PDLP_STORE_BLOCK_RECORDS)
+    ||  ((p_block->timestamp_len + varint_len(delta)) > BLE_PDLP_STORE_BLOCK_TIMESTAMP_LEN))
+    {
+        uint32_t offset = p_header->open_offset + ((p_block != NULL) ? block_sealed_len(p_block) : 0);
+
+        if (offset > (p_header->len - OPEN_BLOCK_LEN))
+        {
+            return false;
+        }
+        if (p_block != NULL)
+        {
+            block_seal(p_store, p_block);
+        }
+        p_block = block_at(p_store, offset);
+        memset(p_block, 0, sizeof(ble_pdlp_store_block_t));
+        p_block->first_timestamp_us = timestamp_us;
+        p_block->last_timestamp_us  = timestamp_us;
+        p_header->block_count++;
+        delta = 0;
+    }
+
+    if (p_store->p_device_hash[device_slot] == 0)
+    {
+        memcpy(&p_store->p_devices[device * M_BD_ADDR_SIZE], p_bd_addr, M_BD_ADDR_SIZE);
+        p_store->p_device_hash[device_slot] = ++p_header->device_count;
+    }
+
+    block_columns(p_block, false, &columns);
+    summary_slot = summary_slot_find(p_store, columns.p_summaries, device, service_id);
+    f_value      = ble_pdlp_store_value_decode(service_id, value);
+    if (p_store->summary_hash[summary_slot] == 0)
+    {
+        p_summary             = &columns.p_summaries[p_block->summary_count++];
+        p_summary->device     = device;
+        p_summary->service_id = service_id;
+        p_summary->count      = 0;
+        p_summary->sum        = 0;
+        p_summary->min        = f_value;
+        p_summary->max        = f_value;
+        p_store->summary_hash[summary_slot] = p_block->summary_count;
+    }
+    else
+    {
+        p_summary = &columns.p_summaries[p_store->summary_hash[summary_slot] - 1];
+    }
+    p_summary->count++;
+    p_summary->sum += f_value;
+    p_summary->min  = (f_value < p_summary->min) ? f_value : p_summary->min;
+    p_summary->max  = (f_value > p_summary->max) ? f_value : p_summary->max;
+
+    p_block->timestamp_len += varint_encode(delta, &columns.p_timestamps[p_block->timestamp_len]);
+    p_block->device_len    += varint_encode(device, &columns.p_devices[p_block->device_len]);
+    columns.p_values[p_block->count]      = value;
+    columns.p_service_ids[p_block->count] = service_id;
+    columns.p_rssi[p_block->count]        = rssi;
+    p_block->count++;
+    p_block->last_timestamp_us = timestamp_us;
+    return true;
+}
+
+uint8_t ble_pdlp_store_append_beacon(ble_pdlp_store_t        * p_store,
+                                     ble_pdlp_beacon_t const * p_beacon,
+                                     int8_t                    rssi,
+                                     uint64_t                  timestamp_us)
+{
+    uint8_t i;
+
+    for (i = 0; i < p_beacon->service_count; i++)
+    {
+        if (!ble_pdlp_store_append(p_store, p_beacon->bd_addr, p_beacon->service_ids[i], p_beacon->values[i], rssi, timestamp_us))
+        {
+            break;
+        }
+    }
+    return i;
+}
+
+bool ble_pdlp_store_query(ble_pdlp_store_t const  * p_store,
+                          uint8_t const           * p_bd_addr,
+                          uint8_t                   service_id,
+                          uint64_t                  from_us,
+                          uint64_t                  to_us,
+                          ble_pdlp_store_result_t * p_result)
+{
+    ble_pdlp_store_header_t const * p_header = p_store->p_header;
+    uint32_t                        offset = p_header->block_offset;
+    uint32_t                        slot;
+    uint32_t                        device;
+    uint32_t                        b;
+
+    memset(p_result, 0, sizeof(*p_result));
+
+    slot = device_slot_find(p_store, p_bd_addr);
+    if (p_store->p_device_hash[slot] == 0)
+    {
+        return false;
+    }
+    device = p_store->p_device_hash[slot] - 1;
+
+    for (b = 0; b < p_header->block_count; offset += block_at(p_store, offset)->len, b++)
+    {
+        ble_pdlp_store_block_t const * p_block = block_at(p_store, offset);
+        bool                           sealed = (b + 1) < p_header->block_count;
+        bool                           inside;
+        block_columns_t                columns;
+        uint32_t                       i;
+
+        if ((p_block->last_timestamp_us < from_us) || (p_block->first_timestamp_us >= to_us))
+        {
+            continue;
+        }
+
+        block_columns(p_block, sealed, &columns);
+        inside = (p_block->first_timestamp_us >= from_us) && (p_block->last_timestamp_us < to_us);
+        if (inside && (p_block->summary_count != 0))
+        {
+            // The whole block is in the window, its summary has the answer
+            ble_pdlp_store_summary_t const * p_summary = NULL;
+
+            if (sealed)
+            {
+                p_summary = summary_search(columns.p_summaries, p_block->summary_count, device, service_id);
+            }
+            else
+            {
+                // The summaries of the open block are not sorted yet. Its hash table belongs to the store that
+                // appends, so another store opened on the segment can query too.
+                for (i = 0; (i < p_block->summary_count) && (p_summary == NULL); i++)
+                {
+                    if ((columns.p_summaries[i].device == device) && (columns.p_summaries[i].service_id == service_id))
+                    {
+                        p_summary = &columns.p_summaries[i];
+                    }
+                }
+            }
+            if (p_summary != NULL)
+            {
+                summary_add(p_result, p_summary->count, p_summary->min, p_summary->max, p_summary->sum);
+            }
+        }
+        else
+        {
+            // The window starts or ends in the block, or the block has no summaries, scan its columns. The
+            // timestamps are only decoded for a block partly in the window.
+            uint64_t timestamp_us = p_block->first_timestamp_us;
+            uint32_t timestamp_offset = 0;
+            uint32_t device_offset = 0;
+
+            for (i = 0; i < p_block->count; i++)
+            {
+                uint64_t delta;
+                uint64_t reading_device;
+
+                if (!inside)
+                {
+                    timestamp_offset += varint_decode(&columns.p_timestamps[timestamp_offset], &delta);
+                    timestamp_us     += delta;
+                }
+                device_offset += varint_decode(&columns.p_devices[device_offset], &reading_device);
+                if ((reading_device == device) && (columns.p_service_ids[i] == service_id)
+                &&  (inside || ((timestamp_us >= from_us) && (timestamp_us < to_us))))
+                {
+                    float f_value = ble_pdlp_store_value_decode(service_id, columns.p_values[i]);
+
+                    summary_add(p_result, 1, f_value, f_value, f_value);
+                }
+            }
+        }
+    }
+    return true;
+}
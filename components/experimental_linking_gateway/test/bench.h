@@ -0,0 +1,88 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+#ifndef BENCH_H__
+#define BENCH_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Helpers of the host benchmarks: a monotonic clock, capture files mapped in place and threads pinned to cores.
+ */
+
+static inline uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Maps a file read-only, returns NULL if it cannot be read
+static inline void * bench_file_map(char const * p_path, size_t * p_len)
+{
+    struct stat st;
+    void *      p_buf;
+    int         fd = open(p_path, O_RDONLY);
+
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    if ((fstat(fd, &st) != 0) || (st.st_size == 0))
+    {
+        close(fd);
+        return NULL;
+    }
+    p_buf = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p_buf == MAP_FAILED)
+    {
+        return NULL;
+    }
+    (void)madvise(p_buf, (size_t)st.st_size, MADV_SEQUENTIAL);
+    *p_len = (size_t)st.st_size;
+    return p_buf;
+}
+
+static inline uint32_t bench_core_count(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return (count > 0) ? (uint32_t)count : 1;
+}
+
+// Starts a thread pinned to a core, cores beyond the ones online wrap around
+static inline bool bench_thread_start(pthread_t * p_thread, uint32_t core, void * (*p_entry)(void *), void * p_context)
+{
+    pthread_attr_t attr;
+    cpu_set_t      cpus;
+    bool           started;
+
+    CPU_ZERO(&cpus);
+    CPU_SET(core % bench_core_count(), &cpus);
+    pthread_attr_init(&attr);
+    pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+    started = (pthread_create(p_thread, &attr, p_entry, p_context) == 0);
+    pthread_attr_destroy(&attr);
+    return started;
+}
+
+#endif // BENCH_H__
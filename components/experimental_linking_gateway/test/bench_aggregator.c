@@ -0,0 +1,155 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+// Measures ble_pdlp_aggregator_update in packets per second for a site of 100000 devices, each sending a reading
+// on the three advertising channels every second, against the target of 1 M packets/s of one aggregator. Then
+// 1 to N aggregators in threads pinned to a core each, one per pipeline, each with its share of the devices.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "ble_pdlp_aggregator.h"
+
+#define DEVICE_COUNT    (100000)
+#define EVENT_COUNT     (5)
+#define SLOT_COUNT      (262144)
+#define TARGET_RATE     (1000000.0)
+#define ROUNDS          (4)
+
+typedef struct
+{
+    uint8_t  bd_addr[M_BD_ADDR_SIZE];
+    uint16_t value;
+    int8_t   rssi;
+    uint64_t timestamp_us;
+} packet_t;
+
+typedef struct
+{
+    pthread_t             thread;
+    ble_pdlp_aggregator_t aggregator;
+    void                * p_slots;
+    packet_t const      * p_packets;
+    uint32_t              packet_count;
+    uint64_t              accepted;
+    uint64_t              elapsed_ns;
+} worker_t;
+
+// The packets of the devices from first to first + count, in time order
+static packet_t * packets_generate(uint32_t first, uint32_t count)
+{
+    packet_t * p_packets = malloc((size_t)count * EVENT_COUNT * 3 * sizeof(packet_t));
+    packet_t * p_packet = p_packets;
+    uint32_t   event;
+    uint32_t   device;
+    uint8_t    channel;
+
+    for (event = 0; event < EVENT_COUNT; event++)
+    {
+        for (device = first; device < (first + count); device++)
+        {
+            for (channel = 0; channel < 3; channel++)
+            {
+                p_packet->bd_addr[0]   = (uint8_t)device;
+                p_packet->bd_addr[1]   = (uint8_t)(device >> 8);
+                p_packet->bd_addr[2]   = (uint8_t)(device >> 16);
+                p_packet->bd_addr[3]   = 0x33;
+                p_packet->bd_addr[4]   = 0x22;
+                p_packet->bd_addr[5]   = 0xC0;
+                p_packet->value        = (uint16_t)((device + event) & 0xFFF);
+                p_packet->rssi         = (int8_t)(-50 - (int32_t)(device % 40) - channel);
+                p_packet->timestamp_us = (uint64_t)event * 1000000 + device * 10 + channel * 300;
+                p_packet++;
+            }
+        }
+    }
+    return p_packets;
+}
+
+static void * worker_run(void * p_context)
+{
+    worker_t * p_worker = (worker_t *)p_context;
+    uint32_t   round;
+    uint32_t   i;
+
+    for (round = 0; round < ROUNDS; round++)
+    {
+        uint64_t start_ns;
+
+        ble_pdlp_aggregator_init(&p_worker->aggregator, p_worker->p_slots, SLOT_COUNT, 10000);
+        start_ns = bench_now_ns();
+        for (i = 0; i < p_worker->packet_count; i++)
+        {
+            packet_t const * p_packet = &p_worker->p_packets[i];
+
+            p_worker->accepted += ble_pdlp_aggregator_update(&p_worker->aggregator, p_packet->bd_addr, 4, p_packet->value,
+                                                             p_packet->rssi, p_packet->timestamp_us);
+        }
+        p_worker->elapsed_ns += bench_now_ns() - start_ns;
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    uint32_t   cores = bench_core_count();
+    worker_t * p_workers = calloc(cores, sizeof(worker_t));
+    double     single_rate = 0;
+    uint32_t   threads;
+    uint32_t   i;
+
+    printf("bench_aggregator: %u devices, %u events on 3 channels, %u slots of %u bytes, %u cores\n",
+           (unsigned int)DEVICE_COUNT, (unsigned int)EVENT_COUNT, (unsigned int)SLOT_COUNT,
+           (unsigned int)sizeof(ble_pdlp_aggregator_entry_t), (unsigned int)cores);
+
+    for (threads = 1; threads <= cores; threads++)
+    {
+        uint64_t total = 0;
+        uint64_t slowest_ns = 0;
+        double   rate;
+
+        for (i = 0; i < threads; i++)
+        {
+            uint32_t first = (uint32_t)((uint64_t)DEVICE_COUNT * i / threads);
+            uint32_t count = (uint32_t)((uint64_t)DEVICE_COUNT * (i + 1) / threads) - first;
+
+            memset(&p_workers[i], 0, sizeof(worker_t));
+            p_workers[i].p_slots      = malloc(ble_pdlp_aggregator_memory_size(SLOT_COUNT));
+            p_workers[i].p_packets    = packets_generate(first, count);
+            p_workers[i].packet_count = count * EVENT_COUNT * 3;
+            bench_thread_start(&p_workers[i].thread, i, worker_run, &p_workers[i]);
+        }
+        for (i = 0; i < threads; i++)
+        {
+            pthread_join(p_workers[i].thread, NULL);
+            if (p_workers[i].accepted != (uint64_t)p_workers[i].packet_count / 3 * ROUNDS)
+            {
+                printf("bench_aggregator: thread %u passed on %llu readings\n", (unsigned int)i, (unsigned long long)p_workers[i].accepted);
+                return 1;
+            }
+            total     += (uint64_t)p_workers[i].packet_count * ROUNDS;
+            slowest_ns = (p_workers[i].elapsed_ns > slowest_ns) ? p_workers[i].elapsed_ns : slowest_ns;
+            free(p_workers[i].p_slots);
+            free((void *)p_workers[i].p_packets);
+        }
+
+        rate        = (double)total * 1e9 / (double)slowest_ns;
+        single_rate = (threads == 1) ? rate : single_rate;
+        printf("  %2u aggregators: %7.2f M packets/s, %6.2f M per core, %5.1f ns per packet\n",
+               (unsigned int)threads, rate / 1e6, rate / 1e6 / threads, (double)slowest_ns * threads / (double)total);
+    }
+
+    printf("bench_aggregator: one aggregator %s the target of %.0f M packets/s\n",
+           (single_rate >= TARGET_RATE) ? "meets" : "misses", TARGET_RATE / 1e6);
+    return (single_rate >= TARGET_RATE) ? 0 : 1;
+}
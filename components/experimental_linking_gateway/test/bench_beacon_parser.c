@@ -0,0 +1,187 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+// Measures ble_pdlp_beacon_parse_batch in reports per second, on 1 to N cores with one pinned thread per core
+// each parsing the whole set of reports. The reports are the advertising reports of the capture given as the
+// argument, or a generated mix of Linking beacons and other advertisers.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "ble_pdlp_beacon_parser.h"
+#include "ble_pdlp_capture.h"
+#include "capture_gen.h"
+
+#define GENERATED_REPORTS   (262144)    // About a second of reports at a busy site
+#define BATCH_SIZE          (256)
+#define TARGET_NS           (500000000ULL)
+
+typedef struct
+{
+    pthread_t thread;
+    uint32_t  rounds;
+    uint64_t  found;
+    uint64_t  elapsed_ns;
+} worker_t;
+
+static ble_pdlp_adv_report_t * mp_reports;
+static uint32_t                m_report_count;
+
+static void * worker_run(void * p_context)
+{
+    worker_t *        p_worker = (worker_t *)p_context;
+    ble_pdlp_beacon_t beacons[BATCH_SIZE];
+    uint64_t          start_ns = bench_now_ns();
+    uint32_t          round;
+    uint32_t          i;
+
+    for (round = 0; round < p_worker->rounds; round++)
+    {
+        for (i = 0; i < m_report_count; i += BATCH_SIZE)
+        {
+            uint32_t count = ((m_report_count - i) < BATCH_SIZE) ? (m_report_count - i) : BATCH_SIZE;
+
+            p_worker->found += ble_pdlp_beacon_parse_batch(&mp_reports[i], count, beacons);
+        }
+    }
+    p_worker->elapsed_ns = bench_now_ns() - start_ns;
+    return NULL;
+}
+
+static uint32_t reports_load(char const * p_path)
+{
+    ble_pdlp_capture_t        capture;
+    ble_pdlp_capture_record_t record;
+    uint8_t const *           p_buf;
+    size_t                    len;
+    uint32_t                  count = 0;
+    uint32_t                  size = 65536;
+
+    p_buf = (uint8_t const *)bench_file_map(p_path, &len);
+    if ((p_buf == NULL) || !ble_pdlp_capture_open(&capture, p_buf, len))
+    {
+        return 0;
+    }
+
+    mp_reports = (ble_pdlp_adv_report_t *)malloc(size * sizeof(ble_pdlp_adv_report_t));
+    while (ble_pdlp_capture_next(&capture, &record))
+    {
+        if (record.type != BLE_PDLP_CAPTURE_RECORD_ADV)
+        {
+            continue;
+        }
+        if (count == size)
+        {
+            size      *= 2;
+            mp_reports = (ble_pdlp_adv_report_t *)realloc(mp_reports, size * sizeof(ble_pdlp_adv_report_t));
+        }
+        memcpy(mp_reports[count].bd_addr, record.params.adv.p_bd_addr, M_BD_ADDR_SIZE);
+        mp_reports[count].data_len = record.params.adv.data_len;
+        memcpy(mp_reports[count].data, record.params.adv.p_data, record.params.adv.data_len);
+        count++;
+    }
+    return count;
+}
+
+// Half Linking beacons, single-service with the UUID and multi-service without, half other advertisers
+static uint32_t reports_generate(void)
+{
+    uint32_t i;
+
+    mp_reports = (ble_pdlp_adv_report_t *)calloc(GENERATED_REPORTS, sizeof(ble_pdlp_adv_report_t));
+    for (i = 0; i < GENERATED_REPORTS; i++)
+    {
+        uint8_t  service_ids[4] = { 1, 2, 3, 4 };
+        uint16_t values[4] = { (uint16_t)(i & 0xFFF), 0x622, 0x0F9, 0xBE8 };
+
+        memcpy(mp_reports[i].bd_addr, &i, sizeof(i));
+        switch (i % 4)
+        {
+            case 0:
+                mp_reports[i].data_len = capture_gen_linking_adv(mp_reports[i].data, true, 0x0A, i & 0xFFFFF, service_ids, values, 1);
+                break;
+            case 1:
+                mp_reports[i].data_len = capture_gen_linking_adv(mp_reports[i].data, false, 0x0A, i & 0xFFFFF, service_ids, values, 4);
+                break;
+            default:
+                mp_reports[i].data_len = capture_gen_other_adv(mp_reports[i].data, i);
+                break;
+        }
+    }
+    return GENERATED_REPORTS;
+}
+
+int main(int argc, char ** argv)
+{
+    worker_t * p_workers;
+    uint32_t   cores = bench_core_count();
+    uint32_t   rounds;
+    uint32_t   threads;
+    uint64_t   found_once = 0;
+
+    m_report_count = (argc > 1) ? reports_load(argv[1]) : reports_generate();
+    if (m_report_count == 0)
+    {
+        printf("bench_beacon_parser: no advertising reports in %s\n", argv[1]);
+        return 1;
+    }
+
+    // Calibrate the rounds for about TARGET_NS on one core
+    {
+        worker_t worker;
+
+        memset(&worker, 0, sizeof(worker));
+        worker.rounds = 1;
+        worker_run(&worker);
+        found_once = worker.found;
+        rounds     = (uint32_t)(TARGET_NS / (worker.elapsed_ns + 1)) + 1;
+    }
+
+    printf("bench_beacon_parser: %u reports, %llu Linking beacons, %u cores\n",
+           (unsigned int)m_report_count, (unsigned long long)found_once, (unsigned int)cores);
+
+    p_workers = (worker_t *)calloc(cores, sizeof(worker_t));
+    for (threads = 1; threads <= cores; threads++)
+    {
+        uint64_t total = 0;
+        uint64_t slowest_ns = 0;
+        uint32_t i;
+
+        for (i = 0; i < threads; i++)
+        {
+            memset(&p_workers[i], 0, sizeof(worker_t));
+            p_workers[i].rounds = rounds;
+            if (!bench_thread_start(&p_workers[i].thread, i, worker_run, &p_workers[i]))
+            {
+                printf("bench_beacon_parser: cannot start thread %u\n", (unsigned int)i);
+                return 1;
+            }
+        }
+        for (i = 0; i < threads; i++)
+        {
+            pthread_join(p_workers[i].thread, NULL);
+            if (p_workers[i].found != found_once * rounds)
+            {
+                printf("bench_beacon_parser: thread %u found %llu beacons\n", (unsigned int)i, (unsigned long long)p_workers[i].found);
+                return 1;
+            }
+            total     += (uint64_t)m_report_count * rounds;
+            slowest_ns = (p_workers[i].elapsed_ns > slowest_ns) ? p_workers[i].elapsed_ns : slowest_ns;
+        }
+
+        printf("  %2u threads: %8.2f M reports/s, %6.2f M reports/s per core, %5.1f ns per report\n",
+               (unsigned int)threads, (double)total * 1000.0 / (double)slowest_ns,
+               (double)total * 1000.0 / (double)slowest_ns / threads, (double)slowest_ns * threads / (double)total);
+    }
+    return 0;
+}
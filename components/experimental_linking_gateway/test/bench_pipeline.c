@@ -0,0 +1,271 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+// Measures the pipeline capture -> decode -> aggregate -> store in advertising reports per second:
+//   pipelines: 1 to N pipelines, one per radio, each running its stages in turn in a thread pinned to its own core.
+//   stages:    one pipeline with a thread per stage, pinned to cores 0 to 3, wrapping around on fewer cores.
+// The capture is the one given as the argument, or a generated site of 10000 beacons on three channels.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "ble_pdlp_pipeline.h"
+#include "capture_gen.h"
+
+#define SITE_DEVICES    (10000)
+#define SITE_EVENTS     (20)
+#define DEVICE_MAX      (65536)
+#define SLOT_COUNT      (262144)
+#define RING_SIZE       (1024)
+#define BATCH_MAX       (256)
+
+typedef struct
+{
+    pthread_t                    thread;
+    ble_pdlp_capture_t           capture;
+    ble_pdlp_ring_t              reports;
+    ble_pdlp_ring_t              beacons;
+    ble_pdlp_ring_t              news;
+    ble_pdlp_pipeline_stage_t    capture_stage;
+    ble_pdlp_pipeline_stage_t    decode_stage;
+    ble_pdlp_pipeline_stage_t    aggregate_stage;
+    ble_pdlp_pipeline_stage_t    store_stage;
+    ble_pdlp_aggregator_t        aggregator;
+    ble_pdlp_store_t             store;
+    ble_pdlp_pipeline_report_t * p_report_buf;
+    ble_pdlp_pipeline_beacon_t * p_beacon_buf;
+    ble_pdlp_pipeline_beacon_t * p_new_buf;
+    void                       * p_slots;
+    void                       * p_segment;
+    uint64_t                     elapsed_ns;
+} pipeline_t;
+
+static uint8_t const * mp_capture;
+static size_t          m_capture_len;
+static uint32_t        m_block_count;
+
+static bool pipeline_init(pipeline_t * p_pipeline)
+{
+    uint32_t segment_len = ble_pdlp_store_segment_len(DEVICE_MAX, m_block_count);
+
+    memset(p_pipeline, 0, sizeof(*p_pipeline));
+    p_pipeline->p_report_buf = malloc(RING_SIZE * sizeof(ble_pdlp_pipeline_report_t));
+    p_pipeline->p_beacon_buf = malloc(RING_SIZE * sizeof(ble_pdlp_pipeline_beacon_t));
+    p_pipeline->p_new_buf    = malloc(RING_SIZE * sizeof(ble_pdlp_pipeline_beacon_t));
+    p_pipeline->p_slots      = malloc(ble_pdlp_aggregator_memory_size(SLOT_COUNT));
+    p_pipeline->p_segment    = malloc(segment_len);
+    if ((p_pipeline->p_report_buf == NULL) || (p_pipeline->p_beacon_buf == NULL) || (p_pipeline->p_new_buf == NULL)
+    ||  (p_pipeline->p_slots == NULL) || (p_pipeline->p_segment == NULL))
+    {
+        return false;
+    }
+
+    ble_pdlp_capture_open(&p_pipeline->capture, mp_capture, m_capture_len);
+    ble_pdlp_ring_init(&p_pipeline->reports, p_pipeline->p_report_buf, sizeof(ble_pdlp_pipeline_report_t), RING_SIZE);
+    ble_pdlp_ring_init(&p_pipeline->beacons, p_pipeline->p_beacon_buf, sizeof(ble_pdlp_pipeline_beacon_t), RING_SIZE);
+    ble_pdlp_ring_init(&p_pipeline->news, p_pipeline->p_new_buf, sizeof(ble_pdlp_pipeline_beacon_t), RING_SIZE);
+    ble_pdlp_aggregator_init(&p_pipeline->aggregator, p_pipeline->p_slots, SLOT_COUNT, 10000);
+    ble_pdlp_pipeline_stage_init(&p_pipeline->capture_stage, BLE_PDLP_PIPELINE_BACKPRESSURE_WAIT, BATCH_MAX);
+    ble_pdlp_pipeline_stage_init(&p_pipeline->decode_stage, BLE_PDLP_PIPELINE_BACKPRESSURE_WAIT, BATCH_MAX);
+    ble_pdlp_pipeline_stage_init(&p_pipeline->aggregate_stage, BLE_PDLP_PIPELINE_BACKPRESSURE_WAIT, BATCH_MAX);
+    ble_pdlp_pipeline_stage_init(&p_pipeline->store_stage, BLE_PDLP_PIPELINE_BACKPRESSURE_WAIT, BATCH_MAX);
+
+    // Touch the segment before the clock starts, as a file mapped by a running gateway would be
+    memset(p_pipeline->p_segment, 0, segment_len);
+    return ble_pdlp_store_create(&p_pipeline->store, p_pipeline->p_segment, segment_len, DEVICE_MAX);
+}
+
+static void pipeline_free(pipeline_t * p_pipeline)
+{
+    free(p_pipeline->p_report_buf);
+    free(p_pipeline->p_beacon_buf);
+    free(p_pipeline->p_new_buf);
+    free(p_pipeline->p_slots);
+    free(p_pipeline->p_segment);
+}
+
+static void * pipeline_run(void * p_context)
+{
+    pipeline_t * p_pipeline = (pipeline_t *)p_context;
+    uint64_t     start_ns = bench_now_ns();
+
+    while (!ble_pdlp_ring_is_drained(&p_pipeline->news))
+    {
+        ble_pdlp_pipeline_capture_step(&p_pipeline->capture_stage, &p_pipeline->capture, &p_pipeline->reports);
+        ble_pdlp_pipeline_decode_step(&p_pipeline->decode_stage, &p_pipeline->reports, &p_pipeline->beacons);
+        ble_pdlp_pipeline_aggregate_step(&p_pipeline->aggregate_stage, &p_pipeline->beacons, &p_pipeline->aggregator, &p_pipeline->news);
+        ble_pdlp_pipeline_store_step(&p_pipeline->store_stage, &p_pipeline->news, &p_pipeline->store);
+    }
+    p_pipeline->elapsed_ns = bench_now_ns() - start_ns;
+    return NULL;
+}
+
+static void * capture_run(void * p_context)
+{
+    pipeline_t * p_pipeline = (pipeline_t *)p_context;
+
+    while (!p_pipeline->reports.closed)
+    {
+        if (ble_pdlp_pipeline_capture_step(&p_pipeline->capture_stage, &p_pipeline->capture, &p_pipeline->reports) == 0)
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void * decode_run(void * p_context)
+{
+    pipeline_t * p_pipeline = (pipeline_t *)p_context;
+
+    while (!ble_pdlp_ring_is_drained(&p_pipeline->reports))
+    {
+        if (ble_pdlp_pipeline_decode_step(&p_pipeline->decode_stage, &p_pipeline->reports, &p_pipeline->beacons) == 0)
+        {
+            sched_yield();
+        }
+    }
+    ble_pdlp_pipeline_decode_step(&p_pipeline->decode_stage, &p_pipeline->reports, &p_pipeline->beacons);
+    return NULL;
+}
+
+static void * aggregate_run(void * p_context)
+{
+    pipeline_t * p_pipeline = (pipeline_t *)p_context;
+
+    while (!ble_pdlp_ring_is_drained(&p_pipeline->beacons))
+    {
+        if (ble_pdlp_pipeline_aggregate_step(&p_pipeline->aggregate_stage, &p_pipeline->beacons, &p_pipeline->aggregator, &p_pipeline->news) == 0)
+        {
+            sched_yield();
+        }
+    }
+    ble_pdlp_pipeline_aggregate_step(&p_pipeline->aggregate_stage, &p_pipeline->beacons, &p_pipeline->aggregator, &p_pipeline->news);
+    return NULL;
+}
+
+static void * store_run(void * p_context)
+{
+    pipeline_t * p_pipeline = (pipeline_t *)p_context;
+
+    while (!ble_pdlp_ring_is_drained(&p_pipeline->news))
+    {
+        if (ble_pdlp_pipeline_store_step(&p_pipeline->store_stage, &p_pipeline->news, &p_pipeline->store) == 0)
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void stages_print(char const * p_label, pipeline_t const * p_pipeline, uint32_t pipelines, uint64_t elapsed_ns)
+{
+    uint64_t reports = p_pipeline->capture_stage.out_count * pipelines;
+
+    printf("  %-10s %2u: %7.2f M reports/s, %6.2f M per core, %7.2f M readings/s stored, %5.1f%% of beacons new\n",
+           p_label, (unsigned int)pipelines, (double)reports * 1000.0 / (double)elapsed_ns,
+           (double)reports * 1000.0 / (double)elapsed_ns / pipelines,
+           (double)(p_pipeline->store_stage.out_count * pipelines) * 1000.0 / (double)elapsed_ns,
+           100.0 * (double)p_pipeline->aggregate_stage.out_count / (double)(p_pipeline->decode_stage.out_count + 1));
+}
+
+static bool capture_load(int argc, char ** argv)
+{
+    capture_gen_t gen;
+    size_t        size = (size_t)SITE_DEVICES * SITE_EVENTS * 400;
+    uint8_t     * p_buf;
+
+    if (argc > 1)
+    {
+        mp_capture = (uint8_t const *)bench_file_map(argv[1], &m_capture_len);
+        // One block per 4096 records at most, whatever the mix of the capture
+        m_block_count = (uint32_t)(m_capture_len / 16 / BLE_PDLP_STORE_BLOCK_RECORDS) + 2;
+        return mp_capture != NULL;
+    }
+
+    p_buf = malloc(size);
+    capture_gen_btsnoop_start(&gen, p_buf, size);
+    m_block_count = capture_gen_site(&gen, 1600000000000000ULL, SITE_DEVICES, SITE_EVENTS, SITE_DEVICES * 1000ULL)
+                  / BLE_PDLP_STORE_BLOCK_RECORDS + 2;
+    mp_capture    = p_buf;
+    m_capture_len = gen.len;
+    return !gen.full;
+}
+
+int main(int argc, char ** argv)
+{
+    static void * (* const stage_entries[4])(void *) = { capture_run, decode_run, aggregate_run, store_run };
+    pipeline_t * p_pipelines;
+    uint32_t     cores = bench_core_count();
+    uint32_t     count;
+    uint32_t     i;
+
+    if (!capture_load(argc, argv))
+    {
+        printf("bench_pipeline: cannot load the capture\n");
+        return 1;
+    }
+
+    p_pipelines = (pipeline_t *)calloc(cores, sizeof(pipeline_t));
+    printf("bench_pipeline: %llu bytes of capture, %u cores\n", (unsigned long long)m_capture_len, (unsigned int)cores);
+    for (count = 1; count <= cores; count++)
+    {
+        uint64_t slowest_ns = 0;
+
+        for (i = 0; i < count; i++)
+        {
+            if (!pipeline_init(&p_pipelines[i]))
+            {
+                printf("bench_pipeline: out of memory for %u pipelines\n", (unsigned int)count);
+                return 1;
+            }
+        }
+        for (i = 0; i < count; i++)
+        {
+            bench_thread_start(&p_pipelines[i].thread, i, pipeline_run, &p_pipelines[i]);
+        }
+        for (i = 0; i < count; i++)
+        {
+            pthread_join(p_pipelines[i].thread, NULL);
+            slowest_ns = (p_pipelines[i].elapsed_ns > slowest_ns) ? p_pipelines[i].elapsed_ns : slowest_ns;
+        }
+        stages_print("pipelines", &p_pipelines[0], count, slowest_ns);
+        for (i = 0; i < count; i++)
+        {
+            pipeline_free(&p_pipelines[i]);
+        }
+    }
+
+    {
+        pthread_t threads[4];
+        uint64_t  start_ns;
+
+        if (!pipeline_init(&p_pipelines[0]))
+        {
+            printf("bench_pipeline: out of memory\n");
+            return 1;
+        }
+        start_ns = bench_now_ns();
+        for (i = 0; i < 4; i++)
+        {
+            bench_thread_start(&threads[i], i, stage_entries[i], &p_pipelines[0]);
+        }
+        for (i = 0; i < 4; i++)
+        {
+            pthread_join(threads[i], NULL);
+        }
+        stages_print("stages", &p_pipelines[0], 1, bench_now_ns() - start_ns);
+        pipeline_free(&p_pipelines[0]);
+    }
+    return 0;
+}
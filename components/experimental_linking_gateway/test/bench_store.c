@@ -0,0 +1,142 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+// Measures the store with the readings of 200 to 100000 interleaved devices, each sending a temperature every
+// 5 seconds: the ingest rate, the bytes taken per sealed reading and per device of the dictionary, and the rate of
+// queries over a tenth of the store and over the whole store.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "ble_pdlp_store.h"
+#include "ble_pdlp_common.h"
+
+#define READING_COUNT   (2000000)
+#define PERIOD_US       (5000000ULL)
+#define BASE_US         (1600000000000000ULL)
+#define QUERY_COUNT     (2000)
+
+static void device_addr(uint32_t device, uint8_t * p_bd_addr)
+{
+    p_bd_addr[0] = (uint8_t)device;
+    p_bd_addr[1] = (uint8_t)(device >> 8);
+    p_bd_addr[2] = (uint8_t)(device >> 16);
+    p_bd_addr[3] = 0x33;
+    p_bd_addr[4] = 0x22;
+    p_bd_addr[5] = 0xC0;
+}
+
+// Runs queries of random devices over random windows, or over the whole store if window_us is UINT64_MAX.
+// Returns the time taken, or 0 if no query found a reading.
+static uint64_t query_run(ble_pdlp_store_t const * p_store, uint32_t device_count, uint64_t window_us, uint64_t last_us)
+{
+    ble_pdlp_store_result_t result;
+    uint8_t                 bd_addr[M_BD_ADDR_SIZE];
+    uint64_t                start_ns = bench_now_ns();
+    uint64_t                found = 0;
+    uint32_t                i;
+
+    srand(1);
+    for (i = 0; i < QUERY_COUNT; i++)
+    {
+        uint64_t from_us = 0;
+        uint64_t to_us = UINT64_MAX;
+
+        if (window_us != UINT64_MAX)
+        {
+            from_us = BASE_US + (uint64_t)rand() * (last_us - BASE_US - window_us) / RAND_MAX;
+            to_us   = from_us + window_us;
+        }
+        device_addr((uint32_t)rand() % device_count, bd_addr);
+        ble_pdlp_store_query(p_store, bd_addr, LINKING_SERVICE_TYPE_TEMPERATURE, from_us, to_us, &result);
+        found += result.count;
+    }
+    return (found != 0) ? (bench_now_ns() - start_ns) : 0;
+}
+
+static bool bench_run(uint32_t device_count)
+{
+    uint32_t                        len = ble_pdlp_store_segment_len(device_count, READING_COUNT / BLE_PDLP_STORE_BLOCK_RECORDS + 2);
+    void                          * p_segment = malloc(len);
+    ble_pdlp_store_t              * p_store = malloc(sizeof(ble_pdlp_store_t));
+    ble_pdlp_store_header_t const * p_header;
+    ble_pdlp_store_block_t const  * p_open;
+    uint8_t                         bd_addr[M_BD_ADDR_SIZE];
+    uint64_t                        timestamp_us = BASE_US;
+    uint64_t                        start_ns;
+    uint64_t                        ingest_ns;
+    uint64_t                        window_ns;
+    uint64_t                        all_ns;
+    uint32_t                        sealed_count;
+    uint32_t                        i;
+
+    if ((p_segment == NULL) || (p_store == NULL) || !ble_pdlp_store_create(p_store, p_segment, len, device_count))
+    {
+        printf("bench_store: cannot create a store of %u bytes\n", (unsigned int)len);
+        return false;
+    }
+    memset((uint8_t *)p_segment + p_store->p_header->block_offset, 0, len - p_store->p_header->block_offset);
+
+    start_ns = bench_now_ns();
+    for (i = 0; i < READING_COUNT; i++)
+    {
+        uint32_t device = i % device_count;
+
+        device_addr(device, bd_addr);
+        timestamp_us += PERIOD_US / device_count;
+        if (!ble_pdlp_store_append(p_store, bd_addr, LINKING_SERVICE_TYPE_TEMPERATURE, (uint16_t)(0x4A0 + (i & 0x3F)), -60, timestamp_us))
+        {
+            printf("bench_store: append %u failed\n", (unsigned int)i);
+            return false;
+        }
+    }
+    ingest_ns = bench_now_ns() - start_ns;
+
+    p_header     = p_store->p_header;
+    p_open       = (ble_pdlp_store_block_t const *)((uint8_t const *)p_header + p_header->open_offset);
+    sealed_count = READING_COUNT - p_open->count;
+    window_ns    = query_run(p_store, device_count, (timestamp_us - BASE_US) / 10, timestamp_us);
+    all_ns       = query_run(p_store, device_count, UINT64_MAX, timestamp_us);
+    if ((window_ns == 0) || (all_ns == 0))
+    {
+        printf("bench_store: the queries found no readings\n");
+        return false;
+    }
+
+    printf("  %6u devices: %6.2f M readings/s, %5.2f bytes per reading in %u blocks, %5.1f bytes per device,"
+           " %7.0f tenth queries/s, %7.0f whole queries/s\n",
+           (unsigned int)device_count, (double)READING_COUNT * 1000.0 / (double)ingest_ns,
+           (double)(p_header->open_offset - p_header->block_offset) / (double)sealed_count, (unsigned int)p_header->block_count - 1,
+           (double)p_header->block_offset / (double)device_count,
+           (double)QUERY_COUNT * 1e9 / (double)window_ns, (double)QUERY_COUNT * 1e9 / (double)all_ns);
+
+    free(p_store);
+    free(p_segment);
+    return true;
+}
+
+int main(void)
+{
+    static const uint32_t device_counts[] = { 200, 10000, 100000 };
+    uint32_t              i;
+
+    printf("bench_store: %u readings of temperature, one per device every %u s\n", (unsigned int)READING_COUNT, (unsigned int)(PERIOD_US / 1000000));
+    for (i = 0; i < sizeof(device_counts) / sizeof(device_counts[0]); i++)
+    {
+        if (!bench_run(device_counts[i]))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,350 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+#include "capture_gen.h"
+#include <string.h>
+
+#define BTSNOOP_EPOCH_TO_UNIX_US    (0x00DCDDB30F2F8000ULL)
+#define LL_ADV_ACCESS_ADDRESS       (0x8E89BED6UL)
+
+// The Linking 128-bit service UUID, least significant byte first
+static const uint8_t m_linking_uuid[16] =
+{
+    0xCD, 0xA6, 0x13, 0x5B, 0x83, 0x50, 0x8D, 0x80, 0x44, 0x40, 0xD3, 0x50, 0x01, 0x69, 0xB3, 0xB3
+};
+
+static void be32_put(uint8_t * p, uint32_t value)
+{
+    p[0] = (uint8_t)(value >> 24);
+    p[1] = (uint8_t)(value >> 16);
+    p[2] = (uint8_t)(value >> 8);
+    p[3] = (uint8_t)value;
+}
+
+static void le16_put(uint8_t * p, uint16_t value)
+{
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+static void le32_put(uint8_t * p, uint32_t value)
+{
+    le16_put(p, (uint16_t)value);
+    le16_put(&p[2], (uint16_t)(value >> 16));
+}
+
+// Reserves a record of len bytes after its record header, returns NULL if it does not fit
+static uint8_t * record_start(capture_gen_t * p_gen, uint64_t timestamp_us, uint32_t len, bool received, bool command_or_event)
+{
+    uint8_t * p;
+
+    if (p_gen->btsnoop)
+    {
+        uint64_t timestamp = timestamp_us + BTSNOOP_EPOCH_TO_UNIX_US;
+
+        if (p_gen->len + 24 + len > p_gen->size)
+        {
+            p_gen->full = true;
+            return NULL;
+        }
+        p = &p_gen->p_buf[p_gen->len];
+        be32_put(&p[0], len);
+        be32_put(&p[4], len);
+        be32_put(&p[8], (received ? 0x01 : 0x00) | (command_or_event ? 0x02 : 0x00));
+        be32_put(&p[12], 0);
+        be32_put(&p[16], (uint32_t)(timestamp >> 32));
+        be32_put(&p[20], (uint32_t)timestamp);
+        p_gen->len += 24 + len;
+        return &p[24];
+    }
+
+    if (p_gen->len + 16 + len > p_gen->size)
+    {
+        p_gen->full = true;
+        return NULL;
+    }
+    p = &p_gen->p_buf[p_gen->len];
+    le32_put(&p[0], (uint32_t)(timestamp_us / 1000000));
+    le32_put(&p[4], (uint32_t)(timestamp_us % 1000000));
+    le32_put(&p[8], len);
+    le32_put(&p[12], len);
+    p_gen->len += 16 + len;
+    return &p[16];
+}
+
+uint8_t capture_gen_linking_adv(uint8_t        * p_data,
+                                bool             with_uuid,
+                                uint8_t          vendor_id,
+                                uint32_t         class_id,
+                                uint8_t const  * p_service_ids,
+                                uint16_t const * p_values,
+                                uint8_t          count)
+{
+    uint8_t len = 0;
+    uint8_t i;
+
+    // Flags
+    p_data[len++] = 2;
+    p_data[len++] = 0x01;
+    p_data[len++] = 0x04;
+
+    if (with_uuid)
+    {
+        p_data[len++] = 17;
+        p_data[len++] = 0x07;
+        memcpy(&p_data[len], m_linking_uuid, sizeof(m_linking_uuid));
+        len += sizeof(m_linking_uuid);
+    }
+
+    // Manufacturer specific data: company ID, version 0, vendor ID, class ID and the service data
+    p_data[len++] = (uint8_t)(7 + count * 2);
+    p_data[len++] = 0xFF;
+    p_data[len++] = 0xE2;
+    p_data[len++] = 0x02;
+    be32_put(&p_data[len], ((uint32_t)vendor_id << 20) | (class_id & 0xFFFFF));
+    len += 4;
+    for (i = 0; i < count; i++)
+    {
+        p_data[len++] = (uint8_t)((p_service_ids[i] << 4) | ((p_values[i] >> 8) & 0xF));
+        p_data[len++] = (uint8_t)p_values[i];
+    }
+    return len;
+}
+
+uint8_t capture_gen_other_adv(uint8_t * p_data, uint32_t seed)
+{
+    uint8_t len = 0;
+    uint8_t i;
+
+    p_data[len++] = 2;
+    p_data[len++] = 0x01;
+    p_data[len++] = 0x06;
+
+    if (seed & 1)
+    {
+        // Another company, with data as long as a Linking header
+        p_data[len++] = 13;
+        p_data[len++] = 0xFF;
+        p_data[len++] = 0x4C;
+        p_data[len++] = 0x00;
+        for (i = 0; i < 10; i++)
+        {
+            p_data[len++] = (uint8_t)(seed >> i);
+        }
+    }
+    else
+    {
+        // A complete local name
+        p_data[len++] = 9;
+        p_data[len++] = 0x09;
+        memcpy(&p_data[len], "Sensor00", 8);
+        p_data[len + 6] = (uint8_t)('0' + (seed >> 1) % 10);
+        len += 8;
+    }
+    return len;
+}
+
+void capture_gen_btsnoop_start(capture_gen_t * p_gen, void * p_buf, size_t size)
+{
+    memset(p_gen, 0, sizeof(*p_gen));
+    p_gen->p_buf   = (uint8_t *)p_buf;
+    p_gen->size    = size;
+    p_gen->btsnoop = true;
+    if (size >= 16)
+    {
+        memcpy(p_gen->p_buf, "btsnoop\0", 8);
+        be32_put(&p_gen->p_buf[8], 1);
+        be32_put(&p_gen->p_buf[12], 1002);
+        p_gen->len = 16;
+    }
+}
+
+void capture_gen_pcap_start(capture_gen_t * p_gen, void * p_buf, size_t size, bool with_phdr)
+{
+    memset(p_gen, 0, sizeof(*p_gen));
+    p_gen->p_buf     = (uint8_t *)p_buf;
+    p_gen->size      = size;
+    p_gen->with_phdr = with_phdr;
+    if (size >= 24)
+    {
+        le32_put(&p_gen->p_buf[0], 0xA1B2C3D4UL);
+        le16_put(&p_gen->p_buf[4], 2);
+        le16_put(&p_gen->p_buf[6], 4);
+        le32_put(&p_gen->p_buf[8], 0);
+        le32_put(&p_gen->p_buf[12], 0);
+        le32_put(&p_gen->p_buf[16], 65535);
+        le32_put(&p_gen->p_buf[20], with_phdr ? 256 : 251);
+        p_gen->len = 24;
+    }
+}
+
+void capture_gen_adv(capture_gen_t * p_gen, uint64_t timestamp_us, uint8_t const * p_bd_addr,
+                     uint8_t const * p_data, uint8_t data_len, int8_t rssi)
+{
+    uint8_t * p;
+
+    if (p_gen->btsnoop)
+    {
+        // H4 type, LE Meta event, one report of an ADV_NONCONN_IND with the RSSI after the data
+        p = record_start(p_gen, timestamp_us, 1 + 2 + 11 + data_len + 1, true, true);
+        if (p == NULL)
+        {
+            return;
+        }
+        p[0]  = 0x04;
+        p[1]  = 0x3E;
+        p[2]  = (uint8_t)(11 + data_len + 1);
+        p[3]  = 0x02;
+        p[4]  = 1;
+        p[5]  = 0x03;
+        p[6]  = 0x01;
+        memcpy(&p[7], p_bd_addr, 6);
+        p[13] = data_len;
+        memcpy(&p[14], p_data, data_len);
+        p[14 + data_len] = (uint8_t)rssi;
+        return;
+    }
+
+    // Access address, header, advertiser address, data and CRC, after the RF info header if any
+    {
+        uint32_t phdr_len = p_gen->with_phdr ? 10 : 0;
+
+        p = record_start(p_gen, timestamp_us, phdr_len + 4 + 2 + 6 + data_len + 3, true, false);
+        if (p == NULL)
+        {
+            return;
+        }
+        if (p_gen->with_phdr)
+        {
+            memset(p, 0, 10);
+            p[0] = 0;                   // RF channel 37
+            p[1] = (uint8_t)rssi;       // Signal power
+            p[2] = 0x80;                // Noise power
+            le16_put(&p[8], 0x0003);    // Dewhitened, signal power valid
+            p += 10;
+        }
+        le32_put(&p[0], LL_ADV_ACCESS_ADDRESS);
+        p[4] = 0x42;                    // ADV_NONCONN_IND, random address
+        p[5] = (uint8_t)(6 + data_len);
+        memcpy(&p[6], p_bd_addr, 6);
+        memcpy(&p[12], p_data, data_len);
+        memset(&p[12 + data_len], 0x55, 3);
+    }
+}
+
+void capture_gen_att(capture_gen_t * p_gen, uint64_t timestamp_us, uint16_t conn_handle, bool received,
+                     uint8_t opcode, uint16_t attr_handle, uint8_t const * p_value, uint16_t value_len)
+{
+    uint16_t  att_len = (opcode == 0x1E) ? 1 : (uint16_t)(3 + value_len);
+    uint8_t * p = record_start(p_gen, timestamp_us, 1 + 4 + 4 + att_len, received, false);
+
+    if (p == NULL)
+    {
+        return;
+    }
+    p[0] = 0x02;
+    le16_put(&p[1], (uint16_t)(conn_handle | 0x2000));     // First automatically flushable packet
+    le16_put(&p[3], (uint16_t)(4 + att_len));
+    le16_put(&p[5], att_len);
+    le16_put(&p[7], 0x0004);
+    p[9] = opcode;
+    if (opcode != 0x1E)
+    {
+        le16_put(&p[10], attr_handle);
+        memcpy(&p[12], p_value, value_len);
+    }
+}
+
+void capture_gen_other(capture_gen_t * p_gen, uint64_t timestamp_us)
+{
+    uint8_t * p;
+
+    if (p_gen->btsnoop)
+    {
+        p = record_start(p_gen, timestamp_us, 7, true, true);
+        if (p != NULL)
+        {
+            static const uint8_t command_complete[7] = { 0x04, 0x0E, 4, 1, 0x0C, 0x20, 0x00 };
+
+            memcpy(p, command_complete, sizeof(command_complete));
+        }
+        return;
+    }
+
+    p = record_start(p_gen, timestamp_us, (p_gen->with_phdr ? 10 : 0) + 4 + 2 + 3, true, false);
+    if (p != NULL)
+    {
+        memset(p, 0, (p_gen->with_phdr ? 10 : 0) + 4 + 2 + 3);
+        if (p_gen->with_phdr)
+        {
+            p += 10;
+        }
+        le32_put(&p[0], 0x50654A3BUL);  // A data channel access address
+    }
+}
+
+void capture_gen_site_addr(uint32_t device, uint8_t * p_bd_addr)
+{
+    p_bd_addr[0] = (uint8_t)device;
+    p_bd_addr[1] = (uint8_t)(device >> 8);
+    p_bd_addr[2] = (uint8_t)(device >> 16);
+    p_bd_addr[3] = 0x33;
+    p_bd_addr[4] = 0x22;
+    p_bd_addr[5] = 0xC0;
+}
+
+int8_t capture_gen_site_rssi(uint32_t device, uint8_t channel)
+{
+    return (int8_t)(-40 - (int32_t)(device % 40) - 3 * channel);
+}
+
+uint32_t capture_gen_site(capture_gen_t * p_gen,
+                          uint64_t        timestamp_us,
+                          uint32_t        device_count,
+                          uint32_t        event_count,
+                          uint64_t        period_us)
+{
+    uint32_t readings = 0;
+    uint32_t event;
+    uint32_t device;
+
+    for (event = 0; event < event_count; event++)
+    {
+        for (device = 0; device < device_count; device++)
+        {
+            uint64_t event_us = timestamp_us + event * period_us + device * period_us / device_count;
+            uint8_t  service_ids[2] = { 1, 4 };     // Temperature and battery
+            uint16_t values[2] = { (uint16_t)((device * 7 + event) & 0xFFF), (uint16_t)(100 - (event % 100)) };
+            uint8_t  bd_addr[6];
+            uint8_t  data[31];
+            uint8_t  data_len;
+            uint8_t  channel;
+
+            capture_gen_site_addr(device, bd_addr);
+            data_len = capture_gen_linking_adv(data, (device & 1) == 0, 0x0A, device & 0xFFFFF, service_ids, values, 1 + (device & 1));
+            for (channel = 0; channel < 3; channel++)
+            {
+                capture_gen_adv(p_gen, event_us + channel * CAPTURE_GEN_SITE_CHANNEL_US, bd_addr, data, data_len,
+                                capture_gen_site_rssi(device, channel));
+            }
+
+            data_len = capture_gen_other_adv(data, device + event);
+            capture_gen_adv(p_gen, event_us + 3 * CAPTURE_GEN_SITE_CHANNEL_US, bd_addr, data, data_len, -90);
+            if ((device % 16) == 0)
+            {
+                capture_gen_other(p_gen, event_us + 3 * CAPTURE_GEN_SITE_CHANNEL_US);
+            }
+            readings += 1 + (device & 1);
+        }
+    }
+    return readings;
+}
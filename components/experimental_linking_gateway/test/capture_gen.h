@@ -0,0 +1,98 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+#ifndef CAPTURE_GEN_H__
+#define CAPTURE_GEN_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Writer of btsnoop (HCI H4) and pcap (BLE link layer) captures and advertising data, for the host tests
+ * and benchmarks. The captures are written to a buffer in the formats read by ble_pdlp_capture.
+ */
+
+#define CAPTURE_GEN_SITE_CHANNEL_US (200)     /* The time between the copies of a report on the advertising channels. */
+
+/**@brief Capture writer state. */
+typedef struct
+{
+    uint8_t * p_buf;                            /**< The capture. */
+    size_t    size;                             /**< The size of p_buf. */
+    size_t    len;                              /**< The length written, p_buf is full when a record does not fit. */
+    bool      btsnoop;                          /**< btsnoop, else pcap. */
+    bool      with_phdr;                        /**< pcap with LINKTYPE_BLUETOOTH_LE_LL_WITH_PHDR. */
+    bool      full;                             /**< A record did not fit and was left out. */
+} capture_gen_t;
+
+/**@brief Builds the advertising data of a Linking beacon, with the Linking UUID if with_uuid.
+ *
+ * @return The length of the data, at most 31.
+ */
+uint8_t capture_gen_linking_adv(uint8_t        * p_data,
+                                bool             with_uuid,
+                                uint8_t          vendor_id,
+                                uint32_t         class_id,
+                                uint8_t const  * p_service_ids,
+                                uint16_t const * p_values,
+                                uint8_t          count);
+
+/**@brief Builds the advertising data of another advertiser, varied by seed: flags with a name, or the
+ *        manufacturer specific data of another company.
+ *
+ * @return The length of the data.
+ */
+uint8_t capture_gen_other_adv(uint8_t * p_data, uint32_t seed);
+
+/**@brief Starts a btsnoop capture with H4 framing. */
+void capture_gen_btsnoop_start(capture_gen_t * p_gen, void * p_buf, size_t size);
+
+/**@brief Starts a pcap capture of the link layer, with the RF info header if with_phdr. */
+void capture_gen_pcap_start(capture_gen_t * p_gen, void * p_buf, size_t size, bool with_phdr);
+
+/**@brief Writes an advertising report: an HCI LE Advertising Report event to btsnoop, or an ADV_NONCONN_IND
+ *        PDU to pcap.
+ */
+void capture_gen_adv(capture_gen_t * p_gen, uint64_t timestamp_us, uint8_t const * p_bd_addr,
+                     uint8_t const * p_data, uint8_t data_len, int8_t rssi);
+
+/**@brief Writes an ATT PDU in an HCI ACL packet to btsnoop, received by the host if received. The handle and
+ *        value are left out of a confirmation.
+ */
+void capture_gen_att(capture_gen_t * p_gen, uint64_t timestamp_us, uint16_t conn_handle, bool received,
+                     uint8_t opcode, uint16_t attr_handle, uint8_t const * p_value, uint16_t value_len);
+
+/**@brief Writes an HCI Command Complete event to btsnoop, or a link layer data PDU to pcap. */
+void capture_gen_other(capture_gen_t * p_gen, uint64_t timestamp_us);
+
+/**@brief Returns the address of a beacon of capture_gen_site. */
+void capture_gen_site_addr(uint32_t device, uint8_t * p_bd_addr);
+
+/**@brief Returns the RSSI at which capture_gen_site receives a beacon on channel 0, 1 or 2. */
+int8_t capture_gen_site_rssi(uint32_t device, uint8_t channel);
+
+/**@brief Writes the advertising of a site of Linking beacons, for the pipeline tests and benchmarks.
+ *        In each of event_count events the beacons take turns over period_us, each received on the three
+ *        advertising channels CAPTURE_GEN_SITE_CHANNEL_US apart, followed by the report of another advertiser
+ *        at the same address and, for every 16th beacon, another record. The even beacons send a temperature
+ *        with the Linking UUID, the odd ones a temperature and a battery level without it. The temperature
+ *        changes at each event. period_us should leave the beacons 4 * CAPTURE_GEN_SITE_CHANNEL_US apart so
+ *        the timestamps do not go backwards.
+ *
+ * @return The number of readings, without the copies of the other channels.
+ */
+uint32_t capture_gen_site(capture_gen_t * p_gen,
+                          uint64_t        timestamp_us,
+                          uint32_t        device_count,
+                          uint32_t        event_count,
+                          uint64_t        period_us);
+
+#endif // CAPTURE_GEN_H__
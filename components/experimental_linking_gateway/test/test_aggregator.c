@@ -0,0 +1,183 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+// Checks the duplicate and out of date readings, the counters and the RSSI statistics of the aggregator, its
+// passing on of the new readings of a beacon, and the table filling up, with 100000 devices on three channels.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ble_pdlp_aggregator.h"
+#include "test.h"
+
+#define SLOT_COUNT  (1 << 18)
+#define WINDOW_US   (10000)
+
+static ble_pdlp_aggregator_t m_aggregator;
+
+static void device_addr(uint32_t device, uint8_t * p_bd_addr)
+{
+    p_bd_addr[0] = (uint8_t)device;
+    p_bd_addr[1] = (uint8_t)(device >> 8);
+    p_bd_addr[2] = (uint8_t)(device >> 16);
+    p_bd_addr[3] = 0x33;
+    p_bd_addr[4] = 0x22;
+    p_bd_addr[5] = 0xC0;
+}
+
+static void duplicate_test(void * p_slots)
+{
+    ble_pdlp_aggregator_entry_t const * p_entry;
+    uint8_t                             bd_addr[M_BD_ADDR_SIZE];
+
+    TEST_CHECK(!ble_pdlp_aggregator_init(&m_aggregator, p_slots, 3, WINDOW_US), "3 slots");
+    TEST_CHECK(ble_pdlp_aggregator_init(&m_aggregator, p_slots, SLOT_COUNT, WINDOW_US), "not initialized");
+    device_addr(1, bd_addr);
+
+    TEST_CHECK(ble_pdlp_aggregator_update(&m_aggregator, bd_addr, 1, 100, -50, 1000000), "first reading");
+    TEST_CHECK(!ble_pdlp_aggregator_update(&m_aggregator, bd_addr, 1, 100, -60, 1000300), "second channel");
+    TEST_CHECK(!ble_pdlp_aggregator_update(&m_aggregator, bd_addr, 1, 100, -40, 1000600), "third channel");
+    TEST_CHECK(!ble_pdlp_aggregator_update(&m_aggregator, bd_addr, 1, 100, BLE_PDLP_AGGREGATOR_RSSI_UNKNOWN, 999000), "late in the window");
+    TEST_CHECK(ble_pdlp_aggregator_update(&m_aggregator, bd_addr, 1, 101, -50, 1000900), "changed value");
+    TEST_CHECK(!ble_pdlp_aggregator_update(&m_aggregator, bd_addr, 1, 100, -50, 1000800), "out of date");
+    TEST_CHECK(ble_pdlp_aggregator_update(&m_aggregator, bd_addr, 1, 101, -50, 1200000), "same value in the next event");
+    TEST_CHECK(ble_pdlp_aggregator_update(&m_aggregator, bd_addr, 2, 7, -50, 1200000), "other service");
+
+    p_entry = ble_pdlp_aggregator_find(&m_aggregator, bd_addr, 1);
+    TEST_CHECK(p_entry != NULL, "not found");
+    if (p_entry != NULL)
+    {
+        TEST_CHECK((p_entry->packet_count == 7) && (p_entry->duplicate_count == 4) && (p_entry->value == 101),
+                   "packets %u, duplicates %u, value %u", p_entry->packet_count, p_entry->duplicate_count, p_entry->value);
+        TEST_CHECK((p_entry->first_seen_us == 1000000) && (p_entry->last_seen_us == 1200000) && (p_entry->accepted_us == 1200000),
+                   "first %llu, last %llu", (unsigned long long)p_entry->first_seen_us, (unsigned long long)p_entry->last_seen_us);
+        TEST_CHECK((p_entry->rssi_count == 6) && (p_entry->rssi_sum == -300) && (p_entry->rssi_min == -60) && (p_entry->rssi_max == -40),
+                   "RSSI count %u, sum %lld, min %d, max %d", p_entry->rssi_count, (long long)p_entry->rssi_sum, p_entry->rssi_min, p_entry->rssi_max);
+    }
+    TEST_CHECK((m_aggregator.entry_count == 2) && (m_aggregator.accept_count == 4) && (m_aggregator.update_count == 8),
+               "entries %u, accepted %llu, updates %llu", m_aggregator.entry_count, (unsigned long long)m_aggregator.accept_count,
+               (unsigned long long)m_aggregator.update_count);
+
+    device_addr(2, bd_addr);
+    TEST_CHECK(ble_pdlp_aggregator_find(&m_aggregator, bd_addr, 1) == NULL, "unknown device found");
+}
+
+// The RSSI range has no value before the first packet with an RSSI, even at the extremes of int8_t
+static void rssi_range_test(void * p_slots)
+{
+    ble_pdlp_aggregator_entry_t const * p_entry;
+    uint8_t                             bd_addr[M_BD_ADDR_SIZE];
+
+    ble_pdlp_aggregator_init(&m_aggregator, p_slots, SLOT_COUNT, WINDOW_US);
+    device_addr(3, bd_addr);
+
+    ble_pdlp_aggregator_update(&m_aggregator, bd_addr, 1, 10, BLE_PDLP_AGGREGATOR_RSSI_UNKNOWN, 1000000);
+    p_entry = ble_pdlp_aggregator_find(&m_aggregator, bd_addr, 1);
+    TEST_CHECK((p_entry != NULL) && (p_entry->rssi_count == 0), "entry");
+    if (p_entry == NULL)
+    {
+        return;
+    }
+    TEST_CHECK((p_entry->rssi_min == BLE_PDLP_AGGREGATOR_RSSI_UNKNOWN) && (p_entry->rssi_max == BLE_PDLP_AGGREGATOR_RSSI_UNKNOWN),
+               "min %d, max %d without an RSSI", p_entry->rssi_min, p_entry->rssi_max);
+
+    ble_pdlp_aggregator_update(&m_aggregator, bd_addr, 1, 10, INT8_MIN, 1000100);
+    TEST_CHECK((p_entry->rssi_count == 1) && (p_entry->rssi_min == INT8_MIN) && (p_entry->rssi_max == INT8_MIN),
+               "min %d, max %d after one RSSI", p_entry->rssi_min, p_entry->rssi_max);
+    ble_pdlp_aggregator_update(&m_aggregator, bd_addr, 1, 10, 20, 1000200);
+    TEST_CHECK((p_entry->rssi_count == 2) && (p_entry->rssi_min == INT8_MIN) && (p_entry->rssi_max == 20) && (p_entry->rssi_sum == -108),
+               "min %d, max %d, sum %lld", p_entry->rssi_min, p_entry->rssi_max, (long long)p_entry->rssi_sum);
+}
+
+static void beacon_test(void * p_slots)
+{
+    ble_pdlp_beacon_t beacon;
+    uint16_t          new_mask;
+
+    ble_pdlp_aggregator_init(&m_aggregator, p_slots, SLOT_COUNT, WINDOW_US);
+    memset(&beacon, 0, sizeof(beacon));
+    device_addr(4, beacon.bd_addr);
+    beacon.service_count  = 3;
+    beacon.service_ids[0] = 1;
+    beacon.service_ids[1] = 2;
+    beacon.service_ids[2] = 4;
+    beacon.values[0]      = 0x100;
+    beacon.values[1]      = 0x200;
+    beacon.values[2]      = 0x050;
+
+    TEST_CHECK((ble_pdlp_aggregator_update_beacon(&m_aggregator, &beacon, -70, 1000000, &new_mask) == 3) && (new_mask == 0x7),
+               "first beacon, mask %04X", new_mask);
+    TEST_CHECK((ble_pdlp_aggregator_update_beacon(&m_aggregator, &beacon, -71, 1000300, &new_mask) == 0) && (new_mask == 0),
+               "copy, mask %04X", new_mask);
+    beacon.values[1] = 0x201;
+    TEST_CHECK((ble_pdlp_aggregator_update_beacon(&m_aggregator, &beacon, -72, 1000600, &new_mask) == 1) && (new_mask == 0x2),
+               "humidity changed, mask %04X", new_mask);
+}
+
+// 100000 devices on three channels for five events fill 100000 entries, each passing on five readings
+static void site_test(void * p_slots)
+{
+    uint64_t accepted = 0;
+    uint32_t event;
+    uint32_t device;
+    uint8_t  channel;
+
+    ble_pdlp_aggregator_init(&m_aggregator, p_slots, SLOT_COUNT, WINDOW_US);
+    for (event = 0; event < 5; event++)
+    {
+        for (device = 0; device < 100000; device++)
+        {
+            uint8_t bd_addr[M_BD_ADDR_SIZE];
+
+            device_addr(device, bd_addr);
+            for (channel = 0; channel < 3; channel++)
+            {
+                accepted += ble_pdlp_aggregator_update(&m_aggregator, bd_addr, 4, (uint16_t)event, -70,
+                                                       (uint64_t)event * 1000000 + device * 5 + channel * 300);
+            }
+        }
+    }
+    TEST_CHECK((accepted == 500000) && (m_aggregator.entry_count == 100000) && (m_aggregator.full_count == 0),
+               "accepted %llu, entries %u, full %llu", (unsigned long long)accepted, m_aggregator.entry_count,
+               (unsigned long long)m_aggregator.full_count);
+}
+
+// A table of 16 slots takes 14 entries, the packets of other devices are dropped
+static void full_test(void * p_slots)
+{
+    uint32_t device;
+
+    ble_pdlp_aggregator_init(&m_aggregator, p_slots, 16, WINDOW_US);
+    for (device = 0; device < 20; device++)
+    {
+        uint8_t bd_addr[M_BD_ADDR_SIZE];
+
+        device_addr(device, bd_addr);
+        ble_pdlp_aggregator_update(&m_aggregator, bd_addr, 1, 0, 0, 0);
+    }
+    TEST_CHECK((m_aggregator.entry_count == 14) && (m_aggregator.full_count == 6), "entries %u, full %llu",
+               m_aggregator.entry_count, (unsigned long long)m_aggregator.full_count);
+}
+
+int main(void)
+{
+    void * p_slots = malloc(ble_pdlp_aggregator_memory_size(SLOT_COUNT));
+
+    duplicate_test(p_slots);
+    rssi_range_test(p_slots);
+    beacon_test(p_slots);
+    site_test(p_slots);
+    full_test(p_slots);
+    free(p_slots);
+
+    return test_result("test_aggregator");
+}
@@ -0,0 +1,176 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+// Feeds the analyzer with the ATT records of PDLP transactions and checks the finished transactions, their times
+// and the summary. The cancel cases check that a cancelled request ends with its cancel packet, takes the cancel
+// message of the device as its response and does not merge with the next request.
+
+#include <string.h>
+
+#include "ble_pdlp_analyzer.h"
+#include "test.h"
+
+#define WRITE_HANDLE    (0x0020)
+#define IND_HANDLE      (0x0022)
+
+static ble_pdlp_analyzer_t m_analyzer;
+
+// Phone packets: first of two, second and last, one packet request, cancel
+static const uint8_t m_write_first[] = { 0x00, 0x01, 0x02, 0x00, 0x01 };
+static const uint8_t m_write_last[]  = { 0x03, 0x09, 0x09 };
+static const uint8_t m_write_one[]   = { 0x01, 0x01, 0x02, 0x00 };
+static const uint8_t m_write_other[] = { 0x01, 0x02, 0x05, 0x00 };
+static const uint8_t m_write_cancel[] = { 0x41, 0x01, 0x02, 0x00 };
+
+// Device packets: first of two response packets, last, error message, cancel message
+static const uint8_t m_ind_first[]  = { 0x80, 0x01, 0x03, 0x00, 0x05 };
+static const uint8_t m_ind_last[]   = { 0x83, 0x01, 0x01 };
+static const uint8_t m_ind_error[]  = { 0x81, 0x01, 0x02, 0x00 };
+static const uint8_t m_ind_cancel[] = { 0xC1, 0x01, 0x02, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x05 };
+
+static bool feed(uint8_t opcode, uint16_t handle, uint64_t time_us, uint8_t const * p_value, uint16_t len)
+{
+    ble_pdlp_capture_record_t record;
+
+    memset(&record, 0, sizeof(record));
+    record.type                     = BLE_PDLP_CAPTURE_RECORD_ATT;
+    record.timestamp_us             = time_us;
+    record.params.att.opcode        = opcode;
+    record.params.att.attr_handle   = handle;
+    record.params.att.p_value       = p_value;
+    record.params.att.value_len     = len;
+    return ble_pdlp_analyzer_att_record(&m_analyzer, &record);
+}
+
+static bool write(uint64_t time_us, uint8_t const * p_value, uint16_t len)
+{
+    return feed(BLE_PDLP_ATT_OP_WRITE_REQ, WRITE_HANDLE, time_us, p_value, len);
+}
+
+static bool indicate(uint64_t time_us, uint8_t const * p_value, uint16_t len)
+{
+    return feed(BLE_PDLP_ATT_OP_INDICATE, IND_HANDLE, time_us, p_value, len);
+}
+
+static bool confirm(uint64_t time_us)
+{
+    return feed(BLE_PDLP_ATT_OP_CONFIRM, 0, time_us, NULL, 0);
+}
+
+static void transaction_test(void)
+{
+    ble_pdlp_transaction_t const * p_last = &m_analyzer.last;
+
+    ble_pdlp_analyzer_init(&m_analyzer, WRITE_HANDLE, IND_HANDLE);
+
+    // Two request and two response packets
+    TEST_CHECK(!write(1000, m_write_first, sizeof(m_write_first)) && !write(1500, m_write_last, sizeof(m_write_last)), "finished early");
+    TEST_CHECK(!indicate(4500, m_ind_first, sizeof(m_ind_first)) && !confirm(5000), "finished early");
+    TEST_CHECK(!indicate(5200, m_ind_last, sizeof(m_ind_last)), "finished early");
+    TEST_CHECK(confirm(6000), "not finished");
+    TEST_CHECK((p_last->service == 1) && (p_last->msgid == 2) && p_last->responded && !p_last->nack && !p_last->cancelled,
+               "service %u, message %u, responded %d, nack %d", p_last->service, p_last->msgid, p_last->responded, p_last->nack);
+    TEST_CHECK((p_last->request_packets == 2) && (p_last->response_packets == 2), "packets %u %u", p_last->request_packets, p_last->response_packets);
+    TEST_CHECK((p_last->think_us == 0) && (p_last->request_us == 500) && (p_last->firmware_us == 3000) && (p_last->confirm_us == 1500),
+               "times %u %u %u %u", p_last->think_us, p_last->request_us, p_last->firmware_us, p_last->confirm_us);
+
+    // An error message repeats the message ID of the request
+    TEST_CHECK(!write(10000, m_write_one, sizeof(m_write_one)) && !indicate(11000, m_ind_error, sizeof(m_ind_error)), "finished early");
+    TEST_CHECK(confirm(11500), "not finished");
+    TEST_CHECK(p_last->nack && (p_last->think_us == 4000) && (p_last->firmware_us == 1000), "nack %d, think %u", p_last->nack, p_last->think_us);
+
+    // Packets of other handles and from the wrong side are not PDLP
+    TEST_CHECK(!feed(BLE_PDLP_ATT_OP_WRITE_REQ, 0x0030, 12000, m_write_one, sizeof(m_write_one)), "other handle");
+    TEST_CHECK(!write(12000, m_ind_first, sizeof(m_ind_first)) && !indicate(12000, m_write_one, sizeof(m_write_one)), "wrong side");
+    TEST_CHECK(m_analyzer.state == BLE_PDLP_ANALYZER_STATE_IDLE, "state %d", m_analyzer.state);
+
+    // The next request finishes a request without a response, so does the end of the capture
+    TEST_CHECK(!write(20000, m_write_one, sizeof(m_write_one)), "finished early");
+    TEST_CHECK(write(30000, m_write_one, sizeof(m_write_one)), "not finished by the next request");
+    TEST_CHECK(!p_last->responded && (p_last->think_us == 8500), "responded %d, think %u", p_last->responded, p_last->think_us);
+    TEST_CHECK(ble_pdlp_analyzer_flush(&m_analyzer) && !p_last->responded, "not flushed");
+    TEST_CHECK(!ble_pdlp_analyzer_flush(&m_analyzer), "flushed twice");
+
+    TEST_CHECK((m_analyzer.summary_count == 1) && (m_analyzer.summary[0].count == 4), "summaries %u", m_analyzer.summary_count);
+    TEST_CHECK((m_analyzer.summary[0].nack_count == 1) && (m_analyzer.summary[0].unanswered_count == 2)
+            && (m_analyzer.summary[0].firmware_us_max == 3000) && (m_analyzer.summary[0].request_us_sum == 500),
+               "nack %u, unanswered %u", m_analyzer.summary[0].nack_count, m_analyzer.summary[0].unanswered_count);
+}
+
+static void cancel_test(void)
+{
+    ble_pdlp_transaction_t const * p_last = &m_analyzer.last;
+
+    ble_pdlp_analyzer_init(&m_analyzer, 0, 0);
+
+    // Cancelled while writing, the device answers with a cancel message
+    TEST_CHECK(!write(1000, m_write_first, sizeof(m_write_first)) && !write(2000, m_write_cancel, sizeof(m_write_cancel)), "finished early");
+    TEST_CHECK(m_analyzer.state == BLE_PDLP_ANALYZER_STATE_WAITING, "state %d", m_analyzer.state);
+    TEST_CHECK(!indicate(2500, m_ind_cancel, sizeof(m_ind_cancel)), "finished early");
+    TEST_CHECK(confirm(3000), "cancel message not taken as the response");
+    TEST_CHECK(p_last->cancelled && p_last->responded && p_last->nack, "cancelled %d, responded %d, nack %d",
+               p_last->cancelled, p_last->responded, p_last->nack);
+    TEST_CHECK((p_last->request_packets == 2) && (p_last->response_packets == 1) && (p_last->request_us == 1000) && (p_last->firmware_us == 500),
+               "packets %u %u, times %u %u", p_last->request_packets, p_last->response_packets, p_last->request_us, p_last->firmware_us);
+
+    // The next request is a transaction of its own
+    TEST_CHECK(!write(4000, m_write_other, sizeof(m_write_other)) && !indicate(4200, m_ind_last, sizeof(m_ind_last)), "finished early");
+    TEST_CHECK(confirm(4300), "not finished");
+    TEST_CHECK((p_last->service == 2) && (p_last->msgid == 5) && !p_last->cancelled && !p_last->nack && (p_last->request_packets == 1),
+               "service %u, message %u, cancelled %d, packets %u", p_last->service, p_last->msgid, p_last->cancelled, p_last->request_packets);
+    TEST_CHECK(p_last->think_us == 1000, "think %u", p_last->think_us);
+
+    // Cancelled while writing without an answer, the next request finishes it
+    TEST_CHECK(!write(5000, m_write_first, sizeof(m_write_first)) && !write(5100, m_write_cancel, sizeof(m_write_cancel)), "finished early");
+    TEST_CHECK(write(6000, m_write_other, sizeof(m_write_other)), "cancelled request merged with the next");
+    TEST_CHECK(p_last->cancelled && !p_last->responded && (p_last->msgid == 2) && (p_last->request_packets == 2),
+               "cancelled %d, responded %d, message %u", p_last->cancelled, p_last->responded, p_last->msgid);
+    TEST_CHECK(!indicate(6100, m_ind_last, sizeof(m_ind_last)) && confirm(6200), "not finished");
+    TEST_CHECK((p_last->msgid == 5) && !p_last->cancelled && (p_last->request_packets == 1), "message %u, packets %u",
+               p_last->msgid, p_last->request_packets);
+
+    // Cancelled while the response is indicated, the cancel message ends the response
+    TEST_CHECK(!write(7000, m_write_one, sizeof(m_write_one)) && !indicate(7500, m_ind_first, sizeof(m_ind_first)), "finished early");
+    TEST_CHECK(!confirm(7600) && !write(7700, m_write_cancel, sizeof(m_write_cancel)), "finished early");
+    TEST_CHECK(!indicate(7800, m_ind_cancel, sizeof(m_ind_cancel)) && confirm(7900), "not finished");
+    TEST_CHECK(p_last->cancelled && p_last->nack && (p_last->request_packets == 1) && (p_last->response_packets == 2) && (p_last->confirm_us == 400),
+               "cancelled %d, nack %d, packets %u %u", p_last->cancelled, p_last->nack, p_last->request_packets, p_last->response_packets);
+
+    // A cancel between transactions is ignored
+    TEST_CHECK(!write(8000, m_write_cancel, sizeof(m_write_cancel)) && (m_analyzer.state == BLE_PDLP_ANALYZER_STATE_IDLE), "state %d", m_analyzer.state);
+    TEST_CHECK(!ble_pdlp_analyzer_flush(&m_analyzer), "flushed");
+}
+
+static void summary_full_test(void)
+{
+    uint8_t  request[4] = { 0x01, 0x01, 0x00, 0x00 };
+    uint32_t i;
+
+    ble_pdlp_analyzer_init(&m_analyzer, 0, 0);
+    for (i = 0; i <= BLE_PDLP_ANALYZER_SUMMARY_MAX; i++)
+    {
+        request[2] = (uint8_t)i;
+        write(1000 * i, request, sizeof(request));
+    }
+    ble_pdlp_analyzer_flush(&m_analyzer);
+    TEST_CHECK((m_analyzer.summary_count == BLE_PDLP_ANALYZER_SUMMARY_MAX) && (m_analyzer.dropped_count == 1),
+               "summaries %u, dropped %u", m_analyzer.summary_count, m_analyzer.dropped_count);
+}
+
+int main(void)
+{
+    transaction_test();
+    cancel_test();
+    summary_full_test();
+
+    return test_result("test_analyzer");
+}
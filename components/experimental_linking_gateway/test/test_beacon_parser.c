@@ -0,0 +1,180 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+// Checks ble_pdlp_beacon_parse on beacons laid out as the beacon core sends them, on other advertisers and on
+// malformed advertising data, the batch parse on a mix of reports, and the 12-bit value decoders as inverses of
+// the conversions used by the firmware.
+
+#include <string.h>
+
+#include "ble_pdlp_beacon_parser.h"
+#include "ble_pdlp_common.h"
+#include "capture_gen.h"
+#include "test.h"
+
+// A single-service temperature beacon as sent by the beacon core: flags, the Linking UUID and the
+// manufacturer specific data with vendor 0xAB, class 0x12345 and 25.5 degrees Celsius
+static const uint8_t m_single[31] =
+{
+    0x02, 0x01, 0x04,
+    0x11, 0x07, 0xCD, 0xA6, 0x13, 0x5B, 0x83, 0x50, 0x8D, 0x80, 0x44, 0x40, 0xD3, 0x50, 0x01, 0x69, 0xB3, 0xB3,
+    0x09, 0xFF, 0xE2, 0x02, 0x0A, 0xB1, 0x23, 0x45, 0x15, 0xCC
+};
+
+static void single_test(void)
+{
+    ble_pdlp_beacon_t beacon;
+
+    memset(&beacon, 0, sizeof(beacon));
+    TEST_CHECK(ble_pdlp_beacon_parse(m_single, sizeof(m_single), &beacon), "not a beacon");
+    TEST_CHECK(beacon.has_uuid && (beacon.version == 0) && (beacon.vendor_id == 0xAB) && (beacon.class_id == 0x12345),
+               "UUID %d version %u vendor %02X class %05X", beacon.has_uuid, beacon.version, beacon.vendor_id, (unsigned int)beacon.class_id);
+    TEST_CHECK((beacon.service_count == 1) && (beacon.service_ids[0] == LINKING_SERVICE_TYPE_TEMPERATURE),
+               "%u services, ID %u", beacon.service_count, beacon.service_ids[0]);
+    TEST_CHECK(IEEE754_Decode_Temperature(beacon.values[0]) == 25.5f, "%g", IEEE754_Decode_Temperature(beacon.values[0]));
+}
+
+static void multi_test(void)
+{
+    static const uint8_t  service_ids[10] = { 1, 2, 3, 4, 5, 6, 7, 8, 15, 1 };
+    static const uint16_t values[10] = { 0x5CC, 0x622, 0x0F9, 0xBE8, 0x123, 0x805, 0x800, 0x000, 0xFFF, 0x001 };
+    ble_pdlp_beacon_t     beacon;
+    uint8_t               data[31];
+    uint8_t               len;
+    uint8_t               i;
+
+    // Ten entries fill the 31 bytes without the UUID
+    len = capture_gen_linking_adv(data, false, 0x01, 0xFFFFF, service_ids, values, 10);
+    TEST_CHECK(len == 31, "length %u", len);
+    TEST_CHECK(ble_pdlp_beacon_parse(data, len, &beacon), "not a beacon");
+    TEST_CHECK(!beacon.has_uuid && (beacon.vendor_id == 0x01) && (beacon.class_id == 0xFFFFF) && (beacon.service_count == 10),
+               "UUID %d vendor %02X class %05X, %u services", beacon.has_uuid, beacon.vendor_id, (unsigned int)beacon.class_id, beacon.service_count);
+    for (i = 0; (i < 10) && (i < beacon.service_count); i++)
+    {
+        TEST_CHECK((beacon.service_ids[i] == service_ids[i]) && (beacon.values[i] == values[i]),
+                   "entry %u: %u %03X", i, beacon.service_ids[i], beacon.values[i]);
+    }
+
+    // A beacon with no service data
+    len = capture_gen_linking_adv(data, true, 0x02, 0x1, NULL, NULL, 0);
+    TEST_CHECK(ble_pdlp_beacon_parse(data, len, &beacon) && beacon.has_uuid && (beacon.service_count == 0),
+               "%u services", beacon.service_count);
+}
+
+static void reject_test(void)
+{
+    ble_pdlp_beacon_t beacon;
+    uint8_t           data[31];
+    uint8_t           len;
+    uint32_t          seed;
+
+    for (seed = 0; seed < 8; seed++)
+    {
+        len = capture_gen_other_adv(data, seed);
+        TEST_CHECK(!ble_pdlp_beacon_parse(data, len, &beacon), "other advertiser %u", (unsigned int)seed);
+    }
+
+    // The manufacturer specific data runs past the end of the data
+    TEST_CHECK(!ble_pdlp_beacon_parse(m_single, sizeof(m_single) - 1, &beacon), "truncated");
+
+    // A zero length ends the AD structures before the manufacturer specific data
+    memcpy(data, m_single, sizeof(m_single));
+    data[3] = 0;
+    TEST_CHECK(!ble_pdlp_beacon_parse(data, sizeof(m_single), &beacon), "after a zero length");
+
+    // The manufacturer specific data is shorter than the Linking header
+    {
+        static const uint8_t short_header[9] = { 0x02, 0x01, 0x04, 0x05, 0xFF, 0xE2, 0x02, 0x0A, 0xB1 };
+
+        TEST_CHECK(!ble_pdlp_beacon_parse(short_header, sizeof(short_header), &beacon), "short header");
+    }
+
+    // Another UUID is not the Linking UUID
+    memcpy(data, m_single, sizeof(m_single));
+    data[5] ^= 0xFF;
+    TEST_CHECK(ble_pdlp_beacon_parse(data, sizeof(m_single), &beacon) && !beacon.has_uuid, "UUID %d", beacon.has_uuid);
+
+    TEST_CHECK(!ble_pdlp_beacon_parse(data, 0, &beacon), "empty");
+}
+
+static void batch_test(void)
+{
+    static const uint8_t  service_ids[3] = { 1, 2, 3 };
+    static const uint16_t values[3] = { 0x5CC, 0x622, 0x0F9 };
+    ble_pdlp_adv_report_t reports[6];
+    ble_pdlp_beacon_t     beacons[6];
+    uint32_t              count;
+    uint32_t              i;
+
+    memset(reports, 0, sizeof(reports));
+    for (i = 0; i < 6; i++)
+    {
+        memset(reports[i].bd_addr, (int)(0x10 + i), M_BD_ADDR_SIZE);
+    }
+    memcpy(reports[0].data, m_single, sizeof(m_single));
+    reports[0].data_len = sizeof(m_single);
+    reports[1].data_len = capture_gen_other_adv(reports[1].data, 1);
+    reports[2].data_len = 3;                                                    // Too short, skipped
+    reports[3].data_len = capture_gen_linking_adv(reports[3].data, false, 0x0A, 0x2, service_ids, values, 3);
+    reports[4].data_len = capture_gen_other_adv(reports[4].data, 2);
+    reports[5].data_len = capture_gen_linking_adv(reports[5].data, true, 0x0B, 0x3, service_ids, values, 1);
+
+    count = ble_pdlp_beacon_parse_batch(reports, 6, beacons);
+    TEST_CHECK(count == 3, "%u beacons", (unsigned int)count);
+    TEST_CHECK((beacons[0].report_index == 0) && (beacons[1].report_index == 3) && (beacons[2].report_index == 5),
+               "reports %u %u %u", (unsigned int)beacons[0].report_index, (unsigned int)beacons[1].report_index, (unsigned int)beacons[2].report_index);
+    TEST_CHECK((beacons[1].bd_addr[0] == 0x13) && (beacons[1].bd_addr[5] == 0x13) && (beacons[1].vendor_id == 0x0A) && (beacons[1].service_count == 3),
+               "address %02X vendor %02X, %u services", beacons[1].bd_addr[0], beacons[1].vendor_id, beacons[1].service_count);
+    TEST_CHECK(beacons[2].has_uuid && (beacons[2].class_id == 0x3) && (beacons[2].service_count == 1), "class %05X", (unsigned int)beacons[2].class_id);
+}
+
+// Every normalized 12-bit code decodes to a float that converts back to the same code
+static void decode_test(void)
+{
+    uint16_t value;
+
+    for (value = 0; value < 0x1000; value++)
+    {
+        uint16_t t_exponent = (value >> 7) & 0xF;
+        uint16_t h_exponent = (value >> 8) & 0xF;
+        uint16_t p_exponent = (value >> 7) & 0x1F;
+
+        if ((t_exponent != 0) && (t_exponent != 0xF))
+        {
+            TEST_CHECK(IEEE754_Convert_Temperature(IEEE754_Decode_Temperature(value)) == value, "temperature %03X", value);
+        }
+        if ((h_exponent != 0) && (h_exponent != 0xF))
+        {
+            TEST_CHECK(IEEE754_Convert_Humidity(IEEE754_Decode_Humidity(value)) == value, "humidity %03X", value);
+        }
+        if ((p_exponent != 0) && (p_exponent != 0x1F))
+        {
+            TEST_CHECK(IEEE754_Convert_Air_Pressure(IEEE754_Decode_Air_Pressure(value)) == value, "air pressure %03X", value);
+        }
+    }
+
+    TEST_CHECK(IEEE754_Decode_Temperature(IEEE754_Convert_Temperature(-12.25f)) == -12.25f, "negative temperature");
+    TEST_CHECK(IEEE754_Decode_Temperature(IEEE754_Convert_Temperature(0.0f)) == 0.0f, "zero temperature");
+    TEST_CHECK(IEEE754_Decode_Humidity(IEEE754_Convert_Humidity(45.0f)) == 45.0f, "humidity");
+    TEST_CHECK(IEEE754_Decode_Air_Pressure(IEEE754_Convert_Air_Pressure(1012.0f)) == 1012.0f, "air pressure");
+}
+
+int main(void)
+{
+    single_test();
+    multi_test();
+    reject_test();
+    batch_test();
+    decode_test();
+
+    return test_result("test_beacon_parser");
+}
@@ -0,0 +1,226 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+// Reads btsnoop and pcap captures written by capture_gen and checks every record: the timestamps, the
+// advertising reports with their RSSI, the ATT PDUs of writes, indications and confirmations, the other records,
+// and the end of the capture at a truncated record. Also checks the byte-swapped and nanosecond pcap variants and
+// the unencapsulated HCI framing of btsnoop.
+
+#include <string.h>
+
+#include "ble_pdlp_capture.h"
+#include "capture_gen.h"
+#include "test.h"
+
+#define BASE_US     (1600000000000000ULL)
+
+static uint8_t m_buf[4096];
+
+static const uint8_t m_addr[6]  = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 };
+static const uint8_t m_adv[11]  = { 0x02, 0x01, 0x04, 0x07, 0xFF, 0xE2, 0x02, 0x0A, 0xB1, 0x23, 0x45 };
+static const uint8_t m_value[5] = { 0x00, 0x01, 0x02, 0x00, 0x01 };
+
+static void adv_check(ble_pdlp_capture_record_t const * p_record, uint64_t timestamp_us, int8_t rssi)
+{
+    TEST_CHECK(p_record->type == BLE_PDLP_CAPTURE_RECORD_ADV, "type %d", p_record->type);
+    TEST_CHECK(p_record->timestamp_us == timestamp_us, "timestamp %llu", (unsigned long long)p_record->timestamp_us);
+    if (p_record->type == BLE_PDLP_CAPTURE_RECORD_ADV)
+    {
+        TEST_CHECK(memcmp(p_record->params.adv.p_bd_addr, m_addr, sizeof(m_addr)) == 0, "address %02X", p_record->params.adv.p_bd_addr[0]);
+        TEST_CHECK((p_record->params.adv.data_len == sizeof(m_adv)) && (memcmp(p_record->params.adv.p_data, m_adv, sizeof(m_adv)) == 0),
+                   "data length %u", p_record->params.adv.data_len);
+        TEST_CHECK(p_record->params.adv.rssi == rssi, "RSSI %d, expected %d", p_record->params.adv.rssi, rssi);
+    }
+}
+
+static void btsnoop_test(void)
+{
+    capture_gen_t             gen;
+    ble_pdlp_capture_t        capture;
+    ble_pdlp_capture_record_t record;
+
+    capture_gen_btsnoop_start(&gen, m_buf, sizeof(m_buf));
+    capture_gen_adv(&gen, BASE_US + 1, m_addr, m_adv, sizeof(m_adv), -67);
+    capture_gen_att(&gen, BASE_US + 2, 0x41, true, BLE_PDLP_ATT_OP_WRITE_REQ, 0x0020, m_value, sizeof(m_value));
+    capture_gen_att(&gen, BASE_US + 3, 0x41, false, BLE_PDLP_ATT_OP_INDICATE, 0x0022, m_value, 3);
+    capture_gen_att(&gen, BASE_US + 4, 0x41, true, BLE_PDLP_ATT_OP_CONFIRM, 0, NULL, 0);
+    capture_gen_other(&gen, BASE_US + 5);
+    capture_gen_adv(&gen, BASE_US + 6, m_addr, m_adv, sizeof(m_adv), 5);
+    TEST_CHECK(!gen.full, "capture full");
+
+    TEST_CHECK(ble_pdlp_capture_open(&capture, m_buf, gen.len), "not opened");
+    TEST_CHECK(capture.format == BLE_PDLP_CAPTURE_FORMAT_BTSNOOP, "format %d", capture.format);
+
+    TEST_CHECK(ble_pdlp_capture_next(&capture, &record), "advertising report");
+    adv_check(&record, BASE_US + 1, -67);
+
+    TEST_CHECK(ble_pdlp_capture_next(&capture, &record), "write");
+    TEST_CHECK((record.type == BLE_PDLP_CAPTURE_RECORD_ATT) && (record.timestamp_us == BASE_US + 2), "type %d", record.type);
+    TEST_CHECK((record.params.att.conn_handle == 0x41) && record.params.att.received && (record.params.att.opcode == BLE_PDLP_ATT_OP_WRITE_REQ),
+               "connection %04X, received %d, opcode %02X", record.params.att.conn_handle, record.params.att.received, record.params.att.opcode);
+    TEST_CHECK((record.params.att.attr_handle == 0x0020) && (record.params.att.value_len == sizeof(m_value))
+            && (memcmp(record.params.att.p_value, m_value, sizeof(m_value)) == 0),
+               "handle %04X, length %u", record.params.att.attr_handle, record.params.att.value_len);
+
+    TEST_CHECK(ble_pdlp_capture_next(&capture, &record), "indication");
+    TEST_CHECK((record.type == BLE_PDLP_CAPTURE_RECORD_ATT) && !record.params.att.received && (record.params.att.opcode == BLE_PDLP_ATT_OP_INDICATE)
+            && (record.params.att.attr_handle == 0x0022) && (record.params.att.value_len == 3),
+               "received %d, opcode %02X, length %u", record.params.att.received, record.params.att.opcode, record.params.att.value_len);
+
+    TEST_CHECK(ble_pdlp_capture_next(&capture, &record), "confirmation");
+    TEST_CHECK((record.type == BLE_PDLP_CAPTURE_RECORD_ATT) && (record.params.att.opcode == BLE_PDLP_ATT_OP_CONFIRM)
+            && (record.params.att.value_len == 0), "opcode %02X", record.params.att.opcode);
+
+    TEST_CHECK(ble_pdlp_capture_next(&capture, &record), "other");
+    TEST_CHECK((record.type == BLE_PDLP_CAPTURE_RECORD_OTHER) && (record.timestamp_us == BASE_US + 5), "type %d", record.type);
+
+    TEST_CHECK(ble_pdlp_capture_next(&capture, &record), "advertising report");
+    adv_check(&record, BASE_US + 6, 5);
+
+    TEST_CHECK(!ble_pdlp_capture_next(&capture, &record), "past the end");
+
+    // A record cut short ends the capture
+    TEST_CHECK(ble_pdlp_capture_open(&capture, m_buf, gen.len - 1), "not opened");
+    while (ble_pdlp_capture_next(&capture, &record))
+    {
+        TEST_CHECK(record.timestamp_us < BASE_US + 6, "truncated record read");
+    }
+}
+
+// An advertising report of a controller that leaves out the RSSI, in an unencapsulated HCI btsnoop
+static void btsnoop_hci_test(void)
+{
+    static const uint8_t header[16] = { 'b', 't', 's', 'n', 'o', 'o', 'p', 0, 0, 0, 0, 1, 0, 0, 0x03, 0xE9 };
+    ble_pdlp_capture_t        capture;
+    ble_pdlp_capture_record_t record;
+    capture_gen_t             gen;
+    uint8_t                   event[64];
+    uint8_t                   event_len;
+
+    // Take the event of a generated H4 capture, without its H4 type and RSSI
+    capture_gen_btsnoop_start(&gen, m_buf, sizeof(m_buf));
+    capture_gen_adv(&gen, BASE_US, m_addr, m_adv, sizeof(m_adv), -40);
+    event_len = (uint8_t)(gen.len - 16 - 24 - 1 - 1);
+    memcpy(event, &m_buf[16 + 24 + 1], event_len);
+    event[1]--;
+
+    memcpy(m_buf, header, sizeof(header));
+    m_buf[16 + 3]  = event_len;
+    m_buf[16 + 7]  = event_len;
+    m_buf[16 + 11] = 0x03;
+    memcpy(&m_buf[16 + 24], event, event_len);
+
+    TEST_CHECK(ble_pdlp_capture_open(&capture, m_buf, 16 + 24 + event_len) && !capture.h4, "not opened");
+    TEST_CHECK(ble_pdlp_capture_next(&capture, &record), "advertising report");
+    adv_check(&record, BASE_US, BLE_PDLP_CAPTURE_RSSI_UNKNOWN);
+}
+
+static void pcap_test(bool with_phdr)
+{
+    capture_gen_t             gen;
+    ble_pdlp_capture_t        capture;
+    ble_pdlp_capture_record_t record;
+    int8_t                    rssi = with_phdr ? -81 : BLE_PDLP_CAPTURE_RSSI_UNKNOWN;
+
+    capture_gen_pcap_start(&gen, m_buf, sizeof(m_buf), with_phdr);
+    capture_gen_adv(&gen, BASE_US + 10, m_addr, m_adv, sizeof(m_adv), -81);
+    capture_gen_other(&gen, BASE_US + 20);
+    capture_gen_adv(&gen, BASE_US + 1000030, m_addr, m_adv, sizeof(m_adv), -81);
+    TEST_CHECK(!gen.full, "capture full");
+
+    TEST_CHECK(ble_pdlp_capture_open(&capture, m_buf, gen.len), "not opened");
+    TEST_CHECK(capture.format == (with_phdr ? BLE_PDLP_CAPTURE_FORMAT_PCAP_BLE_LL_WITH_PHDR : BLE_PDLP_CAPTURE_FORMAT_PCAP_BLE_LL),
+               "format %d", capture.format);
+    TEST_CHECK(ble_pdlp_capture_next(&capture, &record), "advertising PDU");
+    adv_check(&record, BASE_US + 10, rssi);
+    TEST_CHECK(ble_pdlp_capture_next(&capture, &record) && (record.type == BLE_PDLP_CAPTURE_RECORD_OTHER), "data PDU %d", record.type);
+    TEST_CHECK(ble_pdlp_capture_next(&capture, &record), "advertising PDU");
+    adv_check(&record, BASE_US + 1000030, rssi);
+    TEST_CHECK(!ble_pdlp_capture_next(&capture, &record), "past the end");
+
+    if (with_phdr)
+    {
+        // Without the signal power valid flag, the signal power byte is not an RSSI
+        m_buf[24 + 16 + 8] &= (uint8_t)~0x02;
+        TEST_CHECK(ble_pdlp_capture_open(&capture, m_buf, gen.len) && ble_pdlp_capture_next(&capture, &record), "advertising PDU");
+        adv_check(&record, BASE_US + 10, BLE_PDLP_CAPTURE_RSSI_UNKNOWN);
+    }
+}
+
+// A big-endian writer and nanosecond timestamps
+static void pcap_variant_test(void)
+{
+    capture_gen_t             gen;
+    ble_pdlp_capture_t        capture;
+    ble_pdlp_capture_record_t record;
+    uint32_t                  i;
+
+    capture_gen_pcap_start(&gen, m_buf, sizeof(m_buf), false);
+    capture_gen_adv(&gen, BASE_US + 123456, m_addr, m_adv, sizeof(m_adv), 0);
+
+    // Nanosecond magic, the fraction written as microseconds reads as a thousandth
+    m_buf[0] = 0x4D;
+    m_buf[1] = 0x3C;
+    TEST_CHECK(ble_pdlp_capture_open(&capture, m_buf, gen.len) && capture.nanoseconds && !capture.swapped, "not opened");
+    TEST_CHECK(ble_pdlp_capture_next(&capture, &record), "advertising PDU");
+    adv_check(&record, BASE_US + 123, BLE_PDLP_CAPTURE_RSSI_UNKNOWN);
+
+    // Swap the byte order of the header fields
+    capture_gen_pcap_start(&gen, m_buf, sizeof(m_buf), false);
+    capture_gen_adv(&gen, BASE_US + 123456, m_addr, m_adv, sizeof(m_adv), 0);
+    for (i = 0; i < 24 + 16; i += 4)
+    {
+        uint8_t swap[4] = { m_buf[i + 3], m_buf[i + 2], m_buf[i + 1], m_buf[i] };
+
+        if ((i == 4) || (i == 20 + 4 + 20))
+        {
+            continue;
+        }
+        memcpy(&m_buf[i], swap, sizeof(swap));
+    }
+    m_buf[4] = 0; m_buf[5] = 2; m_buf[6] = 0; m_buf[7] = 4;
+    TEST_CHECK(ble_pdlp_capture_open(&capture, m_buf, gen.len) && capture.swapped, "not opened");
+    TEST_CHECK(ble_pdlp_capture_next(&capture, &record), "advertising PDU");
+    adv_check(&record, BASE_US + 123456, BLE_PDLP_CAPTURE_RSSI_UNKNOWN);
+}
+
+static void unsupported_test(void)
+{
+    ble_pdlp_capture_t capture;
+    capture_gen_t      gen;
+
+    memset(m_buf, 0, sizeof(m_buf));
+    TEST_CHECK(!ble_pdlp_capture_open(&capture, m_buf, 64), "zeros");
+    TEST_CHECK(!ble_pdlp_capture_open(&capture, m_buf, 8), "short");
+
+    // A btsnoop of another datalink
+    capture_gen_btsnoop_start(&gen, m_buf, sizeof(m_buf));
+    m_buf[15] = 0xEB;
+    TEST_CHECK(!ble_pdlp_capture_open(&capture, m_buf, gen.len), "datalink 1003");
+
+    // A pcap of another linktype
+    capture_gen_pcap_start(&gen, m_buf, sizeof(m_buf), false);
+    m_buf[20] = 1;
+    TEST_CHECK(!ble_pdlp_capture_open(&capture, m_buf, gen.len), "ethernet");
+}
+
+int main(void)
+{
+    btsnoop_test();
+    btsnoop_hci_test();
+    pcap_test(false);
+    pcap_test(true);
+    pcap_variant_test();
+    unsupported_test();
+
+    return test_result("test_capture");
+}
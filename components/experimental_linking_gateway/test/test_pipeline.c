@@ -0,0 +1,288 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+// Runs the capture, decode, aggregate and store stages over generated captures of a site and checks the counters of
+// each stage, the readings in the store and the RSSI statistics of the aggregator. The stages run in turn in one
+// thread with small rings, with each output ring filling up, and in a thread each.
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "ble_pdlp_pipeline.h"
+#include "capture_gen.h"
+#include "test.h"
+
+#define DEVICE_COUNT    (40)
+#define EVENT_COUNT     (25)
+#define PERIOD_US       (1000000ULL)
+#define BASE_US         (1600000000000000ULL)
+#define READING_COUNT   (EVENT_COUNT * (DEVICE_COUNT / 2) * 3)
+#define SLOT_COUNT      (256)
+#define RING_SIZE       (16)
+#define NEW_RING_SIZE   (4)
+
+typedef struct
+{
+    ble_pdlp_capture_t         capture;
+    ble_pdlp_ring_t            reports;
+    ble_pdlp_ring_t            beacons;
+    ble_pdlp_ring_t            news;
+    ble_pdlp_pipeline_report_t report_buf[RING_SIZE];
+    ble_pdlp_pipeline_beacon_t beacon_buf[RING_SIZE];
+    ble_pdlp_pipeline_beacon_t new_buf[NEW_RING_SIZE];
+    ble_pdlp_pipeline_stage_t  capture_stage;
+    ble_pdlp_pipeline_stage_t  decode_stage;
+    ble_pdlp_pipeline_stage_t  aggregate_stage;
+    ble_pdlp_pipeline_stage_t  store_stage;
+    ble_pdlp_aggregator_t      aggregator;
+    ble_pdlp_store_t           store;
+    uint8_t                    slots[SLOT_COUNT * sizeof(ble_pdlp_aggregator_entry_t)];
+    void                     * p_segment;
+} pipeline_t;
+
+static uint8_t m_capture[1 << 20];
+
+static size_t capture_make(bool btsnoop, bool with_phdr)
+{
+    capture_gen_t gen;
+
+    if (btsnoop)
+    {
+        capture_gen_btsnoop_start(&gen, m_capture, sizeof(m_capture));
+    }
+    else
+    {
+        capture_gen_pcap_start(&gen, m_capture, sizeof(m_capture), with_phdr);
+    }
+    TEST_CHECK(capture_gen_site(&gen, BASE_US, DEVICE_COUNT, EVENT_COUNT, PERIOD_US) == READING_COUNT, "readings");
+    TEST_CHECK(!gen.full, "capture full");
+    return gen.len;
+}
+
+static pipeline_t * pipeline_create(size_t capture_len, ble_pdlp_pipeline_backpressure_t aggregate_backpressure)
+{
+    pipeline_t * p_pipeline = calloc(1, sizeof(pipeline_t));
+    uint32_t     segment_len = ble_pdlp_store_segment_len(DEVICE_COUNT, 2);
+
+    p_pipeline->p_segment = malloc(segment_len);
+    TEST_CHECK(ble_pdlp_capture_open(&p_pipeline->capture, m_capture, capture_len), "capture not opened");
+    TEST_CHECK(ble_pdlp_ring_init(&p_pipeline->reports, p_pipeline->report_buf, sizeof(ble_pdlp_pipeline_report_t), RING_SIZE)
+            && ble_pdlp_ring_init(&p_pipeline->beacons, p_pipeline->beacon_buf, sizeof(ble_pdlp_pipeline_beacon_t), RING_SIZE)
+            && ble_pdlp_ring_init(&p_pipeline->news, p_pipeline->new_buf, sizeof(ble_pdlp_pipeline_beacon_t), NEW_RING_SIZE),
+               "rings");
+    TEST_CHECK(ble_pdlp_aggregator_init(&p_pipeline->aggregator, p_pipeline->slots, SLOT_COUNT, 10000), "aggregator");
+    TEST_CHECK(ble_pdlp_store_create(&p_pipeline->store, p_pipeline->p_segment, segment_len, DEVICE_COUNT), "store");
+
+    ble_pdlp_pipeline_stage_init(&p_pipeline->capture_stage, BLE_PDLP_PIPELINE_BACKPRESSURE_WAIT, 12);
+    ble_pdlp_pipeline_stage_init(&p_pipeline->decode_stage, BLE_PDLP_PIPELINE_BACKPRESSURE_WAIT, 8);
+    ble_pdlp_pipeline_stage_init(&p_pipeline->aggregate_stage, aggregate_backpressure, 16);
+    ble_pdlp_pipeline_stage_init(&p_pipeline->store_stage, BLE_PDLP_PIPELINE_BACKPRESSURE_WAIT, 3);
+    return p_pipeline;
+}
+
+static void pipeline_free(pipeline_t * p_pipeline)
+{
+    free(p_pipeline->p_segment);
+    free(p_pipeline);
+}
+
+// Runs the stages in turn, the store stage only every store_period turns so that the rings before it fill up
+static void pipeline_run(pipeline_t * p_pipeline, uint32_t store_period)
+{
+    uint32_t turn = 0;
+
+    while (!ble_pdlp_ring_is_drained(&p_pipeline->news))
+    {
+        ble_pdlp_pipeline_capture_step(&p_pipeline->capture_stage, &p_pipeline->capture, &p_pipeline->reports);
+        ble_pdlp_pipeline_decode_step(&p_pipeline->decode_stage, &p_pipeline->reports, &p_pipeline->beacons);
+        ble_pdlp_pipeline_aggregate_step(&p_pipeline->aggregate_stage, &p_pipeline->beacons, &p_pipeline->aggregator, &p_pipeline->news);
+        if ((++turn % store_period) == 0)
+        {
+            ble_pdlp_pipeline_store_step(&p_pipeline->store_stage, &p_pipeline->news, &p_pipeline->store);
+        }
+    }
+}
+
+static void * capture_thread(void * p_context)
+{
+    pipeline_t * p_pipeline = p_context;
+
+    while (!p_pipeline->reports.closed)
+    {
+        if (ble_pdlp_pipeline_capture_step(&p_pipeline->capture_stage, &p_pipeline->capture, &p_pipeline->reports) == 0)
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void * decode_thread(void * p_context)
+{
+    pipeline_t * p_pipeline = p_context;
+
+    while (!ble_pdlp_ring_is_drained(&p_pipeline->reports))
+    {
+        if (ble_pdlp_pipeline_decode_step(&p_pipeline->decode_stage, &p_pipeline->reports, &p_pipeline->beacons) == 0)
+        {
+            sched_yield();
+        }
+    }
+    ble_pdlp_pipeline_decode_step(&p_pipeline->decode_stage, &p_pipeline->reports, &p_pipeline->beacons);
+    return NULL;
+}
+
+static void * aggregate_thread(void * p_context)
+{
+    pipeline_t * p_pipeline = p_context;
+
+    while (!ble_pdlp_ring_is_drained(&p_pipeline->beacons))
+    {
+        if (ble_pdlp_pipeline_aggregate_step(&p_pipeline->aggregate_stage, &p_pipeline->beacons, &p_pipeline->aggregator, &p_pipeline->news) == 0)
+        {
+            sched_yield();
+        }
+    }
+    ble_pdlp_pipeline_aggregate_step(&p_pipeline->aggregate_stage, &p_pipeline->beacons, &p_pipeline->aggregator, &p_pipeline->news);
+    return NULL;
+}
+
+static void * store_thread(void * p_context)
+{
+    pipeline_t * p_pipeline = p_context;
+
+    while (!ble_pdlp_ring_is_drained(&p_pipeline->news))
+    {
+        if (ble_pdlp_pipeline_store_step(&p_pipeline->store_stage, &p_pipeline->news, &p_pipeline->store) == 0)
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+// Checks the stages and the store after a lossless run
+static void lossless_check(pipeline_t const * p_pipeline, bool with_rssi)
+{
+    uint32_t device;
+
+    TEST_CHECK(p_pipeline->capture_stage.out_count == DEVICE_COUNT * EVENT_COUNT * 4, "reports %llu",
+               (unsigned long long)p_pipeline->capture_stage.out_count);
+    TEST_CHECK((p_pipeline->decode_stage.out_count == DEVICE_COUNT * EVENT_COUNT * 3) && (p_pipeline->decode_stage.drop_count == 0),
+               "beacons %llu", (unsigned long long)p_pipeline->decode_stage.out_count);
+    TEST_CHECK((p_pipeline->aggregate_stage.in_count == DEVICE_COUNT * EVENT_COUNT * 3)
+            && (p_pipeline->aggregate_stage.out_count == DEVICE_COUNT * EVENT_COUNT) && (p_pipeline->aggregate_stage.drop_count == 0),
+               "aggregate in %llu, out %llu", (unsigned long long)p_pipeline->aggregate_stage.in_count,
+               (unsigned long long)p_pipeline->aggregate_stage.out_count);
+    TEST_CHECK(p_pipeline->aggregator.accept_count == READING_COUNT, "accepted %llu", (unsigned long long)p_pipeline->aggregator.accept_count);
+    TEST_CHECK((p_pipeline->store_stage.out_count == READING_COUNT) && (p_pipeline->store_stage.drop_count == 0),
+               "stored %llu", (unsigned long long)p_pipeline->store_stage.out_count);
+
+    for (device = 0; device < DEVICE_COUNT; device++)
+    {
+        ble_pdlp_aggregator_entry_t const * p_entry;
+        ble_pdlp_store_result_t             result;
+        uint8_t                             bd_addr[M_BD_ADDR_SIZE];
+
+        capture_gen_site_addr(device, bd_addr);
+        TEST_CHECK(ble_pdlp_store_query(&p_pipeline->store, bd_addr, LINKING_SERVICE_TYPE_TEMPERATURE, 0, UINT64_MAX, &result)
+                && (result.count == EVENT_COUNT), "device %u: %u temperatures", device, result.count);
+        ble_pdlp_store_query(&p_pipeline->store, bd_addr, LINKING_SERVICE_TYPE_BATTERY, 0, UINT64_MAX, &result);
+        TEST_CHECK(result.count == ((device & 1) ? EVENT_COUNT : 0), "device %u: %u battery levels", device, result.count);
+
+        p_entry = ble_pdlp_aggregator_find(&p_pipeline->aggregator, bd_addr, LINKING_SERVICE_TYPE_TEMPERATURE);
+        TEST_CHECK(p_entry != NULL, "device %u not aggregated", device);
+        if (p_entry == NULL)
+        {
+            continue;
+        }
+        TEST_CHECK((p_entry->packet_count == EVENT_COUNT * 3) && (p_entry->duplicate_count == EVENT_COUNT * 2),
+                   "device %u: %u packets, %u duplicates", device, p_entry->packet_count, p_entry->duplicate_count);
+        if (with_rssi)
+        {
+            TEST_CHECK((p_entry->rssi_count == EVENT_COUNT * 3)
+                    && (p_entry->rssi_min == capture_gen_site_rssi(device, 2)) && (p_entry->rssi_max == capture_gen_site_rssi(device, 0))
+                    && (p_entry->rssi_sum == (int64_t)EVENT_COUNT * (capture_gen_site_rssi(device, 0) + capture_gen_site_rssi(device, 1)
+                                                                      + capture_gen_site_rssi(device, 2))),
+                       "device %u: RSSI count %u, min %d, max %d", device, p_entry->rssi_count, p_entry->rssi_min, p_entry->rssi_max);
+        }
+        else
+        {
+            TEST_CHECK(p_entry->rssi_count == 0, "device %u: RSSI count %u", device, p_entry->rssi_count);
+        }
+    }
+}
+
+static void turns_test(void)
+{
+    static const struct
+    {
+        bool btsnoop;
+        bool with_phdr;
+    } formats[] = { { true, false }, { false, false }, { false, true } };
+    uint32_t i;
+
+    for (i = 0; i < sizeof(formats) / sizeof(formats[0]); i++)
+    {
+        pipeline_t * p_pipeline = pipeline_create(capture_make(formats[i].btsnoop, formats[i].with_phdr), BLE_PDLP_PIPELINE_BACKPRESSURE_WAIT);
+
+        // The store stage falls behind, so every ring fills up and the stages before it wait
+        pipeline_run(p_pipeline, 3);
+        lossless_check(p_pipeline, formats[i].btsnoop || formats[i].with_phdr);
+        TEST_CHECK(p_pipeline->aggregate_stage.depth_max == RING_SIZE, "beacon ring depth %u", p_pipeline->aggregate_stage.depth_max);
+        pipeline_free(p_pipeline);
+    }
+}
+
+static void drop_test(void)
+{
+    pipeline_t * p_pipeline = pipeline_create(capture_make(true, false), BLE_PDLP_PIPELINE_BACKPRESSURE_DROP);
+    uint64_t     news;
+
+    pipeline_run(p_pipeline, 4);
+    news = p_pipeline->aggregate_stage.out_count + p_pipeline->aggregate_stage.drop_count;
+    TEST_CHECK((news == DEVICE_COUNT * EVENT_COUNT) && (p_pipeline->aggregate_stage.drop_count != 0),
+               "aggregate out %llu, dropped %llu", (unsigned long long)p_pipeline->aggregate_stage.out_count,
+               (unsigned long long)p_pipeline->aggregate_stage.drop_count);
+    TEST_CHECK(p_pipeline->aggregator.accept_count == READING_COUNT, "accepted %llu", (unsigned long long)p_pipeline->aggregator.accept_count);
+    TEST_CHECK(p_pipeline->store_stage.in_count == p_pipeline->aggregate_stage.out_count, "store in %llu",
+               (unsigned long long)p_pipeline->store_stage.in_count);
+    pipeline_free(p_pipeline);
+}
+
+static void threads_test(void)
+{
+    pipeline_t * p_pipeline = pipeline_create(capture_make(true, false), BLE_PDLP_PIPELINE_BACKPRESSURE_WAIT);
+    pthread_t    threads[4];
+
+    TEST_CHECK((pthread_create(&threads[0], NULL, capture_thread, p_pipeline) == 0)
+            && (pthread_create(&threads[1], NULL, decode_thread, p_pipeline) == 0)
+            && (pthread_create(&threads[2], NULL, aggregate_thread, p_pipeline) == 0)
+            && (pthread_create(&threads[3], NULL, store_thread, p_pipeline) == 0), "threads");
+    pthread_join(threads[0], NULL);
+    pthread_join(threads[1], NULL);
+    pthread_join(threads[2], NULL);
+    pthread_join(threads[3], NULL);
+    lossless_check(p_pipeline, true);
+    pipeline_free(p_pipeline);
+}
+
+int main(void)
+{
+    turns_test();
+    drop_test();
+    threads_test();
+
+    return test_result("test_pipeline");
+}
@@ -0,0 +1,271 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+// Appends readings of interleaved devices to stores and checks the queries against a scan of the appended
+// readings, over random windows that start and end inside blocks or take them whole. Also checks the reopening of a
+// segment in the middle of a block, the blocks sealed without summaries, the full dictionary, the full segment and
+// the length of the sealed blocks.
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "ble_pdlp_store.h"
+#include "ble_pdlp_common.h"
+#include "test.h"
+
+#define DEVICE_COUNT    (200)
+#define READING_MAX     (60000)
+#define BASE_US         (1600000000000000ULL)
+
+typedef struct
+{
+    uint32_t device;
+    uint8_t  service_id;
+    uint16_t value;
+    uint64_t timestamp_us;
+} reading_t;
+
+static reading_t m_readings[READING_MAX];
+static uint32_t  m_reading_count;
+
+static void device_addr(uint32_t device, uint8_t * p_bd_addr)
+{
+    p_bd_addr[0] = (uint8_t)device;
+    p_bd_addr[1] = (uint8_t)(device >> 8);
+    p_bd_addr[2] = (uint8_t)(device >> 16);
+    p_bd_addr[3] = 0x33;
+    p_bd_addr[4] = 0x22;
+    p_bd_addr[5] = 0xC0;
+}
+
+static bool append(ble_pdlp_store_t * p_store, uint32_t device, uint8_t service_id, uint16_t value, uint64_t timestamp_us)
+{
+    uint8_t bd_addr[M_BD_ADDR_SIZE];
+
+    device_addr(device, bd_addr);
+    if (!ble_pdlp_store_append(p_store, bd_addr, service_id, value, -50 - (int8_t)(device % 40), timestamp_us))
+    {
+        return false;
+    }
+    m_readings[m_reading_count].device       = device;
+    m_readings[m_reading_count].service_id   = service_id;
+    m_readings[m_reading_count].value        = value;
+    m_readings[m_reading_count].timestamp_us = timestamp_us;
+    m_reading_count++;
+    return true;
+}
+
+// Appends readings of the devices in turn, a temperature and a button press each. Every 10000 readings starts a run
+// of 3 second gaps, whose 4-byte deltas fill the timestamp column of a block before its readings do.
+static void ingest(ble_pdlp_store_t * p_store, uint32_t count, uint64_t * p_timestamp_us)
+{
+    uint32_t i;
+
+    for (i = 0; i < count; i += 2)
+    {
+        uint32_t device = (m_reading_count / 2) % DEVICE_COUNT;
+        float    temperature = (float)((int32_t)((device * 7 + i) % 60) - 20) * 0.5f;
+
+        bool     long_gaps = ((m_reading_count % 10000) < 4000);
+
+        *p_timestamp_us += long_gaps ? 3000000 : (uint64_t)(500 + (i % 13) * 100);
+        TEST_CHECK(append(p_store, device, LINKING_SERVICE_TYPE_TEMPERATURE, IEEE754_Convert_Temperature(temperature), *p_timestamp_us),
+                   "append %u", m_reading_count);
+        *p_timestamp_us += long_gaps ? 3000000 : 0;
+        TEST_CHECK(append(p_store, device, LINKING_SERVICE_TYPE_BUTTON, (uint16_t)(i & 0xFFF), *p_timestamp_us), "append %u", m_reading_count);
+    }
+}
+
+static void query_check(ble_pdlp_store_t const * p_store, uint32_t device, uint8_t service_id, uint64_t from_us, uint64_t to_us)
+{
+    ble_pdlp_store_result_t result;
+    uint8_t                 bd_addr[M_BD_ADDR_SIZE];
+    uint32_t                count = 0;
+    double                  sum = 0;
+    float                   min = 0;
+    float                   max = 0;
+    uint32_t                i;
+
+    for (i = 0; i < m_reading_count; i++)
+    {
+        reading_t const * p_reading = &m_readings[i];
+
+        if ((p_reading->device == device) && (p_reading->service_id == service_id)
+        &&  (p_reading->timestamp_us >= from_us) && (p_reading->timestamp_us < to_us))
+        {
+            float f_value = ble_pdlp_store_value_decode(service_id, p_reading->value);
+
+            min  = ((count == 0) || (f_value < min)) ? f_value : min;
+            max  = ((count == 0) || (f_value > max)) ? f_value : max;
+            sum += f_value;
+            count++;
+        }
+    }
+
+    device_addr(device, bd_addr);
+    TEST_CHECK(ble_pdlp_store_query(p_store, bd_addr, service_id, from_us, to_us, &result), "device %u not found", device);
+    TEST_CHECK(result.count == count, "device %u service %u [%llu, %llu): count %u, expected %u", device, service_id,
+               (unsigned long long)(from_us - BASE_US), (unsigned long long)(to_us - BASE_US), result.count, count);
+    if ((count != 0) && (result.count == count))
+    {
+        TEST_CHECK((result.min == min) && (result.max == max) && (fabs(result.sum - sum) < 1e-3),
+                   "device %u: min %f max %f sum %f, expected %f %f %f", device, result.min, result.max, result.sum, min, max, sum);
+    }
+}
+
+static void queries_check(ble_pdlp_store_t const * p_store, uint32_t device_count, uint32_t query_count)
+{
+    uint64_t last_us = m_readings[m_reading_count - 1].timestamp_us;
+    uint32_t i;
+
+    srand(1);
+    for (i = 0; i < query_count; i++)
+    {
+        uint64_t from_us = BASE_US + (uint64_t)rand() * (last_us - BASE_US) / RAND_MAX;
+        uint64_t to_us = from_us + (uint64_t)rand() * (last_us - from_us + 1) / RAND_MAX;
+        uint8_t  service_id = (i & 1) ? LINKING_SERVICE_TYPE_TEMPERATURE : LINKING_SERVICE_TYPE_BUTTON;
+
+        query_check(p_store, (uint32_t)rand() % device_count, service_id, from_us, to_us);
+    }
+
+    // Windows taking every block whole
+    query_check(p_store, 0, LINKING_SERVICE_TYPE_TEMPERATURE, 0, UINT64_MAX);
+    query_check(p_store, device_count - 1, LINKING_SERVICE_TYPE_BUTTON, 0, UINT64_MAX);
+    query_check(p_store, 7, LINKING_SERVICE_TYPE_HUMIDITY, 0, UINT64_MAX);
+}
+
+static void store_test(void)
+{
+    uint32_t                 len = ble_pdlp_store_segment_len(4096, 40);
+    void                   * p_segment = malloc(len);
+    ble_pdlp_store_t       * p_store = malloc(sizeof(ble_pdlp_store_t));
+    ble_pdlp_store_t       * p_reopened = malloc(sizeof(ble_pdlp_store_t));
+    ble_pdlp_store_header_t const * p_header;
+    ble_pdlp_store_result_t  result;
+    uint8_t                  bd_addr[M_BD_ADDR_SIZE];
+    uint64_t                 timestamp_us = BASE_US;
+    uint32_t                 offset;
+    uint32_t                 sealed_count = 0;
+    uint32_t                 short_count = 0;
+    uint32_t                 b;
+
+    TEST_CHECK(!ble_pdlp_store_create(p_store, p_segment, len, 0), "no devices");
+    TEST_CHECK(!ble_pdlp_store_create(p_store, p_segment, len, BLE_PDLP_STORE_DEVICE_MAX + 1), "too many devices");
+    TEST_CHECK(!ble_pdlp_store_create(p_store, p_segment, ble_pdlp_store_segment_len(4096, 1) - 1, 4096), "no room for a block");
+    TEST_CHECK(ble_pdlp_store_create(p_store, p_segment, len, 4096), "not created");
+    p_header = p_store->p_header;
+
+    m_reading_count = 0;
+    ingest(p_store, 40001, &timestamp_us);
+    TEST_CHECK(p_header->device_count == DEVICE_COUNT, "devices %u", p_header->device_count);
+    TEST_CHECK(!ble_pdlp_store_append(p_store, bd_addr, LINKING_SERVICE_TYPE_BUTTON, 0, 0, timestamp_us - 1), "timestamp backwards");
+
+    // Sealed blocks take the length of their readings and summaries
+    for (b = 0, offset = p_header->block_offset; (b + 1) < p_header->block_count; b++)
+    {
+        ble_pdlp_store_block_t const * p_block = (ble_pdlp_store_block_t const *)((uint8_t const *)p_header + offset);
+
+        TEST_CHECK((p_block->len % 8) == 0, "block %u length %u", b, p_block->len);
+        TEST_CHECK(p_block->summary_count == DEVICE_COUNT * 2, "block %u: %u summaries of %u readings", b, p_block->summary_count, p_block->count);
+        short_count += (p_block->count < BLE_PDLP_STORE_BLOCK_RECORDS);
+        sealed_count += p_block->count;
+        offset       += p_block->len;
+    }
+    TEST_CHECK(short_count != 0, "no block sealed by its timestamps");
+    TEST_CHECK(offset == p_header->open_offset, "sealed blocks end at %u, open block at %u", offset, p_header->open_offset);
+    TEST_CHECK((sealed_count > 30000) && ((p_header->open_offset - p_header->block_offset) < sealed_count * 12),
+               "%u bytes for %u sealed readings", p_header->open_offset - p_header->block_offset, sealed_count);
+
+    queries_check(p_store, DEVICE_COUNT, 400);
+
+    // Reopened in the middle of a block, the appends go on in the open block
+    TEST_CHECK(ble_pdlp_store_open(p_reopened, p_segment, len), "not reopened");
+    ingest(p_reopened, 2000, &timestamp_us);
+    queries_check(p_reopened, DEVICE_COUNT, 200);
+    queries_check(p_store, DEVICE_COUNT, 10);
+
+    device_addr(DEVICE_COUNT, bd_addr);
+    TEST_CHECK(!ble_pdlp_store_query(p_store, bd_addr, LINKING_SERVICE_TYPE_BUTTON, 0, UINT64_MAX, &result), "unknown device found");
+
+    TEST_CHECK(!ble_pdlp_store_open(p_reopened, p_segment, len - 1), "opened shorter");
+    p_store->p_header->magic = 0;
+    TEST_CHECK(!ble_pdlp_store_open(p_reopened, p_segment, len), "opened without magic");
+
+    free(p_reopened);
+    free(p_store);
+    free(p_segment);
+}
+
+// With more devices than fit the summaries of a block, the sealed blocks have none and the queries scan them
+static void many_devices_test(void)
+{
+    uint32_t           len = ble_pdlp_store_segment_len(5000, 4);
+    void             * p_segment = malloc(len);
+    ble_pdlp_store_t * p_store = malloc(sizeof(ble_pdlp_store_t));
+    uint64_t           timestamp_us = BASE_US;
+    uint32_t           i;
+
+    TEST_CHECK(ble_pdlp_store_create(p_store, p_segment, len, 5000), "not created");
+    m_reading_count = 0;
+    for (i = 0; i < 9000; i++)
+    {
+        uint32_t device = i % 3000;
+
+        timestamp_us += 1000;
+        TEST_CHECK(append(p_store, device, (device & 1) ? LINKING_SERVICE_TYPE_TEMPERATURE : LINKING_SERVICE_TYPE_BUTTON,
+                          (uint16_t)(0x480 + (i & 0xFF)), timestamp_us), "append %u", i);
+    }
+    TEST_CHECK(p_store->p_header->block_count == 3, "blocks %u", p_store->p_header->block_count);
+    TEST_CHECK(((ble_pdlp_store_block_t const *)((uint8_t const *)p_store->p_header + p_store->p_header->block_offset))->summary_count == 0,
+               "summaries kept");
+    queries_check(p_store, 3000, 200);
+
+    free(p_store);
+    free(p_segment);
+}
+
+static void full_test(void)
+{
+    uint32_t           len = ble_pdlp_store_segment_len(3, 2);
+    void             * p_segment = malloc(len);
+    ble_pdlp_store_t * p_store = malloc(sizeof(ble_pdlp_store_t));
+    uint64_t           timestamp_us = BASE_US;
+
+    TEST_CHECK(ble_pdlp_store_create(p_store, p_segment, len, 3), "not created");
+    m_reading_count = 0;
+    TEST_CHECK(append(p_store, 0, LINKING_SERVICE_TYPE_BUTTON, 1, timestamp_us)
+            && append(p_store, 1, LINKING_SERVICE_TYPE_BUTTON, 2, timestamp_us)
+            && append(p_store, 2, LINKING_SERVICE_TYPE_BUTTON, 3, timestamp_us), "append");
+    TEST_CHECK(!append(p_store, 3, LINKING_SERVICE_TYPE_BUTTON, 4, timestamp_us), "dictionary over full");
+
+    // Two open block lengths hold more than two blocks once sealed
+    while (append(p_store, m_reading_count % 3, LINKING_SERVICE_TYPE_BUTTON, (uint16_t)m_reading_count, timestamp_us += 1000))
+    {
+    }
+    TEST_CHECK((p_store->p_header->block_count > 2) && (m_reading_count > 2 * BLE_PDLP_STORE_BLOCK_RECORDS),
+               "blocks %u, readings %u", p_store->p_header->block_count, m_reading_count);
+    query_check(p_store, 1, LINKING_SERVICE_TYPE_BUTTON, 0, UINT64_MAX);
+    query_check(p_store, 2, LINKING_SERVICE_TYPE_BUTTON, BASE_US + 5000000, BASE_US + 9000000);
+
+    free(p_store);
+    free(p_segment);
+}
+
+int main(void)
+{
+    store_test();
+    many_devices_test();
+    full_test();
+
+    return test_result("test_store");
+}
@@ -1,77 +0,0 @@
-/* Copyright (c) Nordic Semiconductor ASA
- * All rights reserved.
- * 
- * Redistribution and use in source and binary forms, with or without modification,
- * are permitted provided that the following conditions are met:
- * 
- *   1. Redistributions of source code must retain the above copyright notice, this
- *   list of conditions and the following disclaimer.
- * 
- *   2. Redistributions in binary form must reproduce the above copyright notice, this
- *   list of conditions and the following disclaimer in the documentation and/or
- *   other materials provided with the distribution.
- * 
- *   3. Neither the name of Nordic Semiconductor ASA nor the names of other
- *   contributors to this software may be used to endorse or promote products
- *   derived from this software without specific prior written permission.
- * 
- *   4. This software must only be used in a processor manufactured by Nordic
- *   Semiconductor ASA, or in a processor manufactured by a third party that
- *   is used in combination with a processor manufactured by Nordic Semiconductor.
- * 
- * 
- * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
- * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
- * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
- * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
- * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
- * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
- * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
- * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
- * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
- * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
- */
-#include "hal_timer.h"
-#include "hal_clock.h"
-#include "nrf.h"
-
-/* Converts the specified microsecond time to the closest prior RTC unit. */
-static void m_convert(uint32_t time_us, uint32_t *rtc_units, uint32_t *us_units)
-{
-   uint32_t u1, u2, t1, t2, t3;
-
-   t1 = time_us / 15625;
-   u1 = t1 * 512;
-   t2 = time_us - t1 * 15625;
-   u2 = (t2 << 9) / 15625;
-   t3 = (((t2 << 9) - u2 * 15625) + 256) >> 9;
-
-   *rtc_units = u1 + u2;
-   *us_units = t3;
-}
-
-
-void hal_timer_start(void)
-{
-    hal_clock_lfclk_enable();
-
-    NVIC_ClearPendingIRQ(RTC0_IRQn);
-    NVIC_EnableIRQ(RTC0_IRQn);
-
-    NRF_RTC0->TASKS_CLEAR = 1;
-    NRF_RTC0->TASKS_START = 1;
-}
-
-
-void hal_timer_timeout_set(uint32_t timeout_us)
-{
-    uint32_t rtc_units;
-    uint32_t us_units;
-    
-    m_convert(timeout_us, &rtc_units, &us_units);
-    (void)us_units;
-
-    NRF_RTC0->CC[0]    = rtc_units;
-    NRF_RTC0->EVTENSET = (RTC_EVTENSET_COMPARE0_Enabled << RTC_EVTENSET_COMPARE0_Pos);
-    NRF_RTC0->INTENSET = (RTC_INTENSET_COMPARE0_Enabled << RTC_INTENSET_COMPARE0_Pos);
-}
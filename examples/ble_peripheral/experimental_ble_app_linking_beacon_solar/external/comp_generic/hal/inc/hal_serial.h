@@ -42,6 +42,12 @@
 #include <stdbool.h>
 
 
+/* The TWI masters are driven through EasyDMA (TWIM) on nRF52 if SYS_CFG_TWI_USE_EASYDMA is defined. */
+#if defined(NRF52) && defined(SYS_CFG_TWI_USE_EASYDMA)
+#define HAL_SERIAL_TWI_EASYDMA
+#endif
+
+
 #ifdef SYS_CFG_USE_SPI0
 void hal_serial_spi0_isr_handler(void);
 #endif
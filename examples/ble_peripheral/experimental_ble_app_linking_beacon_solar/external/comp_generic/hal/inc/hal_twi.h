@@ -95,6 +95,29 @@ enum
 typedef void (*hal_twi_sig_callback_t) (hal_twi_signal_type_t hal_twi_signal_type);
 
 
+/**@brief A queued transaction: an optional write followed by an optional read with a repeated start.
+ */
+typedef struct hal_twi_xfer_s hal_twi_xfer_t;
+
+
+/**@brief The type of the callback called when a queued transaction is done.
+ */
+typedef void (*hal_twi_xfer_callback_t) (hal_twi_xfer_t * p_xfer, bool success);
+
+
+struct hal_twi_xfer_s
+{
+    uint8_t                 address;    ///< The 7-bit device address.
+    uint32_t                frequency;  ///< The frequency setting for the device, as in ::hal_twi_cfg_t.
+    uint8_t                 tx_length;  ///< The number of bytes to write, or 0.
+    uint8_t               * p_tx;       ///< The bytes to write.
+    uint8_t                 rx_length;  ///< The number of bytes to read, or 0.
+    uint8_t               * p_rx;       ///< The buffer to read into.
+    hal_twi_xfer_callback_t callback;   ///< Called from the TWI interrupt when the transaction is done, or NULL.
+    hal_twi_xfer_t        * p_next;     ///< The next transaction of the list, or NULL.
+};
+
+
 /**@brief Initializes the twi interface.
  */
 void hal_twi_init(void);
@@ -140,7 +163,9 @@ void hal_twi_stop_mode_set(hal_twi_id_t id, hal_twi_stop_mode_t stop_mode);
 /**@brief Writes bytes to a device.
  *
  * @note The transmit buffer shall be available to the driver until all bytes
- *       have been sent.
+ *       have been sent. The bytes are sent right away; unless the stop mode
+ *       generates a stop condition after the write, the bus is held so that a
+ *       following read starts with a repeated start.
  *
  * @param{in] id        The id of the HW peripheral to write through.
  * @param[in] length    The number of bytes to transmit from the buffer.
@@ -167,6 +192,46 @@ uint32_t hal_twi_write(hal_twi_id_t id, uint32_t length, uint8_t * tx_buffer);
 uint32_t hal_twi_read(hal_twi_id_t id, uint32_t length, uint8_t * rx_buffer);
 
 
+/**@brief Writes bytes to a device, then reads bytes from it with a repeated start.
+ *
+ * @note Both buffers shall be available to the driver until all bytes have been
+ *       received. A stop condition is generated after the read whatever the stop
+ *       mode. With EasyDMA the transaction ends with a single interrupt, and a
+ *       failed write is signalled as ::HAL_TWI_SIGNAL_TYPE_RX_ERROR. Only the
+ *       read signals completion.
+ *
+ * @param{in]   id        The id of the HW peripheral to use.
+ * @param[in]   tx_length The number of bytes to transmit from the transmit buffer.
+ * @param{in]   tx_buffer The transmit buffer to use.
+ * @param{in]   rx_length The number of bytes to read.
+ * @param{[out] rx_buffer The receive buffer to use.
+ *
+ * @retval ::HAL_TWI_STATUS_CODE_SUCCESS        if successful.
+ * @retval ::HAL_TWI_STATUS_CODE_WRITE_ERROR    if the bytes could not be written.
+ * @retval ::HAL_TWI_STATUS_CODE_READ_ERROR     if the bytes could not be read.
+ * @retval ::HAL_TWI_STATUS_CODE_DISALLOWED     if a transfer is ongoing.
+ */
+uint32_t hal_twi_write_read(hal_twi_id_t id, uint32_t tx_length, uint8_t * tx_buffer, uint32_t rx_length, uint8_t * rx_buffer);
+
+
+/**@brief Queues a list of transactions, linked through p_next, to be run back-to-back.
+ *
+ * @note The queue owns the HW peripheral: it is acquired with the first queued transaction and
+ *       released when the queue becomes idle, so drivers using the queue shall not open it with
+ *       ::hal_twi_open. The transactions of several drivers can be queued, and are run in order
+ *       without releasing the peripheral in between. The transactions and their buffers shall be
+ *       available to the driver until their callbacks have been called. The signal callback, the
+ *       stop mode and the device address are restored when the queue becomes idle.
+ *
+ * @param{in] id            The id of the HW peripheral to run the transactions on.
+ * @param{in] p_xfer_list   The first transaction of the list.
+ *
+ * @retval ::HAL_TWI_STATUS_CODE_SUCCESS    if successful.
+ * @retval ::HAL_TWI_STATUS_CODE_DISALLOWED if the transactions could not be queued, e.g. the HW peripheral is open.
+ */
+uint32_t hal_twi_xfer_schedule(hal_twi_id_t id, hal_twi_xfer_t * p_xfer_list);
+
+
 /**@brief Closes the specified driver.
  *
  * @param{in] id    The id of the HW peripheral to close the driver for.
@@ -91,9 +91,15 @@ bool hal_serial_id_acquire(hal_serial_id_t id)
         case HAL_SERIAL_ID_TWI0:
             if ( hal_serial.current_id[0] == HAL_SERIAL_ID_NONE )
             {
+#ifdef HAL_SERIAL_TWI_EASYDMA
+                NRF_TWIM0->PSEL.SCL = hal_serial.cfg->twi0.psel.scl;
+                NRF_TWIM0->PSEL.SDA = hal_serial.cfg->twi0.psel.sda;
+                NRF_TWIM0->ENABLE = (TWIM_ENABLE_ENABLE_Enabled << TWIM_ENABLE_ENABLE_Pos);
+#else
                 NRF_TWI0->PSELSCL = hal_serial.cfg->twi0.psel.scl;
                 NRF_TWI0->PSELSDA = hal_serial.cfg->twi0.psel.sda;
                 NRF_TWI0->ENABLE = (TWI_ENABLE_ENABLE_Enabled << TWI_ENABLE_ENABLE_Pos);
+#endif
                 hal_serial.current_id[0] = id;
                 hal_serial.current_handler[0] = hal_serial_twi0_isr_handler;
             
@@ -120,9 +126,15 @@ bool hal_serial_id_acquire(hal_serial_id_t id)
         case HAL_SERIAL_ID_TWI1:
             if ( hal_serial.current_id[1] == HAL_SERIAL_ID_NONE )
             {
+#ifdef HAL_SERIAL_TWI_EASYDMA
+                NRF_TWIM1->PSEL.SCL = hal_serial.cfg->twi1.psel.scl;
+                NRF_TWIM1->PSEL.SDA = hal_serial.cfg->twi1.psel.sda;
+                NRF_TWIM1->ENABLE = (TWIM_ENABLE_ENABLE_Enabled << TWIM_ENABLE_ENABLE_Pos);
+#else
                 NRF_TWI1->PSELSCL = hal_serial.cfg->twi1.psel.scl;
                 NRF_TWI1->PSELSDA = hal_serial.cfg->twi1.psel.sda;
                 NRF_TWI1->ENABLE = (TWI_ENABLE_ENABLE_Enabled << TWI_ENABLE_ENABLE_Pos);
+#endif
                 hal_serial.current_id[1] = id;
                 hal_serial.current_handler[1] = hal_serial_twi1_isr_handler;
         
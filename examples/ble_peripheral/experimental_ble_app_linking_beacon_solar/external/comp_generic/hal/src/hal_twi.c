@@ -39,6 +39,17 @@
 #include <stdbool.h>
 
 
+#ifdef HAL_SERIAL_TWI_EASYDMA
+typedef NRF_TWIM_Type   hal_twi_hw_t;
+#define M_TWI0          NRF_TWIM0
+#define M_TWI1          NRF_TWIM1
+#else
+typedef NRF_TWI_Type    hal_twi_hw_t;
+#define M_TWI0          NRF_TWI0
+#define M_TWI1          NRF_TWI1
+#endif
+
+
 typedef struct
 {
     hal_twi_sig_callback_t  current_sig_callback;
@@ -62,6 +73,22 @@ typedef struct
     } state;
     uint8_t                 current_address;
     hal_twi_stop_mode_t     current_stop_mode;
+#ifdef HAL_SERIAL_TWI_EASYDMA
+    bool                    suspended;          ///< The bus is held after a TX buffer without a stop condition.
+    bool                    error;              ///< An error occured during the current transfer.
+    volatile uint32_t *     p_end_event;        ///< The event ending the current transfer.
+    uint32_t                end_int_mask;       ///< The interrupt of the event ending the current transfer.
+#else
+    bool                    rx_pending;         ///< The read of hal_twi_write_read follows the current write.
+#endif
+    struct
+    {
+        hal_twi_xfer_t *        p_head;             ///< The transaction in progress, NULL if the queue is idle.
+        hal_twi_xfer_t *        p_tail;             ///< The last queued transaction.
+        hal_twi_sig_callback_t  saved_sig_callback; ///< The signal callback to restore when the queue becomes idle.
+        hal_twi_stop_mode_t     saved_stop_mode;    ///< The stop mode to restore when the queue becomes idle.
+        uint8_t                 saved_address;      ///< The device address to restore when the queue becomes idle.
+    } queue;
 } hal_twi_t;
 
 
@@ -73,9 +100,66 @@ static hal_twi_t hal_twi1;
 #endif
 
 
-static void hal_twi_isr_handler(NRF_TWI_Type * twi, hal_twi_t * context);
+static void hal_twi_isr_handler(hal_twi_hw_t * twi, hal_twi_t * context);
+
+
+#ifdef HAL_SERIAL_TWI_EASYDMA
+/* Translates the legacy TWI frequency setting of the configuration to the TWIM one. */
+static uint32_t twim_frequency_get(uint32_t twi_frequency)
+{
+    switch ( twi_frequency )
+    {
+        case (TWI_FREQUENCY_FREQUENCY_K100 << TWI_FREQUENCY_FREQUENCY_Pos):
+            return ( TWIM_FREQUENCY_FREQUENCY_K100 << TWIM_FREQUENCY_FREQUENCY_Pos );
+        case (TWI_FREQUENCY_FREQUENCY_K250 << TWI_FREQUENCY_FREQUENCY_Pos):
+            return ( TWIM_FREQUENCY_FREQUENCY_K250 << TWIM_FREQUENCY_FREQUENCY_Pos );
+        default:
+            return ( TWIM_FREQUENCY_FREQUENCY_K400 << TWIM_FREQUENCY_FREQUENCY_Pos );
+    }
+}
+
+
+/* Starts a transfer with the already configured buffers and shortcuts. The whole transfer ends with one
+ * interrupt: STOPPED if the shortcuts generate a stop condition, otherwise SUSPENDED. */
+static void transfer_start(hal_twi_hw_t * twi, hal_twi_t * context, volatile uint32_t * p_start_task)
+{
+    if ( (twi->SHORTS & ((TWIM_SHORTS_LASTTX_STOP_Enabled << TWIM_SHORTS_LASTTX_STOP_Pos) |
+                         (TWIM_SHORTS_LASTRX_STOP_Enabled << TWIM_SHORTS_LASTRX_STOP_Pos))) != 0 )
+    {
+        context->p_end_event  = &(twi->EVENTS_STOPPED);
+        context->end_int_mask = (TWIM_INTENSET_STOPPED_Enabled << TWIM_INTENSET_STOPPED_Pos);
+    }
+    else
+    {
+        context->p_end_event  = &(twi->EVENTS_SUSPENDED);
+        context->end_int_mask = (TWIM_INTENSET_SUSPENDED_Enabled << TWIM_INTENSET_SUSPENDED_Pos);
+    }
+    context->error = false;
+
+    twi->INTENCLR = 0xFFFFFFFF;
+    twi->EVENTS_STOPPED   = 0;
+    twi->EVENTS_SUSPENDED = 0;
+    twi->EVENTS_ERROR     = 0;
+
+    if ( context->current_sig_callback != NULL )
+    {
+        twi->INTENSET = context->end_int_mask |
+                        (TWIM_INTENSET_ERROR_Enabled << TWIM_INTENSET_ERROR_Pos);
+    }
 
+    if ( context->suspended )
+    {
+        context->suspended = false;
+        twi->TASKS_RESUME = 1;
+    }
+    *p_start_task = 1;
 
+    if ( context->current_sig_callback == NULL )
+    {
+        hal_twi_isr_handler(twi, context);
+    }
+}
+#else
 static void hal_twi_stop_check_and_handle(NRF_TWI_Type * twi)
 {
     if ( (twi->SHORTS & (TWI_SHORTS_BB_STOP_Enabled << TWI_SHORTS_BB_STOP_Pos)) != 0 )
@@ -94,8 +178,9 @@ static void hal_twi_tx_shorts_setup(NRF_TWI_Type * twi, hal_twi_t * context)
     }
     else
     {
-        if ( (context->current_stop_mode == HAL_TWI_STOP_MODE_STOP_ON_ANY)
-        ||   (context->current_stop_mode == HAL_TWI_STOP_MODE_STOP_ON_TX_BUF_END) )
+        if ( ((context->current_stop_mode == HAL_TWI_STOP_MODE_STOP_ON_ANY)
+        ||    (context->current_stop_mode == HAL_TWI_STOP_MODE_STOP_ON_TX_BUF_END))
+        &&   (!context->rx_pending) )
         {
             twi->EVENTS_STOPPED = 0;
             twi->SHORTS = (TWI_SHORTS_BB_STOP_Enabled << TWI_SHORTS_BB_STOP_Pos);
@@ -121,6 +206,25 @@ static void hal_twi_rx_shorts_setup(NRF_TWI_Type * twi, hal_twi_t * context)
         }
     }
 }
+#endif
+
+
+static hal_twi_t * context_get(hal_twi_id_t id)
+{
+    switch ( id )
+    {
+#ifdef SYS_CFG_USE_TWI0
+        case HAL_TWI_ID_TWI0:
+            return ( &hal_twi0 );
+#endif
+#ifdef SYS_CFG_USE_TWI1
+        case HAL_TWI_ID_TWI1:
+            return ( &hal_twi1 );
+#endif
+        default:
+            return ( NULL );
+    }
+}
 
 
 void hal_twi_init(void)
@@ -132,6 +236,8 @@ void hal_twi_init(void)
 
     hal_twi0.state = STATE_IDLE;
     hal_twi0.current_sig_callback = NULL;
+    hal_twi0.queue.p_head = NULL;
+    hal_twi0.queue.p_tail = NULL;
 #endif
 #ifdef SYS_CFG_USE_TWI1
     hal_twi1.current_sig_callback = NULL;
@@ -140,6 +246,8 @@ void hal_twi_init(void)
 
     hal_twi1.state = STATE_IDLE;
     hal_twi1.current_sig_callback = NULL;
+    hal_twi1.queue.p_head = NULL;
+    hal_twi1.queue.p_tail = NULL;
 #endif
 }
 
@@ -152,8 +260,14 @@ uint32_t hal_twi_open(hal_twi_id_t id, hal_twi_cfg_t const * const cfg)
         case HAL_TWI_ID_TWI0:
             if ( hal_serial_id_acquire(HAL_SERIAL_ID_TWI0) )
             {
-                NRF_TWI0->ADDRESS = cfg->address;
-                NRF_TWI0->FREQUENCY = cfg->frequency;
+                M_TWI0->ADDRESS = cfg->address;
+#ifdef HAL_SERIAL_TWI_EASYDMA
+                M_TWI0->FREQUENCY = twim_frequency_get(cfg->frequency);
+                hal_twi0.suspended  = false;
+#else
+                M_TWI0->FREQUENCY = cfg->frequency;
+                hal_twi0.rx_pending = false;
+#endif
                 return ( HAL_TWI_STATUS_CODE_SUCCESS );
             }
             break;
@@ -162,8 +276,14 @@ uint32_t hal_twi_open(hal_twi_id_t id, hal_twi_cfg_t const * const cfg)
         case HAL_TWI_ID_TWI1:
             if ( hal_serial_id_acquire(HAL_SERIAL_ID_TWI1) )
             {
-                NRF_TWI1->ADDRESS = cfg->address;
-                NRF_TWI1->FREQUENCY = cfg->frequency;
+                M_TWI1->ADDRESS = cfg->address;
+#ifdef HAL_SERIAL_TWI_EASYDMA
+                M_TWI1->FREQUENCY = twim_frequency_get(cfg->frequency);
+                hal_twi1.suspended  = false;
+#else
+                M_TWI1->FREQUENCY = cfg->frequency;
+                hal_twi1.rx_pending = false;
+#endif
                 return ( HAL_TWI_STATUS_CODE_SUCCESS );
             }
             break;
@@ -178,6 +298,15 @@ uint32_t hal_twi_open(hal_twi_id_t id, hal_twi_cfg_t const * const cfg)
 
 uint32_t hal_twi_close(hal_twi_id_t id)
 {
+    hal_twi_t * context = context_get(id);
+
+    // The peripheral is held by the transaction queue, not by the caller.
+    if ( (context != NULL)
+    &&   (context->queue.p_head != NULL) )
+    {
+        return ( HAL_TWI_STATUS_CODE_DISALLOWED );
+    }
+
     switch ( id )
     {
 #ifdef SYS_CFG_USE_TWI0
@@ -203,15 +332,15 @@ void hal_twi_callback_set(hal_twi_id_t id, hal_twi_sig_callback_t hal_twi_sig_ca
 #ifdef SYS_CFG_USE_TWI0
         case HAL_TWI_ID_TWI0:
             hal_twi0.current_sig_callback = hal_twi_sig_callback;
-            NRF_TWI0->INTENCLR = 0xFFFFFFFF;
-            NRF_TWI0->EVENTS_ERROR = 0;
+            M_TWI0->INTENCLR = 0xFFFFFFFF;
+            M_TWI0->EVENTS_ERROR = 0;
             break;
 #endif
 #ifdef SYS_CFG_USE_TWI1
         case HAL_TWI_ID_TWI1:
             hal_twi1.current_sig_callback = hal_twi_sig_callback;
-            NRF_TWI1->INTENCLR = 0xFFFFFFFF;
-            NRF_TWI1->EVENTS_ERROR = 0;
+            M_TWI1->INTENCLR = 0xFFFFFFFF;
+            M_TWI1->EVENTS_ERROR = 0;
             break;
 #endif
         default:
@@ -227,13 +356,13 @@ void hal_twi_address_set(hal_twi_id_t id, uint8_t dev_addr)
 #ifdef SYS_CFG_USE_TWI0
         case HAL_TWI_ID_TWI0:
             hal_twi0.current_address = dev_addr & 0x7F;
-            NRF_TWI0->ADDRESS = (hal_twi0.current_address << TWI_ADDRESS_ADDRESS_Pos);
+            M_TWI0->ADDRESS = (hal_twi0.current_address << TWI_ADDRESS_ADDRESS_Pos);
             break;
 #endif
 #ifdef SYS_CFG_USE_TWI1
         case HAL_TWI_ID_TWI1:
             hal_twi1.current_address = dev_addr & 0x7F;
-            NRF_TWI1->ADDRESS = (hal_twi1.current_address << TWI_ADDRESS_ADDRESS_Pos);
+            M_TWI1->ADDRESS = (hal_twi1.current_address << TWI_ADDRESS_ADDRESS_Pos);
             break;
 #endif
         default:
@@ -262,6 +391,32 @@ void hal_twi_stop_mode_set(hal_twi_id_t id, hal_twi_stop_mode_t stop_mode)
 }
 
 
+#ifdef HAL_SERIAL_TWI_EASYDMA
+static uint32_t write_start(hal_twi_hw_t * twi, hal_twi_t * context, uint32_t length, uint8_t * tx_buffer)
+{
+    if ( (context->state == STATE_TX)
+    ||   (context->state == STATE_RX) )
+    {
+        return ( HAL_TWI_STATUS_CODE_DISALLOWED );
+    }
+
+    context->current_buffer.tx = tx_buffer;
+    context->current_buffer.tx_length = length;
+    context->state = STATE_TX;
+
+    // Without a stop condition the bus is held, so that a following read starts with a repeated start.
+    twi->TXD.PTR    = (uint32_t)tx_buffer;
+    twi->TXD.MAXCNT = length;
+    twi->SHORTS     = ((context->current_stop_mode == HAL_TWI_STOP_MODE_STOP_ON_TX_BUF_END) ||
+                       (context->current_stop_mode == HAL_TWI_STOP_MODE_STOP_ON_ANY))
+                    ? (TWIM_SHORTS_LASTTX_STOP_Enabled    << TWIM_SHORTS_LASTTX_STOP_Pos)
+                    : (TWIM_SHORTS_LASTTX_SUSPEND_Enabled << TWIM_SHORTS_LASTTX_SUSPEND_Pos);
+
+    transfer_start(twi, context, &(twi->TASKS_STARTTX));
+
+    return ( (context->state == STATE_TX_ERROR) ? HAL_TWI_STATUS_CODE_WRITE_ERROR : HAL_TWI_STATUS_CODE_SUCCESS );
+}
+#else
 static uint32_t write_start(NRF_TWI_Type * twi, hal_twi_t * context, uint32_t length, uint8_t * tx_buffer)
 {
     if ( (context->state == STATE_TX)
@@ -306,6 +461,7 @@ static uint32_t write_start(NRF_TWI_Type * twi, hal_twi_t * context, uint32_t le
     }
     return ( (context->state == STATE_TX_ERROR) ? HAL_TWI_STATUS_CODE_WRITE_ERROR : HAL_TWI_STATUS_CODE_SUCCESS );
 }
+#endif
 
 
 uint32_t hal_twi_write(hal_twi_id_t id, uint32_t length, uint8_t * tx_buffer)
@@ -314,11 +470,11 @@ uint32_t hal_twi_write(hal_twi_id_t id, uint32_t length, uint8_t * tx_buffer)
     {
 #ifdef SYS_CFG_USE_TWI0
         case HAL_TWI_ID_TWI0:
-            return ( write_start(NRF_TWI0, &hal_twi0, length, tx_buffer) );
+            return ( write_start(M_TWI0, &hal_twi0, length, tx_buffer) );
 #endif
 #ifdef SYS_CFG_USE_TWI1
         case HAL_TWI_ID_TWI1:
-            return ( write_start(NRF_TWI1, &hal_twi1, length, tx_buffer) );
+            return ( write_start(M_TWI1, &hal_twi1, length, tx_buffer) );
 #endif
         default:
             return ( HAL_TWI_STATUS_CODE_WRITE_ERROR );
@@ -326,6 +482,29 @@ uint32_t hal_twi_write(hal_twi_id_t id, uint32_t length, uint8_t * tx_buffer)
 }
 
 
+#ifdef HAL_SERIAL_TWI_EASYDMA
+/* Note: reads always end with a stop condition, as the TWIM has no event marking the end of a read without one. */
+static uint32_t read_start(hal_twi_hw_t * twi, hal_twi_t * context, uint32_t length, uint8_t * rx_buffer)
+{
+    if ( (context->state == STATE_TX)
+    ||   (context->state == STATE_RX) )
+    {
+        return ( HAL_TWI_STATUS_CODE_DISALLOWED );
+    }
+
+    context->state = STATE_RX;
+    context->current_buffer.rx = rx_buffer;
+    context->current_buffer.rx_length = length;
+
+    twi->RXD.PTR    = (uint32_t)rx_buffer;
+    twi->RXD.MAXCNT = length;
+    twi->SHORTS     = (TWIM_SHORTS_LASTRX_STOP_Enabled << TWIM_SHORTS_LASTRX_STOP_Pos);
+
+    transfer_start(twi, context, &(twi->TASKS_STARTRX));
+
+    return ( (context->state == STATE_RX_ERROR) ? HAL_TWI_STATUS_CODE_READ_ERROR : HAL_TWI_STATUS_CODE_SUCCESS );
+}
+#else
 static uint32_t read_start(NRF_TWI_Type * twi, hal_twi_t * context, uint32_t length, uint8_t * rx_buffer)
 {
     if ( (context->state == STATE_TX)
@@ -371,6 +550,8 @@ static uint32_t read_start(NRF_TWI_Type * twi, hal_twi_t * context, uint32_t len
     return ( (context->state == STATE_RX_ERROR) ? HAL_TWI_STATUS_CODE_READ_ERROR : HAL_TWI_STATUS_CODE_SUCCESS );
 }
     
+#endif
+
 
 uint32_t hal_twi_read(hal_twi_id_t id, uint32_t length, uint8_t * rx_buffer)
 {
@@ -378,11 +559,11 @@ uint32_t hal_twi_read(hal_twi_id_t id, uint32_t length, uint8_t * rx_buffer)
     {
 #ifdef SYS_CFG_USE_TWI0
         case HAL_TWI_ID_TWI0:
-            return ( read_start(NRF_TWI0, &hal_twi0, length, rx_buffer) );
+            return ( read_start(M_TWI0, &hal_twi0, length, rx_buffer) );
 #endif
 #ifdef SYS_CFG_USE_TWI1
         case HAL_TWI_ID_TWI1:
-            return ( read_start(NRF_TWI1, &hal_twi1, length, rx_buffer) );
+            return ( read_start(M_TWI1, &hal_twi1, length, rx_buffer) );
 #endif
         default:
             return ( HAL_TWI_STATUS_CODE_READ_ERROR );
@@ -390,6 +571,364 @@ uint32_t hal_twi_read(hal_twi_id_t id, uint32_t length, uint8_t * rx_buffer)
 }
 
 
+#ifdef HAL_SERIAL_TWI_EASYDMA
+/* Both buffers are sent in one transfer, with the read started by a shortcut, so that it ends with one interrupt. */
+static uint32_t write_read_start(hal_twi_hw_t * twi, hal_twi_t * context, uint32_t tx_length, uint8_t * tx_buffer,
+                                 uint32_t rx_length, uint8_t * rx_buffer)
+{
+    if ( (context->state == STATE_TX)
+    ||   (context->state == STATE_RX) )
+    {
+        return ( HAL_TWI_STATUS_CODE_DISALLOWED );
+    }
+
+    context->state = STATE_RX;
+    context->current_buffer.tx = tx_buffer;
+    context->current_buffer.tx_length = tx_length;
+    context->current_buffer.rx = rx_buffer;
+    context->current_buffer.rx_length = rx_length;
+
+    twi->TXD.PTR    = (uint32_t)tx_buffer;
+    twi->TXD.MAXCNT = tx_length;
+    twi->RXD.PTR    = (uint32_t)rx_buffer;
+    twi->RXD.MAXCNT = rx_length;
+    twi->SHORTS     = (TWIM_SHORTS_LASTTX_STARTRX_Enabled << TWIM_SHORTS_LASTTX_STARTRX_Pos) |
+                      (TWIM_SHORTS_LASTRX_STOP_Enabled    << TWIM_SHORTS_LASTRX_STOP_Pos);
+
+    transfer_start(twi, context, &(twi->TASKS_STARTTX));
+
+    return ( (context->state == STATE_RX_ERROR) ? HAL_TWI_STATUS_CODE_READ_ERROR : HAL_TWI_STATUS_CODE_SUCCESS );
+}
+#else
+/* The read is started from the interrupt handler when the write is done, see rx_pending. */
+static uint32_t write_read_start(NRF_TWI_Type * twi, hal_twi_t * context, uint32_t tx_length, uint8_t * tx_buffer,
+                                 uint32_t rx_length, uint8_t * rx_buffer)
+{
+    uint32_t status;
+
+    if ( (context->state == STATE_TX)
+    ||   (context->state == STATE_RX) )
+    {
+        return ( HAL_TWI_STATUS_CODE_DISALLOWED );
+    }
+
+    context->current_buffer.rx = rx_buffer;
+    context->current_buffer.rx_length = rx_length;
+    context->rx_pending = true;
+
+    status = write_start(twi, context, tx_length, tx_buffer);
+    if ( status != HAL_TWI_STATUS_CODE_SUCCESS )
+    {
+        context->rx_pending = false;
+        return ( status );
+    }
+
+    return ( (context->state == STATE_RX_ERROR) ? HAL_TWI_STATUS_CODE_READ_ERROR : HAL_TWI_STATUS_CODE_SUCCESS );
+}
+#endif
+
+
+uint32_t hal_twi_write_read(hal_twi_id_t id, uint32_t tx_length, uint8_t * tx_buffer, uint32_t rx_length, uint8_t * rx_buffer)
+{
+    switch ( id )
+    {
+#ifdef SYS_CFG_USE_TWI0
+        case HAL_TWI_ID_TWI0:
+            return ( write_read_start(M_TWI0, &hal_twi0, tx_length, tx_buffer, rx_length, rx_buffer) );
+#endif
+#ifdef SYS_CFG_USE_TWI1
+        case HAL_TWI_ID_TWI1:
+            return ( write_read_start(M_TWI1, &hal_twi1, tx_length, tx_buffer, rx_length, rx_buffer) );
+#endif
+        default:
+            return ( HAL_TWI_STATUS_CODE_WRITE_ERROR );
+    }
+}
+
+
+static void queue_signal_handle(hal_twi_id_t id, hal_twi_signal_type_t hal_twi_signal_type);
+
+
+#ifdef SYS_CFG_USE_TWI0
+static void queue_twi0_sig_callback(hal_twi_signal_type_t hal_twi_signal_type)
+{
+    queue_signal_handle(HAL_TWI_ID_TWI0, hal_twi_signal_type);
+}
+#endif
+
+
+#ifdef SYS_CFG_USE_TWI1
+static void queue_twi1_sig_callback(hal_twi_signal_type_t hal_twi_signal_type)
+{
+    queue_signal_handle(HAL_TWI_ID_TWI1, hal_twi_signal_type);
+}
+#endif
+
+
+/* Acquires the HW peripheral for the queue, and saves the settings of the driver to restore when the queue becomes idle. */
+static bool queue_bus_acquire(hal_twi_id_t id, hal_twi_t * context)
+{
+    switch ( id )
+    {
+#ifdef SYS_CFG_USE_TWI0
+        case HAL_TWI_ID_TWI0:
+            if ( !hal_serial_id_acquire(HAL_SERIAL_ID_TWI0) )
+            {
+                return ( false );
+            }
+            context->queue.saved_sig_callback = context->current_sig_callback;
+            hal_twi_callback_set(id, queue_twi0_sig_callback);
+            break;
+#endif
+#ifdef SYS_CFG_USE_TWI1
+        case HAL_TWI_ID_TWI1:
+            if ( !hal_serial_id_acquire(HAL_SERIAL_ID_TWI1) )
+            {
+                return ( false );
+            }
+            context->queue.saved_sig_callback = context->current_sig_callback;
+            hal_twi_callback_set(id, queue_twi1_sig_callback);
+            break;
+#endif
+        default:
+            return ( false );
+    }
+
+    context->queue.saved_stop_mode = context->current_stop_mode;
+    context->queue.saved_address   = context->current_address;
+#ifdef HAL_SERIAL_TWI_EASYDMA
+    context->suspended  = false;
+#else
+    context->rx_pending = false;
+#endif
+    return ( true );
+}
+
+
+/* Restores the settings of the driver, and releases the HW peripheral when the queue has become idle. */
+static void queue_bus_release(hal_twi_id_t id, hal_twi_t * context)
+{
+    context->current_sig_callback = context->queue.saved_sig_callback;
+    context->current_stop_mode    = context->queue.saved_stop_mode;
+    hal_twi_address_set(id, context->queue.saved_address);
+
+    switch ( id )
+    {
+#ifdef SYS_CFG_USE_TWI0
+        case HAL_TWI_ID_TWI0:
+            (void)hal_serial_id_release(HAL_SERIAL_ID_TWI0);
+            break;
+#endif
+#ifdef SYS_CFG_USE_TWI1
+        case HAL_TWI_ID_TWI1:
+            (void)hal_serial_id_release(HAL_SERIAL_ID_TWI1);
+            break;
+#endif
+        default:
+            break;
+    }
+}
+
+
+/* Sets the frequency of the device of the next transaction. */
+static void queue_frequency_set(hal_twi_id_t id, uint32_t frequency)
+{
+    switch ( id )
+    {
+#ifdef SYS_CFG_USE_TWI0
+        case HAL_TWI_ID_TWI0:
+#ifdef HAL_SERIAL_TWI_EASYDMA
+            M_TWI0->FREQUENCY = twim_frequency_get(frequency);
+#else
+            M_TWI0->FREQUENCY = frequency;
+#endif
+            break;
+#endif
+#ifdef SYS_CFG_USE_TWI1
+        case HAL_TWI_ID_TWI1:
+#ifdef HAL_SERIAL_TWI_EASYDMA
+            M_TWI1->FREQUENCY = twim_frequency_get(frequency);
+#else
+            M_TWI1->FREQUENCY = frequency;
+#endif
+            break;
+#endif
+        default:
+            break;
+    }
+}
+
+
+/* Starts the transaction at the head of the queue. */
+static void queue_xfer_start(hal_twi_id_t id, hal_twi_t * context)
+{
+    hal_twi_xfer_t * p_xfer = context->queue.p_head;
+    uint32_t         status;
+
+    // A failed transaction shall not be resumed by the next one.
+    context->state = STATE_IDLE;
+
+    queue_frequency_set(id, p_xfer->frequency);
+    hal_twi_address_set(id, p_xfer->address);
+    if ( (p_xfer->tx_length > 0)
+    &&   (p_xfer->rx_length > 0) )
+    {
+        status = hal_twi_write_read(id, p_xfer->tx_length, p_xfer->p_tx, p_xfer->rx_length, p_xfer->p_rx);
+    }
+    else if ( p_xfer->tx_length > 0 )
+    {
+        hal_twi_stop_mode_set(id, HAL_TWI_STOP_MODE_STOP_ON_TX_BUF_END);
+        status = hal_twi_write(id, p_xfer->tx_length, p_xfer->p_tx);
+    }
+    else
+    {
+        hal_twi_stop_mode_set(id, HAL_TWI_STOP_MODE_STOP_ON_RX_BUF_END);
+        status = hal_twi_read(id, p_xfer->rx_length, p_xfer->p_rx);
+    }
+
+    if ( status != HAL_TWI_STATUS_CODE_SUCCESS )
+    {
+        queue_signal_handle(id, (p_xfer->tx_length > 0) ? HAL_TWI_SIGNAL_TYPE_TX_ERROR : HAL_TWI_SIGNAL_TYPE_RX_ERROR);
+    }
+}
+
+
+/* Handles the signals of the transaction at the head of the queue, and continues with the next one. */
+static void queue_signal_handle(hal_twi_id_t id, hal_twi_signal_type_t hal_twi_signal_type)
+{
+    hal_twi_t      * context = context_get(id);
+    hal_twi_xfer_t * p_xfer  = context->queue.p_head;
+    hal_twi_xfer_t * p_next;
+    bool             success;
+
+    success = (hal_twi_signal_type == HAL_TWI_SIGNAL_TYPE_TX_COMPLETE)
+           || (hal_twi_signal_type == HAL_TWI_SIGNAL_TYPE_RX_COMPLETE);
+
+    p_next = p_xfer->p_next;
+    context->queue.p_head = p_next;
+    if ( p_next == NULL )
+    {
+        context->queue.p_tail = NULL;
+        queue_bus_release(id, context);
+    }
+
+    // The callback may queue more transactions, which acquire the peripheral again if the queue became idle.
+    if ( p_xfer->callback != NULL )
+    {
+        p_xfer->callback(p_xfer, success);
+    }
+
+    if ( p_next != NULL )
+    {
+        queue_xfer_start(id, context);
+    }
+}
+
+
+uint32_t hal_twi_xfer_schedule(hal_twi_id_t id, hal_twi_xfer_t * p_xfer_list)
+{
+    hal_twi_t      * context = context_get(id);
+    hal_twi_xfer_t * p_last  = p_xfer_list;
+    uint32_t         primask;
+    bool             idle;
+
+    if ( (context == NULL)
+    ||   (p_xfer_list == NULL) )
+    {
+        return ( HAL_TWI_STATUS_CODE_DISALLOWED );
+    }
+
+    while ( p_last->p_next != NULL )
+    {
+        p_last = p_last->p_next;
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    idle = (context->queue.p_head == NULL);
+    if ( idle
+    &&   (!queue_bus_acquire(id, context)) )
+    {
+        // The peripheral is open for transfers outside of the queue.
+        __set_PRIMASK(primask);
+        return ( HAL_TWI_STATUS_CODE_DISALLOWED );
+    }
+
+    if ( idle )
+    {
+        context->queue.p_head = p_xfer_list;
+    }
+    else
+    {
+        context->queue.p_tail->p_next = p_xfer_list;
+    }
+    context->queue.p_tail = p_last;
+
+    __set_PRIMASK(primask);
+
+    if ( idle )
+    {
+        queue_xfer_start(id, context);
+    }
+
+    return ( HAL_TWI_STATUS_CODE_SUCCESS );
+}
+
+
+#ifdef HAL_SERIAL_TWI_EASYDMA
+static void hal_twi_isr_handler(hal_twi_hw_t * twi, hal_twi_t * context)
+{
+    bool done = (context->current_sig_callback != NULL);
+
+    do
+    {
+        if ( twi->EVENTS_ERROR != 0 )
+        {
+            twi->EVENTS_ERROR = 0;
+
+            // Release the bus, and report the error once stopped.
+            context->error        = true;
+            context->p_end_event  = &(twi->EVENTS_STOPPED);
+            context->end_int_mask = (TWIM_INTENSET_STOPPED_Enabled << TWIM_INTENSET_STOPPED_Pos);
+
+            twi->INTENCLR = (TWIM_INTENCLR_ERROR_Clear << TWIM_INTENCLR_ERROR_Pos);
+            if ( context->current_sig_callback != NULL )
+            {
+                twi->INTENSET = context->end_int_mask;
+            }
+            twi->SHORTS = 0;
+            twi->TASKS_STOP = 1;
+        }
+        else if ( *(context->p_end_event) != 0 )
+        {
+            *(context->p_end_event) = 0;
+
+            twi->INTENCLR = 0xFFFFFFFF;
+            twi->SHORTS = 0;
+            context->suspended = (context->p_end_event == &(twi->EVENTS_SUSPENDED));
+
+            if ( context->state == STATE_TX )
+            {
+                context->state = (context->error) ? STATE_TX_ERROR : STATE_IDLE;
+                if ( context->current_sig_callback != NULL )
+                {
+                    context->current_sig_callback((context->error) ? HAL_TWI_SIGNAL_TYPE_TX_ERROR : HAL_TWI_SIGNAL_TYPE_TX_COMPLETE);
+                }
+            }
+            else
+            {
+                context->state = (context->error) ? STATE_RX_ERROR : STATE_IDLE;
+                if ( context->current_sig_callback != NULL )
+                {
+                    context->current_sig_callback((context->error) ? HAL_TWI_SIGNAL_TYPE_RX_ERROR : HAL_TWI_SIGNAL_TYPE_RX_COMPLETE);
+                }
+            }
+            done = true;
+        }
+    } while ( !done );
+}
+#else
 static void hal_twi_isr_handler(NRF_TWI_Type * twi, hal_twi_t * context)
 {
     bool done = (context->current_sig_callback != NULL);
@@ -417,7 +956,13 @@ static void hal_twi_isr_handler(NRF_TWI_Type * twi, hal_twi_t * context)
                     
                     hal_twi_stop_check_and_handle(twi);
                     context->state = STATE_IDLE;
-                    if ( context->current_sig_callback != NULL )
+                    if ( context->rx_pending )
+                    {
+                        // The read of hal_twi_write_read, with a repeated start. It signals when done.
+                        context->rx_pending = false;
+                        (void)read_start(twi, context, context->current_buffer.rx_length, context->current_buffer.rx);
+                    }
+                    else if ( context->current_sig_callback != NULL )
                     {
                         context->current_sig_callback(HAL_TWI_SIGNAL_TYPE_TX_COMPLETE);
                     }
@@ -433,6 +978,7 @@ static void hal_twi_isr_handler(NRF_TWI_Type * twi, hal_twi_t * context)
 
                 //hal_twi_stop_check_and_handle(twi);
                 context->state = STATE_TX_ERROR;
+                context->rx_pending = false;
                 if ( context->current_sig_callback != NULL )
                 {
                     context->current_sig_callback(HAL_TWI_SIGNAL_TYPE_TX_ERROR);
@@ -486,12 +1032,13 @@ static void hal_twi_isr_handler(NRF_TWI_Type * twi, hal_twi_t * context)
         }
     } while ( !done );
 }
+#endif
 
 
 #ifdef SYS_CFG_USE_TWI0
 void hal_serial_twi0_isr_handler(void)
 {
-    hal_twi_isr_handler(NRF_TWI0, &hal_twi0);
+    hal_twi_isr_handler(M_TWI0, &hal_twi0);
 }
 #endif
 
@@ -499,6 +1046,6 @@ void hal_serial_twi0_isr_handler(void)
 #ifdef SYS_CFG_USE_TWI1
 void hal_serial_twi1_isr_handler(void)
 {
-    hal_twi_isr_handler(NRF_TWI1, &hal_twi1);
+    hal_twi_isr_handler(M_TWI1, &hal_twi1);
 }
 #endif
@@ -66,8 +66,10 @@ typedef void (*drv_lps25h_sleep_hook_t)(void);
 typedef struct
 {
     hal_twi_id_t            twi_id;         ///< The ID of TWI master to be used for transactions.
-    hal_twi_cfg_t           twi_cfg;        ///< The TWI configuration to use while the driver is opened.
+    hal_twi_cfg_t           twi_cfg;        ///< The TWI configuration of the transactions of the driver.
     drv_lps25h_sleep_hook_t p_sleep_hook;   ///< Pointer to a function for CPU power down to be used in the CPU inactive mode.
+    bool                    drdy_wakeup_enabled;    ///< Indicates whether the INT1 pin is connected and used to wake up on data ready.
+    uint8_t                 drdy_pin;       ///< The GPIO connected to the INT1 pin of the device.
 } drv_lps25h_cfg_t;
 
 
@@ -81,8 +83,11 @@ void drv_lps25h_init(void);
  * @param{in] id    The id of the HW peripheral to open the driver for.
  * @param{in] cfg   The driver configuration.
  *
+ * @note The TWI peripheral is shared with other drivers through the transaction queue of hal_twi,
+ *       and shall not be opened with hal_twi_open.
+ *
  * @retval ::DRV_LPS25H_STATUS_CODE_SUCCESS     if successful.
- * @retval ::DRV_LPS25H_STATUS_CODE_DISALLOWED  if the driver could not be opened.
+ * @retval ::DRV_LPS25H_STATUS_CODE_DISALLOWED  if the driver is already open.
  */
 uint32_t drv_lps25h_open(drv_lps25h_cfg_t const * const p_drv_lps25h_cfg);
 
@@ -111,6 +116,8 @@ uint32_t drv_lps25h_status_reg_get(uint8_t *p_stat_value);
 
 
 /**@brief Modifies the control register of the lps25h device.
+ *
+ * @note Setting BOOT or SWRESET discards the copy of the control registers, which are then read back on the next modification.
  *
  * @param[in]   set_mask    A mask specifying what bits to set.
  * @param[in]   clr_mask    A mask specifying what bits to clear.
@@ -122,6 +129,39 @@ uint32_t drv_lps25h_status_reg_get(uint8_t *p_stat_value);
 uint32_t drv_lps25h_ctrl_reg_modify(uint32_t set_mask, uint32_t clr_mask);
 
 
+/**@brief Starts a single measurement of temperature and pressure.
+ *
+ * @note The output data rate must be one shot. The device powers down its measurement
+ *       chain when done, and the data available bits of the status register are set.
+ *
+ * @return DRV_LPS25H_STATUS_CODE_SUCCESS      If the call was successful.
+ * @return DRV_LPS25H_STATUS_CODE_DISALLOWED   If the call was not allowed at this time.
+ */
+uint32_t drv_lps25h_one_shot_trigger(void);
+
+
+/**@brief Sets up the FIFO mean mode, where the outputs are the moving average of a number of samples.
+ *
+ * @param[in]   wtm_point   One of the DRV_LSP25H_FIFO_CTRL_WTM_POINT_MeanX values, or 0 to turn the mode off.
+ *
+ * @return DRV_LPS25H_STATUS_CODE_SUCCESS          If the call was successful.
+ * @return DRV_LPS25H_STATUS_CODE_DISALLOWED       If the call was not allowed at this time.
+ * @return DRV_LPS25H_STATUS_CODE_INVALID_PARAM    If the number of samples is not supported.
+ */
+uint32_t drv_lps25h_fifo_mean_mode_set(uint8_t wtm_point);
+
+
+/**@brief Informs the driver that the control registers hold their reset values (all zero), e.g. right after powering up the device.
+ *
+ * @note The driver keeps a copy of the control registers while it is open, so that modifying them needs no reads.
+ *       The copy is discarded when the driver is closed.
+ *
+ * @return DRV_LPS25H_STATUS_CODE_SUCCESS      If the call was successful.
+ * @return DRV_LPS25H_STATUS_CODE_DISALLOWED   If the call was not allowed at this time.
+ */
+uint32_t drv_lps25h_ctrl_reg_reset_assume(void);
+
+
 /**@brief Gets the temperature in milli degrees Celcius.
  *
  * @param[in]   p_temperature_milli_deg A pointer to where value of the temperature is to be stored.
@@ -142,10 +182,34 @@ uint32_t drv_lps25h_temperature_get(int32_t * p_temperature_milli_deg);
 uint32_t drv_lps25h_pressure_get(uint32_t * p_pressure_pa);
 
 
-/**@brief Opens access to the lps25h driver.
+/**@brief Gets both the temperature and the pressure in one burst read of the output registers.
+ *
+ * @param[in]   p_temperature_milli_deg A pointer to where value of the temperature is to be stored.
+ * @param[in]   p_pressure_pa           A pointer to where value of the pressure is to be stored.
+ *
+ * @return DRV_LPS25H_STATUS_CODE_SUCCESS      If the call was successful.
+ * @return DRV_LPS25H_STATUS_CODE_DISALLOWED   If the call was not allowed at this time.
+ */
+uint32_t drv_lps25h_outputs_get(int32_t * p_temperature_milli_deg, uint32_t * p_pressure_pa);
+
+
+/**@brief Handles the GPIOTE PORT event caused by the data-ready signal on the INT1 pin.
+ *
+ * @note To be called from GPIOTE_IRQHandler. When the wake-up on data ready is enabled in the configuration,
+ *       the pin is sensed from opening the driver until the first data-ready signal (P1_DRDY in CTRL_REG4 must be set).
+ *
+ * @return true     If the data-ready signal woke up the CPU.
+ * @return false    Otherwise.
+ */
+bool drv_lps25h_drdy_isr_handler(void);
+
+
+/**@brief Closes access to the lps25h driver.
+ *
+ * @note The transactions of other drivers still queued on the TWI peripheral are not affected.
  *
  * @retval ::DRV_LPS25H_STATUS_CODE_SUCCESS     if successful.
- * @retval ::DRV_LPS25H_STATUS_CODE_DISALLOWED  if the driver could not be opened.
+ * @retval ::DRV_LPS25H_STATUS_CODE_DISALLOWED  if the driver is not open.
  */
 uint32_t drv_lps25h_close(void);
 
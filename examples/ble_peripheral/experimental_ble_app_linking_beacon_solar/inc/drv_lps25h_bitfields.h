@@ -52,6 +52,54 @@
 #define DRV_LSP25H_CTRL_REG_ODR_12HZ5   (3)                                   /*!< 'Pressure 12.5 Hz, Temperatur 12.5 Hz */
 #define DRV_LSP25H_CTRL_REG_ODR_25HZ0   (4)                                   /*!< 'Pressure 25.0 Hz, Temperatur 25.0 Hz */
 
+/* Field ONE_SHOT: Starts a single measurement when the output data rate is one shot (cleared when the measurement is done). */
+#define DRV_LSP25H_CTRL_REG_ONE_SHOT_Pos     (8)                                      
+#define DRV_LSP25H_CTRL_REG_ONE_SHOT_Msk     (0x1 << DRV_LSP25H_CTRL_REG_ONE_SHOT_Pos) 
+#define DRV_LSP25H_CTRL_REG_ONE_SHOT_Idle    (0)                                       /*!< Waiting for start of conversion */
+#define DRV_LSP25H_CTRL_REG_ONE_SHOT_Start   (1)                                       /*!< Start for a new dataset */
+
+/* Field SWRESET: Resets the control registers to their reset values (cleared when done). */
+#define DRV_LSP25H_CTRL_REG_SWRESET_Pos      (10)
+#define DRV_LSP25H_CTRL_REG_SWRESET_Msk      (0x1 << DRV_LSP25H_CTRL_REG_SWRESET_Pos)
+#define DRV_LSP25H_CTRL_REG_SWRESET_Reset    (1)                                      /*!< Software reset */
+
+/* Field BOOT: Reboots the memory content (cleared when done). */
+#define DRV_LSP25H_CTRL_REG_BOOT_Pos         (15)
+#define DRV_LSP25H_CTRL_REG_BOOT_Msk         (0x1 << DRV_LSP25H_CTRL_REG_BOOT_Pos)
+#define DRV_LSP25H_CTRL_REG_BOOT_Reboot      (1)                                      /*!< Reboot memory content */
+
+/* Field FIFO_EN: FIFO enable. */
+#define DRV_LSP25H_CTRL_REG_FIFO_EN_Pos      (14)                                     
+#define DRV_LSP25H_CTRL_REG_FIFO_EN_Msk      (0x1 << DRV_LSP25H_CTRL_REG_FIFO_EN_Pos) 
+#define DRV_LSP25H_CTRL_REG_FIFO_EN_Disabled (0)                                       /*!< FIFO disabled */
+#define DRV_LSP25H_CTRL_REG_FIFO_EN_Enabled  (1)                                       /*!< FIFO enabled */
+
+/* Field P1_DRDY: Data-ready signal on the INT1 pin. */
+#define DRV_LSP25H_CTRL_REG_P1_DRDY_Pos      (24)                                     
+#define DRV_LSP25H_CTRL_REG_P1_DRDY_Msk      (0x1 << DRV_LSP25H_CTRL_REG_P1_DRDY_Pos) 
+#define DRV_LSP25H_CTRL_REG_P1_DRDY_Disabled (0)                                       /*!< Data-ready signal disabled */
+#define DRV_LSP25H_CTRL_REG_P1_DRDY_Enabled  (1)                                       /*!< Data-ready signal enabled */
+
+/* Register: FIFO_CTRL. */
+/* Description: FIFO control register. */
+
+/* Field WTM_POINT: FIFO watermark level, selecting the number of samples of the FIFO mean mode. */
+#define DRV_LSP25H_FIFO_CTRL_WTM_POINT_Pos    (0)                                          
+#define DRV_LSP25H_FIFO_CTRL_WTM_POINT_Msk    (0x1F << DRV_LSP25H_FIFO_CTRL_WTM_POINT_Pos) 
+#define DRV_LSP25H_FIFO_CTRL_WTM_POINT_Mean2  (1)                                           /*!< 2-sample moving average */
+#define DRV_LSP25H_FIFO_CTRL_WTM_POINT_Mean4  (3)                                           /*!< 4-sample moving average */
+#define DRV_LSP25H_FIFO_CTRL_WTM_POINT_Mean8  (7)                                           /*!< 8-sample moving average */
+#define DRV_LSP25H_FIFO_CTRL_WTM_POINT_Mean16 (15)                                          /*!< 16-sample moving average */
+#define DRV_LSP25H_FIFO_CTRL_WTM_POINT_Mean32 (31)                                          /*!< 32-sample moving average */
+
+/* Field F_MODE: FIFO mode selection. */
+#define DRV_LSP25H_FIFO_CTRL_F_MODE_Pos      (5)                                       
+#define DRV_LSP25H_FIFO_CTRL_F_MODE_Msk      (0x7 << DRV_LSP25H_FIFO_CTRL_F_MODE_Pos) 
+#define DRV_LSP25H_FIFO_CTRL_F_MODE_Bypass   (0)                                        /*!< Bypass mode */
+#define DRV_LSP25H_FIFO_CTRL_F_MODE_Fifo     (1)                                        /*!< FIFO mode */
+#define DRV_LSP25H_FIFO_CTRL_F_MODE_Stream   (2)                                        /*!< Stream mode */
+#define DRV_LSP25H_FIFO_CTRL_F_MODE_Mean     (6)                                        /*!< FIFO mean mode */
+
 /* Register: STATUS_REG. */
 /* Description: Status register. */
 
@@ -0,0 +1,70 @@
+/* Copyright (c) Nordic Semiconductor ASA
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ *   1. Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ *   2. Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ *   3. Neither the name of Nordic Semiconductor ASA nor the names of other
+ *   contributors to this software may be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ * 
+ *   4. This software must only be used in a processor manufactured by Nordic
+ *   Semiconductor ASA, or in a processor manufactured by a third party that
+ *   is used in combination with a processor manufactured by Nordic Semiconductor.
+ * 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef SENSOR_BEACON_CONFIG_H__
+#define SENSOR_BEACON_CONFIG_H__
+
+/* Sensor beacon configuration of the solar sensor beacon (PCA20014) with the LPS25H pressure sensor. */
+
+#define SENSOR_BEACON_BACKEND_LPS25H                                    /* Read temperature and air pressure from the LPS25H over TWI. */
+
+#define INTERVAL_US                                 (1000000)           /* The time in microseconds between advertising events. */
+#define SENSOR_SKIP_READ_COUNT                      (10)                /* The number of advertising events between reading the sensor. */
+
+/* The advertised service types. One per sensor reading in turn, or all of them in every advertising event
+   with BEACON_PDU_MULTI_SERVICE_ENABLE. Only temperature, humidity and air pressure are available. */
+#define BEACON_SERVICE_SCHEDULE                     LINKING_SERVICE_TYPE_TEMPERATURE, LINKING_SERVICE_TYPE_HUMIDITY, LINKING_SERVICE_TYPE_AIRPRESSURE
+
+#define HFCLK_PRECISION_MODE_ENABLE                                     /* Start sending as soon as the HF crystal reports that it is stable. */
+#define RADIO_CHAINED_TX_ENABLE                                         /* Send on all advertising channels back-to-back, waking up for all but the last packet. */
+#define ADV_DELAY_ENABLE                                                /* Add a pseudo-random advDelay of 0-10 ms to each advertising interval. */
+//#define ADV_DELAY_RNG_SEED_ENABLE                                     /* Also seed the advDelay from the RNG, not only from the device address. */
+//#define BEACON_PDU_MULTI_SERVICE_ENABLE                               /* Send all scheduled service types in every advertising event. */
+//#define SENSOR_FIFO_MEAN_ENABLE                                       /* Measure continuously and average in the sensor FIFO instead of a single one-shot measurement. */
+//#define SENSOR_DRDY_PIN                           (0)               /* The GPIO wired to the LPS25H INT1 pin. Define it to sleep until data ready instead of polling (one-shot only). */
+//#define ADAPTIVE_INTERVAL_ENABLE                                      /* Advertise in bursts when the sensor data changes and back off while it does not. */
+//#define BEACON_EVENT_PIN                          (0)               /* The GPIO of an event switch to ground. Define it to send a burst of advertising events whenever it changes. */
+#define BEACON_EVENT_SERVICE_TYPE                   LINKING_SERVICE_TYPE_BUTTON             /* Button, open/close, human or vibration sense. */
+
+#ifdef SENSOR_FIFO_MEAN_ENABLE
+#define SENSOR_FIFO_MEAN_WTM_POINT                  (DRV_LSP25H_FIFO_CTRL_WTM_POINT_Mean2)  /* The number of samples averaged by the sensor (at 25 Hz). */
+#endif
+
+#ifdef ADAPTIVE_INTERVAL_ENABLE
+#define ADAPTIVE_INTERVAL_MIN_US                    (125000)            /* The burst interval in microseconds, a multiple of 15625 to be exact in RTC ticks. */
+#define ADAPTIVE_INTERVAL_MAX_SHIFT                 (6)                 /* The longest idle interval as a power of two of the burst interval (8 s). */
+#define ADAPTIVE_INTERVAL_BURST_COUNT               (8)                 /* The number of advertising events at the burst interval after a change. */
+#define ADAPTIVE_INTERVAL_DELTA                     (2)                 /* The change of a 12-bit Linking value that restarts the burst. */
+#endif
+
+#endif // SENSOR_BEACON_CONFIG_H__
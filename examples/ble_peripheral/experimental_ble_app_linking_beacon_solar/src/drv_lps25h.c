@@ -33,7 +33,9 @@
  */
 #include "drv_lps25h.h"
 #include "drv_lps25h_bitfields.h"
+#include "nrf.h"
 #include <stdlib.h>
+#include <string.h>
 
 /* Register addresses of the lps25h device. */
 #define M_REGSTATUS     (0x27)
@@ -46,6 +48,11 @@
 #define M_REGPRESSOUTH  (0x2A)
 #define M_REGTEMPOUTL   (0x2B)
 #define M_REGTEMPOUTH   (0x2C)
+#define M_REGFIFOCTRL   (0x2E)
+
+#define M_REG_ADDR_AUTO_INCREMENT   (0x80)  ///< Sub-address bit enabling address auto-increment for multi-byte accesses.
+#define M_OUTPUTS_SIZE              (M_REGTEMPOUTH - M_REGPRESSOUTXL + 1)   ///< The number of consecutive output registers.
+#define M_CTRL_REG_COUNT            (M_REGCTRL4 - M_REGCTRL1 + 1)           ///< The number of consecutive control registers.
 
 
 /* Driver properties. */
@@ -53,159 +60,223 @@ static struct
 {
     drv_lps25h_cfg_t const  *   p_drv_lps25h_cfg;       ///< Pointer to the device configuration.
     drv_lps25h_access_mode_t    current_access_mode;    ///< The currently used access mode.
-    volatile bool               twi_sig_callback_called;///< Indicates whether the signal callback was called.
+    hal_twi_xfer_t              xfer;                   ///< The queued TWI transaction of the current register access.
+    volatile bool               xfer_done;              ///< Indicates whether the transaction is done.
+    bool                        xfer_success;           ///< Indicates whether the transaction succeeded.
+    uint8_t                     ctrl_reg_shadow[M_CTRL_REG_COUNT];  ///< Write-through copy of the control registers.
+    uint8_t                     ctrl_reg_shadow_valid;  ///< Bit n indicates that the shadow of control register n is valid.
 } m_drv_lps25h;
 
 
-/* Gets the value of the specified register. */
-static bool reg_get(uint8_t reg_addr, uint8_t *p_value)
+/* Called from the TWI interrupt when the transaction of a register access is done. */
+static void xfer_callback(hal_twi_xfer_t * p_xfer, bool success)
 {
-    if ( m_drv_lps25h.p_drv_lps25h_cfg != NULL )
-    {
-        hal_twi_id_t twi_id = m_drv_lps25h.p_drv_lps25h_cfg->twi_id;
+    (void)p_xfer;
+    
+    m_drv_lps25h.xfer_success = success;
+    m_drv_lps25h.xfer_done    = true;
+}
 
-        hal_twi_stop_mode_set(twi_id, HAL_TWI_STOP_MODE_STOP_ON_RX_BUF_END);
 
-        m_drv_lps25h.twi_sig_callback_called = false;
-        if ( hal_twi_write(twi_id, 1, &reg_addr)== HAL_TWI_STATUS_CODE_SUCCESS )
+/* Queues a register access on the TWI bus, behind the transactions of other drivers, and waits for it to be done. */
+static bool xfer_run(uint8_t tx_length, uint8_t *p_tx, uint8_t rx_length, uint8_t *p_rx)
+{
+    drv_lps25h_cfg_t const * p_cfg = m_drv_lps25h.p_drv_lps25h_cfg;
+    
+    m_drv_lps25h.xfer.address   = p_cfg->twi_cfg.address;
+    m_drv_lps25h.xfer.frequency = p_cfg->twi_cfg.frequency;
+    m_drv_lps25h.xfer.tx_length = tx_length;
+    m_drv_lps25h.xfer.p_tx      = p_tx;
+    m_drv_lps25h.xfer.rx_length = rx_length;
+    m_drv_lps25h.xfer.p_rx      = p_rx;
+    m_drv_lps25h.xfer.callback  = xfer_callback;
+    m_drv_lps25h.xfer.p_next    = NULL;
+    
+    m_drv_lps25h.xfer_done = false;
+    if ( hal_twi_xfer_schedule(p_cfg->twi_id, &(m_drv_lps25h.xfer)) != HAL_TWI_STATUS_CODE_SUCCESS )
+    {
+        return ( false );
+    }
+    
+    while ( !m_drv_lps25h.xfer_done )
+    {
+        if ( m_drv_lps25h.current_access_mode == DRV_LPS25H_ACCESS_MODE_CPU_INACTIVE )
         {
-            while ( (m_drv_lps25h.current_access_mode == DRV_LPS25H_ACCESS_MODE_CPU_INACTIVE)
-            &&      (!m_drv_lps25h.twi_sig_callback_called) )
-            {
-                m_drv_lps25h.p_drv_lps25h_cfg->p_sleep_hook();
-            }
-
-            m_drv_lps25h.twi_sig_callback_called = false;
-            if ( hal_twi_read(twi_id, 1, p_value) == HAL_TWI_STATUS_CODE_SUCCESS )
-            {
-                while ( (m_drv_lps25h.current_access_mode == DRV_LPS25H_ACCESS_MODE_CPU_INACTIVE)
-                &&      (!m_drv_lps25h.twi_sig_callback_called) )
-                {
-                    m_drv_lps25h.p_drv_lps25h_cfg->p_sleep_hook();
-                }
-
-                return ( true );
-            }
+            p_cfg->p_sleep_hook();
         }
     }
     
-    return ( false );
+    return ( m_drv_lps25h.xfer_success );
 }
 
 
-/* Gets the value of the registers from left to right and stores them at the specified location. */
-static bool two_registers_get(uint8_t reg_a, uint8_t reg_b, uint16_t *value)
+/* Gets the values of the specified number of consecutive registers in one burst read, starting at the specified register. */
+static bool registers_get(uint8_t reg_addr, uint8_t length, uint8_t *p_values)
 {
-    uint8_t  tmp_u8;
-    uint16_t tmp_u16;
-    
-    if ( (m_drv_lps25h.p_drv_lps25h_cfg != NULL)
-    &&   (reg_get(reg_b, &tmp_u8)) )
+    if ( m_drv_lps25h.p_drv_lps25h_cfg != NULL )
     {
-        tmp_u16 = tmp_u8;
-        if ( reg_get(reg_a, &tmp_u8) )
+        if ( length > 1 )
         {
-            *value = (tmp_u16 << 8) | tmp_u8;
-             return ( true );
+            reg_addr |= M_REG_ADDR_AUTO_INCREMENT;
         }
+        
+        return ( xfer_run(1, &reg_addr, length, p_values) );
     }
     
     return ( false );
 }
 
 
-/* Gets the value of the registers from left to right and stores them at the specified location. */
-static bool three_registers_get(uint8_t reg_a, uint8_t reg_b, uint8_t reg_c, uint32_t *value)
+/* Gets the value of the specified register. */
+static bool reg_get(uint8_t reg_addr, uint8_t *p_value)
+{
+    return ( registers_get(reg_addr, 1, p_value) );
+}
+
+
+/* Converts the raw TEMP_OUT value to milli degrees Celcius. */
+static int32_t temperature_convert(uint8_t const *p_temp_out)
+{
+    int16_t tmp_16 = (int16_t)(((uint16_t)p_temp_out[1] << 8) | p_temp_out[0]);
+    
+    //T(milli C) = 42.5 + (TEMP_OUT / 480) * 1000 
+    return ( (425 + ((int32_t)tmp_16 / 48)) * 100 );
+}
+
+
+/* Converts the raw PRESS_OUT value to Pascal. */
+static uint32_t pressure_convert(uint8_t const *p_press_out)
 {
-    uint8_t  tmp_u8;
-    uint32_t tmp_u32;
+    uint32_t tmp_u32 = ((uint32_t)p_press_out[2] << 16) | ((uint32_t)p_press_out[1] << 8) | p_press_out[0];
     
+    // Pout(Pa) = (PRESS_OUT * 100) / 4096
+    return ( (tmp_u32 * 100) / 4096 );
+}
+
+
+/* Sets the specified number of consecutive registers in one burst write, starting at the specified register. */
+static bool registers_set(uint8_t reg_addr, uint8_t length, uint8_t const *p_values)
+{
     if ( (m_drv_lps25h.p_drv_lps25h_cfg != NULL)
-    &&   (reg_get(reg_c, &tmp_u8)) )
+    &&   (length <= M_CTRL_REG_COUNT) )
     {
-        tmp_u32 = tmp_u8;
-        if ( reg_get(reg_b, &tmp_u8) )
-        {
-            tmp_u32 <<= 8;
-            if ( reg_get(reg_a, &tmp_u8) )
-            {
-                *value = (tmp_u32 << 8) | tmp_u8;
-                return ( true );
-            }
-        }
+        uint8_t tx_buffer[1 + M_CTRL_REG_COUNT];
+        
+        tx_buffer[0] = (length > 1) ? (reg_addr | M_REG_ADDR_AUTO_INCREMENT) : reg_addr;
+        memcpy(&(tx_buffer[1]), p_values, length);
+        
+        return ( xfer_run(1 + length, &(tx_buffer[0]), 0, NULL) );
     }
     
     return ( false );
 }
 
 
-/* Sets the specified register to the specified value. */
-static bool reg_set(uint8_t reg_addr, uint8_t value)
+/* Modifies the control registers according to the specified per-register set and clear masks.
+ * The registers are read only if their shadow is invalid, and all changed registers are written in one burst.
+ */
+static bool ctrl_registers_modify(uint8_t const *p_set_masks, uint8_t const *p_clear_masks)
 {
-    if ( m_drv_lps25h.p_drv_lps25h_cfg != NULL )
+    uint8_t new_values[M_CTRL_REG_COUNT];
+    uint8_t first = M_CTRL_REG_COUNT;
+    uint8_t last  = 0;
+    uint8_t range_mask;
+    uint8_t i;
+    
+    if ( m_drv_lps25h.p_drv_lps25h_cfg == NULL )
+    {
+        return ( false );
+    }
+    
+    for ( i = 0; i < M_CTRL_REG_COUNT; i++ )
     {
-        hal_twi_id_t twi_id  = m_drv_lps25h.p_drv_lps25h_cfg->twi_id;
-        uint8_t tx_buffer[2] = {reg_addr, value};
+        if ( (p_set_masks[i] | p_clear_masks[i]) != 0 )
+        {
+            first = (first == M_CTRL_REG_COUNT) ? i : first;
+            last  = i;
+        }
+    }
     
-        hal_twi_stop_mode_set(twi_id, HAL_TWI_STOP_MODE_STOP_ON_TX_BUF_END);
+    if ( first == M_CTRL_REG_COUNT )
+    {
+        return ( true );
+    }
     
-        m_drv_lps25h.twi_sig_callback_called = false;
-        if ( hal_twi_write(twi_id, 2, &(tx_buffer[0])) == HAL_TWI_STATUS_CODE_SUCCESS )
+    range_mask = ((1 << (last + 1)) - 1) & ~((1 << first) - 1);
+    if ( (m_drv_lps25h.ctrl_reg_shadow_valid & range_mask) != range_mask )
+    {
+        if ( !registers_get(M_REGCTRL1 + first, last - first + 1, &(m_drv_lps25h.ctrl_reg_shadow[first])) )
         {
-            while ( (m_drv_lps25h.current_access_mode == DRV_LPS25H_ACCESS_MODE_CPU_INACTIVE)
-            &&      (!m_drv_lps25h.twi_sig_callback_called) )
-            {
-                m_drv_lps25h.p_drv_lps25h_cfg->p_sleep_hook();
-            }
-
-            return ( true );
+            return ( false );
         }
+        m_drv_lps25h.ctrl_reg_shadow_valid |= range_mask;
     }
     
-    return ( false );
-}
-
-
-/* Modifies the specified register according to the specified set and clear masks. */
-static bool register_bits_modify(uint8_t reg, uint8_t set_mask, uint8_t clear_mask)
-{
-    uint8_t  tmp_u8;
+    for ( i = first; i <= last; i++ )
+    {
+        new_values[i] = (m_drv_lps25h.ctrl_reg_shadow[i] | p_set_masks[i]) & ~(p_clear_masks[i]);
+    }
     
-    if ( ((set_mask & clear_mask)       == 0)
-    &&   (m_drv_lps25h.p_drv_lps25h_cfg != NULL)
-    &&   (reg_get(reg, &tmp_u8)) )
+    if ( memcmp(&(new_values[first]), &(m_drv_lps25h.ctrl_reg_shadow[first]), last - first + 1) == 0 )
     {
-        tmp_u8 |= set_mask;
-        tmp_u8 &= ~(clear_mask);
-        return ( reg_set(reg, tmp_u8) );
+        return ( true );
     }
     
+    if ( registers_set(M_REGCTRL1 + first, last - first + 1, &(new_values[first])) )
+    {
+        memcpy(&(m_drv_lps25h.ctrl_reg_shadow[first]), &(new_values[first]), last - first + 1);
+        
+        // The device clears ONE_SHOT by itself when the measurement is done.
+        m_drv_lps25h.ctrl_reg_shadow[1] &= ~(DRV_LSP25H_CTRL_REG_ONE_SHOT_Msk >> 8);
+        
+        // It also clears BOOT and SWRESET when done, and the latter resets the control registers, so the shadow is reloaded.
+        if ( (p_set_masks[1] & ((DRV_LSP25H_CTRL_REG_BOOT_Msk | DRV_LSP25H_CTRL_REG_SWRESET_Msk) >> 8)) != 0 )
+        {
+            m_drv_lps25h.ctrl_reg_shadow_valid = 0;
+        }
+        return ( true );
+    }
+    
+    m_drv_lps25h.ctrl_reg_shadow_valid &= ~range_mask;
     return ( false );
 }
 
 
-/* Handles the signals from the TWI driver. */
-static void hal_twi_sig_callback(hal_twi_signal_type_t hal_twi_signal_type)
+/* Configures the data-ready pin as an input with the specified sense, or disconnects it. */
+static void drdy_pin_cfg(bool connect, uint32_t sense)
 {
-    (void)hal_twi_signal_type;
-    
-    m_drv_lps25h.twi_sig_callback_called = true;
+    NRF_GPIO->PIN_CNF[m_drv_lps25h.p_drv_lps25h_cfg->drdy_pin] =
+        (GPIO_PIN_CNF_DIR_Input     << GPIO_PIN_CNF_DIR_Pos)   |
+        ((connect ? GPIO_PIN_CNF_INPUT_Connect : GPIO_PIN_CNF_INPUT_Disconnect) << GPIO_PIN_CNF_INPUT_Pos) |
+        (GPIO_PIN_CNF_PULL_Disabled << GPIO_PIN_CNF_PULL_Pos)  |
+        (sense                      << GPIO_PIN_CNF_SENSE_Pos);
 }
 
 
 void drv_lps25h_init(void)
 {
-    m_drv_lps25h.p_drv_lps25h_cfg = NULL;
+    m_drv_lps25h.p_drv_lps25h_cfg      = NULL;
+    m_drv_lps25h.ctrl_reg_shadow_valid = 0;
 }
 
 
 uint32_t drv_lps25h_open(drv_lps25h_cfg_t const * const p_drv_lps25h_cfg)
 {
-    if ( hal_twi_open(p_drv_lps25h_cfg->twi_id, &(p_drv_lps25h_cfg->twi_cfg)) == HAL_TWI_STATUS_CODE_SUCCESS )
+    // The TWI peripheral is not opened here: the transaction queue holds it while it has transactions, so that other drivers share it.
+    if ( m_drv_lps25h.p_drv_lps25h_cfg == NULL )
     {
         m_drv_lps25h.p_drv_lps25h_cfg    = p_drv_lps25h_cfg;
         m_drv_lps25h.current_access_mode = DRV_LPS25H_ACCESS_MODE_CPU_ACTIVE;
         
+        if ( p_drv_lps25h_cfg->drdy_wakeup_enabled )
+        {
+            drdy_pin_cfg(true, GPIO_PIN_CNF_SENSE_High);
+            NRF_GPIOTE->EVENTS_PORT = 0;
+            NRF_GPIOTE->INTENSET = (GPIOTE_INTENSET_PORT_Enabled << GPIOTE_INTENSET_PORT_Pos);
+            NVIC_ClearPendingIRQ(GPIOTE_IRQn);
+            NVIC_EnableIRQ(GPIOTE_IRQn);
+        }
+        
         return ( DRV_LPS25H_STATUS_CODE_SUCCESS );
     }
     
@@ -223,13 +294,11 @@ uint32_t drv_lps25h_access_mode_set(drv_lps25h_access_mode_t access_mode)
     if ( access_mode == DRV_LPS25H_ACCESS_MODE_CPU_ACTIVE )
     {
         m_drv_lps25h.current_access_mode = DRV_LPS25H_ACCESS_MODE_CPU_ACTIVE;
-        hal_twi_callback_set(m_drv_lps25h.p_drv_lps25h_cfg->twi_id, NULL);
     }
     else if ( (access_mode == DRV_LPS25H_ACCESS_MODE_CPU_INACTIVE)
     &&        (m_drv_lps25h.p_drv_lps25h_cfg->p_sleep_hook != NULL) )
     {
         m_drv_lps25h.current_access_mode = DRV_LPS25H_ACCESS_MODE_CPU_INACTIVE;
-        hal_twi_callback_set(m_drv_lps25h.p_drv_lps25h_cfg->twi_id, hal_twi_sig_callback);
     }
     else
     {
@@ -257,58 +326,84 @@ uint32_t drv_lps25h_status_reg_get(uint8_t *p_stat_value)
 
 uint32_t drv_lps25h_ctrl_reg_modify(uint32_t set_mask, uint32_t clr_mask)
 {
-    uint8_t set_mask_u8;
-    uint8_t clr_mask_u8;
+    uint8_t set_masks_u8[M_CTRL_REG_COUNT];
+    uint8_t clr_masks_u8[M_CTRL_REG_COUNT];
+    uint8_t i;
     
     if ( (set_mask & clr_mask) != 0 )
     {
         return ( DRV_LPS25H_STATUS_CODE_INVALID_PARAM );
     }
     
-    set_mask_u8 = set_mask & 0xFF;
-    clr_mask_u8 = clr_mask & 0xFF;
-    if ( ((set_mask_u8 | clr_mask_u8) != 0)
-    &&   (!register_bits_modify(M_REGCTRL1, set_mask_u8, clr_mask_u8)) )
+    for ( i = 0; i < M_CTRL_REG_COUNT; i++ )
     {
-        return ( DRV_LPS25H_STATUS_CODE_DISALLOWED );
+        set_masks_u8[i] = (set_mask >> (8 * i)) & 0xFF;
+        clr_masks_u8[i] = (clr_mask >> (8 * i)) & 0xFF;
     }
-        
-    set_mask_u8 = (set_mask >> 8) & 0xFF;
-    clr_mask_u8 = (clr_mask >> 8) & 0xFF;
-    if ( ((set_mask_u8 | clr_mask_u8) != 0)
-    &&   (!register_bits_modify(M_REGCTRL2, set_mask_u8, clr_mask_u8)) )
+    
+    return ( ctrl_registers_modify(&(set_masks_u8[0]), &(clr_masks_u8[0])) ? DRV_LPS25H_STATUS_CODE_SUCCESS : DRV_LPS25H_STATUS_CODE_DISALLOWED );
+}
+
+
+uint32_t drv_lps25h_one_shot_trigger(void)
+{
+    return ( drv_lps25h_ctrl_reg_modify(DRV_LSP25H_CTRL_REG_ONE_SHOT_Start << DRV_LSP25H_CTRL_REG_ONE_SHOT_Pos, 0) );
+}
+
+
+uint32_t drv_lps25h_fifo_mean_mode_set(uint8_t wtm_point)
+{
+    uint8_t fifo_ctrl;
+    
+    switch ( wtm_point )
     {
-        return ( DRV_LPS25H_STATUS_CODE_DISALLOWED );
+        case 0:
+            fifo_ctrl = (DRV_LSP25H_FIFO_CTRL_F_MODE_Bypass << DRV_LSP25H_FIFO_CTRL_F_MODE_Pos);
+            break;
+        case DRV_LSP25H_FIFO_CTRL_WTM_POINT_Mean2:
+        case DRV_LSP25H_FIFO_CTRL_WTM_POINT_Mean4:
+        case DRV_LSP25H_FIFO_CTRL_WTM_POINT_Mean8:
+        case DRV_LSP25H_FIFO_CTRL_WTM_POINT_Mean16:
+        case DRV_LSP25H_FIFO_CTRL_WTM_POINT_Mean32:
+            fifo_ctrl = (DRV_LSP25H_FIFO_CTRL_F_MODE_Mean << DRV_LSP25H_FIFO_CTRL_F_MODE_Pos)
+                      | (wtm_point                        << DRV_LSP25H_FIFO_CTRL_WTM_POINT_Pos);
+            break;
+        default:
+            return ( DRV_LPS25H_STATUS_CODE_INVALID_PARAM );
     }
-
-    set_mask_u8 = (set_mask >> 16) & 0xFF;
-    clr_mask_u8 = (clr_mask >> 16) & 0xFF;
-    if ( ((set_mask_u8 | clr_mask_u8) != 0)
-    &&   (!register_bits_modify(M_REGCTRL3, set_mask_u8, clr_mask_u8)) )
+    
+    if ( !registers_set(M_REGFIFOCTRL, 1, &fifo_ctrl) )
     {
         return ( DRV_LPS25H_STATUS_CODE_DISALLOWED );
     }
+    
+    return ( (wtm_point == 0)
+           ? drv_lps25h_ctrl_reg_modify(0, DRV_LSP25H_CTRL_REG_FIFO_EN_Msk)
+           : drv_lps25h_ctrl_reg_modify(DRV_LSP25H_CTRL_REG_FIFO_EN_Enabled << DRV_LSP25H_CTRL_REG_FIFO_EN_Pos, 0) );
+}
+
 
-    set_mask_u8 = (set_mask >> 24) & 0xFF;
-    clr_mask_u8 = (clr_mask >> 24) & 0xFF;
-    if ( ((set_mask_u8 | clr_mask_u8) != 0)
-    &&   (!register_bits_modify(M_REGCTRL4, set_mask_u8, clr_mask_u8)) )
+uint32_t drv_lps25h_ctrl_reg_reset_assume(void)
+{
+    if ( m_drv_lps25h.p_drv_lps25h_cfg == NULL )
     {
         return ( DRV_LPS25H_STATUS_CODE_DISALLOWED );
     }
     
+    memset(&(m_drv_lps25h.ctrl_reg_shadow[0]), 0, sizeof(m_drv_lps25h.ctrl_reg_shadow));
+    m_drv_lps25h.ctrl_reg_shadow_valid = (1 << M_CTRL_REG_COUNT) - 1;
+    
     return ( DRV_LPS25H_STATUS_CODE_SUCCESS );
 }
 
 
 uint32_t drv_lps25h_temperature_get(int32_t * p_temperature_milli_deg)
 {
-    int16_t tmp_16;
+    uint8_t temp_out[2];
     
-    if ( two_registers_get(M_REGTEMPOUTL, M_REGTEMPOUTH, (uint16_t *)(&tmp_16)) )
+    if ( registers_get(M_REGTEMPOUTL, sizeof(temp_out), &(temp_out[0])) )
     {
-        //T(milli C) = 42.5 + (TEMP_OUT / 480) * 1000 
-        *p_temperature_milli_deg = (425 + ((int32_t)tmp_16 / 48)) * 100;
+        *p_temperature_milli_deg = temperature_convert(&(temp_out[0]));
         
         return ( DRV_LPS25H_STATUS_CODE_SUCCESS );
     }
@@ -319,26 +414,69 @@ uint32_t drv_lps25h_temperature_get(int32_t * p_temperature_milli_deg)
 
 uint32_t drv_lps25h_pressure_get(uint32_t * p_pressure_pa)
 {
-    uint32_t tmp_u32;
+    uint8_t press_out[3];
+    
+    if ( registers_get(M_REGPRESSOUTXL, sizeof(press_out), &(press_out[0])) )
+    {
+        *p_pressure_pa = pressure_convert(&(press_out[0]));
+        
+        return ( DRV_LPS25H_STATUS_CODE_SUCCESS );
+    }
+    
+    return ( DRV_LPS25H_STATUS_CODE_DISALLOWED );
+    
+}
+
+
+uint32_t drv_lps25h_outputs_get(int32_t * p_temperature_milli_deg, uint32_t * p_pressure_pa)
+{
+    uint8_t outputs[M_OUTPUTS_SIZE];
     
-    if ( three_registers_get(M_REGPRESSOUTXL, M_REGPRESSOUTL, M_REGPRESSOUTH, &tmp_u32) )
+    if ( registers_get(M_REGPRESSOUTXL, sizeof(outputs), &(outputs[0])) )
     {
-        // Pout(Pa) = (PRESS_OUT * 100) / 4096
-        *p_pressure_pa = (tmp_u32 * 100) / 4096;
+        *p_pressure_pa           = pressure_convert(&(outputs[M_REGPRESSOUTXL - M_REGPRESSOUTXL]));
+        *p_temperature_milli_deg = temperature_convert(&(outputs[M_REGTEMPOUTL - M_REGPRESSOUTXL]));
         
         return ( DRV_LPS25H_STATUS_CODE_SUCCESS );
     }
     
     return ( DRV_LPS25H_STATUS_CODE_DISALLOWED );
+}
+
+
+bool drv_lps25h_drdy_isr_handler(void)
+{
+    if ( NRF_GPIOTE->EVENTS_PORT != 0 )
+    {
+        NRF_GPIOTE->EVENTS_PORT = 0;
+        
+        if ( (m_drv_lps25h.p_drv_lps25h_cfg != NULL)
+        &&   (m_drv_lps25h.p_drv_lps25h_cfg->drdy_wakeup_enabled) )
+        {
+            // The pin stays high until the outputs are read, so stop sensing it to wake up only once.
+            drdy_pin_cfg(true, GPIO_PIN_CNF_SENSE_Disabled);
+            return ( true );
+        }
+    }
     
+    return ( false );
 }
 
 
 uint32_t drv_lps25h_close(void)
 {
-    if ( hal_twi_close(m_drv_lps25h.p_drv_lps25h_cfg->twi_id) == HAL_TWI_STATUS_CODE_SUCCESS )
+    // Every register access is done on return, and the transactions of other drivers are left to the queue.
+    if ( m_drv_lps25h.p_drv_lps25h_cfg != NULL )
     {
-        m_drv_lps25h.p_drv_lps25h_cfg = NULL;
+        if ( m_drv_lps25h.p_drv_lps25h_cfg->drdy_wakeup_enabled )
+        {
+            NVIC_DisableIRQ(GPIOTE_IRQn);
+            NRF_GPIOTE->INTENCLR = (GPIOTE_INTENCLR_PORT_Clear << GPIOTE_INTENCLR_PORT_Pos);
+            drdy_pin_cfg(false, GPIO_PIN_CNF_SENSE_Disabled);
+        }
+        
+        m_drv_lps25h.p_drv_lps25h_cfg      = NULL;
+        m_drv_lps25h.ctrl_reg_shadow_valid = 0;
         
         return ( DRV_LPS25H_STATUS_CODE_SUCCESS );
     }
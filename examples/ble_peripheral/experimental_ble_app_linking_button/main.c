@@ -226,6 +226,7 @@ static void services_init(void)
     init.notifycategory       = PDNS_NOTIFY_CATEGORY_NOTNOTIFY;
     //PDSIS
     init.sensortypes          = PDSIS_SENSOR_BITMASK_NONE;
+    init.pdsis_heartbeat      = 0;
     init.pdsis_event_handler  = NULL;
     //PDSOS
     init.pdsos_event_handler  = NULL;
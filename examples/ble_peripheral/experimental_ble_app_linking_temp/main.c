@@ -38,6 +38,7 @@
 #include "ble_conn_state.h"
 #include "nrf_log.h"
 #include "bsp_btn_ble.h"
+#include "hal_temp.h"
 
 #define CENTRAL_LINK_COUNT              0                                           /**< Number of central links used by the application. When changing this number remember to adjust the RAM settings*/
 #define PERIPHERAL_LINK_COUNT           1                                           /**< Number of peripheral links used by the application. When changing this number remember to adjust the RAM settings*/
@@ -73,12 +74,15 @@
 
 #define DEAD_BEEF                        0xDEADBEEF                                  /**< Value used as error code on stack dump, can be used to identify stack location on stack unwind. */
 
-#define PDSIS_NOTIFY_INTERVAL            APP_TIMER_TICKS(5000, APP_TIMER_PRESCALER) /**< PDSIS Notify interval (ticks). */
+#define PDSIS_NOTIFY_INTERVAL            APP_TIMER_TICKS(1000, APP_TIMER_PRESCALER) /**< PDSIS sampling interval (ticks), values within the threshold are not indicated. */
+#define PDSIS_HEARTBEAT                  30                                         /**< Indicate every 30th value (30 s) even if within the threshold. */
 APP_TIMER_DEF(m_pdsis_notify_timer_tmp);                                            /**< PDSIS Notify timer for temperature notification*/
 APP_TIMER_DEF(m_pdsis_notify_timer_hum);                                            /**< PDSIS Notify timer for humidity notification*/
 
 static uint16_t                         m_conn_handle = BLE_CONN_HANDLE_INVALID;    /**< Handle of the current connection. */
 static ble_pdls_t                       m_pdls;                                     /**< PDLP Service instance. */
+static volatile int32_t                 m_soc_temp;                                 /**< The last SoC temperature sample, in steps of 0.25 degrees Celsius. */
+static volatile bool                    m_temp_notify_requested;                    /**< The next SoC temperature sample is to be notified. */
 
 /**@brief Function for assert macro callback.
  *
@@ -96,22 +100,39 @@ void assert_nrf_callback(uint16_t line_num, const uint8_t * p_file_name)
     app_error_handler(DEAD_BEEF, line_num, p_file_name);
 }
 
-static void pdsis_temp_timeout_handler(void * p_context)
+/**@brief Function for handling the software interrupt in which the SoC temperature is sampled.
+ */
+void HAL_TEMP_SWI_IRQHandler(void)
 {
-    int32_t  i_temp;
+    (void)hal_temp_isr_handler();
+}
+
+/**@brief Function for handling a finished SoC temperature sample.
+ *
+ * @param[in] temp  The temperature in steps of 0.25 degrees Celsius.
+ */
+static void temp_sample_handler(int32_t temp)
+{
+    m_soc_temp = temp;
     
-    // Read SoC temperature
-    uint32_t err_code = sd_temp_get(&i_temp);
-    if (err_code == NRF_SUCCESS)
+    if (m_temp_notify_requested)
     {
         ble_pdsis_notify_value_t value;
-        ble_pdls_t * p_pdls       = (ble_pdls_t *)p_context;
-        value.u16_originaldata[0] = IEEE754_Convert_Temperature(i_temp*0.25f);
         
-        ble_pdls_pdsis_notify(p_pdls, PDSIS_SENSOR_TYPE_TEMPERATURE, &value);
+        m_temp_notify_requested   = false;
+        value.u16_originaldata[0] = IEEE754_Convert_Temperature(temp*0.25f);
+        
+        ble_pdls_pdsis_notify(&m_pdls, PDSIS_SENSOR_TYPE_TEMPERATURE, &value);
     }
 }
 
+static void pdsis_temp_timeout_handler(void * p_context)
+{
+    // Sample the SoC temperature, and notify it when done. A sample already in progress is notified instead.
+    m_temp_notify_requested = true;
+    (void)hal_temp_sample_start(temp_sample_handler);
+}
+
 static void pdsis_hum_timeout_handler(void * p_context)
 {
     static uint8_t count = 1;
@@ -317,16 +338,10 @@ static ble_pdls_result_code_t pdsis_event_handler(ble_pdls_t * p_pdls, ble_pdsis
         {
           if (p_pdsis_event->type == PDSIS_SENSOR_TYPE_TEMPERATURE)
           {
-            int32_t  i_temp;
-            
-            // Read SoC temperature
-            err_code = sd_temp_get(&i_temp);
-            if (err_code != NRF_SUCCESS)
-            {
-              return PDLS_RESULT_ERROR_FAILED;
-            }
+            // The answer cannot wait for a sample, so give the last one, and take a new one for the next request.
             // Encode in DoCoMo format
-            p_pdsis_event->data.u16_originaldata[0] = IEEE754_Convert_Temperature(i_temp*0.25f);
+            p_pdsis_event->data.u16_originaldata[0] = IEEE754_Convert_Temperature(m_soc_temp*0.25f);
+            (void)hal_temp_sample_start(temp_sample_handler);
             return PDLS_RESULT_OK;
           }
           else if (p_pdsis_event->type == PDSIS_SENSOR_TYPE_HUMIDITY)
@@ -361,10 +376,14 @@ static void services_init(void)
     init.notifycategory       = PDNS_NOTIFY_CATEGORY_NOTNOTIFY;
     //PDSIS
     init.sensortypes          = PDSIS_SENSOR_BITMASK_TEMPERATURE | PDSIS_SENSOR_BITMASK_HUMIDITY;
+    init.pdsis_heartbeat      = PDSIS_HEARTBEAT;
     init.pdsis_event_handler  = pdsis_event_handler;
   
     err_code = ble_pdls_init(&m_pdls, &init);
     APP_ERROR_CHECK(err_code);
+    
+    // Take a first SoC temperature sample for the first sensor info request.
+    (void)hal_temp_sample_start(temp_sample_handler);
 }
 
 